@@ -8,10 +8,9 @@ local texture = require("texture")
 
 local gifrecorder = {}
 
-gifrecorder._VERSION = "1.1.0"
+gifrecorder._VERSION = "2.0.0"
 
 local KEY_F7 = 64
-local KEY_F8 = 65
 
 gifrecorder.Recorder = {}
 
@@ -21,74 +20,41 @@ function gifrecorder.Recorder:new(o)
     setmetatable(recorder, self)
     self.__index = self
 
-    recorder.frames = {}
-    recorder.is_recording = false
-    recorder.is_key_down = keyboard.key(KEY_F8)
-    recorder.scale = recorder.scale or 1
+    recorder.is_key_down = keyboard.key(KEY_F7)
 
     return recorder
 end
 
---- Record a single frame
-function gifrecorder.Recorder:record()
-    local render_texture = graphics.get_render_texture()
-    table.insert(self.frames, texture.copy(render_texture))
+--- Start recording the screen. Frames are captured and encoded by the engine.
+---@param filename? string
+function gifrecorder.Recorder:start(filename)
+    gif.record(filename)
 end
 
---- Save gif with given filename
----@param filename string
-function gifrecorder.Recorder:save(filename)
-    local frames = {}
-
-    for _, frame in ipairs(self.frames) do
-        local w = frame.width * self.scale
-        local h = frame.height * self.scale
-        local t = texture.new(w, h)
-        t:blit(frame, 0, 0, w, h)
-
-        table.insert(frames, t)
-    end
-
-    gif.save(filename, frames)
+--- Stop recording and save gif
+function gifrecorder.Recorder:stop()
+    gif.stop()
 end
 
---- Clear internal frame buffer
-function gifrecorder.Recorder:reset()
-    self.frames = {}
+--- Check if currently recording
+---@return boolean
+function gifrecorder.Recorder:is_recording()
+    return gif.is_recording()
 end
 
---- Update recorder state. Should be called each frame.
+--- Update recorder state. Should be called each frame. F8 toggles recording
+--- in the engine.
 function gifrecorder.Recorder:update()
-    if not self.is_key_down then
-        -- Take a single screenshot
-        if keyboard.key(KEY_F7) then
-            local name = string.format("screenshot_%s.gif", os.date("%Y%m%d%H%M%S"))
-
-            print(string.format("Saving %s", name))
+    -- Take a single screenshot
+    if not self.is_key_down and keyboard.key(KEY_F7) then
+        local name = string.format("screenshot_%s.gif", os.date("%Y%m%d%H%M%S"))
 
-            gif.save(name, texture.copy(graphics.get_render_texture()))
+        print(string.format("Saving %s", name))
 
-        -- Record the screen
-        elseif keyboard.key(KEY_F8) then
-            -- If currently recording save and stop
-            if self.is_recording then
-                local name = string.format("screenshot_%s.gif", os.date("%Y%m%d%H%M%S"))
-
-                print(string.format("Saving %s (%s frames)", name, #self.frames))
-
-                self:save(name)
-                self:reset()
-            end
-
-            self.is_recording = not self.is_recording
-        end
+        gif.save(name, texture.copy(graphics.get_render_texture()))
     end
 
-    self.is_key_down = keyboard.key(KEY_F7) or keyboard.key(KEY_F8)
-
-    if self.is_recording then
-        self:record()
-    end
+    self.is_key_down = keyboard.key(KEY_F7)
 end
 
 return gifrecorder
@@ -4,14 +4,23 @@
 local assets = {}
 
 --- Get texture for given filename and frame
---- @param filename string  Name of texture asset to look for
+--- @param filename string|integer  Name or handle of texture asset to look for
 --- @param frame integer?  Index of frame (default 1)
 --- @return texture Texture userdata if found, nil otherwise.
 function assets.get_texture(filename, frame) end
 
 --- Get sound for given filename
---- @param filename string  Name of sound asset to look for
+--- @param filename string|integer  Name or handle of sound asset to look for
 --- @return sound Sound userdata if found, nil otherwise.
 function assets.get_sound(filename) end
 
+--- Get handle for given filename. Handles can be used in place of filenames and are faster to look up.
+--- @param filename string  Name of asset to look for
+--- @return integer? Asset handle if found, nil otherwise.
+function assets.handle(filename) end
+
+--- Start loading assets in the background so they are resident by the time they are used. Only has an effect when assets are loaded lazily.
+--- @param filenames (string|integer)[]  Names or handles of assets to load
+function assets.prefetch(filenames) end
+
 return assets
\ No newline at end of file
@@ -3,9 +3,41 @@
 --- Module for working with gif data.
 local gif = {}
 
---- Save frames as an animated GIF.
+--- Save frames as an animated GIF. All frames must be the same size. Raises
+--- an error if the GIF could not be saved.
 --- @param filename string  Name of GIF to save.
 --- @param frames texture[]  Array of texture userdata.
 function gif.save(filename, frames) end
 
-return gif
\ No newline at end of file
+--- Open a GIF for writing frames as they are made.
+--- @param filename string  Name of GIF to save.
+--- @param width? integer  Frame width. Defaults to render texture width.
+--- @param height? integer  Frame height. Defaults to render texture height.
+--- @return gif.encoder
+function gif.open(filename, width, height) end
+
+--- Start recording the screen to a GIF. Frames are encoded in the background. Recording can also be toggled with F8.
+--- @param filename? string  Name of GIF to save. Defaults to a timestamped name.
+--- @return boolean  True if recording started.
+function gif.record(filename) end
+
+--- Stop recording and save GIF.
+function gif.stop() end
+
+--- Check if screen is being recorded.
+--- @return boolean
+function gif.is_recording() end
+
+--- @class gif.encoder
+gif.encoder = {}
+
+--- Write frame to GIF. Only pixels changed since the previous frame are stored.
+--- @param frame texture  Frame to write. Must match GIF size.
+--- @param delay? number  Seconds frame is shown for. Defaults to 1/50.
+function gif.encoder:add_frame(frame, delay) end
+
+--- Finish and close GIF.
+--- @return boolean  True if whole GIF was written.
+function gif.encoder:close() end
+
+return gif
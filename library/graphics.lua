@@ -59,4 +59,22 @@ function graphics.set_global_palette_color(index, r, g, b) end
 --- @param height integer  Resolution height
 function graphics.set_resolution(width, height) end
 
+--- Bakes a shade table from the current palette.
+--- @param levels integer  Number of brightness levels.
+--- @param r integer?  Fog red value. [0, 255] (default 0)
+--- @param g integer?  Fog green value. [0, 255] (default 0)
+--- @param b integer?  Fog blue value. [0, 255] (default 0)
+--- @return texture Shade table texture of size levels x 256.
+function graphics.bake_shade_table(levels, r, g, b) end
+
+--- Begins a scene. Until the scene ends, the render texture is reduced in size when frames go over budget.
+function graphics.begin_scene() end
+
+--- Ends current scene and upscales it to fill the render texture.
+function graphics.end_scene() end
+
+--- Get current scene scale.
+--- @return number  Fraction of full resolution scenes are rendered at.
+function graphics.get_scene_scale() end
+
 return graphics
\ No newline at end of file
@@ -15,20 +15,40 @@ matrix2.matrix2 = {}
 function matrix2.matrix2:determinant() end
 
 --- Negates a matrix.
+--- @param out matrix2?  Destination, a new matrix2 is returned if omitted
 --- @return matrix2 
-function matrix2.matrix2:negative() end
+function matrix2.matrix2:negative(out) end
+
+--- Same as negative, but writes the result to the matrix.
+--- @return matrix2
+function matrix2.matrix2:negative_() end
 
 --- Transpose of matrix.
+--- @param out matrix2?  Destination, a new matrix2 is returned if omitted
 --- @return matrix2 
-function matrix2.matrix2:transpose() end
+function matrix2.matrix2:transpose(out) end
+
+--- Same as transpose, but writes the result to the matrix.
+--- @return matrix2
+function matrix2.matrix2:transpose_() end
 
 --- Cofactor of matrix.
+--- @param out matrix2?  Destination, a new matrix2 is returned if omitted
 --- @return matrix2 
-function matrix2.matrix2:cofactor() end
+function matrix2.matrix2:cofactor(out) end
+
+--- Same as cofactor, but writes the result to the matrix.
+--- @return matrix2
+function matrix2.matrix2:cofactor_() end
 
 --- Inverse of matrix.
+--- @param out matrix2?  Destination, a new matrix2 is returned if omitted
 --- @return matrix2 
-function matrix2.matrix2:inverse() end
+function matrix2.matrix2:inverse(out) end
+
+--- Same as inverse, but writes the result to the matrix.
+--- @return matrix2
+function matrix2.matrix2:inverse_() end
 
 --- Scales matrix in-place.
 --- @param v0 vector2 
@@ -50,6 +70,15 @@ function matrix2.matrix2:scale(x, y, z) end
 --- @return matrix2 
 function matrix2.new(m11, m21, m12, m22) end
 
+--- Returns a matrix2 from a pool of temporaries. Values are handed out again next
+--- frame, so they must not be kept.
+--- @param m11 number? 
+--- @param m21 number? 
+--- @param m12 number? 
+--- @param m22 number? 
+--- @return matrix2
+function matrix2.scratch(m11, m21, m12, m22) end
+
 --- Returns a matrix with all elements set to zero.
 --- @return matrix2 
 function matrix2.zero() end
@@ -74,7 +103,19 @@ function matrix2.scaling(x, y, z) end
 --- @param m0 matrix2 
 --- @param m1 matrix2 
 --- @param f number 
+--- @param out matrix2?  Destination, a new matrix2 is returned if omitted
 --- @return matrix2 
-function matrix2.lerp(m0, m1, f) end
+function matrix2.lerp(m0, m1, f, out) end
+
+--- Same as lerp, but writes the result to the matrix.
+--- @param m1 matrix2 
+--- @param f number 
+--- @return matrix2
+function matrix2.matrix2:lerp_(m1, f) end
+
+--- Same as the multiply operator, but writes the result to the matrix.
+--- @param m1 matrix2|number
+--- @return matrix2
+function matrix2.matrix2:multiply_(m1) end
 
 return matrix2
\ No newline at end of file
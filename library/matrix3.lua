@@ -20,20 +20,40 @@ matrix3.matrix3 = {}
 function matrix3.matrix3:determinant() end
 
 --- Negates a matrix.
+--- @param out matrix3?  Destination, a new matrix3 is returned if omitted
 --- @return matrix3 
-function matrix3.matrix3:negative() end
+function matrix3.matrix3:negative(out) end
+
+--- Same as negative, but writes the result to the matrix.
+--- @return matrix3
+function matrix3.matrix3:negative_() end
 
 --- Transpose of matrix.
+--- @param out matrix3?  Destination, a new matrix3 is returned if omitted
 --- @return matrix3 
-function matrix3.matrix3:transpose() end
+function matrix3.matrix3:transpose(out) end
+
+--- Same as transpose, but writes the result to the matrix.
+--- @return matrix3
+function matrix3.matrix3:transpose_() end
 
 --- Cofactor of matrix.
+--- @param out matrix3?  Destination, a new matrix3 is returned if omitted
 --- @return matrix3 
-function matrix3.matrix3:cofactor() end
+function matrix3.matrix3:cofactor(out) end
+
+--- Same as cofactor, but writes the result to the matrix.
+--- @return matrix3
+function matrix3.matrix3:cofactor_() end
 
 --- Inverse of matrix.
+--- @param out matrix3?  Destination, a new matrix3 is returned if omitted
 --- @return matrix3 
-function matrix3.matrix3:inverse() end
+function matrix3.matrix3:inverse(out) end
+
+--- Same as inverse, but writes the result to the matrix.
+--- @return matrix3
+function matrix3.matrix3:inverse_() end
 
 --- Scales matrix in-place.
 --- @param v0 vector3 
@@ -60,6 +80,20 @@ function matrix3.matrix3:scale(x, y, z) end
 --- @return matrix3 
 function matrix3.new(m11, m21, m31, m12, m22, m32, m13, m23, m33) end
 
+--- Returns a matrix3 from a pool of temporaries. Values are handed out again next
+--- frame, so they must not be kept.
+--- @param m11 number? 
+--- @param m21 number? 
+--- @param m31 number? 
+--- @param m12 number? 
+--- @param m22 number? 
+--- @param m32 number? 
+--- @param m13 number? 
+--- @param m23 number? 
+--- @param m33 number? 
+--- @return matrix3
+function matrix3.scratch(m11, m21, m31, m12, m22, m32, m13, m23, m33) end
+
 --- Returns a matrix with all elements set to zero.
 --- @return matrix3 
 function matrix3.zero() end
@@ -70,8 +104,9 @@ function matrix3.identity() end
 
 --- Creates a rotation matrix
 --- @param q0 quaternion 
+--- @param out matrix3?  Destination, a new matrix3 is returned if omitted
 --- @return matrix3 
-function matrix3.rotation(q0) end
+function matrix3.rotation(q0, out) end
 
 --- Creates a scaling matrix
 --- @param v0 vector3 
@@ -89,7 +124,19 @@ function matrix3.scaling(x, y, z) end
 --- @param m0 matrix3 
 --- @param m1 matrix3 
 --- @param f number 
+--- @param out matrix3?  Destination, a new matrix3 is returned if omitted
 --- @return matrix3 
-function matrix3.lerp(m0, m1, f) end
+function matrix3.lerp(m0, m1, f, out) end
+
+--- Same as lerp, but writes the result to the matrix.
+--- @param m1 matrix3 
+--- @param f number 
+--- @return matrix3
+function matrix3.matrix3:lerp_(m1, f) end
+
+--- Same as the multiply operator, but writes the result to the matrix.
+--- @param m1 matrix3|number
+--- @return matrix3
+function matrix3.matrix3:multiply_(m1) end
 
 return matrix3
\ No newline at end of file
@@ -23,6 +23,27 @@ local matrix4 = {}
 --- @return matrix4 
 function matrix4.new(m11, m21, m31, m41, m12, m22, m32, m42, m13, m23, m33, m43, m14, m24, m34, m44) end
 
+--- Returns a matrix4 from a pool of temporaries. Values are handed out again next
+--- frame, so they must not be kept.
+--- @param m11 number? 
+--- @param m21 number? 
+--- @param m31 number? 
+--- @param m41 number? 
+--- @param m12 number? 
+--- @param m22 number? 
+--- @param m32 number? 
+--- @param m42 number? 
+--- @param m13 number? 
+--- @param m23 number? 
+--- @param m33 number? 
+--- @param m43 number? 
+--- @param m14 number? 
+--- @param m24 number? 
+--- @param m34 number? 
+--- @param m44 number? 
+--- @return matrix4
+function matrix4.scratch(m11, m21, m31, m41, m12, m22, m32, m42, m13, m23, m33, m43, m14, m24, m34, m44) end
+
 --- Returns a matrix with all elements set to zero.
 --- @return matrix4 
 function matrix4.zero() end
@@ -33,8 +54,9 @@ function matrix4.identity() end
 
 --- Creates a rotation matrix
 --- @param q0 quaternion 
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.rotation(q0) end
+function matrix4.rotation(q0, out) end
 
 --- Creates a translation matrix
 --- @param v0 vector3 
@@ -64,15 +86,23 @@ function matrix4.scaling(x, y, z) end
 --- @param m0 matrix4 
 --- @param m1 matrix4 
 --- @param f number 
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.lerp(m0, m1, f) end
+function matrix4.lerp(m0, m1, f, out) end
+
+--- Same as lerp, but writes the result to the matrix.
+--- @param m1 matrix4 
+--- @param f number 
+--- @return matrix4
+function matrix4.matrix4:lerp_(m1, f) end
 
 --- Creates a look at transformation.
 --- @param position vector3 
 --- @param target vector3 
 --- @param up vector3 
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.look_at(position, target, up) end
+function matrix4.look_at(position, target, up, out) end
 
 --- Creates an orthographic view transformation.
 --- @param l number 
@@ -81,16 +111,18 @@ function matrix4.look_at(position, target, up) end
 --- @param t number 
 --- @param n number 
 --- @param f number 
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.ortho(l, r, b, t, n, f) end
+function matrix4.ortho(l, r, b, t, n, f, out) end
 
 --- Creates an perspective view transformation.
 --- @param fov_y number 
 --- @param aspect number 
 --- @param n number 
 --- @param f number 
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.perspective(fov_y, aspect, n, f) end
+function matrix4.perspective(fov_y, aspect, n, f, out) end
 
 --- Creates an perspective view transformation.
 --- @param fov_y number 
@@ -98,15 +130,17 @@ function matrix4.perspective(fov_y, aspect, n, f) end
 --- @param h number 
 --- @param n number 
 --- @param f number 
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.perspective_fov(fov_y, w, h, n, f) end
+function matrix4.perspective_fov(fov_y, w, h, n, f, out) end
 
 --- Creates an perspective view transformation.
 --- @param fov_y number 
 --- @param aspect number 
 --- @param n number 
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.perspective_infinite(fov_y, aspect, n) end
+function matrix4.perspective_infinite(fov_y, aspect, n, out) end
 
 --- @class matrix4
 --- @field m11 number
@@ -132,20 +166,40 @@ matrix4.matrix4 = {}
 function matrix4.matrix4:determinant() end
 
 --- Negates a matrix.
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.matrix4:negative() end
+function matrix4.matrix4:negative(out) end
+
+--- Same as negative, but writes the result to the matrix.
+--- @return matrix4
+function matrix4.matrix4:negative_() end
 
 --- Transpose of matrix.
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.matrix4:transpose() end
+function matrix4.matrix4:transpose(out) end
+
+--- Same as transpose, but writes the result to the matrix.
+--- @return matrix4
+function matrix4.matrix4:transpose_() end
 
 --- Cofactor of matrix.
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.matrix4:cofactor() end
+function matrix4.matrix4:cofactor(out) end
+
+--- Same as cofactor, but writes the result to the matrix.
+--- @return matrix4
+function matrix4.matrix4:cofactor_() end
 
 --- Inverse of matrix.
+--- @param out matrix4?  Destination, a new matrix4 is returned if omitted
 --- @return matrix4 
-function matrix4.matrix4:inverse() end
+function matrix4.matrix4:inverse(out) end
+
+--- Same as inverse, but writes the result to the matrix.
+--- @return matrix4
+function matrix4.matrix4:inverse_() end
 
 --- Translates matrix in-place.
 --- @param v0 vector3 
@@ -171,4 +225,27 @@ function matrix4.matrix4:scale(v0) end
 --- @return matrix4 
 function matrix4.matrix4:scale(x, y, z) end
 
+--- Same as the multiply operator, but writes the result to the matrix.
+--- @param m1 matrix4|number
+--- @return matrix4
+function matrix4.matrix4:multiply_(m1) end
+
+--- Transforms all points in a floatarray. Points have w of 1.
+--- @param m0 matrix4
+--- @param points floatarray  Points with x, y and z components
+--- @param out floatarray?  Destination, grown if needed. May be points. A new floatarray is returned if omitted
+--- @param stride integer?  Floats between points, default 3. With 4 or more, w is stored as fourth component
+--- @return floatarray
+function matrix4.transform_points(m0, points, out, stride) end
+
+--- Projects all points in a floatarray to screen. Stores screen x and y and depth, plus w if stride is 4 or more. Points with w of 0 or less are behind the camera.
+--- @param m0 matrix4  View projection matrix
+--- @param points floatarray  Points with x, y and z components
+--- @param out floatarray?  Destination, grown if needed. May be points. A new floatarray is returned if omitted
+--- @param width number  Viewport width
+--- @param height number  Viewport height
+--- @param stride integer?  Floats between points, default 3
+--- @return floatarray
+function matrix4.project_points(m0, points, out, width, height, stride) end
+
 return matrix4
\ No newline at end of file
@@ -0,0 +1,38 @@
+--- @meta
+
+--- Module for mode7 renderer
+local mode7 = {}
+
+--- @class Renderer
+mode7.Renderer = {}
+
+--- Creates a mode7 renderer object.
+--- @param texture texture?  Texture to render to. Defaults to the render texture.
+--- @return Renderer 
+function mode7.Renderer:new(texture) end
+
+--- Clears internal buffers.
+--- @param target string?  One of: "all" (default), "color", or "depth".
+function mode7.Renderer:clear(target) end
+
+--- Renders given texture as the ground plane.
+--- @param plane texture  Texture to render.
+function mode7.Renderer:render(plane) end
+
+--- Renders given sprite standing on the plane.
+--- @param sprite texture  Sprite to render.
+--- @param position vector3  Position of sprite. The z-component is height above the plane.
+function mode7.Renderer:render(sprite, position) end
+
+--- Set renderer's camera data.
+--- @param position vector3  Camera position. The z-component is height above the plane.
+--- @param direction vector2  Camera forward vector.
+--- @param fov number  Camera field of view in degrees.
+function mode7.Renderer:camera(position, direction, fov) end
+
+--- Access renderer's features.
+--- @param name string  Feature name.
+--- @param value any?  Value to set feature to.
+function mode7.Renderer:feature(name, value) end
+
+return mode7
@@ -11,10 +11,24 @@ local quaternion = {}
 --- @return quaternion 
 function quaternion.new(x, y, z, w) end
 
+--- Returns a quaternion from a pool of temporaries. Values are handed out again next
+--- frame, so they must not be kept.
+--- @param x number 
+--- @param y number 
+--- @param z number 
+--- @param w number 
+--- @return quaternion
+function quaternion.scratch(x, y, z, w) end
+
 --- Creates quaternion with same rotation, but magnitude of 1.
 --- @param q0 quaternion 
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.normalize(q0) end
+function quaternion.normalize(q0, out) end
+
+--- Same as normalize, but writes the result to the quaternion.
+--- @return quaternion
+function quaternion.quaternion:normalize_() end
 
 --- Dot product of two quaternions.
 --- @param q0 quaternion 
@@ -25,19 +39,22 @@ function quaternion.normalize(q0, q1) end
 --- Creates a rotation from a unit vector and angle to rotate around the vector.
 --- @param v0 vector3 
 --- @param radians number 
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.from_axis_angle(v0, radians) end
+function quaternion.from_axis_angle(v0, radians, out) end
 
 --- Creates a rotation from v0 to v1.
 --- @param v0 vector3 
 --- @param v1 vector3 
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.from_vector3(v0, v1) end
+function quaternion.from_vector3(v0, v1, out) end
 
 --- Create a rotation from a rotation matrix.
 --- @param m0 matrix4 
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.from_matrix4(m0) end
+function quaternion.from_matrix4(m0, out) end
 
 --- Create a rotation from Euler angles.
 --- @param v0 vector3 
@@ -60,15 +77,29 @@ function quaternion.to_euler(q0) end
 --- @param q0 quaternion 
 --- @param q1 quaternion 
 --- @param t number  Value used to interpolate between q0 and q1.
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.lerp(q0, q1, t) end
+function quaternion.lerp(q0, q1, t, out) end
+
+--- Same as lerp, but writes the result to the quaternion.
+--- @param q1 quaternion 
+--- @param t number  Value used to interpolate between q0 and q1.
+--- @return quaternion
+function quaternion.quaternion:lerp_(q1, t) end
 
 --- Linearly interpolate between q0 and q1, using spherical linear interpolation.
 --- @param q0 quaternion 
 --- @param q1 quaternion 
 --- @param t number  Value used to interpolate between q0 and q1.
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.slerp(q0, q1, t) end
+function quaternion.slerp(q0, q1, t, out) end
+
+--- Same as slerp, but writes the result to the quaternion.
+--- @param q1 quaternion 
+--- @param t number  Value used to interpolate between q0 and q1.
+--- @return quaternion
+function quaternion.quaternion:slerp_(q1, t) end
 
 --- Get angle between two rotations
 --- @param q0 quaternion 
@@ -84,12 +115,22 @@ function quaternion.angle(q0, q1) end
 quaternion.quaternion = {}
 
 --- Conjugate of quaternion.
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.quaternion:conjugate() end
+function quaternion.quaternion:conjugate(out) end
+
+--- Same as conjugate, but writes the result to the quaternion.
+--- @return quaternion
+function quaternion.quaternion:conjugate_() end
 
 --- Inverse of quaternion.
+--- @param out quaternion?  Destination, a new quaternion is returned if omitted
 --- @return quaternion 
-function quaternion.quaternion:inverse() end
+function quaternion.quaternion:inverse(out) end
+
+--- Same as inverse, but writes the result to the quaternion.
+--- @return quaternion
+function quaternion.quaternion:inverse_() end
 
 --- Get quaternion magnitude
 --- @return number float
@@ -99,4 +140,26 @@ function quaternion.quaternion:length() end
 --- @return number float
 function quaternion.quaternion:length_squared() end
 
+--- Same as the multiply operator, but writes the result to the quaternion.
+--- @param q1 quaternion|number
+--- @return quaternion
+function quaternion.quaternion:multiply_(q1) end
+
+--- Same as the divide operator, but writes the result to the quaternion.
+--- @param q1 quaternion|number
+--- @return quaternion
+function quaternion.quaternion:divide_(q1) end
+
+--- Same as the negative operator, but writes the result to the quaternion.
+--- @return quaternion
+function quaternion.quaternion:negative_() end
+
+--- Spherically interpolates quaternion pairs in two floatarrays. Quaternions are packed with x, y, z and w components.
+--- @param a floatarray  Start quaternions
+--- @param b floatarray  End quaternions
+--- @param t number|floatarray  Interpolation value, or one value per pair
+--- @param out floatarray?  Destination, grown if needed. May be a or b. A new floatarray is returned if omitted
+--- @return floatarray
+function quaternion.slerp_array(a, b, t, out) end
+
 return quaternion
\ No newline at end of file
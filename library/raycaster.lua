@@ -15,6 +15,55 @@ raycaster.Map = {}
 --- @return Map 
 function raycaster.Map.new(width, height) end
 
+--- Enables or disables empty space skipping.
+--- @param enabled boolean?  Build acceleration structure if true (default), free it if false.
+function raycaster.Map:accelerate(enabled) end
+
+--- Get layer data at given cell.
+--- @param x integer  Cell x-coordinate
+--- @param y integer  Cell y-coordinate
+--- @param layer string  One of: "walls", "floors", or "ceilings".
+--- @return integer  Layer data. 0 if cell is outside of map.
+function raycaster.Map:get(x, y, layer) end
+
+--- Set layer data at given cell.
+--- @param x integer  Cell x-coordinate
+--- @param y integer  Cell y-coordinate
+--- @param layer string  One of: "walls", "floors", or "ceilings".
+--- @param value integer  Layer data. Valid range is 0-65535.
+function raycaster.Map:set(x, y, layer, value) end
+
+--- Load entire layer.
+--- @param layer string  One of: "walls", "floors", or "ceilings".
+--- @param data integer[]|intarray|texture  Layer data. Size must match map size.
+function raycaster.Map:load(layer, data) end
+
+--- Copy entire layer into an intarray.
+--- @param layer string  One of: "walls", "floors", or "ceilings".
+--- @param array intarray?  Array to copy into. Grown to map size if needed.
+--- @return intarray  Given array or a new array if none was given.
+function raycaster.Map:store(layer, array) end
+
+--- Casts a ray against map walls.
+--- @param origin vector2  Ray origin.
+--- @param direction vector2  Ray direction.
+--- @param max_distance number?  Distance after which the ray stops. Defaults to math.huge.
+--- @return number?  Hit distance or nil if nothing was hit.
+--- @return integer  Hit cell x-coordinate
+--- @return integer  Hit cell y-coordinate
+--- @return integer  Hit side. 0 for north/south facing walls, 1 for east/west facing walls.
+--- @return number  Normalized horizontal texture offset of hit.
+function raycaster.Map:cast(origin, direction, max_distance) end
+
+--- Casts many rays against map walls.
+--- @param origins floatarray  Ray origins.
+--- @param directions floatarray  Ray directions.
+--- @param out floatarray?  Results, grown if needed. Must not be origins or directions. A new floatarray is returned if omitted.
+--- @param max_distance number?  Distance after which rays stop. Defaults to math.huge.
+--- @return integer  Number of rays that hit a wall.
+--- @return floatarray  Results.
+function raycaster.Map:cast_many(origins, directions, out, max_distance) end
+
 --- @class Renderer
 raycaster.Renderer = {}
 
@@ -0,0 +1,71 @@
+--- @meta
+
+--- Module for sector renderer.
+local sector = {}
+
+--- @class Map
+sector.Map = {}
+
+--- Create a new empty map.
+--- @return Map 
+function sector.Map.new() end
+
+--- Adds a sector with no walls.
+--- @param floor number  Floor height
+--- @param ceiling number  Ceiling height
+--- @param floor_tile integer  Floor tile index
+--- @param ceiling_tile integer  Ceiling tile index
+--- @param brightness number?  Sector light level. 1.0 = full bright (default) 0.0 = full dark
+--- @return integer  Sector index. Indices start at 0.
+function sector.Map:add_sector(floor, ceiling, floor_tile, ceiling_tile, brightness) end
+
+--- Adds a wall to a sector.
+--- @param sector integer  Sector index
+--- @param start vector2  Wall start point
+--- @param end vector2  Wall end point
+--- @param tile integer  Wall tile index. Used for upper and lower walls of portals.
+--- @param portal integer?  Index of sector on the other side. Solid wall if nil.
+function sector.Map:add_wall(sector, start, end_, tile, portal) end
+
+--- Access sector floor and ceiling heights.
+--- @param sector integer  Sector index
+--- @param floor number?  New floor height
+--- @param ceiling number?  New ceiling height
+--- @return number  Floor height
+--- @return number  Ceiling height
+function sector.Map:heights(sector, floor, ceiling) end
+
+--- Find sector containing given point.
+--- @param point vector2  Point to find.
+--- @return integer?  Sector index or nil if point is outside all sectors.
+function sector.Map:find(point) end
+
+--- @class Renderer
+sector.Renderer = {}
+
+--- Creates a sector renderer object.
+--- @param texture texture?  Texture to render to. Defaults to the render texture.
+--- @return Renderer 
+function sector.Renderer:new(texture) end
+
+--- Clears color buffer.
+--- @param color integer?  Clear color. Defaults to 0.
+function sector.Renderer:clear(color) end
+
+--- Renders given map.
+--- @param map Map  Map to render.
+--- @param tiles texture[]  An array of textures. Valid range of indices is 0-255.
+function sector.Renderer:render(map, tiles) end
+
+--- Set renderer's camera data.
+--- @param position vector3  Camera position. The z-component is eye height.
+--- @param direction vector2  Camera forward vector.
+--- @param fov number  Camera field of view in degrees.
+function sector.Renderer:camera(position, direction, fov) end
+
+--- Access renderer's features.
+--- @param name string  Feature name.
+--- @param value any?  Value to set feature to.
+function sector.Renderer:feature(name, value) end
+
+return sector
@@ -8,13 +8,48 @@ local sound = {}
 --- @return sound 
 function sound.new(frame_count) end
 
+--- Open a sound for streaming. Streams are decoded a little at a time while
+--- they play instead of being loaded up front, use them for music and other
+--- long sounds. Streams opened from a zip file hold their entry inflated in
+--- memory, use an asset pack to stream from disk.
+--- @param filename string  Name of WAV file to stream.
+--- @return stream 
+function sound.stream(filename) end
+
+--- Stops a playing voice.
+--- @param voice integer  Voice returned by play.
+function sound.stop(voice) end
+
+--- Stops all playing voices.
+function sound.stop_all() end
+
+--- Checks if a voice is still playing.
+--- @param voice integer  Voice returned by play.
+--- @return boolean
+function sound.is_playing(voice) end
+
+--- Changes parameters of a playing voice.
+--- @param voice integer  Voice returned by play.
+--- @param volume? number  Volume from 0 to 1. Unchanged if nil.
+--- @param pan? number  Pan from -1 (left) to 1 (right). Unchanged if nil.
+--- @param pitch? number  Playback speed, 1 is normal. Unchanged if nil.
+function sound.set_voice(voice, volume, pan, pitch) end
+
+--- Gets parameters of a voice.
+--- @param voice integer  Voice returned by play.
+--- @return number volume
+--- @return number pan
+--- @return number pitch
+function sound.get_voice(voice) end
+
 --- @class sound
 --- @field pcm integer[]
 --- @field frame_count integer
 sound.sound = {}
 
---- Plays sound.
---- @param channel integer  Channel to play sound on. (optional)
+--- Plays sound. Options can be given instead of a channel.
+--- @param channel? integer|{channel?: integer, volume?: number, pan?: number, pitch?: number, loop?: boolean}  Channel to play sound on, or table of options.
+--- @return integer? Voice playing sound, nil if sound could not be played.
 function sound.sound:play(channel) end
 
 --- Returns a copy of this sound.
@@ -31,4 +66,44 @@ function sound.sound:set_frame(index, value) end
 --- @return integer PCM data
 function sound.sound:get_frame(index) end
 
+--- Sets PCM data for a run of frames from a floatarray. Samples are
+--- interleaved by channel and range from -1 to 1.
+--- @param samples floatarray  Samples to copy.
+--- @param offset? integer  Index of first frame to set. Defaults to 0.
+--- @return integer Number of frames set.
+function sound.sound:set_frames(samples, offset) end
+
+--- Gets PCM data for a run of frames as a floatarray. Samples are
+--- interleaved by channel and range from -1 to 1.
+--- @param offset? integer  Index of first frame to get. Defaults to 0.
+--- @param count? integer  Number of frames to get. Defaults to rest of sound.
+--- @return floatarray 
+function sound.sound:get_frames(offset, count) end
+
+--- @class stream
+--- @field loop boolean  Restart stream when it reaches its end.
+--- @field position number  Current position in seconds. (read-only)
+--- @field duration number  Length in seconds. (read-only)
+local stream = {}
+
+--- Plays stream from its current position. Restarts stream if it has ended.
+--- @param options? {volume?: number, pan?: number, pitch?: number, loop?: boolean}  Table of options.
+--- @return integer? Voice playing stream, nil if stream could not be played.
+function stream:play(options) end
+
+--- Stops stream and moves back to its start.
+function stream:stop() end
+
+--- Moves stream to given position. A playing stream continues from there.
+--- @param seconds number  Position in seconds.
+function stream:seek(seconds) end
+
+--- Checks if stream is playing.
+--- @return boolean
+function stream:is_playing() end
+
+--- Stops and closes stream. Happens automatically when stream is garbage
+--- collected.
+function stream:close() end
+
 return sound
\ No newline at end of file
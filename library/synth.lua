@@ -0,0 +1,60 @@
+--- @meta
+
+--- Module for generating sound effects.
+local synth = {}
+
+--- @alias synth.wave "square"|"saw"|"sine"|"triangle"|"noise"
+
+--- @class synth.params
+--- @field wave? synth.wave
+--- @field frequency? number  Frequency in Hz at start.
+--- @field frequency_end? number  Frequency in Hz at end.
+--- @field duty? number  Portion of square wave period spent high, 0 to 1.
+--- @field vibrato_depth? number  Vibrato depth as a fraction of frequency.
+--- @field vibrato_speed? number  Vibrato speed in Hz.
+--- @field volume? number  Volume from 0 to 1.
+--- @field attack? number  Attack time in seconds.
+--- @field decay? number  Decay time in seconds.
+--- @field sustain? number  Sustain level from 0 to 1.
+--- @field hold? number  Sustain time in seconds.
+--- @field release? number  Release time in seconds.
+--- @field lowpass? number  Lowpass cutoff in Hz.
+--- @field highpass? number  Highpass cutoff in Hz.
+--- @field seed? integer  Noise seed.
+
+--- Render a sound effect. Sound length is the sum of attack, decay, hold and
+--- release.
+--- @param params synth.params  Effect parameters.
+--- @return sound 
+function synth.render(params) end
+
+--- Render an oscillator into a sound, replacing its contents.
+--- @param sound sound  Sound to render into.
+--- @param wave synth.wave  Wave shape.
+--- @param frequency number  Frequency in Hz at start.
+--- @param frequency_end? number  Frequency in Hz at end. Defaults to frequency.
+--- @param duty? number  Portion of square wave period spent high.
+--- @param volume? number  Volume from 0 to 1.
+--- @param seed? integer  Noise seed.
+function synth.oscillator(sound, wave, frequency, frequency_end, duty, volume, seed) end
+
+--- Shape a sound with an ADSR envelope. Sustain lasts until release starts
+--- at the end of the sound.
+--- @param sound sound  Sound to shape.
+--- @param attack number  Attack time in seconds.
+--- @param decay number  Decay time in seconds.
+--- @param sustain number  Sustain level from 0 to 1.
+--- @param release number  Release time in seconds.
+function synth.envelope(sound, attack, decay, sustain, release) end
+
+--- Filter out frequencies above cutoff.
+--- @param sound sound  Sound to filter.
+--- @param cutoff number  Cutoff frequency in Hz.
+function synth.lowpass(sound, cutoff) end
+
+--- Filter out frequencies below cutoff.
+--- @param sound sound  Sound to filter.
+--- @param cutoff number  Cutoff frequency in Hz.
+function synth.highpass(sound, cutoff) end
+
+return synth
\ No newline at end of file
@@ -41,4 +41,51 @@ function texture.texture:get_pixel(x, y) end
 --- @param y integer  Destination y-offset
 function texture.texture:blit(source, x, y) end
 
+--- Returns pixels as a string with one byte per pixel, one row after another.
+--- Much faster than the pixels field for reading a whole texture.
+--- @param x? integer  Rect x-offset
+--- @param y? integer  Rect y-offset
+--- @param w? integer  Rect width, defaults to rest of the row
+--- @param h? integer  Rect height, defaults to rest of the texture
+--- @return string Pixel bytes
+function texture.texture:get_bytes(x, y, w, h) end
+
+--- Sets pixels from a string with one byte per pixel, one row after another.
+--- String length must match the rect size.
+--- @param bytes string  Pixel bytes
+--- @param x? integer  Rect x-offset
+--- @param y? integer  Rect y-offset
+--- @param w? integer  Rect width, defaults to rest of the row
+--- @param h? integer  Rect height, defaults to rest of the texture
+function texture.texture:set_bytes(bytes, x, y, w, h) end
+
+--- Returns a row of pixels as a string with one byte per pixel.
+--- @param y integer  Row y-coordinate
+--- @return string Pixel bytes
+function texture.texture:get_row(y) end
+
+--- Sets a row of pixels from a string with one byte per pixel. String length
+--- must match the texture width.
+--- @param y integer  Row y-coordinate
+--- @param bytes string  Pixel bytes
+function texture.texture:set_row(y, bytes) end
+
+--- Copies pixels to an intarray, one row after another.
+--- @param out? intarray  Array to store pixels in, grown if needed
+--- @param x? integer  Rect x-offset
+--- @param y? integer  Rect y-offset
+--- @param w? integer  Rect width, defaults to rest of the row
+--- @param h? integer  Rect height, defaults to rest of the texture
+--- @return intarray Array of pixels
+function texture.texture:to_intarray(out, x, y, w, h) end
+
+--- Sets pixels from an intarray, one row after another. Array must hold at
+--- least as many values as the rect has pixels.
+--- @param array intarray  Array of pixels
+--- @param x? integer  Rect x-offset
+--- @param y? integer  Rect y-offset
+--- @param w? integer  Rect width, defaults to rest of the row
+--- @param h? integer  Rect height, defaults to rest of the texture
+function texture.texture:from_intarray(array, x, y, w, h) end
+
 return texture
\ No newline at end of file
@@ -15,65 +15,132 @@ vector2.vector2 = {}
 --- @return vector2
 function vector2.new(x, y) end
 
+--- Returns a vector2 from a pool of temporaries. Values are handed out again next
+--- frame, so they must not be kept.
+--- @param x number?
+--- @param y number?
+--- @return vector2
+function vector2.scratch(x, y) end
+
 --- Returns a vector made from the sign of it's components.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.sign(v0) end
+function vector2.sign(v0, out) end
+
+--- Same as sign, but writes the result to the vector.
+--- @return vector2
+function vector2.vector2:sign_() end
 
 --- Returns a vector made from snapping the components to given resolution.
 --- @param v0 vector2
 --- @param f number  Resolution of snap
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
+--- @return vector2
+function vector2.snap(v0, f, out) end
+
+--- Same as snap, but writes the result to the vector.
+--- @param f number  Resolution of snap
 --- @return vector2
-function vector2.snap(v0, f) end
+function vector2.vector2:snap_(f) end
 
 --- Negates a vector.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
+--- @return vector2
+function vector2.negative(v0, out) end
+
+--- Same as negative, but writes the result to the vector.
 --- @return vector2
-function vector2.negative(v0) end
+function vector2.vector2:negative_() end
 
 --- Returns a vector made from the absolute values of the components.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.abs(v0) end
+function vector2.abs(v0, out) end
+
+--- Same as abs, but writes the result to the vector.
+--- @return vector2
+function vector2.vector2:abs_() end
 
 --- Returns a vector made from the floor of the components.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.floor(v0) end
+function vector2.floor(v0, out) end
+
+--- Same as floor, but writes the result to the vector.
+--- @return vector2
+function vector2.vector2:floor_() end
 
 --- Returns a vector made from the ceil of the components.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
+--- @return vector2
+function vector2.ceil(v0, out) end
+
+--- Same as ceil, but writes the result to the vector.
 --- @return vector2
-function vector2.ceil(v0) end
+function vector2.vector2:ceil_() end
 
 --- Returns a vector made from rounding the components.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.round(v0) end
+function vector2.round(v0, out) end
+
+--- Same as round, but writes the result to the vector.
+--- @return vector2
+function vector2.vector2:round_() end
 
 --- Returns a vector that is the component-wise max of v0 and v1.
 --- @param v0 vector2
 --- @param v1 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.max(v0, v1) end
+function vector2.max(v0, v1, out) end
+
+--- Same as max, but writes the result to the vector.
+--- @param v1 vector2
+--- @return vector2
+function vector2.vector2:max_(v1) end
 
 --- Returns a vector that is the component-wise min of v0 and v1.
 --- @param v0 vector2
 --- @param v1 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
+--- @return vector2
+function vector2.min(v0, v1, out) end
+
+--- Same as min, but writes the result to the vector.
+--- @param v1 vector2
 --- @return vector2
-function vector2.min(v0, v1) end
+function vector2.vector2:min_(v1) end
 
 --- Returns a vector that is a component-wise clamp of v0 such that min < v0 < max.
 --- @param v0 vector2  Vector to clamp
 --- @param min vector2  Min vector
 --- @param max vector2  Max vector
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
+--- @return vector2
+function vector2.clamp(v0, min, max, out) end
+
+--- Same as clamp, but writes the result to the vector.
+--- @param min vector2  Min vector
+--- @param max vector2  Max vector
 --- @return vector2
-function vector2.clamp(v0, min, max) end
+function vector2.vector2:clamp_(min, max) end
 
 --- Returns a vector in the direction of v0 with magnitude 1.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
+--- @return vector2
+function vector2.normalize(v0, out) end
+
+--- Same as normalize, but writes the result to the vector.
 --- @return vector2
-function vector2.normalize(v0) end
+function vector2.vector2:normalize_() end
 
 --- Dot product of two vectors.
 --- @param v0 vector2
@@ -84,32 +151,62 @@ function vector2.dot(v0, v1) end
 --- Project v0 onto v1.
 --- @param v0 vector2
 --- @param v1 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
+--- @return vector2
+function vector2.project(v0, v1, out) end
+
+--- Same as project, but writes the result to the vector.
+--- @param v1 vector2
 --- @return vector2
-function vector2.project(v0, v1) end
+function vector2.vector2:project_(v1) end
 
 --- Reflect v0 off of plane given by normal.
 --- @param v0 vector2
 --- @param normal vector2  Plane normal
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.reflect(v0, normal) end
+function vector2.reflect(v0, normal, out) end
+
+--- Same as reflect, but writes the result to the vector.
+--- @param normal vector2  Plane normal
+--- @return vector2
+function vector2.vector2:reflect_(normal) end
 
 --- Returns a vector rotated 90 degrees clockwise from v0.
 --- @param v0 vector2
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.tangent(v0) end
+function vector2.tangent(v0, out) end
+
+--- Same as tangent, but writes the result to the vector.
+--- @return vector2
+function vector2.vector2:tangent_() end
 
 --- Returns a vector that is rotated clockwise by angle in radians from v0.
 --- @param v0 vector2
 --- @param radians number  Angle to rotate
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.rotate(v0, radians) end
+function vector2.rotate(v0, radians, out) end
+
+--- Same as rotate, but writes the result to the vector.
+--- @param radians number  Angle to rotate
+--- @return vector2
+function vector2.vector2:rotate_(radians) end
 
 --- Linearly interpolate between v0 and v1.
 --- @param v0 vector2
 --- @param v1 vector2
 --- @param t number  Value used to interpolate between v0 and v1.
+--- @param out vector2?  Destination, a new vector2 is returned if omitted
 --- @return vector2
-function vector2.lerp(v0, v1, t) end
+function vector2.lerp(v0, v1, t, out) end
+
+--- Same as lerp, but writes the result to the vector.
+--- @param v1 vector2
+--- @param t number  Value used to interpolate between v0 and v1.
+--- @return vector2
+function vector2.vector2:lerp_(v1, t) end
 
 --- Get counterclockwise angle in radians between the positive x-axis and v0.
 --- @param v0 vector2
@@ -138,4 +235,24 @@ function vector2.distance(v0, v1) end
 --- @return number Squared distance
 function vector2.distance_squared(v0, v1) end
 
+--- Same as the add operator, but writes the result to the vector.
+--- @param v1 vector2|number
+--- @return vector2
+function vector2.vector2:add_(v1) end
+
+--- Same as the subtract operator, but writes the result to the vector.
+--- @param v1 vector2|number
+--- @return vector2
+function vector2.vector2:subtract_(v1) end
+
+--- Same as the multiply operator, but writes the result to the vector.
+--- @param v1 vector2|number
+--- @return vector2
+function vector2.vector2:multiply_(v1) end
+
+--- Same as the divide operator, but writes the result to the vector.
+--- @param v1 vector2|number
+--- @return vector2
+function vector2.vector2:divide_(v1) end
+
 return vector2
\ No newline at end of file
@@ -17,71 +17,145 @@ vector3.vector3 = {}
 --- @return vector3
 function vector3.new(x, y, z) end
 
+--- Returns a vector3 from a pool of temporaries. Values are handed out again next
+--- frame, so they must not be kept.
+--- @param x number?
+--- @param y number?
+--- @param z number?
+--- @return vector3
+function vector3.scratch(x, y, z) end
+
 --- Returns a vector made from the sign of it's components.
 --- @param v0 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.sign(v0, out) end
+
+--- Same as sign, but writes the result to the vector.
 --- @return vector3
-function vector3.sign(v0) end
+function vector3.vector3:sign_() end
 
 --- Returns a vector made from snapping the components to given resolution.
 --- @param v0 vector3
 --- @param f number  Resolution of snap
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
 --- @return vector3
-function vector3.snap(v0, f) end
+function vector3.snap(v0, f, out) end
+
+--- Same as snap, but writes the result to the vector.
+--- @param f number  Resolution of snap
+--- @return vector3
+function vector3.vector3:snap_(f) end
 
 --- Negates a vector.
 --- @param v0 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.negative(v0, out) end
+
+--- Same as negative, but writes the result to the vector.
 --- @return vector3
-function vector3.negative(v0) end
+function vector3.vector3:negative_() end
 
 --- Returns a vector made from the absolute values of the components.
 --- @param v0 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
 --- @return vector3
-function vector3.abs(v0) end
+function vector3.abs(v0, out) end
+
+--- Same as abs, but writes the result to the vector.
+--- @return vector3
+function vector3.vector3:abs_() end
 
 --- Returns a vector made from the floor of the components.
 --- @param v0 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.floor(v0, out) end
+
+--- Same as floor, but writes the result to the vector.
 --- @return vector3
-function vector3.floor(v0) end
+function vector3.vector3:floor_() end
 
 --- Returns a vector made from the ceil of the components.
 --- @param v0 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.ceil(v0, out) end
+
+--- Same as ceil, but writes the result to the vector.
 --- @return vector3
-function vector3.ceil(v0) end
+function vector3.vector3:ceil_() end
 
 --- Returns a vector made from rounding the components.
 --- @param v0 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.round(v0, out) end
+
+--- Same as round, but writes the result to the vector.
 --- @return vector3
-function vector3.round(v0) end
+function vector3.vector3:round_() end
 
 --- Returns a vector that is the component-wise max of v0 and v1.
 --- @param v0 vector3
 --- @param v1 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.max(v0, v1, out) end
+
+--- Same as max, but writes the result to the vector.
+--- @param v1 vector3
 --- @return vector3
-function vector3.max(v0, v1) end
+function vector3.vector3:max_(v1) end
 
 --- Returns a vector that is the component-wise min of v0 and v1.
 --- @param v0 vector3
 --- @param v1 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
 --- @return vector3
-function vector3.min(v0, v1) end
+function vector3.min(v0, v1, out) end
+
+--- Same as min, but writes the result to the vector.
+--- @param v1 vector3
+--- @return vector3
+function vector3.vector3:min_(v1) end
 
 --- Returns a vector that is a component-wise clamp of v0 such that min < v0 < max.
 --- @param v0 vector3  Vector to clamp
 --- @param min vector3  Min vector
 --- @param max vector3  Max vector
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.clamp(v0, min, max, out) end
+
+--- Same as clamp, but writes the result to the vector.
+--- @param min vector3  Min vector
+--- @param max vector3  Max vector
 --- @return vector3
-function vector3.clamp(v0, min, max) end
+function vector3.vector3:clamp_(min, max) end
 
 --- Cross product of two vectors.
 --- @param v0 vector3
 --- @param v1 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
 --- @return vector3
-function vector3.cross(v0, v1) end
+function vector3.cross(v0, v1, out) end
+
+--- Same as cross, but writes the result to the vector.
+--- @param v1 vector3
+--- @return vector3
+function vector3.vector3:cross_(v1) end
 
 --- Returns a vector in the direction of v0 with magnitude 1.
 --- @param v0 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.normalize(v0, out) end
+
+--- Same as normalize, but writes the result to the vector.
 --- @return vector3
-function vector3.normalize(v0) end
+function vector3.vector3:normalize_() end
 
 --- Dot product of two vectors.
 --- @param v0 vector3
@@ -92,28 +166,54 @@ function vector3.dot(v0, v1) end
 --- Project v0 onto v1.
 --- @param v0 vector3
 --- @param v1 vector3
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.project(v0, v1, out) end
+
+--- Same as project, but writes the result to the vector.
+--- @param v1 vector3
 --- @return vector3
-function vector3.project(v0, v1) end
+function vector3.vector3:project_(v1) end
 
 --- Reflect v0 off of plane given by normal.
 --- @param v0 vector3
 --- @param normal vector3  Plane normal
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
 --- @return vector3
-function vector3.reflect(v0, normal) end
+function vector3.reflect(v0, normal, out) end
+
+--- Same as reflect, but writes the result to the vector.
+--- @param normal vector3  Plane normal
+--- @return vector3
+function vector3.vector3:reflect_(normal) end
 
 --- Rotate v0 around ra clockwise by angle in radians.
 --- @param v0 vector3
 --- @param ra vector3  Vector to rotate around
 --- @param radians number  Angle to rotate in radians
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
+--- @return vector3
+function vector3.rotate(v0, ra, radians, out) end
+
+--- Same as rotate, but writes the result to the vector.
+--- @param ra vector3  Vector to rotate around
+--- @param radians number  Angle to rotate in radians
 --- @return vector3
-function vector3.rotate(v0, ra, radians) end
+function vector3.vector3:rotate_(ra, radians) end
 
 --- Linearly interpolate between v0 and v1.
 --- @param v0 vector3
 --- @param v1 vector3
 --- @param t number  Value used to interpolate between v0 and v1.
+--- @param out vector3?  Destination, a new vector3 is returned if omitted
 --- @return vector3
-function vector3.lerp(v0, v1, t) end
+function vector3.lerp(v0, v1, t, out) end
+
+--- Same as lerp, but writes the result to the vector.
+--- @param v1 vector3
+--- @param t number  Value used to interpolate between v0 and v1.
+--- @return vector3
+function vector3.vector3:lerp_(v1, t) end
 
 --- Get vector magnitude.
 --- @param v0 vector3
@@ -137,4 +237,47 @@ function vector3.distance(v0, v1) end
 --- @return number float
 function vector3.distance_squared(v0, v1) end
 
+--- Same as the add operator, but writes the result to the vector.
+--- @param v1 vector3|number
+--- @return vector3
+function vector3.vector3:add_(v1) end
+
+--- Same as the subtract operator, but writes the result to the vector.
+--- @param v1 vector3|number
+--- @return vector3
+function vector3.vector3:subtract_(v1) end
+
+--- Same as the multiply operator, but writes the result to the vector.
+--- @param v1 vector3|number
+--- @return vector3
+function vector3.vector3:multiply_(v1) end
+
+--- Same as the divide operator, but writes the result to the vector.
+--- @param v1 vector3|number
+--- @return vector3
+function vector3.vector3:divide_(v1) end
+
+--- Normalizes all vectors in a floatarray. Zero length vectors stay zero.
+--- @param vectors floatarray  Vectors with x, y and z components
+--- @param out floatarray?  Destination, grown if needed. May be vectors. A new floatarray is returned if omitted
+--- @param stride integer?  Floats between vectors, default 3
+--- @return floatarray
+function vector3.normalize_array(vectors, out, stride) end
+
+--- Dot products of vector pairs in two floatarrays. Results are packed, one float per pair.
+--- @param a floatarray  Vectors with x, y and z components
+--- @param b floatarray  Vectors with x, y and z components
+--- @param out floatarray?  Destination, grown if needed. A new floatarray is returned if omitted
+--- @param stride integer?  Floats between vectors, default 3
+--- @return floatarray
+function vector3.dot_array(a, b, out, stride) end
+
+--- Cross products of vector pairs in two floatarrays.
+--- @param a floatarray  Vectors with x, y and z components
+--- @param b floatarray  Vectors with x, y and z components
+--- @param out floatarray?  Destination, grown if needed. May be a or b. A new floatarray is returned if omitted
+--- @param stride integer?  Floats between vectors, default 3
+--- @return floatarray
+function vector3.cross_array(a, b, out, stride) end
+
 return vector3
\ No newline at end of file
@@ -18,71 +18,167 @@ vector4.vector4 = {}
 --- @return vector4 
 function vector4.new(x, y, z, w) end
 
+--- Returns a vector4 from a pool of temporaries. Values are handed out again next
+--- frame, so they must not be kept.
+--- @param x number? 
+--- @param y number? 
+--- @param z number? 
+--- @param w number? 
+--- @return vector4
+function vector4.scratch(x, y, z, w) end
+
 --- Returns a vector made from the sign of it's components.
 --- @param v0 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.sign(v0) end
+function vector4.sign(v0, out) end
+
+--- Same as sign, but writes the result to the vector.
+--- @return vector4
+function vector4.vector4:sign_() end
 
 --- Returns a vector made from snapping the components to given resolution.
 --- @param v0 vector4 
 --- @param f number  Resolution of snap
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.snap(v0, f) end
+function vector4.snap(v0, f, out) end
+
+--- Same as snap, but writes the result to the vector.
+--- @param f number  Resolution of snap
+--- @return vector4
+function vector4.vector4:snap_(f) end
 
 --- Negates a vector.
 --- @param v0 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.negative(v0) end
+function vector4.negative(v0, out) end
+
+--- Same as negative, but writes the result to the vector.
+--- @return vector4
+function vector4.vector4:negative_() end
 
 --- Returns a vector made from the absolute values of the components.
 --- @param v0 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.abs(v0) end
+function vector4.abs(v0, out) end
+
+--- Same as abs, but writes the result to the vector.
+--- @return vector4
+function vector4.vector4:abs_() end
 
 --- Returns a vector made from the floor of the components.
 --- @param v0 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.floor(v0) end
+function vector4.floor(v0, out) end
+
+--- Same as floor, but writes the result to the vector.
+--- @return vector4
+function vector4.vector4:floor_() end
 
 --- Returns a vector made from the ceil of the components.
 --- @param v0 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.ceil(v0) end
+function vector4.ceil(v0, out) end
+
+--- Same as ceil, but writes the result to the vector.
+--- @return vector4
+function vector4.vector4:ceil_() end
 
 --- Returns a vector made from rounding the components.
 --- @param v0 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.round(v0) end
+function vector4.round(v0, out) end
+
+--- Same as round, but writes the result to the vector.
+--- @return vector4
+function vector4.vector4:round_() end
 
 --- Returns a vector that is the component-wise max of v0 and v1.
 --- @param v0 vector4 
 --- @param v1 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.max(v0, v1) end
+function vector4.max(v0, v1, out) end
+
+--- Same as max, but writes the result to the vector.
+--- @param v1 vector4 
+--- @return vector4
+function vector4.vector4:max_(v1) end
 
 --- Returns a vector that is the component-wise min of v0 and v1.
 --- @param v0 vector4 
 --- @param v1 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.min(v0, v1) end
+function vector4.min(v0, v1, out) end
+
+--- Same as min, but writes the result to the vector.
+--- @param v1 vector4 
+--- @return vector4
+function vector4.vector4:min_(v1) end
 
 --- Returns a vector that is a component-wise clamp of v0 such that min < v0 < max.
 --- @param v0 vector4  Vector to clamp
 --- @param min vector4  Min vector
 --- @param max vector4  Max vector
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.clamp(v0, min, max) end
+function vector4.clamp(v0, min, max, out) end
+
+--- Same as clamp, but writes the result to the vector.
+--- @param min vector4  Min vector
+--- @param max vector4  Max vector
+--- @return vector4
+function vector4.vector4:clamp_(min, max) end
 
 --- Returns a vector in the direction of v0 with magnitude 1.
 --- @param v0 vector4 
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.normalize(v0) end
+function vector4.normalize(v0, out) end
+
+--- Same as normalize, but writes the result to the vector.
+--- @return vector4
+function vector4.vector4:normalize_() end
 
 --- Linearly interpolate between v0 and v1.
 --- @param v0 vector4 
 --- @param v1 vector4 
 --- @param t number  Value used to interpolate between v0 and v1.
+--- @param out vector4?  Destination, a new vector4 is returned if omitted
 --- @return vector4 
-function vector4.lerp(v0, v1, t) end
+function vector4.lerp(v0, v1, t, out) end
+
+--- Same as lerp, but writes the result to the vector.
+--- @param v1 vector4 
+--- @param t number  Value used to interpolate between v0 and v1.
+--- @return vector4
+function vector4.vector4:lerp_(v1, t) end
+
+--- Same as the add operator, but writes the result to the vector.
+--- @param v1 vector4|number
+--- @return vector4
+function vector4.vector4:add_(v1) end
+
+--- Same as the subtract operator, but writes the result to the vector.
+--- @param v1 vector4|number
+--- @return vector4
+function vector4.vector4:subtract_(v1) end
+
+--- Same as the multiply operator, but writes the result to the vector.
+--- @param v1 vector4|number
+--- @return vector4
+function vector4.vector4:multiply_(v1) end
+
+--- Same as the divide operator, but writes the result to the vector.
+--- @param v1 vector4|number
+--- @return vector4
+function vector4.vector4:divide_(v1) end
 
 return vector4
\ No newline at end of file
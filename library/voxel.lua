@@ -0,0 +1,34 @@
+--- @meta
+
+--- Module for voxel space terrain renderer
+local voxel = {}
+
+--- @class Renderer
+voxel.Renderer = {}
+
+--- Creates a voxel renderer object.
+--- @param texture texture?  Texture to render to. Defaults to the render texture.
+--- @return Renderer 
+function voxel.Renderer:new(texture) end
+
+--- Clears color buffer.
+--- @param color integer?  Clear color. Defaults to 0.
+function voxel.Renderer:clear(color) end
+
+--- Renders terrain.
+--- @param heights texture  Height map. Texel values are scaled by the 'heightscale' feature.
+--- @param colors texture  Color map. Must be the same size as the height map.
+function voxel.Renderer:render(heights, colors) end
+
+--- Set renderer's camera data.
+--- @param position vector3  Camera position. The z-component is height above zero.
+--- @param direction vector2  Camera forward vector.
+--- @param fov number  Camera field of view in degrees.
+function voxel.Renderer:camera(position, direction, fov) end
+
+--- Access renderer's features.
+--- @param name string  Feature name.
+--- @param value any?  Value to set feature to.
+function voxel.Renderer:feature(name, value) end
+
+return voxel
@@ -7,11 +7,22 @@
 #include <giflib/gif_lib.h>
 #include <zip/zip.h>
 
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
 #include "arguments.h"
 #include "assets.h"
+#include "configuration.h"
 #include "files.h"
+#include "collections/hash_table.h"
+#include "gif_encoder.h"
 #include "graphics.h"
+#include "jobs.h"
 #include "log.h"
+#include "mixer.h"
+#include "pack.h"
+#include "script.h"
 #include "sounds.h"
 
 const int default_texture_asset_count = 1;
@@ -23,24 +34,110 @@ typedef struct {
     void* asset;
 } asset_entry_t;
 
+typedef enum {
+    ASSET_TYPE_TEXTURE,
+    ASSET_TYPE_SCRIPT,
+    ASSET_TYPE_SOUND
+} asset_type_t;
+
+typedef struct {
+    const char* name;
+    asset_type_t type;
+    void* asset;
+
+    /** Load task to decode from on first use when loading lazily. -1 otherwise. */
+    int task;
+    size_t size;
+
+    /** Number of references that keep a lazily loaded asset resident. */
+    int pins;
+
+    /** Neighbors in least recently used order. -1 if none. */
+    int lru_prev;
+    int lru_next;
+} asset_slot_t;
+
+/**
+ * Maps asset names to handles. Names and handles are kept across reloads so
+ * handles cached by scripts stay valid.
+ */
+static hash_table_t* asset_handles = NULL;
+static asset_slot_t* asset_slots = NULL;
+static int asset_slot_count = 0;
+static int asset_slot_capacity = 0;
+
+/**
+ * Register an asset under given name, reusing the name's handle if it already
+ * has one. Later assets replace earlier ones with the same name.
+ *
+ * @param name Name of asset
+ * @param type Type of asset
+ * @param asset Asset data
+ * @param size Size of asset in bytes
+ * @return int Asset handle. -1 on failure.
+ */
+static int asset_register(const char* name, asset_type_t type, void* asset, size_t size) {
+    if (!asset_handles) {
+        asset_handles = hash_table_new(1024);
+
+        if (!asset_handles) return -1;
+    }
+
+    int handle;
+
+    if (!hash_table_get(asset_handles, name, &handle)) {
+        if (asset_slot_count == asset_slot_capacity) {
+            int capacity = asset_slot_capacity ? asset_slot_capacity * 2 : 256;
+            asset_slot_t* slots = (asset_slot_t*)realloc(asset_slots, sizeof(asset_slot_t) * capacity);
+
+            if (!slots) {
+                log_error("Failed to register asset: %s", name);
+                return -1;
+            }
+
+            asset_slots = slots;
+            asset_slot_capacity = capacity;
+        }
+
+        const char* interned_name = hash_table_set(asset_handles, name, asset_slot_count);
+        if (!interned_name) return -1;
+
+        handle = asset_slot_count++;
+        asset_slots[handle].name = interned_name;
+        asset_slots[handle].pins = 0;
+        asset_slots[handle].lru_prev = -1;
+        asset_slots[handle].lru_next = -1;
+    }
+
+    asset_slots[handle].type = type;
+    asset_slots[handle].asset = asset;
+    asset_slots[handle].task = -1;
+    asset_slots[handle].size = size;
+
+    return handle;
+}
+
 /**
  * Create a new asset entry
  *
  * @param name Name of asset
+ * @param type Type of asset
  * @param asset Asset data
+ * @param size Size of asset in bytes
  * @return asset_entry_t
  */
-static asset_entry_t assets_entry_new(const char* name, void* asset) {
-    int n = strlen(name);
-    char* asset_name = (char*)calloc(n + 1, sizeof(char));
-    memcpy(asset_name, name, n);
+static asset_entry_t assets_entry_new(const char* name, asset_type_t type, void* asset, size_t size) {
+    int handle = asset_register(name, type, asset, size);
 
-    return (asset_entry_t) {asset_name, asset};
+    return (asset_entry_t) {handle >= 0 ? asset_slots[handle].name : NULL, asset};
 }
 
 typedef struct {
     int frame_count;
     texture_t** frames;
+
+    /** Frames point into a pack file and are not owned. */
+    bool mapped;
 } texture_asset_t;
 
 static texture_asset_t* texture_asset_new(int frame_count);
@@ -64,33 +161,100 @@ char* assets_directory = "assets";
 
 typedef struct {
     int frame_count;
+    int frame_capacity;
     texture_t** frames;
     uint32_t palette[256];
+    bool has_transparent_color;
+    int transparent_color;
 } gif_t;
 
 static gif_t* gif_load(const char* filename);
 static void gif_free(gif_t* gif);
+static texture_asset_t* texture_asset_from_gif(gif_t* gif);
 static gif_t* gif_load_from_buffer(void* buffer, size_t buffer_size);
 
 static bool load_assets(void);
 static void unload_assets(void);
 
+/** True if current assets were read from an asset directory. */
+static bool loaded_from_directory = false;
+
+static bool init_loaded = false;
+
+#ifndef __EMSCRIPTEN__
+static pthread_t init_thread;
+static bool init_thread_running = false;
+
+static void prefetch_thread_stop(void);
+
+static void* init_thread_main(void* arg) {
+    init_loaded = load_assets();
+
+    return NULL;
+}
+#endif
+
 void assets_init(void) {
     log_info("assets init");
 
-    if (!load_assets()) {
+#ifndef __EMSCRIPTEN__
+    // Load in the background while the rest of the engine starts up
+    if (pthread_create(&init_thread, NULL, init_thread_main, NULL) == 0) {
+        init_thread_running = true;
+        return;
+    }
+
+    log_error("Failed to create asset loading thread");
+#endif
+
+    init_loaded = load_assets();
+}
+
+void assets_init_wait(void) {
+#ifndef __EMSCRIPTEN__
+    if (init_thread_running) {
+        pthread_join(init_thread, NULL);
+        init_thread_running = false;
+    }
+#endif
+
+    if (!init_loaded) {
         log_fatal("assets init failed");
     }
 
     log_info("scripts:  %iB", script_assets_total_bytes);
     log_info("sounds:   %iB", sound_assets_total_bytes);
     log_info("textures: %iB", texture_assets_total_bytes);
+
+    if (config->assets.lazy) {
+        log_info("lazy:     %iMB budget", config->assets.budget);
+    }
 }
 
 void assets_destroy(void) {
+#ifndef __EMSCRIPTEN__
+    prefetch_thread_stop();
+#endif
+
     unload_assets();
+
+    if (asset_handles) {
+        hash_table_free(asset_handles);
+        asset_handles = NULL;
+    }
+
+    free(asset_slots);
+    asset_slots = NULL;
+    asset_slot_count = 0;
+    asset_slot_capacity = 0;
 }
 
+/**
+ * Create sound from an opened WAV.
+ *
+ * @param wav WAV to read PCM frames from
+ * @return sound_t* new sound if successful, NULL otherwise
+ */
 sound_t* sound_from_wav(drwav* wav) {
     size_t total_frames = wav->totalPCMFrameCount;
     size_t size = total_frames * wav->channels * sizeof(sample_t);
@@ -107,8 +271,6 @@ sound_t* sound_from_wav(drwav* wav) {
         return NULL;
     }
 
-    sound_assets_total_bytes += size + sizeof(sound_t);
-
     sound_t* sound = sounds_sound_new(
         total_frames,
         wav->channels,
@@ -122,504 +284,1747 @@ sound_t* sound_from_wav(drwav* wav) {
 }
 
 /**
- * Load assets from zip file.
- *
- * @return true if successful, false otherwise.
+ * Progress of a lazily loaded task.
  */
-static bool load_from_zip(void) {
-    const char* filename = arguments_last();
-    struct zip_t* zip = zip_open(filename, 0, 'r');
+typedef enum {
+    LOAD_TASK_IDLE,
+    LOAD_TASK_QUEUED,
+    LOAD_TASK_DECODING,
+    LOAD_TASK_DONE
+} load_task_state_t;
 
-    if (!zip) {
-        log_error("Failed to open zip file: %s", filename);
-        return false;
-    }
+/**
+ * A file found while scanning assets, and what it decoded into.
+ */
+typedef struct {
+    char* name;
+    asset_type_t type;
 
-    log_info("loading zip file: %s", filename);
+    /** Path to read from when loading from a directory. */
+    char* path;
 
-    // Load palette
-    zip_entry_open(zip, "palette.gif");
-    {
-        void* buffer = NULL;
-        size_t buffer_size = 0;
+    /** Raw file bytes when loading from a zip file. */
+    void* buffer;
+    size_t buffer_size;
 
-        zip_entry_read(zip, &buffer, &buffer_size);
+    /** Zip entry to read from when loading lazily. -1 if read during scan. */
+    int zip_index;
 
-        gif_t* palette = gif_load_from_buffer(buffer, buffer_size);
-        graphics_palette_set(palette->palette);
+    void* asset;
+    size_t size;
+    bool has_transparent_color;
+    int transparent_color;
+
+    /** Lazy loading progress. Guarded by the prefetch lock. */
+    load_task_state_t state;
+    bool failed;
+} load_task_t;
+
+static load_task_t* load_tasks = NULL;
+static int load_task_count = 0;
+static int load_task_capacity = 0;
+
+/** Zip file kept open to read lazily loaded entries from. */
+static struct zip_t* lazy_zip = NULL;
+
+#ifndef __EMSCRIPTEN__
+static pthread_mutex_t lazy_zip_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t prefetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LAZY_ZIP_LOCK() pthread_mutex_lock(&lazy_zip_mutex)
+#define LAZY_ZIP_UNLOCK() pthread_mutex_unlock(&lazy_zip_mutex)
+#define PREFETCH_LOCK() pthread_mutex_lock(&prefetch_mutex)
+#define PREFETCH_UNLOCK() pthread_mutex_unlock(&prefetch_mutex)
+#else
+#define LAZY_ZIP_LOCK()
+#define LAZY_ZIP_UNLOCK()
+#define PREFETCH_LOCK()
+#define PREFETCH_UNLOCK()
+#endif
 
-        gif_free(palette);
+/**
+ * Get asset type for given filename.
+ *
+ * @param filename Filename to check
+ * @param type Out asset type
+ * @return true if file is an asset, false otherwise
+ */
+static bool asset_type_from_filename(const char* filename, asset_type_t* type) {
+    if (files_check_extension(filename, "gif")) {
+        *type = ASSET_TYPE_TEXTURE;
+    }
+    else if (files_check_extension(filename, "lua")) {
+        *type = ASSET_TYPE_SCRIPT;
+    }
+    else if (files_check_extension(filename, "wav")) {
+        *type = ASSET_TYPE_SOUND;
+    }
+    else {
+        return false;
     }
-    zip_entry_close(zip);
-
-    int total_zip_entries = zip_entries_total(zip);
 
-    // Count assets
-    texture_asset_count = default_texture_asset_count;
-    for (int i = 0; i < total_zip_entries; i++) {
-        zip_entry_openbyindex(zip, i);
-        {
-            if (zip_entry_isdir(zip)) {
-                zip_entry_close(zip);
-                continue;
-            }
+    return true;
+}
 
-            const char* name = zip_entry_name(zip);
+/**
+ * Copy given string.
+ *
+ * @param s String to copy
+ * @return char* new string
+ */
+static char* string_copy(const char* s) {
+    size_t n = strlen(s);
+    char* copy = (char*)malloc(n + 1);
 
-            if (files_check_extension(name, "gif")) {
-                texture_asset_count++;
-            }
-            else if (files_check_extension(name, "lua")) {
-                script_asset_count++;
-            }
-            else if (files_check_extension(name, "wav")) {
-                sound_asset_count++;
-            }
-        }
-        zip_entry_close(zip);
+    if (copy) {
+        memcpy(copy, s, n + 1);
     }
 
-    // Load textures
-    texture_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * texture_asset_count);
-    int asset_index = 0;
+    return copy;
+}
 
-    // Load default textures
-    texture_t* texture = graphics_texture_new(256, 64, default_font_pixels);
-    texture_asset_t* asset = texture_asset_new(1);
-    asset->frames[0] = texture;
-    texture_assets_total_bytes += texture_asset_sizeof(asset);
-    texture_assets[asset_index++] = assets_entry_new("font.gif", asset);
+/**
+ * Add a load task.
+ *
+ * @param name Asset name
+ * @param type Asset type
+ * @return load_task_t* new task if successful, NULL otherwise
+ */
+static load_task_t* load_task_add(const char* name, asset_type_t type) {
+    if (load_task_count == load_task_capacity) {
+        int capacity = load_task_capacity ? load_task_capacity * 2 : 256;
+        load_task_t* tasks = (load_task_t*)realloc(load_tasks, sizeof(load_task_t) * capacity);
 
-    // Load asset textures
-    for (int i = 0; i < total_zip_entries; i++) {
-        zip_entry_openbyindex(zip, i);
-        {
-            if (zip_entry_isdir(zip)) {
-                zip_entry_close(zip);
-                continue;
-            }
+        if (!tasks) {
+            log_error("Failed to allocate memory for asset: %s", name);
+            return NULL;
+        }
 
-            const char* name = zip_entry_name(zip);
+        load_tasks = tasks;
+        load_task_capacity = capacity;
+    }
 
-            if (!files_check_extension(name, "gif")) {
-                zip_entry_close(zip);
-                continue;
-            }
+    load_task_t* task = &load_tasks[load_task_count++];
+    memset(task, 0, sizeof(load_task_t));
+    task->name = string_copy(name);
+    task->type = type;
+    task->zip_index = -1;
 
-            void* buffer = NULL;
-            size_t buffer_size = 0;
-            zip_entry_read(zip, &buffer, &buffer_size);
+    return task;
+}
 
-            // Create texture asset
-            gif_t* gif = gif_load_from_buffer(buffer, buffer_size);
-            texture_asset_t* asset = texture_asset_new(gif->frame_count);
+/**
+ * Free all load tasks. Decoded assets are not freed.
+ */
+static void load_tasks_clear(void) {
+    for (int i = 0; i < load_task_count; i++) {
+        free(load_tasks[i].name);
+        free(load_tasks[i].path);
+        free(load_tasks[i].buffer);
+    }
 
-            // Add all frames
-            for (size_t i = 0 ; i < asset->frame_count; i++) {
-                asset->frames[i] = graphics_texture_copy(gif->frames[i]);
-            }
+    free(load_tasks);
+    load_tasks = NULL;
+    load_task_count = 0;
+    load_task_capacity = 0;
+}
 
-            texture_assets_total_bytes += texture_asset_sizeof(asset);
+/**
+ * Read a script file.
+ *
+ * @param filename Script file path
+ * @param size Out script size in bytes
+ * @return char* script text if successful, NULL otherwise
+ */
+static char* script_load(const char* filename, size_t* size) {
+    // Open script file
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) {
+        return NULL;
+    }
 
-            // Add texture asset
-            texture_assets[asset_index++] = assets_entry_new(name, asset);
+    // Get script size
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    rewind(fp);
 
-            gif_free(gif);
-        }
-        zip_entry_close(zip);
+    // Allocate memory
+    char* script = calloc(*size + 1, sizeof(char));
+    if (!script) {
+        fclose(fp);
+        return NULL;
     }
 
-    // Load scripts
-    script_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * script_asset_count);
-    asset_index = 0;
+    // Read in script bytes
+    size_t ret_code = fread(script, 1, *size, fp);
+    fclose(fp);
 
-    for (int i = 0; i < total_zip_entries; i++) {
-        zip_entry_openbyindex(zip, i);
-        {
-            if (zip_entry_isdir(zip)) {
-                zip_entry_close(zip);
-                continue;
-            }
+    if (ret_code != *size) {
+        free(script);
+        return NULL;
+    }
 
-            const char* name = zip_entry_name(zip);
+    return script;
+}
 
-            if (!files_check_extension(name, "lua")) {
-                zip_entry_close(zip);
-                continue;
-            }
+/**
+ * Read raw bytes of the currently open zip entry into a load task.
+ *
+ * @param zip Zip file with an open entry
+ * @param task Task to read into
+ */
+static void load_task_zip_entry_read(struct zip_t* zip, load_task_t* task) {
+    if (task->type == ASSET_TYPE_SCRIPT) {
+        // Read scripts null terminated so they need no decoding
+        task->buffer_size = zip_entry_size(zip);
+        task->buffer = calloc(task->buffer_size + 1, sizeof(char));
+
+        if (task->buffer) {
+            zip_entry_noallocread(zip, task->buffer, task->buffer_size);
+        }
+    }
+    else {
+        zip_entry_read(zip, &task->buffer, &task->buffer_size);
+    }
+}
 
-            size_t buffer_size = zip_entry_size(zip);
-            char* script = calloc(buffer_size + 1, sizeof(char));
-            script_assets_total_bytes += buffer_size + 1;
+/**
+ * Read raw bytes of a lazily loaded zip entry. Entries share one open zip
+ * file, so reads are serialized.
+ *
+ * @param task Task to read into
+ */
+static void load_task_zip_read(load_task_t* task) {
+    if (task->zip_index < 0 || !lazy_zip) return;
 
-            zip_entry_noallocread(zip, script, buffer_size);
+    LAZY_ZIP_LOCK();
 
-            // Add script asset
-            script_assets[asset_index++] = assets_entry_new(name, script);
-        }
-        zip_entry_close(zip);
+    if (zip_entry_openbyindex(lazy_zip, task->zip_index) == 0) {
+        load_task_zip_entry_read(lazy_zip, task);
+        zip_entry_close(lazy_zip);
     }
 
-    // Load sounds
-    sound_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * sound_asset_count);
-    asset_index = 0;
+    LAZY_ZIP_UNLOCK();
+}
 
-    for (int i = 0; i < total_zip_entries; i++) {
-        zip_entry_openbyindex(zip, i);
-        {
-            if (zip_entry_isdir(zip)) {
-                zip_entry_close(zip);
-                continue;
-            }
+/**
+ * Decode a load task into its asset. Safe to call from worker threads, as
+ * tasks don't share any state.
+ *
+ * @param task Task to decode
+ */
+static void load_task_decode(load_task_t* task) {
+    if (!task->path && !task->buffer) {
+        load_task_zip_read(task);
+    }
 
-            const char* name = zip_entry_name(zip);
+    switch (task->type) {
+        case ASSET_TYPE_TEXTURE: {
+            gif_t* gif = task->path ? gif_load(task->path) : gif_load_from_buffer(task->buffer, task->buffer_size);
+            if (!gif) break;
 
-            if (!files_check_extension(name, "wav")) {
-                zip_entry_close(zip);
-                continue;
+            task->has_transparent_color = gif->has_transparent_color;
+            task->transparent_color = gif->transparent_color;
+
+            texture_asset_t* asset = texture_asset_from_gif(gif);
+            if (asset) {
+                task->asset = asset;
+                task->size = texture_asset_sizeof(asset);
             }
+            break;
+        }
 
-            void* buffer = NULL;
-            size_t buffer_size = 0;
-            zip_entry_read(zip, &buffer, &buffer_size);
+        case ASSET_TYPE_SCRIPT: {
+            if (task->path) {
+                task->asset = script_load(task->path, &task->size);
+            }
+            else {
+                // Zip entries are read as scripts directly
+                task->asset = task->buffer;
+                task->size = task->buffer_size;
+                task->buffer = NULL;
+            }
+            break;
+        }
 
-            // Load sounds
+        case ASSET_TYPE_SOUND: {
             drwav wav;
-            if (!drwav_init_memory(&wav, buffer, buffer_size, NULL)) {
-                log_error("Failed to open sound: %s", name);
-                zip_entry_close(zip);
-                continue;
-            }
+            bool opened = task->path ? drwav_init_file(&wav, task->path, NULL) : drwav_init_memory(&wav, task->buffer, task->buffer_size, NULL);
+            if (!opened) break;
 
             sound_t* sound = sound_from_wav(&wav);
-
             if (sound) {
-                // Add script asset
-                sound_assets[asset_index++] = assets_entry_new(name, sound);
+                task->asset = sound;
+                task->size = sizeof(sound_t) + sound->frame_count * sound->channel_count * sizeof(sample_t);
             }
 
             drwav_uninit(&wav);
+            break;
         }
-        zip_entry_close(zip);
     }
 
-    zip_close(zip);
+    free(task->buffer);
+    task->buffer = NULL;
+}
 
-    return true;
+/**
+ * Job function to decode a range of load tasks.
+ */
+static void load_tasks_decode(void* data, int start, int end) {
+    load_task_t* tasks = (load_task_t*)data;
+
+    for (int i = start; i < end; i++) {
+        load_task_decode(&tasks[i]);
+    }
 }
 
 /**
- * Get filepath relative to asset directory.
+ * Allocate asset arrays to hold current asset counts. Counts and totals are
+ * reset so assets can be stored.
  *
- * @param filename Filename
- * @return char* Filename with asset directory removed
+ * @return true if successful, false otherwise.
  */
-static char* normalize_filename(const char* filename) {
-    char* name = (char*)filename;
-
-    // Get asset directory with trailing slash
-    const int size = strlen(assets_directory) + 2;
-    char asset_root_directory[size];
-    memset(asset_root_directory, 0, size);
-    strcat(asset_root_directory, assets_directory);
-    strcat(asset_root_directory, "/\0");
+static bool asset_arrays_new(void) {
+    texture_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * texture_asset_count);
+    script_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * script_asset_count);
+    sound_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * sound_asset_count);
 
-    // Check if name starts with asset directory
-    if (strncmp(name, asset_root_directory, size - 1) == 0) {
-        name += size - 1;
+    if (!texture_assets || (!script_assets && script_asset_count) || (!sound_assets && sound_asset_count)) {
+        log_error("Failed to allocate memory for assets");
+        return false;
     }
 
-    return name;
+    texture_asset_count = 0;
+    script_asset_count = 0;
+    sound_asset_count = 0;
+    texture_assets_total_bytes = 0;
+    script_assets_total_bytes = 0;
+    sound_assets_total_bytes = 0;
+
+    return true;
 }
 
 /**
- * Callback function to count assets.
+ * Add default textures. Texture asset array must have room for them.
  */
-static void count_assets(const char* filename) {
-    if (files_check_extension(filename, "gif")) {
-        texture_asset_count++;
-    }
-    else if (files_check_extension(filename, "lua")) {
-        script_asset_count++;
-    }
-    else if (files_check_extension(filename, "wav")) {
-        sound_asset_count++;
-    }
+static void default_textures_add(void) {
+    texture_t* texture = graphics_texture_new(256, 64, default_font_pixels);
+    texture_asset_t* asset = texture_asset_new(1);
+    asset->frames[0] = texture;
+
+    size_t size = texture_asset_sizeof(asset);
+    texture_assets_total_bytes += size;
+    texture_assets[texture_asset_count++] = assets_entry_new("font.gif", ASSET_TYPE_TEXTURE, asset, size);
+}
+
+/**
+ * Decode all load tasks in parallel and store the results as assets. Assets
+ * are stored in scan order, so later assets with the same name still win.
+ *
+ * @return true if successful, false otherwise.
+ */
+static bool load_tasks_store(void) {
+    jobs_parallel_for(load_task_count, load_tasks_decode, load_tasks);
+
+    // Count assets
+    texture_asset_count = default_texture_asset_count;
+    script_asset_count = 0;
+    sound_asset_count = 0;
+
+    for (int i = 0; i < load_task_count; i++) {
+        switch (load_tasks[i].type) {
+            case ASSET_TYPE_TEXTURE: texture_asset_count++; break;
+            case ASSET_TYPE_SCRIPT: script_asset_count++; break;
+            case ASSET_TYPE_SOUND: sound_asset_count++; break;
+        }
+    }
+
+    if (!asset_arrays_new()) return false;
+
+    default_textures_add();
+
+    for (int i = 0; i < load_task_count; i++) {
+        load_task_t* task = &load_tasks[i];
+
+        switch (task->type) {
+            case ASSET_TYPE_TEXTURE:
+                if (!task->asset) {
+                    log_error("Failed to load texture: %s", task->name);
+                    continue;
+                }
+
+                if (task->has_transparent_color) {
+                    graphics_transparent_color_set(task->transparent_color);
+                }
+
+                texture_assets_total_bytes += task->size;
+                texture_assets[texture_asset_count++] = assets_entry_new(task->name, ASSET_TYPE_TEXTURE, task->asset, task->size);
+                break;
+
+            case ASSET_TYPE_SCRIPT:
+                if (!task->asset) {
+                    log_error("Failed to load script: %s", task->name);
+                    continue;
+                }
+
+                script_assets_total_bytes += task->size;
+                script_assets[script_asset_count++] = assets_entry_new(task->name, ASSET_TYPE_SCRIPT, task->asset, task->size);
+                break;
+
+            case ASSET_TYPE_SOUND:
+                if (!task->asset) {
+                    log_error("Failed to open sound: %s", task->name);
+                    continue;
+                }
+
+                sound_assets_total_bytes += task->size;
+                sound_assets[sound_asset_count++] = assets_entry_new(task->name, ASSET_TYPE_SOUND, task->asset, task->size);
+                break;
+        }
+    }
+
+    return true;
+}
+
+/** Bytes of lazily loaded assets allowed to stay resident. */
+static size_t lazy_budget_bytes = 0;
+static size_t lazy_resident_bytes = 0;
+
+/**
+ * Register all load tasks without decoding them. Tasks are kept and decoded
+ * on first use instead. Only default textures are loaded up front.
+ *
+ * @return true if successful, false otherwise.
+ */
+static bool load_tasks_index(void) {
+    texture_asset_count = default_texture_asset_count;
+    script_asset_count = 0;
+    sound_asset_count = 0;
+
+    if (!asset_arrays_new()) return false;
+
+    default_textures_add();
+
+    for (int i = 0; i < load_task_count; i++) {
+        int handle = asset_register(load_tasks[i].name, load_tasks[i].type, NULL, 0);
+
+        if (handle >= 0) {
+            asset_slots[handle].task = i;
+        }
+    }
+
+    lazy_budget_bytes = (size_t)config->assets.budget * 1024 * 1024;
+
+    return true;
+}
+
+/**
+ * Set graphics palette from given palette GIF.
+ *
+ * @param palette Palette GIF
+ * @return true if successful, false otherwise.
+ */
+static bool palette_set(gif_t* palette) {
+    if (!palette) {
+        log_error("Failed to load palette file.");
+        return false;
+    }
+
+    graphics_palette_set(palette->palette);
+
+    if (palette->has_transparent_color) {
+        graphics_transparent_color_set(palette->transparent_color);
+    }
+
+    gif_free(palette);
+
+    return true;
+}
+
+/**
+ * Scan zip file for assets. Entries are read in a single pass and decoded
+ * later.
+ *
+ * @return true if successful, false otherwise.
+ */
+static bool scan_zip(void) {
+    const char* filename = arguments_last();
+    struct zip_t* zip = zip_open(filename, 0, 'r');
+
+    if (!zip) {
+        log_error("Failed to open zip file: %s", filename);
+        return false;
+    }
+
+    log_info("loading zip file: %s", filename);
+
+    // Load palette
+    gif_t* palette = NULL;
+    if (zip_entry_open(zip, "palette.gif") == 0) {
+        void* buffer = NULL;
+        size_t buffer_size = 0;
+        zip_entry_read(zip, &buffer, &buffer_size);
+
+        palette = gif_load_from_buffer(buffer, buffer_size);
+        free(buffer);
+
+        zip_entry_close(zip);
+    }
+
+    if (!palette_set(palette)) {
+        zip_close(zip);
+        return false;
+    }
+
+    int total_zip_entries = zip_entries_total(zip);
+
+    for (int i = 0; i < total_zip_entries; i++) {
+        zip_entry_openbyindex(zip, i);
+        {
+            asset_type_t type;
+            const char* name = zip_entry_name(zip);
+
+            if (zip_entry_isdir(zip) || !asset_type_from_filename(name, &type)) {
+                zip_entry_close(zip);
+                continue;
+            }
+
+            load_task_t* task = load_task_add(name, type);
+            if (!task) {
+                zip_entry_close(zip);
+                continue;
+            }
+
+            if (config->assets.lazy) {
+                task->zip_index = i;
+            }
+            else {
+                load_task_zip_entry_read(zip, task);
+            }
+        }
+        zip_entry_close(zip);
+    }
+
+    // Lazily loaded entries are read when first used
+    if (config->assets.lazy) {
+        lazy_zip = zip;
+    }
+    else {
+        zip_close(zip);
+    }
+
+    return true;
+}
+
+/**
+ * Get filepath relative to asset directory.
+ *
+ * @param filename Filename
+ * @return char* Filename with asset directory removed
+ */
+static char* normalize_filename(const char* filename) {
+    char* name = (char*)filename;
+
+    // Get asset directory with trailing slash
+    const int size = strlen(assets_directory) + 2;
+    char asset_root_directory[size];
+    memset(asset_root_directory, 0, size);
+    strcat(asset_root_directory, assets_directory);
+    strcat(asset_root_directory, "/\0");
+
+    // Check if name starts with asset directory
+    if (strncmp(name, asset_root_directory, size - 1) == 0) {
+        name += size - 1;
+    }
+
+    return name;
+}
+
+/**
+ * Callback function to add load tasks for asset files.
+ *
+ * @param filename Asset filename
+ */
+static void add_file(const char* filename) {
+    asset_type_t type;
+    if (!asset_type_from_filename(filename, &type)) return;
+
+    load_task_t* task = load_task_add(normalize_filename(filename), type);
+    if (!task) return;
+
+    task->path = string_copy(filename);
+}
+
+/**
+ * Scan assets directory for assets. Files are read when decoded.
+ *
+ * @return true If successful, false otherwise.
+ */
+static bool scan_assets_directory(void) {
+    log_info("loading directory: %s", assets_directory);
+
+    // Load palette
+    char palette_path[strlen(assets_directory) + 13];
+    memset(palette_path, 0, strlen(assets_directory) + 13);
+    strcat(palette_path, assets_directory);
+    strcat(palette_path, "/palette.gif");
+
+    if (!palette_set(gif_load(palette_path))) {
+        return false;
+    }
+
+    files_walk_directory(assets_directory, add_file);
+    loaded_from_directory = true;
+
+    return true;
+}
+
+/** Pack file assets point into. NULL unless loading from a pack. */
+static pack_t* assets_pack = NULL;
+
+/**
+ * Create texture asset with frames pointing into pack entry data.
+ *
+ * @param entry Pack entry to read frames from
+ * @return texture_asset_t* new texture asset if entry is well formed, NULL otherwise
+ */
+static texture_asset_t* texture_asset_from_pack(const pack_entry_t* entry) {
+    if (entry->count == 0) return NULL;
+
+    uint8_t* data = (uint8_t*)pack_entry_data_get(assets_pack, entry);
+    texture_asset_t* asset = texture_asset_new(entry->count);
+    asset->mapped = true;
+
+    uint64_t position = 0;
+
+    for (uint32_t i = 0; i < entry->count; i++) {
+        // Each frame starts aligned
+        position = (position + PACK_ALIGNMENT - 1) & ~(uint64_t)(PACK_ALIGNMENT - 1);
+        if (position + sizeof(texture_t) > entry->size) break;
+
+        texture_t* frame = (texture_t*)(data + position);
+        if (frame->width <= 0 || frame->height <= 0) break;
+        if ((uint64_t)frame->width * frame->height > entry->size) break;
+
+        size_t size = graphics_texture_sizeof(frame);
+        if (size > entry->size - position) break;
+
+        asset->frames[i] = frame;
+        position += size;
+    }
+
+    if (!asset->frames[entry->count - 1]) {
+        texture_asset_free(asset);
+        return NULL;
+    }
+
+    return asset;
+}
+
+/**
+ * Get sound pointing into pack entry data.
+ *
+ * @param entry Pack entry to read sound from
+ * @return sound_t* sound if entry is well formed, NULL otherwise
+ */
+static sound_t* sound_from_pack(const pack_entry_t* entry) {
+    if (entry->size < sizeof(sound_t)) return NULL;
+
+    sound_t* sound = (sound_t*)pack_entry_data_get(assets_pack, entry);
+    uint64_t pcm_size = entry->size - sizeof(sound_t);
+
+    if (sound->channel_count == 0) return NULL;
+    if (sound->frame_count > pcm_size / (sound->channel_count * sizeof(sample_t))) return NULL;
+
+    return sound;
+}
+
+/**
+ * Load all assets from pack file. Pack is mapped and assets point straight
+ * into it, so nothing is decoded or copied.
+ *
+ * @return true if successful, false otherwise.
+ */
+static bool load_pack(void) {
+    const char* filename = arguments_last();
+    assets_pack = pack_open(filename);
+
+    if (!assets_pack) return false;
+
+    log_info("loading pack file: %s", filename);
+
+    const pack_header_t* header = assets_pack->header;
+
+    uint32_t palette[256];
+    memcpy(palette, header->palette, sizeof(palette));
+    graphics_palette_set(palette);
+
+    if (header->transparent_color >= 0) {
+        graphics_transparent_color_set(header->transparent_color);
+    }
+
+    // Count assets
+    texture_asset_count = default_texture_asset_count;
+    script_asset_count = 0;
+    sound_asset_count = 0;
+
+    for (uint32_t i = 0; i < header->directory_size; i++) {
+        switch (assets_pack->directory[i].type) {
+            case PACK_ENTRY_TEXTURE: texture_asset_count++; break;
+            case PACK_ENTRY_SCRIPT: script_asset_count++; break;
+            case PACK_ENTRY_SOUND: sound_asset_count++; break;
+        }
+    }
+
+    if (!asset_arrays_new()) return false;
+
+    default_textures_add();
+
+    for (uint32_t i = 0; i < header->directory_size; i++) {
+        const pack_entry_t* entry = &assets_pack->directory[i];
+        const char* name = pack_entry_name_get(assets_pack, entry);
+
+        switch (entry->type) {
+            case PACK_ENTRY_TEXTURE: {
+                texture_asset_t* asset = texture_asset_from_pack(entry);
+                if (!asset) {
+                    log_error("Failed to load texture: %s", name);
+                    continue;
+                }
+
+                texture_assets_total_bytes += entry->size;
+                texture_assets[texture_asset_count++] = assets_entry_new(name, ASSET_TYPE_TEXTURE, asset, entry->size);
+                break;
+            }
+
+            case PACK_ENTRY_SCRIPT: {
+                void* script = pack_entry_data_get(assets_pack, entry);
+
+                script_assets_total_bytes += entry->size;
+                script_assets[script_asset_count++] = assets_entry_new(name, ASSET_TYPE_SCRIPT, script, entry->size);
+                break;
+            }
+
+            case PACK_ENTRY_SOUND: {
+                sound_t* sound = sound_from_pack(entry);
+                if (!sound) {
+                    log_error("Failed to open sound: %s", name);
+                    continue;
+                }
+
+                sound_assets_total_bytes += entry->size;
+                sound_assets[sound_asset_count++] = assets_entry_new(name, ASSET_TYPE_SOUND, sound, entry->size);
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Load all assets.
+ *
+ * @return true if successful, false otherwise
+ */
+static bool load_assets(void) {
+    bool scanned = false;
+    loaded_from_directory = false;
+
+    // Check if user gave us a zip file or asset directory
+    if (arguments_count() > 1) {
+        const char* zip_or_directory = arguments_last();
+
+        // If we are given a zip file, load it
+        if (files_check_extension(zip_or_directory, "zip")) {
+            scanned = scan_zip();
+        }
+        else if (files_check_extension(zip_or_directory, "brasspak")) {
+            // Packs are used in place and need no decoding
+            return load_pack();
+        }
+        else {
+            // Otherwise set the asset directory
+            assets_directory = (char*)zip_or_directory;
+
+            // Sanitize Windows-style path separators
+            size_t len = strlen(assets_directory);
+            for (size_t i = 0; i < len; i++) {
+                if (assets_directory[i] == '\\') {
+                    assets_directory[i] = '/';
+                }
+            }
+
+            scanned = scan_assets_directory();
+        }
+    }
+    else {
+        scanned = scan_assets_directory();
+    }
+
+    bool loaded = scanned && (config->assets.lazy ? load_tasks_index() : load_tasks_store());
+
+    // Lazily loaded assets decode from their tasks later
+    if (!loaded || !config->assets.lazy) {
+        load_tasks_clear();
+
+        if (lazy_zip) {
+            zip_close(lazy_zip);
+            lazy_zip = NULL;
+        }
+    }
+
+    return loaded;
+}
+
+/** Most and least recently used resident lazily loaded assets. */
+static int lru_head = -1;
+static int lru_tail = -1;
+
+/**
+ * Unlink asset from least recently used list.
+ *
+ * @param handle Asset handle
+ */
+static void lru_remove(int handle) {
+    asset_slot_t* slot = &asset_slots[handle];
+
+    if (slot->lru_prev >= 0) {
+        asset_slots[slot->lru_prev].lru_next = slot->lru_next;
+    }
+    else {
+        lru_head = slot->lru_next;
+    }
+
+    if (slot->lru_next >= 0) {
+        asset_slots[slot->lru_next].lru_prev = slot->lru_prev;
+    }
+    else {
+        lru_tail = slot->lru_prev;
+    }
+
+    slot->lru_prev = -1;
+    slot->lru_next = -1;
+}
+
+/**
+ * Link asset as most recently used.
+ *
+ * @param handle Asset handle
+ */
+static void lru_push_front(int handle) {
+    asset_slot_t* slot = &asset_slots[handle];
+
+    slot->lru_prev = -1;
+    slot->lru_next = lru_head;
+
+    if (lru_head >= 0) {
+        asset_slots[lru_head].lru_prev = handle;
+    }
+    else {
+        lru_tail = handle;
+    }
+
+    lru_head = handle;
+}
+
+/**
+ * Check if asset is lazily loaded, resident and can be evicted. Sounds are
+ * never evicted, as playing channels keep pointers to them.
+ *
+ * @param slot Asset slot
+ * @return true if asset is in least recently used list, false otherwise
+ */
+static bool lru_contains(asset_slot_t* slot) {
+    return slot->task >= 0 && slot->asset && slot->type != ASSET_TYPE_SOUND;
+}
+
+/**
+ * Free asset of given type.
+ *
+ * @param type Asset type
+ * @param asset Asset to free
+ */
+static void asset_free(asset_type_t type, void* asset) {
+    switch (type) {
+        case ASSET_TYPE_TEXTURE: texture_asset_free(asset); break;
+        case ASSET_TYPE_SCRIPT: free(asset); break;
+        case ASSET_TYPE_SOUND: sounds_sound_free(asset); break;
+    }
+}
+
+/**
+ * Evict least recently used assets until resident assets fit the budget.
+ * Pinned assets are skipped.
+ *
+ * @param keep Handle of asset to keep resident regardless of budget
+ */
+static void lazy_evict(int keep) {
+    int handle = lru_tail;
+
+    while (handle >= 0 && lazy_resident_bytes > lazy_budget_bytes) {
+        asset_slot_t* slot = &asset_slots[handle];
+        int prev = slot->lru_prev;
+
+        if (handle != keep && slot->pins == 0) {
+            lru_remove(handle);
+            asset_free(slot->type, slot->asset);
+            lazy_resident_bytes -= slot->size;
+            slot->asset = NULL;
+            slot->size = 0;
+        }
+
+        handle = prev;
+    }
+}
+
+#ifndef __EMSCRIPTEN__
+static pthread_cond_t prefetch_available = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t prefetch_done = PTHREAD_COND_INITIALIZER;
+static pthread_t prefetch_thread;
+static bool prefetch_thread_running = false;
+static bool prefetch_decoding = false;
+
+/** Queue of task indices to decode. */
+static int* prefetch_queue = NULL;
+static int prefetch_queue_head = 0;
+static int prefetch_queue_count = 0;
+static int prefetch_queue_capacity = 0;
+
+static void* prefetch_thread_main(void* arg) {
+    PREFETCH_LOCK();
+
+    while (true) {
+        while (prefetch_thread_running && prefetch_queue_head == prefetch_queue_count) {
+            prefetch_queue_head = 0;
+            prefetch_queue_count = 0;
+            pthread_cond_wait(&prefetch_available, &prefetch_mutex);
+        }
+
+        if (!prefetch_thread_running) break;
+
+        load_task_t* task = &load_tasks[prefetch_queue[prefetch_queue_head++]];
+
+        // Task may have been taken over by a load on the main thread
+        if (task->state != LOAD_TASK_QUEUED) continue;
+
+        task->state = LOAD_TASK_DECODING;
+        prefetch_decoding = true;
+        PREFETCH_UNLOCK();
+
+        load_task_decode(task);
+
+        PREFETCH_LOCK();
+        task->state = LOAD_TASK_DONE;
+        prefetch_decoding = false;
+        pthread_cond_broadcast(&prefetch_done);
+    }
+
+    PREFETCH_UNLOCK();
+
+    return NULL;
+}
+
+/**
+ * Start prefetch thread if not already running.
+ *
+ * @return true if thread is running, false otherwise
+ */
+static bool prefetch_thread_start(void) {
+    if (prefetch_thread_running) return true;
+
+    prefetch_thread_running = true;
+
+    if (pthread_create(&prefetch_thread, NULL, prefetch_thread_main, NULL) != 0) {
+        log_error("Failed to create asset prefetch thread");
+        prefetch_thread_running = false;
+    }
+
+    return prefetch_thread_running;
+}
+
+/**
+ * Stop prefetch thread and wait for it to finish.
+ */
+static void prefetch_thread_stop(void) {
+    if (!prefetch_thread_running) return;
+
+    PREFETCH_LOCK();
+    prefetch_thread_running = false;
+    pthread_cond_broadcast(&prefetch_available);
+    PREFETCH_UNLOCK();
+
+    pthread_join(prefetch_thread, NULL);
+
+    free(prefetch_queue);
+    prefetch_queue = NULL;
+    prefetch_queue_head = 0;
+    prefetch_queue_count = 0;
+    prefetch_queue_capacity = 0;
+}
+
+/**
+ * Add task to prefetch queue. Prefetch lock must be held.
+ *
+ * @param index Task index
+ * @return true if queued, false otherwise
+ */
+static bool prefetch_queue_push(int index) {
+    if (prefetch_queue_count == prefetch_queue_capacity) {
+        int capacity = prefetch_queue_capacity ? prefetch_queue_capacity * 2 : 64;
+        int* queue = (int*)realloc(prefetch_queue, sizeof(int) * capacity);
+
+        if (!queue) return false;
+
+        prefetch_queue = queue;
+        prefetch_queue_capacity = capacity;
+    }
+
+    prefetch_queue[prefetch_queue_count++] = index;
+    pthread_cond_signal(&prefetch_available);
+
+    return true;
+}
+#endif
+
+/**
+ * Make lazily loaded asset resident. Decodes on the calling thread unless the
+ * prefetch thread is already decoding it, in which case waits for it.
+ *
+ * @param handle Asset handle
+ */
+static void lazy_load(int handle) {
+    asset_slot_t* slot = &asset_slots[handle];
+    load_task_t* task = &load_tasks[slot->task];
+
+    PREFETCH_LOCK();
+
+    if (task->failed) {
+        PREFETCH_UNLOCK();
+        return;
+    }
+
+    if (task->state == LOAD_TASK_IDLE || task->state == LOAD_TASK_QUEUED) {
+        task->state = LOAD_TASK_DECODING;
+        PREFETCH_UNLOCK();
+
+        load_task_decode(task);
+
+        PREFETCH_LOCK();
+        task->state = LOAD_TASK_DONE;
+    }
+
+#ifndef __EMSCRIPTEN__
+    while (task->state == LOAD_TASK_DECODING) {
+        pthread_cond_wait(&prefetch_done, &prefetch_mutex);
+    }
+#endif
+
+    slot->asset = task->asset;
+    slot->size = task->size;
+    task->asset = NULL;
+    task->failed = slot->asset == NULL;
+    task->state = LOAD_TASK_IDLE;
+
+    PREFETCH_UNLOCK();
+
+    if (!slot->asset) {
+        log_error("Failed to load asset: %s", slot->name);
+        return;
+    }
+
+    if (task->has_transparent_color) {
+        graphics_transparent_color_set(task->transparent_color);
+    }
+
+    if (lru_contains(slot)) {
+        lazy_resident_bytes += slot->size;
+        lru_push_front(handle);
+        lazy_evict(handle);
+    }
+}
+
+/**
+ * Free all lazily loaded assets and their tasks.
+ */
+static void lazy_unload(void) {
+#ifndef __EMSCRIPTEN__
+    // Drop queued tasks and wait for the one in flight
+    PREFETCH_LOCK();
+    prefetch_queue_head = 0;
+    prefetch_queue_count = 0;
+
+    while (prefetch_decoding) {
+        pthread_cond_wait(&prefetch_done, &prefetch_mutex);
+    }
+
+    PREFETCH_UNLOCK();
+#endif
+
+    for (int i = 0; i < asset_slot_count; i++) {
+        asset_slot_t* slot = &asset_slots[i];
+
+        if (slot->task >= 0 && slot->asset) {
+            asset_free(slot->type, slot->asset);
+            slot->asset = NULL;
+        }
+
+        slot->task = -1;
+        slot->size = 0;
+        slot->pins = 0;
+        slot->lru_prev = -1;
+        slot->lru_next = -1;
+    }
+
+    // Prefetched assets never used
+    for (int i = 0; i < load_task_count; i++) {
+        if (load_tasks[i].asset) {
+            asset_free(load_tasks[i].type, load_tasks[i].asset);
+            load_tasks[i].asset = NULL;
+        }
+    }
+
+    load_tasks_clear();
+
+    if (lazy_zip) {
+        zip_close(lazy_zip);
+        lazy_zip = NULL;
+    }
+
+    lru_head = -1;
+    lru_tail = -1;
+    lazy_resident_bytes = 0;
+}
+
+typedef struct {
+    asset_type_t type;
+    void* asset;
+} detached_asset_t;
+
+/**
+ * Assets owned by neither the asset arrays nor a lazily loaded slot, such as
+ * assets added or replaced by a file reload. Freed when assets are unloaded.
+ */
+static detached_asset_t* detached_assets = NULL;
+static int detached_asset_count = 0;
+static int detached_asset_capacity = 0;
+
+/**
+ * Keep asset until assets are unloaded.
+ *
+ * @param type Asset type
+ * @param asset Asset to keep
+ */
+static void detached_asset_add(asset_type_t type, void* asset) {
+    if (!asset) return;
+
+    if (detached_asset_count == detached_asset_capacity) {
+        int capacity = detached_asset_capacity ? detached_asset_capacity * 2 : 16;
+        detached_asset_t* assets = (detached_asset_t*)realloc(detached_assets, sizeof(detached_asset_t) * capacity);
+
+        if (!assets) {
+            log_error("Failed to allocate memory for asset");
+            return;
+        }
+
+        detached_assets = assets;
+        detached_asset_capacity = capacity;
+    }
+
+    detached_assets[detached_asset_count++] = (detached_asset_t) {type, asset};
+}
+
+/**
+ * Unload all assets.
+ */
+static void unload_assets(void) {
+    // Sounds may still be playing from asset memory
+    mixer_stop_all();
+    mixer_sync();
+    streams_sources_close();
+
+    lazy_unload();
+
+    // Free detached assets
+    for (int i = 0; i < detached_asset_count; i++) {
+        asset_free(detached_assets[i].type, detached_assets[i].asset);
+    }
+    free(detached_assets);
+    detached_assets = NULL;
+    detached_asset_count = 0;
+    detached_asset_capacity = 0;
+
+    // Free textures
+    for (int i = 0; i < texture_asset_count; i++) {
+        texture_asset_free(texture_assets[i].asset);
+        texture_assets[i].asset = NULL;
+        texture_assets[i].name = NULL;
+    }
+    free(texture_assets);
+    texture_assets = NULL;
+    texture_asset_count = 0;
+
+    // Free scripts. Pack scripts are owned by the pack.
+    for (int i = 0; i < script_asset_count; i++) {
+        if (!assets_pack) free((char*)script_assets[i].asset);
+        script_assets[i].asset = NULL;
+        script_assets[i].name = NULL;
+    }
+    free(script_assets);
+    script_assets = NULL;
+    script_asset_count = 0;
+
+    // Free sounds
+    for (int i = 0; i <  sound_asset_count; i++) {
+        if (!assets_pack) sounds_sound_free(sound_assets[i].asset);
+        sound_assets[i].name = NULL;
+    }
+    free(sound_assets);
+    sound_assets = NULL;
+    sound_asset_count = 0;
+
+    pack_close(assets_pack);
+    assets_pack = NULL;
+
+    // Zip may have changed on disk
+    files_archive_close();
+
+    // Keep names and handles for next load
+    for (int i = 0; i < asset_slot_count; i++) {
+        asset_slots[i].asset = NULL;
+    }
+}
+
+void assets_reload(void)  {
+    unload_assets();
+    load_assets();
+}
+
+int assets_handle_get(const char* filename) {
+    if (!asset_handles) return -1;
+
+    const char* name = normalize_filename(filename);
+
+    while (strncmp(name, "./", 2) == 0) {
+        name += 2;
+    }
+
+    int handle;
+
+    if (!hash_table_get(asset_handles, name, &handle)) return -1;
+
+    return handle;
+}
+
+/**
+ * Get asset for given handle.
+ *
+ * @param handle Asset handle
+ * @param type Expected asset type
+ * @return void* Asset for handle if found and of given type, NULL otherwise
+ */
+static void* asset_get(int handle, asset_type_t type) {
+    if (handle < 0 || handle >= asset_slot_count) return NULL;
+
+    asset_slot_t* slot = &asset_slots[handle];
+    if (slot->type != type) return NULL;
+
+    if (slot->task >= 0) {
+        if (!slot->asset) {
+            lazy_load(handle);
+        }
+        else if (lru_contains(slot) && lru_head != handle) {
+            lru_remove(handle);
+            lru_push_front(handle);
+        }
+    }
+
+    return slot->asset;
+}
+
+void assets_prefetch(int handle) {
+    if (handle < 0 || handle >= asset_slot_count) return;
+
+    asset_slot_t* slot = &asset_slots[handle];
+    if (slot->task < 0 || slot->asset) return;
+
+    load_task_t* task = &load_tasks[slot->task];
+
+#ifndef __EMSCRIPTEN__
+    if (prefetch_thread_start()) {
+        PREFETCH_LOCK();
+
+        if (!task->failed && task->state == LOAD_TASK_IDLE && prefetch_queue_push(slot->task)) {
+            task->state = LOAD_TASK_QUEUED;
+        }
+
+        PREFETCH_UNLOCK();
+        return;
+    }
+#endif
+
+    lazy_load(handle);
+}
+
+void assets_pin(int handle) {
+    if (handle < 0 || handle >= asset_slot_count) return;
+
+    asset_slots[handle].pins++;
+}
+
+const char* assets_source_directory_get(void) {
+    return loaded_from_directory ? assets_directory : NULL;
+}
+
+/**
+ * Copy given texture asset's pixels into another of the same shape.
+ *
+ * @param asset Texture asset to update
+ * @param update Texture asset to copy from
+ * @return true if updated, false if shapes differ
+ */
+static bool texture_asset_update(texture_asset_t* asset, texture_asset_t* update) {
+    if (asset->mapped || asset->frame_count != update->frame_count) return false;
+
+    for (int i = 0; i < asset->frame_count; i++) {
+        if (asset->frames[i]->width != update->frames[i]->width) return false;
+        if (asset->frames[i]->height != update->frames[i]->height) return false;
+    }
+
+    for (int i = 0; i < asset->frame_count; i++) {
+        texture_t* frame = asset->frames[i];
+        memcpy(frame->pixels, update->frames[i]->pixels, frame->width * frame->height * sizeof(color_t));
+    }
+
+    return true;
+}
+
+/**
+ * Copy given sound's samples into another of the same shape.
+ *
+ * @param sound Sound to update
+ * @param update Sound to copy from
+ * @return true if updated, false if shapes differ
+ */
+static bool sound_update(sound_t* sound, sound_t* update) {
+    if (assets_pack) return false;
+    if (sound->frame_count != update->frame_count || sound->channel_count != update->channel_count) return false;
+
+    memcpy(sound->pcm, update->pcm, sound->frame_count * sound->channel_count * sizeof(sample_t));
+
+    return true;
+}
+
+bool assets_file_reload(const char* filename) {
+    asset_type_t type;
+    if (!asset_type_from_filename(filename, &type)) return false;
+
+    const char* name = normalize_filename(filename);
+
+    load_task_t task;
+    memset(&task, 0, sizeof(load_task_t));
+    task.type = type;
+    task.path = (char*)filename;
+    task.zip_index = -1;
+
+    load_task_decode(&task);
+
+    if (!task.asset) {
+        log_error("Failed to reload asset: %s", name);
+        return false;
+    }
+
+    if (task.has_transparent_color) {
+        graphics_transparent_color_set(task.transparent_color);
+    }
+
+    int handle = assets_handle_get(name);
+    asset_slot_t* slot = handle >= 0 ? &asset_slots[handle] : NULL;
+
+    if (slot && slot->type != type) {
+        slot = NULL;
+    }
+
+    // Lazily loaded assets that aren't resident will read the file when used
+    if (slot && slot->task >= 0 && !slot->asset) {
+        PREFETCH_LOCK();
+        load_tasks[slot->task].failed = false;
+        PREFETCH_UNLOCK();
+
+        asset_free(type, task.asset);
+        return true;
+    }
+
+    // Update in place so existing handles to the asset stay valid
+    if (slot && slot->asset) {
+        bool updated = false;
+
+        switch (type) {
+            case ASSET_TYPE_TEXTURE: updated = texture_asset_update(slot->asset, task.asset); break;
+            case ASSET_TYPE_SOUND: updated = sound_update(slot->asset, task.asset); break;
+            case ASSET_TYPE_SCRIPT: break;
+        }
+
+        if (updated) {
+            asset_free(type, task.asset);
+            log_info("reloaded: %s", name);
+            return true;
+        }
+    }
+
+    // Otherwise replace asset. Previous asset is kept until next unload as
+    // it may still be referenced.
+    if (slot && slot->task >= 0) {
+        detached_asset_add(type, slot->asset);
+
+        if (lru_contains(slot)) {
+            lazy_resident_bytes = lazy_resident_bytes - slot->size + task.size;
+        }
+
+        slot->asset = task.asset;
+        slot->size = task.size;
+    }
+    else {
+        if (asset_register(name, type, task.asset, task.size) < 0) {
+            asset_free(type, task.asset);
+            return false;
+        }
+
+        detached_asset_add(type, task.asset);
+    }
+
+    log_info("reloaded: %s", name);
+
+    return true;
+}
+
+void assets_unpin(int handle) {
+    if (handle < 0 || handle >= asset_slot_count) return;
+
+    // Pins are reset by reloads, while old references may still be released
+    if (asset_slots[handle].pins > 0) {
+        asset_slots[handle].pins--;
+    }
+}
+
+texture_t* assets_texture_get(const char* filename, int frame) {
+    return assets_texture_handle_get(assets_handle_get(filename), frame);
+}
+
+const char* assets_script_get(const char* filename) {
+    return (const char*)asset_get(assets_handle_get(filename), ASSET_TYPE_SCRIPT);
+}
+
+const char* assets_script_chunk_get(const char* filename, size_t* size) {
+    int handle = assets_handle_get(filename);
+    const char* script = (const char*)asset_get(handle, ASSET_TYPE_SCRIPT);
+
+    *size = script ? asset_slots[handle].size : 0;
+
+    return script;
+}
+
+sound_t* assets_sound_get(const char* filename) {
+    return assets_sound_handle_get(assets_handle_get(filename));
+}
+
+texture_t* assets_texture_handle_get(int handle, int frame) {
+    texture_asset_t* asset = (texture_asset_t*)asset_get(handle, ASSET_TYPE_TEXTURE);
+
+    return texture_asset_frame_get(asset, frame);
+}
+
+sound_t* assets_sound_handle_get(int handle) {
+    return (sound_t*)asset_get(handle, ASSET_TYPE_SOUND);
+}
+
+/** Frames converted at a time when streaming WAV files. */
+#define WAV_STREAM_CHUNK_FRAMES 1024
+
+/**
+ * Streaming WAV decoder.
+ */
+typedef struct {
+    drwav wav;
+    FILE* file;
+    int16_t* samples;
+} wav_stream_t;
+
+static size_t wav_stream_file_read(void* data, void* buffer, size_t size) {
+    return fread(buffer, 1, size, ((wav_stream_t*)data)->file);
 }
 
-static int asset_count;
+static drwav_bool32 wav_stream_file_seek(void* data, int offset, drwav_seek_origin origin) {
+    int whence = origin == drwav_seek_origin_current ? SEEK_CUR : SEEK_SET;
 
-/**
- * Callback function to add texture assets.
- *
- * @param filename Texture filename
- */
-static void add_textures(const char* filename) {
-    if (!files_check_extension(filename, "gif")) return;
+    return fseek(((wav_stream_t*)data)->file, offset, whence) == 0;
+}
 
-    // Load gif file
-    gif_t* gif = gif_load(filename);
-    if (!gif) {
-        log_error("Failed to load texture: %s", filename);
-        return;
-    }
+static uint64_t wav_stream_read(void* data, sample_t* buffer, uint64_t frame_count) {
+    wav_stream_t* stream = (wav_stream_t*)data;
+    int channel_count = stream->wav.channels;
+    uint64_t total = 0;
+
+    while (total < frame_count) {
+        uint64_t count = frame_count - total;
+        if (count > WAV_STREAM_CHUNK_FRAMES) count = WAV_STREAM_CHUNK_FRAMES;
 
-    texture_asset_t* asset = texture_asset_new(gif->frame_count);
+        uint64_t frames = drwav_read_pcm_frames_s16(&stream->wav, count, stream->samples);
+        if (frames == 0) break;
 
-    // Add all frames
-    for (size_t i = 0 ; i < asset->frame_count; i++) {
-        asset->frames[i] = graphics_texture_copy(gif->frames[i]);
+        // Any WAV format is converted to unsigned 8 bit samples
+        sample_t* out = buffer + total * channel_count;
+        for (uint64_t i = 0; i < frames * channel_count; i++) {
+            out[i] = (sample_t)((stream->samples[i] + 32768) >> 8);
+        }
+
+        total += frames;
     }
 
-    texture_assets_total_bytes += texture_asset_sizeof(asset);
+    return total;
+}
 
-    // Normalize filename
-    char* asset_name = normalize_filename(filename);
+static bool wav_stream_seek(void* data, uint64_t frame) {
+    return drwav_seek_to_pcm_frame(&((wav_stream_t*)data)->wav, frame);
+}
 
-    // Add texture asset
-    texture_assets[asset_count++] = assets_entry_new(asset_name, asset);
+static void wav_stream_close(void* data) {
+    wav_stream_t* stream = (wav_stream_t*)data;
 
-    gif_free(gif);
+    drwav_uninit(&stream->wav);
+    fclose(stream->file);
+    free(stream->samples);
+    free(stream);
 }
 
 /**
- * Callback function to add script assets.
- *
- * @param filename Script filename
+ * Streaming reader for a sound already in memory.
  */
-static void add_scripts(const char* filename) {
-    if (!files_check_extension(filename, "lua")) return;
+typedef struct {
+    sound_t* sound;
+    uint64_t position;
+} sound_stream_t;
 
-    // Open script file
-    FILE* fp = fopen(filename, "rb");
-    if (!fp) {
-        log_error("Failed to open script: %s", filename);
-        return;
-    }
+static uint64_t sound_stream_read(void* data, sample_t* buffer, uint64_t frame_count) {
+    sound_stream_t* stream = (sound_stream_t*)data;
 
-    // Get script size
-    fseek(fp, 0, SEEK_END);
-    size_t size = ftell(fp);
-    rewind(fp);
+    uint64_t remaining = stream->sound->frame_count - stream->position;
+    if (frame_count > remaining) frame_count = remaining;
 
-    // Allocate memory
-    char* script = calloc(size + 1, sizeof(char));
-    if (!script) {
-        log_error("Failed to allocate memory for script.");
-        fclose(fp);
-        return;
-    }
+    size_t frame_size = stream->sound->channel_count * sizeof(sample_t);
+    memcpy(buffer, stream->sound->pcm + stream->position * stream->sound->channel_count, frame_count * frame_size);
+    stream->position += frame_count;
 
-    // Read in script bytes
-    size_t ret_code = fread(script, 1, size, fp);
-    if (ret_code != size) {
-        if (feof(fp)) {
-            log_error("Error reading %s: unexpected end of file\n", filename);
-        }
-        else if (ferror(fp)) {
-            log_error("Error reading %s", filename);
-        }
-    }
+    return frame_count;
+}
 
-    script_assets_total_bytes += size;
+static bool sound_stream_seek(void* data, uint64_t frame) {
+    sound_stream_t* stream = (sound_stream_t*)data;
+    if (frame > stream->sound->frame_count) return false;
 
-    // Normalize filename
-    char* asset_name = normalize_filename(filename);
+    stream->position = frame;
 
-    // Add script asset
-    script_assets[asset_count++] = assets_entry_new(asset_name, script);
+    return true;
+}
 
-    fclose(fp);
+static void sound_stream_close(void* data) {
+    free(data);
 }
 
-/**
- * Callback function to add sound assets.
- *
- * @param filename Sound filename
- */
-static void add_sounds(const char* filename) {
-    if (!files_check_extension(filename, "wav")) return;
+bool assets_stream_source_open(const char* filename, stream_source_t* source) {
+    if (assets_pack) {
+        const pack_entry_t* entry = pack_entry_find(assets_pack, filename);
+        sound_t* sound = entry && entry->type == PACK_ENTRY_SOUND ? sound_from_pack(entry) : NULL;
+        if (!sound) return false;
 
-    drwav wav;
-    if (!drwav_init_file(&wav, filename, NULL)) {
-        log_error("Failed to open sound: %s", filename);
-        return;
-    }
+        sound_stream_t* stream = (sound_stream_t*)calloc(1, sizeof(sound_stream_t));
+        if (!stream) return false;
 
-    sound_t* sound = sound_from_wav(&wav);
+        stream->sound = sound;
 
-    if (sound) {
-        // Normalize filename
-        char* asset_name = normalize_filename(filename);
+        source->data = stream;
+        source->read = sound_stream_read;
+        source->seek = sound_stream_seek;
+        source->close = sound_stream_close;
+        source->frame_count = sound->frame_count;
+        source->channel_count = sound->channel_count;
+        source->sample_rate = SOUNDS_SAMPLE_RATE;
 
-        // Add script asset
-        sound_assets[asset_count++] = assets_entry_new(asset_name, sound);
+        return true;
     }
 
-    drwav_uninit(&wav);
-}
-
-/**
- * Load assets from assets directory.
- *
- * @return true If successful, false otherwise.
- */
-static bool load_from_assets_directory(void) {
-    log_info("loading directory: %s", assets_directory);
+    if (!files_check_extension(filename, "wav")) return false;
 
-    // Load palette
-    char palette_path[strlen(assets_directory) + 13];
-    memset(palette_path, 0, strlen(assets_directory) + 13);
-    strcat(palette_path, assets_directory);
-    strcat(palette_path, "/palette.gif");
+    // Zip entries can only be inflated whole, so they are decoded from
+    // memory. Still saves decoding up front, but not the memory.
+    if (!loaded_from_directory) {
+        log_info("streaming zip entry from memory, use an asset pack to stream from disk: %s", filename);
+    }
 
-    gif_t* palette = gif_load(palette_path);
+    wav_stream_t* stream = (wav_stream_t*)calloc(1, sizeof(wav_stream_t));
+    if (!stream) return false;
 
-    if (!palette) {
-        log_error("Failed to load palette file.");
+    stream->file = files_open(filename, "rb");
+    if (!stream->file) {
+        free(stream);
         return false;
     }
 
-    graphics_palette_set(palette->palette);
-    gif_free(palette);
-
-    // Count all assets
-    texture_asset_count = default_texture_asset_count;
-    files_walk_directory(assets_directory, count_assets);
-
-    // Load textures
-    asset_count = 0;
-    texture_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * texture_asset_count);
-
-    // Load default textures
-    texture_t* texture = graphics_texture_new(256, 64, default_font_pixels);
-    texture_asset_t* asset = texture_asset_new(1);
-    asset->frames[0] = texture;
-    texture_assets_total_bytes += texture_asset_sizeof(asset);
-    texture_assets[asset_count++] = assets_entry_new("font.gif", asset);
+    if (!drwav_init(&stream->wav, wav_stream_file_read, wav_stream_file_seek, stream, NULL)) {
+        fclose(stream->file);
+        free(stream);
+        return false;
+    }
 
-    // Load asset textures
-    files_walk_directory(assets_directory, add_textures);
+    if (stream->wav.channels == 0 || stream->wav.sampleRate == 0) {
+        drwav_uninit(&stream->wav);
+        fclose(stream->file);
+        free(stream);
+        return false;
+    }
 
-    // Load scripts
-    asset_count = 0;
-    script_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * script_asset_count);
-    files_walk_directory(assets_directory, add_scripts);
+    stream->samples = (int16_t*)malloc(sizeof(int16_t) * WAV_STREAM_CHUNK_FRAMES * stream->wav.channels);
+    if (!stream->samples) {
+        wav_stream_close(stream);
+        return false;
+    }
 
-    // Load sounds
-    asset_count = 0;
-    sound_assets = (asset_entry_t*)malloc(sizeof(asset_entry_t) * sound_asset_count);
-    files_walk_directory(assets_directory, add_sounds);
+    source->data = stream;
+    source->read = wav_stream_read;
+    source->seek = wav_stream_seek;
+    source->close = wav_stream_close;
+    source->frame_count = stream->wav.totalPCMFrameCount;
+    source->channel_count = stream->wav.channels;
+    source->sample_rate = stream->wav.sampleRate;
 
     return true;
 }
 
 /**
- * Load all assets.
+ * Copy a GIF color map into a palette.
+ *
+ * @param palette 256 color array
+ * @param color_map GIF color map
+ */
+static void palette_from_color_map(uint32_t* palette, ColorMapObject* color_map) {
+    for (int i = 0; i < color_map->ColorCount && i < 256; i++) {
+        GifColorType gct = color_map->Colors[i];
+        int r = gct.Red;
+        int g = gct.Green;
+        int b = gct.Blue;
+        int a = 0xFF;
+        uint32_t color = a << 24 | b << 16 | g << 8 | r;
+        palette[i] = color;
+    }
+}
+
+/**
+ * Decode next image of a GIF straight into a new frame texture.
  *
+ * @param gif_file GIF being read, positioned at an image descriptor
+ * @param gif gif_t to add frame to
  * @return true if successful, false otherwise
  */
-static bool load_assets(void) {
-    // Check if user gave us a zip file or asset directory
-    if (arguments_count() > 1) {
-        const char* zip_or_directory = arguments_last();
+static bool gif_frame_read(GifFileType* gif_file, gif_t* gif) {
+    if (DGifGetImageDesc(gif_file) == GIF_ERROR) return false;
 
-        // If we are given a zip file, load it
-        if (files_check_extension(zip_or_directory, "zip")) {
-            return load_from_zip();
-        }
+    GifImageDesc* image_desc = &gif_file->Image;
 
-        // Otherwise set the asset directory and fall through
-        assets_directory = (char*)zip_or_directory;
+    // Get palette from first image if there is no common palette
+    if (!gif_file->SColorMap && gif->frame_count == 0) {
+        log_error("GIF missing common color map");
 
-        // Sanitize Windows-style path separators
-        size_t len = strlen(assets_directory);
-        for (size_t i = 0; i < len; i++) {
-            if (assets_directory[i] == '\\') {
-                assets_directory[i] = '/';
-            }
-        }
+        if (!image_desc->ColorMap) return false;
+
+        palette_from_color_map(gif->palette, image_desc->ColorMap);
+        log_error("Using color map from first frame.");
     }
 
-    return load_from_assets_directory();
-}
+    if (gif->frame_count == gif->frame_capacity) {
+        int capacity = gif->frame_capacity ? gif->frame_capacity * 2 : 1;
+        texture_t** frames = (texture_t**)realloc(gif->frames, sizeof(texture_t*) * capacity);
+        if (!frames) {
+            log_error("Failed to create frames for GIF");
+            return false;
+        }
 
-/**
- * Unload all assets.
- */
-static void unload_assets(void) {
-    // Free textures
-    for (int i = 0; i < texture_asset_count; i++) {
-        texture_asset_free(texture_assets[i].asset);
-        texture_assets[i].asset = NULL;
-        free((char*)texture_assets[i].name);
-        texture_assets[i].name = NULL;
+        gif->frames = frames;
+        gif->frame_capacity = capacity;
     }
-    free(texture_assets);
-    texture_assets = NULL;
-    texture_asset_count = 0;
 
-    // Free scripts
-    for (int i = 0; i < script_asset_count; i++) {
-        free((char*)script_assets[i].asset);
-        script_assets[i].asset = NULL;
-        free((char*)script_assets[i].name);
-        script_assets[i].name = NULL;
-    }
-    free(script_assets);
-    script_assets = NULL;
-    script_asset_count = 0;
+    const int width = image_desc->Width;
+    const int height = image_desc->Height;
 
-    // Free sounds
-    for (int i = 0; i <  sound_asset_count; i++) {
-        sounds_sound_free(sound_assets[i].asset);
-        free((char*) sound_assets[i].name);
-        sound_assets[i].name = NULL;
+    texture_t* texture = graphics_texture_new(width, height, NULL);
+    if (!texture) return false;
+
+    gif->frames[gif->frame_count++] = texture;
+
+    if (image_desc->Interlace) {
+        static const int offsets[] = {0, 4, 2, 1};
+        static const int jumps[] = {8, 8, 4, 2};
+
+        for (int pass = 0; pass < 4; pass++) {
+            for (int y = offsets[pass]; y < height; y += jumps[pass]) {
+                if (DGifGetLine(gif_file, &texture->pixels[y * width], width) == GIF_ERROR) return false;
+            }
+        }
+    }
+    else {
+        for (int y = 0; y < height; y++) {
+            if (DGifGetLine(gif_file, &texture->pixels[y * width], width) == GIF_ERROR) return false;
+        }
     }
-    free(sound_assets);
-    sound_assets = NULL;
-    sound_asset_count = 0;
-}
 
-void assets_reload(void)  {
-    unload_assets();
-    load_assets();
+    return true;
 }
 
 /**
- * Get asset for given name.
+ * Read all records of a GIF.
  *
- * @param assets Array of asset_entry_t
- * @param count Count of asset_entry_t array
- * @param name Name to look for
- * @return void* Asset for name if found, NULL otherwise
+ * @param gif_file GIF being read
+ * @param gif gif_t to fill
+ * @return true if successful, false otherwise
  */
-static void* asset_get(asset_entry_t* assets, int count, const char* name) {
-    for (int i = count - 1; i >= 0; i--) {
-        const char* asset_name = assets[i].name;
-        if (strcmp(name, asset_name) == 0) {
-            return assets[i].asset;
+static bool gif_records_read(GifFileType* gif_file, gif_t* gif) {
+    GifRecordType record_type;
+
+    do {
+        if (DGifGetRecordType(gif_file, &record_type) == GIF_ERROR) return false;
+
+        if (record_type == IMAGE_DESC_RECORD_TYPE) {
+            // Extensions before an image belong to that image
+            gif->has_transparent_color = false;
+
+            if (!gif_frame_read(gif_file, gif)) return false;
         }
-    }
+        else if (record_type == EXTENSION_RECORD_TYPE) {
+            int code;
+            GifByteType* extension = NULL;
 
-    return NULL;
-}
+            if (DGifGetExtension(gif_file, &code, &extension) == GIF_ERROR) return false;
 
-texture_t* assets_texture_get(const char* filename, int frame) {
-    texture_asset_t* asset = (texture_asset_t*)asset_get(texture_assets, texture_asset_count, filename);
-    return texture_asset_frame_get(asset, frame);
-}
+            if (code == GRAPHICS_EXT_FUNC_CODE && extension) {
+                GraphicsControlBlock gcb;
 
-const char* assets_script_get(const char* filename) {
-    return(const char*)asset_get(script_assets, script_asset_count, filename);
-}
+                if (DGifExtensionToGCB(extension[0], extension + 1, &gcb) == GIF_OK) {
+                    gif->has_transparent_color = true;
+                    gif->transparent_color = gcb.TransparentColor;
+                }
+            }
 
-sound_t* assets_sound_get(const char* filename) {
-    return(sound_t*)asset_get(sound_assets, sound_asset_count, filename);
+            while (extension) {
+                if (DGifGetExtensionNext(gif_file, &extension) == GIF_ERROR) return false;
+            }
+        }
+    } while (record_type != TERMINATE_RECORD_TYPE);
+
+    return true;
 }
 
 /**
- * Processes GifFileType* into a gif_t*
+ * Processes GifFileType* into a gif_t*. Frames are decoded directly into
+ * their textures. Only a transparent color given after the last image is
+ * reported, matching extension blocks not owned by any image.
  *
  * @param gif_file GifFileType* to process
  * @return gif_t* new gif_t if successful, NULL otherwise
@@ -627,98 +2032,27 @@ sound_t* assets_sound_get(const char* filename) {
 static gif_t* load_gif_internal(GifFileType* gif_file) {
     int error;
 
-    // Read GIF file contents
-    if (DGifSlurp(gif_file) == GIF_ERROR) {
-        log_error("Failed to read GIF data");
+    gif_t* gif = (gif_t*)calloc(1, sizeof(gif_t));
+    if (!gif) {
+        log_error("Failed to create GIF");
         DGifCloseFile(gif_file, &error);
         return NULL;
     }
 
     // Get common palette
-    ColorMapObject* color_map = gif_file->SColorMap;
-
-    if (!color_map) {
-        log_error("GIF missing common color map");
-
-        // Get palette from first image
-        SavedImage first_image = gif_file->SavedImages[0];
-        GifImageDesc first_desc = first_image.ImageDesc;
-        color_map = first_desc.ColorMap;
-
-        if (!color_map) {
-            DGifCloseFile(gif_file, &error);
-            return NULL;
-        }
-
-        log_error("Using color map from first frame.");
-    }
-
-    uint32_t* palette = (uint32_t*)calloc(256, sizeof(uint32_t));
-
-    if (!palette) {
-        log_error("Failed to create palette for GIF");
-        DGifCloseFile(gif_file, &error);
-        return NULL;
-    }
-
-    for (int i = 0; i < color_map->ColorCount; i++) {
-        GifColorType gct = color_map->Colors[i];
-
-        int r = gct.Red;
-        int g = gct.Green;
-        int b = gct.Blue;
-        int a = 0xFF;
-
-        uint32_t color = a << 24 | b << 16 | g << 8 | r;
-
-        palette[i] = color;
-    }
-
-    // Get transparent color
-    for (int i = 0; i < gif_file->ExtensionBlockCount; i++) {
-        ExtensionBlock* block = &gif_file->ExtensionBlocks[i];
-
-        if (block->Function == GRAPHICS_EXT_FUNC_CODE) {
-            GraphicsControlBlock* gcb = NULL;
-            DGifExtensionToGCB(block->ByteCount, block->Bytes, gcb);
-            graphics_transparent_color_set(gcb->TransparentColor);
-        }
+    if (gif_file->SColorMap) {
+        palette_from_color_map(gif->palette, gif_file->SColorMap);
     }
 
-    // Get frames
-    int frame_count = gif_file->ImageCount;
-    texture_t** textures = (texture_t**)malloc(sizeof(texture_t*) * frame_count);
-
-    if (!textures) {
-        log_error("Failed to create frames for GIF");
+    if (!gif_records_read(gif_file, gif)) {
+        log_error("Failed to read GIF data");
         DGifCloseFile(gif_file, &error);
+        gif_free(gif);
         return NULL;
     }
 
-    for (int i = 0; i < frame_count; i++) {
-        SavedImage saved_image = gif_file->SavedImages[i];
-        GifImageDesc image_desc = saved_image.ImageDesc;
-
-        texture_t* t = graphics_texture_new(image_desc.Width, image_desc.Height, saved_image.RasterBits);
-        textures[i] = t;
-    }
-
     DGifCloseFile(gif_file, &error);
 
-    // Create gif_t
-    gif_t* gif = (gif_t*)malloc(sizeof(gif_t));
-
-    if (!gif) {
-        log_error("Failed to create GIF");
-        return NULL;
-    }
-
-    gif->frame_count = frame_count;
-    gif->frames = textures;
-    memmove(gif->palette, palette, sizeof(uint32_t) * 256);
-
-    free(palette);
-
     return gif;
 }
 
@@ -780,6 +2114,7 @@ static texture_asset_t* texture_asset_new(int frame_count) {
 
     asset->frame_count = frame_count;
     asset->frames = (texture_t**)malloc(sizeof(texture_t*) * frame_count);
+    asset->mapped = false;
 
     for (size_t i=0; i < frame_count; i++) {
         asset->frames[i] = NULL;
@@ -789,15 +2124,41 @@ static texture_asset_t* texture_asset_new(int frame_count) {
 }
 
 /**
- * Frees a texture asset. Will also free all frame textures.
+ * Creates a new texture asset from a GIF. The asset takes ownership of the
+ * GIF's frames and the GIF is freed.
+ *
+ * @param gif GIF to take frames from.
+ * @return New texture asset.
+ */
+static texture_asset_t* texture_asset_from_gif(gif_t* gif) {
+    texture_asset_t* asset = (texture_asset_t*)malloc(sizeof(texture_asset_t));
+
+    if (asset) {
+        asset->frame_count = gif->frame_count;
+        asset->frames = gif->frames;
+        asset->mapped = false;
+
+        gif->frame_count = 0;
+        gif->frames = NULL;
+    }
+
+    gif_free(gif);
+
+    return asset;
+}
+
+/**
+ * Frees a texture asset. Will also free all frame textures unless they are
+ * owned by a pack.
  *
  * @param texture_asset_t Texture asset to free.
  */
 static void texture_asset_free(texture_asset_t* asset) {
-    for (size_t i=0; i < asset->frame_count; i++) {
+    for (size_t i=0; i < asset->frame_count && !asset->mapped; i++) {
         graphics_texture_free(asset->frames[i]);
     }
 
+    free(asset->frames);
     asset->frames = NULL;
 
     free(asset);
@@ -896,151 +2257,89 @@ static void gif_free(gif_t* gif) {
     gif = NULL;
 }
 
-void assets_gif_save(const char* filename, int frame_count, texture_t** frames) {
-    int error;
-    GifFileType* gif_file = EGifOpenFileName(filename, false, &error);
-
-    if (!gif_file) {
-        log_error("Failed to open: %s", filename);
-        return;
-    }
-
-    texture_t* texture = frames[0];
-
-    gif_file->SWidth = texture->width;
-    gif_file->SHeight = texture->height;
-    gif_file->SBackGroundColor = 0;
-    gif_file->SColorResolution = 8;
-
-    // Make palette
-    GifColorType color_map[256];
-    uint32_t* palette = graphics_palette_get();
-
-    for (int i = 0; i < 256; i++) {
-        uint32_t rgba = palette[i];
-        color_map[i].Red = rgba & 0xff;
-        color_map[i].Green = (rgba >> 8) & 0xff;
-        color_map[i].Blue = (rgba >> 16) & 0xff;
-    }
-
-    gif_file->SColorMap = GifMakeMapObject(256, color_map);
-
-    // Write out first frame
-    SavedImage saved_image;
-
-    saved_image.ImageDesc.Left = 0;
-    saved_image.ImageDesc.Top = 0;
-    saved_image.ImageDesc.Width = texture->width;
-    saved_image.ImageDesc.Height = texture->height;
-    saved_image.ImageDesc.Interlace = false;
-    saved_image.ImageDesc.ColorMap = NULL;
-
-    size_t size = sizeof(color_t) * texture->width * texture->height;
-    saved_image.RasterBits = malloc(size);
-    memcpy(saved_image.RasterBits, texture->pixels, size);
+bool assets_pack_save(const char* filename) {
+    pack_writer_t* writer = pack_writer_open(filename);
+    if (!writer) return false;
 
-    int extension_block_count = 0;
-    ExtensionBlock* extension_blocks = NULL;
-
-    // Netscape loop
-    error = GifAddExtensionBlock(
-        &extension_block_count,
-        &extension_blocks,
-        APPLICATION_EXT_FUNC_CODE,
-        11,
-        (unsigned char *)"NETSCAPE2.0"
-    );
-
-    if (error == GIF_ERROR) {
-        log_error("Failed to save: %s - %i", filename, gif_file->Error);
-    }
+    int count = 0;
 
-    unsigned char params[] = {1, 0, 0};
+    for (int handle = 0; handle < asset_slot_count; handle++) {
+        asset_slot_t* slot = &asset_slots[handle];
+        void* asset = asset_get(handle, slot->type);
 
-    error = GifAddExtensionBlock(
-        &extension_block_count,
-        &extension_blocks,
-        0,
-        sizeof(params),
-        params
-    );
+        if (!asset) continue;
 
-    // Graphics control block
-    GraphicsControlBlock gcb;
-    memset(&gcb, '\0', 4);
+        // Default textures are created by the engine
+        bool is_default = false;
+        for (int i = 0; i < default_texture_asset_count; i++) {
+            is_default = is_default || texture_assets[i].asset == asset;
+        }
 
-    gcb.DisposalMode = DISPOSE_DO_NOT;
-    gcb.UserInputFlag = false;
-    gcb.DelayTime = GIF_DELAY_50_FPS;
-    gcb.TransparentColor = NO_TRANSPARENT_COLOR;
+        if (is_default) continue;
 
-    GifByteType extension[4];
-    EGifGCBToExtension(&gcb, (GifByteType*)extension);
+        switch (slot->type) {
+            case ASSET_TYPE_TEXTURE: {
+                texture_asset_t* texture_asset = (texture_asset_t*)asset;
+                pack_writer_entry_add(writer, slot->name, PACK_ENTRY_TEXTURE, texture_asset->frame_count);
 
-    error = GifAddExtensionBlock(
-        &extension_block_count,
-        &extension_blocks,
-        GRAPHICS_EXT_FUNC_CODE,
-        4,
-        (unsigned char*)extension
-    );
+                for (int i = 0; i < texture_asset->frame_count; i++) {
+                    texture_t* frame = texture_asset->frames[i];
+                    pack_writer_write(writer, frame, graphics_texture_sizeof(frame));
+                }
+                break;
+            }
 
-    saved_image.ExtensionBlockCount = extension_block_count;
-    saved_image.ExtensionBlocks = extension_blocks;
+            case ASSET_TYPE_SCRIPT: {
+                size_t size = strlen(slot->name) + 2;
+                char chunk_name[size];
+                snprintf(chunk_name, size, "=%s", slot->name);
 
-    GifMakeSavedImage(gif_file, &saved_image);
+                // Scripts that fail to compile are stored as text so errors
+                // are still reported when they run.
+                size_t chunk_size;
+                char* chunk = script_compile(chunk_name, (const char*)asset, slot->size, &chunk_size);
 
-    // Write out additional frames
-    for (int i = 1; i < frame_count; i++) {
-        extension_block_count = 0;
-        extension_blocks = NULL;
+                pack_writer_entry_add(writer, slot->name, PACK_ENTRY_SCRIPT, 0);
+                pack_writer_write(writer, chunk ? chunk : asset, chunk ? chunk_size : slot->size);
 
-        texture = frames[i];
+                free(chunk);
+                break;
+            }
 
-        SavedImage saved_image;
+            case ASSET_TYPE_SOUND: {
+                sound_t* sound = (sound_t*)asset;
+                pack_writer_entry_add(writer, slot->name, PACK_ENTRY_SOUND, 0);
+                pack_writer_write(writer, sound, sizeof(sound_t) + sound->frame_count * sound->channel_count * sizeof(sample_t));
+                break;
+            }
+        }
 
-        saved_image.ImageDesc.Left = 0;
-        saved_image.ImageDesc.Top = 0;
-        saved_image.ImageDesc.Width = texture->width;
-        saved_image.ImageDesc.Height = texture->height;
-        saved_image.ImageDesc.Interlace = false;
-        saved_image.ImageDesc.ColorMap = NULL;
+        count++;
+    }
 
-        size_t size = sizeof(color_t) * texture->width * texture->height;
-        saved_image.RasterBits = malloc(size);
-        memcpy(saved_image.RasterBits, texture->pixels, size);
+    if (!pack_writer_close(writer, graphics_palette_get(), graphics_transparent_color_get())) {
+        return false;
+    }
 
-        // Graphics control block
-        GraphicsControlBlock gcb;
-        memset(&gcb, '\0', 4);
+    log_info("packed %i assets: %s", count, filename);
 
-        gcb.DisposalMode = DISPOSE_DO_NOT;
-        gcb.UserInputFlag = false;
-        gcb.DelayTime = GIF_DELAY_50_FPS;
-        gcb.TransparentColor = NO_TRANSPARENT_COLOR;
+    return true;
+}
 
-        GifByteType extension[4];
-        EGifGCBToExtension(&gcb, (GifByteType*)extension);
+bool assets_gif_save(const char* filename, int frame_count, texture_t** frames) {
+    if (frame_count <= 0) return false;
 
-        error = GifAddExtensionBlock(
-            &extension_block_count,
-            &extension_blocks,
-            GRAPHICS_EXT_FUNC_CODE,
-            4,
-            (unsigned char*)extension
-        );
+    texture_t* texture = frames[0];
+    gif_encoder_t* encoder = gif_encoder_open(filename, texture->width, texture->height);
 
-        saved_image.ExtensionBlockCount = extension_block_count;
-        saved_image.ExtensionBlocks = extension_blocks;
+    if (!encoder) return false;
 
-        GifMakeSavedImage(gif_file, &saved_image);
+    // A failed frame fails the encoder, so closing removes the partial file
+    for (int i = 0; i < frame_count; i++) {
+        if (!gif_encoder_frame_add(encoder, frames[i], GIF_DELAY_50_FPS / 100.0)) break;
     }
 
-    error = EGifSpew(gif_file);
-
-    if (error == GIF_ERROR) {
-        log_error("Failed to save: %s - %i", filename, gif_file->Error);
-    }
+    return gif_encoder_close(encoder);
 }
 
 // Default font 256 x 64 pixels
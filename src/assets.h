@@ -12,12 +12,20 @@
 
 #include "graphics.h"
 #include "sounds.h"
+#include "streams.h"
 
 /**
- * Initialize assets system.
+ * Initialize assets system. Assets load in the background until
+ * assets_init_wait() is called.
  */
 void assets_init(void);
 
+/**
+ * Wait for assets started by assets_init() to finish loading. Must be called
+ * before any assets are used.
+ */
+void assets_init_wait(void);
+
 /**
  * Destroy assets system.
  */
@@ -44,6 +52,16 @@ texture_t* assets_texture_get(const char* filename, int frame_count);
  */
 const char* assets_script_get(const char* filename);
 
+/**
+ * Get script chunk for given filename. Chunks are script text or precompiled
+ * Lua bytecode, which is not null terminated.
+ *
+ * @param filename Name to search for.
+ * @param size Out chunk size in bytes.
+ * @return const char* chunk if found, NULL otherwise
+ */
+const char* assets_script_chunk_get(const char* filename, size_t* size);
+
 /**
  * Get sound for given filename.
  *
@@ -53,13 +71,101 @@ const char* assets_script_get(const char* filename);
 sound_t* assets_sound_get(const char* filename);
 
 /**
- * Save sequence of textures as an animated GIF.
+ * Get handle for given filename. Handles are stable for the lifetime of the
+ * engine, including across reloads, and are cheaper to look up than names.
+ *
+ * @param filename Name to search for.
+ * @return int Asset handle if found, -1 otherwise
+ */
+int assets_handle_get(const char* filename);
+
+/**
+ * Get texture for given handle.
+ *
+ * @param handle Asset handle.
+ * @param frame Index of frame.
+ * @return texture_t* texture if found, NULL otherwise
+ */
+texture_t* assets_texture_handle_get(int handle, int frame);
+
+/**
+ * Get sound for given handle.
+ *
+ * @param handle Asset handle.
+ * @return sound_t* sound if found, NULL otherwise
+ */
+sound_t* assets_sound_handle_get(int handle);
+
+/**
+ * Open source for streaming given sound. WAV files are decoded from the asset
+ * directory or zip file as they play, pack sounds are read in place. Zip
+ * entries can only be inflated whole, so they are held in memory while open.
+ *
+ * @param filename Name of sound to stream.
+ * @param source Source to initialize.
+ * @return true if successful, false otherwise
+ */
+bool assets_stream_source_open(const char* filename, stream_source_t* source);
+
+/**
+ * Start loading asset for given handle in the background. Only has an effect
+ * when assets are loaded lazily and the asset is not resident.
+ *
+ * @param handle Asset handle.
+ */
+void assets_prefetch(int handle);
+
+/**
+ * Keep lazily loaded asset resident until unpinned, regardless of memory
+ * budget. Pins nest.
+ *
+ * @param handle Asset handle.
+ */
+void assets_pin(int handle);
+
+/**
+ * Release a pin added by assets_pin().
+ *
+ * @param handle Asset handle.
+ */
+void assets_unpin(int handle);
+
+/**
+ * Get directory assets were loaded from.
+ *
+ * @return const char* Asset directory. NULL if assets were loaded from a zip or pack file.
+ */
+const char* assets_source_directory_get(void);
+
+/**
+ * Reload asset from given file. Textures and sounds with unchanged dimensions
+ * are updated in place, so existing references stay valid. Other assets are
+ * replaced and previous versions are kept alive until the next full reload.
+ *
+ * @param filename Path of changed file, including asset directory.
+ * @return bool True if asset was reloaded, false otherwise.
+ */
+bool assets_file_reload(const char* filename);
+
+/**
+ * Save sequence of textures as an animated GIF. All frames must be the same
+ * size. Nothing is left on disk if saving fails.
  *
  * @param filename Name of file to save.
  * @param frame_count Frame count.
  * @param frames Array of frames.
+ * @return bool True if saved, false otherwise.
+ */
+bool assets_gif_save(const char* filename, int frame_count, texture_t** frames);
+
+/**
+ * Save all assets as a precompiled asset pack. Scripts are stored as Lua
+ * bytecode.
+ *
+ * @param filename Name of file to save.
+ * @return bool True if successful, false otherwise.
  */
-void assets_gif_save(const char* filename, int frame_count, texture_t** frames);
+bool assets_pack_save(const char* filename);
 
 extern char* assets_directory;
 
@@ -0,0 +1,191 @@
+#include <math.h>
+#include <stddef.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "batch.h"
+
+#ifdef __SSE__
+/**
+ * Multiply point with w of 1 by matrix columns.
+ */
+static __m128 point_transform(const float* point, __m128 c0, __m128 c1, __m128 c2, __m128 c3) {
+    __m128 xy = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(point[0])), _mm_mul_ps(c1, _mm_set1_ps(point[1])));
+    __m128 zw = _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(point[2])), c3);
+
+    return _mm_add_ps(xy, zw);
+}
+
+/**
+ * Store x, y and z of given point, and w if stride has room for it. Next
+ * point may not have been read yet, so nothing past stride is written.
+ */
+static void point_store(float* out, __m128 point, size_t stride) {
+    if (stride >= 4) {
+        _mm_storeu_ps(out, point);
+    }
+    else {
+        _mm_storel_pi((__m64*)out, point);
+        _mm_store_ss(out + 2, _mm_movehl_ps(point, point));
+    }
+}
+#endif
+
+void batch_points_transform(float* out, const float* in, size_t count, size_t stride, const float* matrix) {
+#ifdef __SSE__
+    __m128 c0 = _mm_loadu_ps(matrix);
+    __m128 c1 = _mm_loadu_ps(matrix + 4);
+    __m128 c2 = _mm_loadu_ps(matrix + 8);
+    __m128 c3 = _mm_loadu_ps(matrix + 12);
+
+    for (size_t i = 0; i < count; i++) {
+        point_store(out + i * stride, point_transform(in + i * stride, c0, c1, c2, c3), stride);
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        const float* p = in + i * stride;
+        float x = p[0];
+        float y = p[1];
+        float z = p[2];
+        float* r = out + i * stride;
+
+        r[0] = matrix[0] * x + matrix[4] * y + matrix[8] * z + matrix[12];
+        r[1] = matrix[1] * x + matrix[5] * y + matrix[9] * z + matrix[13];
+        r[2] = matrix[2] * x + matrix[6] * y + matrix[10] * z + matrix[14];
+
+        if (stride >= 4) {
+            r[3] = matrix[3] * x + matrix[7] * y + matrix[11] * z + matrix[15];
+        }
+    }
+#endif
+}
+
+void batch_points_project(float* out, const float* in, size_t count, size_t stride, const float* matrix, const float* viewport) {
+    float half_width = viewport[2] * 0.5f;
+    float half_height = viewport[3] * 0.5f;
+
+#ifdef __SSE__
+    __m128 c0 = _mm_loadu_ps(matrix);
+    __m128 c1 = _mm_loadu_ps(matrix + 4);
+    __m128 c2 = _mm_loadu_ps(matrix + 8);
+    __m128 c3 = _mm_loadu_ps(matrix + 12);
+
+    // Screen y grows down, so y is flipped. Last lane carries w through.
+    __m128 scale = _mm_setr_ps(half_width, -half_height, 1.0f, 0.0f);
+    __m128 offset = _mm_setr_ps(viewport[0] + half_width, viewport[1] + half_height, 0.0f, 0.0f);
+    __m128 w_lane = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+
+    for (size_t i = 0; i < count; i++) {
+        __m128 clip = point_transform(in + i * stride, c0, c1, c2, c3);
+        __m128 w = _mm_shuffle_ps(clip, clip, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128 ndc = _mm_div_ps(clip, w);
+        __m128 screen = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ndc, scale), offset), _mm_mul_ps(w, w_lane));
+
+        point_store(out + i * stride, screen, stride);
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        const float* p = in + i * stride;
+        float x = p[0];
+        float y = p[1];
+        float z = p[2];
+        float* r = out + i * stride;
+
+        float w = matrix[3] * x + matrix[7] * y + matrix[11] * z + matrix[15];
+        float nx = (matrix[0] * x + matrix[4] * y + matrix[8] * z + matrix[12]) / w;
+        float ny = (matrix[1] * x + matrix[5] * y + matrix[9] * z + matrix[13]) / w;
+        float nz = (matrix[2] * x + matrix[6] * y + matrix[10] * z + matrix[14]) / w;
+
+        r[0] = viewport[0] + half_width + nx * half_width;
+        r[1] = viewport[1] + half_height - ny * half_height;
+        r[2] = nz;
+
+        if (stride >= 4) {
+            r[3] = w;
+        }
+    }
+#endif
+}
+
+void batch_vectors_normalize(float* out, const float* in, size_t count, size_t stride) {
+    for (size_t i = 0; i < count; i++) {
+        const float* v = in + i * stride;
+        float* r = out + i * stride;
+
+        float length_squared = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+        float scale = length_squared > 0.0f ? 1.0f / sqrtf(length_squared) : 0.0f;
+
+        r[0] = v[0] * scale;
+        r[1] = v[1] * scale;
+        r[2] = v[2] * scale;
+    }
+}
+
+void batch_vectors_dot(float* out, const float* a, const float* b, size_t count, size_t stride) {
+    for (size_t i = 0; i < count; i++) {
+        const float* v0 = a + i * stride;
+        const float* v1 = b + i * stride;
+
+        out[i] = v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2];
+    }
+}
+
+void batch_vectors_cross(float* out, const float* a, const float* b, size_t count, size_t stride) {
+    for (size_t i = 0; i < count; i++) {
+        const float* v0 = a + i * stride;
+        const float* v1 = b + i * stride;
+        float* r = out + i * stride;
+
+        float x = v0[1] * v1[2] - v0[2] * v1[1];
+        float y = v0[2] * v1[0] - v0[0] * v1[2];
+        float z = v0[0] * v1[1] - v0[1] * v1[0];
+
+        r[0] = x;
+        r[1] = y;
+        r[2] = z;
+    }
+}
+
+void batch_quaternions_slerp(float* out, const float* a, const float* b, const float* t, size_t t_stride, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const float* q0 = a + i * 4;
+        const float* q1 = b + i * 4;
+        float* r = out + i * 4;
+        float f = t[i * t_stride];
+
+        // Take the shorter way around
+        float d = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+        float sign = 1.0f;
+
+        if (d < 0.0f) {
+            d = -d;
+            sign = -1.0f;
+        }
+
+        float f0 = 1.0f - f;
+        float f1 = f;
+
+        // Nearly parallel quaternions fall back to linear interpolation
+        if (d <= 0.9995f) {
+            float theta = acosf(d);
+            float sin_theta = sinf(theta);
+
+            f0 = sinf((1.0f - f) * theta) / sin_theta;
+            f1 = sinf(f * theta) / sin_theta;
+        }
+
+        f1 *= sign;
+
+        float x = q0[0] * f0 + q1[0] * f1;
+        float y = q0[1] * f0 + q1[1] * f1;
+        float z = q0[2] * f0 + q1[2] * f1;
+        float w = q0[3] * f0 + q1[3] * f1;
+
+        r[0] = x;
+        r[1] = y;
+        r[2] = z;
+        r[3] = w;
+    }
+}
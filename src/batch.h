@@ -0,0 +1,89 @@
+/**
+ * @file batch.h
+ * Batch math module. Applies vector, matrix and quaternion operations to
+ * whole buffers of packed floats at once, so scripts can transform thousands
+ * of points without a Lua call per point. Uses SSE where available.
+ *
+ * Points and vectors are stored interleaved, stride floats apart, with
+ * components x, y, z first. Components a kernel does not produce are left
+ * untouched. Matrices are column-major, as in mathc. Output may be the same
+ * buffer as input.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+
+/**
+ * Transform points by matrix. Points are taken to have w of 1. If stride is
+ * at least 4 the resulting w is stored as fourth component.
+ *
+ * @param out Buffer for transformed points.
+ * @param in Points to transform.
+ * @param count Number of points.
+ * @param stride Floats between points. At least 3.
+ * @param matrix 4x4 matrix.
+ */
+void batch_points_transform(float* out, const float* in, size_t count, size_t stride, const float* matrix);
+
+/**
+ * Transform points by matrix, divide by w and map to viewport. Stores screen
+ * x and y and depth, plus w as fourth component if stride is at least 4.
+ * Points with w of 0 or less are behind the camera and should be skipped.
+ *
+ * @param out Buffer for projected points.
+ * @param in Points to project.
+ * @param count Number of points.
+ * @param stride Floats between points. At least 3.
+ * @param matrix 4x4 view projection matrix.
+ * @param viewport Viewport x, y, width and height.
+ */
+void batch_points_project(float* out, const float* in, size_t count, size_t stride, const float* matrix, const float* viewport);
+
+/**
+ * Normalize 3D vectors. Zero length vectors are left at zero.
+ *
+ * @param out Buffer for normalized vectors.
+ * @param in Vectors to normalize.
+ * @param count Number of vectors.
+ * @param stride Floats between vectors. At least 3.
+ */
+void batch_vectors_normalize(float* out, const float* in, size_t count, size_t stride);
+
+/**
+ * Dot products of 3D vector pairs. Results are stored packed.
+ *
+ * @param out Buffer for count dot products.
+ * @param a First vectors.
+ * @param b Second vectors.
+ * @param count Number of vector pairs.
+ * @param stride Floats between vectors. At least 3.
+ */
+void batch_vectors_dot(float* out, const float* a, const float* b, size_t count, size_t stride);
+
+/**
+ * Cross products of 3D vector pairs.
+ *
+ * @param out Buffer for cross products.
+ * @param a First vectors.
+ * @param b Second vectors.
+ * @param count Number of vector pairs.
+ * @param stride Floats between vectors. At least 3.
+ */
+void batch_vectors_cross(float* out, const float* a, const float* b, size_t count, size_t stride);
+
+/**
+ * Spherical interpolation of quaternion pairs. Quaternions are packed with
+ * x, y, z and w.
+ *
+ * @param out Buffer for interpolated quaternions.
+ * @param a Start quaternions.
+ * @param b End quaternions.
+ * @param t Interpolation values.
+ * @param t_stride Floats between interpolation values. 0 uses t[0] for all.
+ * @param count Number of quaternion pairs.
+ */
+void batch_quaternions_slerp(float* out, const float* a, const float* b, const float* t, size_t t_stride, size_t count);
+
+#endif
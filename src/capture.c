@@ -0,0 +1,372 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
+#ifndef _WIN32
+#include <signal.h>
+#else
+#define popen _popen
+#define pclose _pclose
+#endif
+
+#include "arguments.h"
+#include "capture.h"
+#include "graphics.h"
+#include "log.h"
+
+typedef struct {
+    color_t* pixels;
+    uint32_t palette[256];
+    bool is_full;
+} capture_frame_t;
+
+static FILE* output = NULL;
+static bool is_pipe = false;
+static bool is_capturing = false;
+static bool failed = false;
+
+static capture_format_t format;
+static int width;
+static int height;
+
+/** Frames are filled and written alternately. */
+static capture_frame_t frames[2];
+static int write_index = 0;
+
+/** Expanded pixels of frame being written. */
+static uint8_t* buffer = NULL;
+
+/** Last palette written in indexed format. */
+static uint32_t written_palette[256];
+static bool has_written_palette = false;
+
+static int frame_count = 0;
+static int dropped_count = 0;
+
+#ifndef __EMSCRIPTEN__
+static pthread_t writer_thread;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t frame_available = PTHREAD_COND_INITIALIZER;
+static bool is_stopping = false;
+#endif
+
+/**
+ * Write bytes to output, recording any failure.
+ */
+static void output_write(const void* data, size_t size) {
+    if (failed) return;
+
+    if (fwrite(data, 1, size, output) != size) {
+        log_error("Failed to write capture");
+        failed = true;
+    }
+}
+
+/**
+ * Convert frame to output format and write it.
+ */
+static void frame_write(capture_frame_t* frame) {
+    int pixel_count = width * height;
+
+    if (format == CAPTURE_FORMAT_RAW) {
+        for (int i = 0; i < pixel_count; i++) {
+            uint32_t rgba = frame->palette[frame->pixels[i]];
+            buffer[i * 4 + 0] = rgba & 0xff;
+            buffer[i * 4 + 1] = (rgba >> 8) & 0xff;
+            buffer[i * 4 + 2] = (rgba >> 16) & 0xff;
+            buffer[i * 4 + 3] = 0xff;
+        }
+
+        output_write(buffer, pixel_count * 4);
+    }
+    else if (format == CAPTURE_FORMAT_Y4M) {
+        // Convert palette once instead of every pixel. BT.601 studio range.
+        uint8_t y[256], u[256], v[256];
+
+        for (int i = 0; i < 256; i++) {
+            int r = frame->palette[i] & 0xff;
+            int g = (frame->palette[i] >> 8) & 0xff;
+            int b = (frame->palette[i] >> 16) & 0xff;
+
+            y[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+            u[i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+            v[i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+        }
+
+        uint8_t* y_plane = buffer;
+        uint8_t* u_plane = buffer + pixel_count;
+        uint8_t* v_plane = buffer + pixel_count * 2;
+
+        for (int i = 0; i < pixel_count; i++) {
+            color_t color = frame->pixels[i];
+            y_plane[i] = y[color];
+            u_plane[i] = u[color];
+            v_plane[i] = v[color];
+        }
+
+        output_write("FRAME\n", 6);
+        output_write(buffer, pixel_count * 3);
+    }
+    else {
+        if (!has_written_palette || memcmp(written_palette, frame->palette, sizeof(written_palette)) != 0) {
+            uint8_t record = CAPTURE_RECORD_PALETTE;
+            output_write(&record, 1);
+            output_write(frame->palette, sizeof(frame->palette));
+
+            memcpy(written_palette, frame->palette, sizeof(written_palette));
+            has_written_palette = true;
+        }
+
+        uint8_t record = CAPTURE_RECORD_FRAME;
+        output_write(&record, 1);
+        output_write(frame->pixels, sizeof(color_t) * pixel_count);
+    }
+}
+
+#ifndef __EMSCRIPTEN__
+/**
+ * Write filled frames until capture is stopped and all frames are written.
+ */
+static void* writer_thread_run(void* arg) {
+    int read_index = 0;
+
+    pthread_mutex_lock(&mutex);
+
+    while (true) {
+        while (!frames[read_index].is_full && !is_stopping) {
+            pthread_cond_wait(&frame_available, &mutex);
+        }
+
+        if (!frames[read_index].is_full) break;
+
+        // Frame is not touched by the main thread until it is marked empty
+        pthread_mutex_unlock(&mutex);
+        frame_write(&frames[read_index]);
+        pthread_mutex_lock(&mutex);
+
+        frames[read_index].is_full = false;
+        read_index = 1 - read_index;
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    return NULL;
+}
+#endif
+
+/**
+ * Get value following given command line argument.
+ *
+ * @return const char* Value if found, NULL otherwise.
+ */
+static const char* argument_value_get(const char* arg) {
+    int index = arguments_check(arg);
+    if (!index || index + 1 >= arguments_count()) return NULL;
+
+    return arguments_vector()[index + 1];
+}
+
+void capture_init(void) {
+    const char* target = argument_value_get("--capture");
+    if (!target) return;
+
+    const char* format_name = argument_value_get("--capture-format");
+    const char* fps = argument_value_get("--capture-fps");
+
+    capture_format_t format = CAPTURE_FORMAT_RAW;
+    const char* dot = strrchr(target, '.');
+
+    if (format_name) {
+        if (strcmp(format_name, "y4m") == 0) {
+            format = CAPTURE_FORMAT_Y4M;
+        }
+        else if (strcmp(format_name, "indexed") == 0) {
+            format = CAPTURE_FORMAT_INDEXED;
+        }
+        else if (strcmp(format_name, "raw") != 0) {
+            log_error("Unknown capture format: %s", format_name);
+            return;
+        }
+    }
+    else if (target[0] != '|' && dot && strcmp(dot, ".y4m") == 0) {
+        format = CAPTURE_FORMAT_Y4M;
+    }
+    else if (target[0] != '|' && dot && strcmp(dot, ".bcap") == 0) {
+        format = CAPTURE_FORMAT_INDEXED;
+    }
+
+    capture_start(target, format, fps ? atoi(fps) : 60);
+}
+
+void capture_destroy(void) {
+    capture_stop();
+}
+
+/**
+ * Free frame and conversion buffers.
+ */
+static void buffers_free(void) {
+    for (int i = 0; i < 2; i++) {
+        free(frames[i].pixels);
+        frames[i].pixels = NULL;
+        frames[i].is_full = false;
+    }
+
+    free(buffer);
+    buffer = NULL;
+}
+
+bool capture_start(const char* target, capture_format_t format_, int fps) {
+    if (is_capturing) return false;
+
+    texture_t* render_texture = graphics_render_texture_get();
+    width = render_texture->width;
+    height = render_texture->height;
+    format = format_;
+
+    size_t pixel_count = width * height;
+
+    for (int i = 0; i < 2; i++) {
+        frames[i].pixels = (color_t*)malloc(sizeof(color_t) * pixel_count);
+        frames[i].is_full = false;
+    }
+
+    buffer = (uint8_t*)malloc(pixel_count * 4);
+
+    if (!frames[0].pixels || !frames[1].pixels || !buffer) {
+        log_error("Failed to allocate capture buffers");
+        buffers_free();
+        return false;
+    }
+
+    is_pipe = target[0] == '|';
+
+    if (is_pipe) {
+#ifndef _WIN32
+        // Report a closed pipe as a write error instead of terminating
+        signal(SIGPIPE, SIG_IGN);
+#endif
+        output = popen(target + 1, "w");
+    }
+    else {
+        output = fopen(target, "wb");
+    }
+
+    if (!output) {
+        log_error("Failed to open capture: %s", target);
+        buffers_free();
+        return false;
+    }
+
+    failed = false;
+    has_written_palette = false;
+    frame_count = 0;
+    dropped_count = 0;
+    write_index = 0;
+
+    if (format == CAPTURE_FORMAT_Y4M) {
+        fprintf(output, "YUV4MPEG2 W%i H%i F%i:1 Ip A1:1 C444\n", width, height, fps);
+    }
+    else if (format == CAPTURE_FORMAT_INDEXED) {
+        uint32_t header[4] = {CAPTURE_VERSION, width, height, fps};
+        output_write(CAPTURE_MAGIC, 8);
+        output_write(header, sizeof(header));
+    }
+
+#ifndef __EMSCRIPTEN__
+    is_stopping = false;
+
+    if (pthread_create(&writer_thread, NULL, writer_thread_run, NULL) != 0) {
+        log_error("Failed to create capture thread");
+        is_pipe ? pclose(output) : fclose(output);
+        output = NULL;
+        buffers_free();
+        return false;
+    }
+#endif
+
+    is_capturing = true;
+
+    log_info("capturing %ix%i: %s", width, height, target);
+
+    return true;
+}
+
+void capture_stop(void) {
+    if (!is_capturing) return;
+
+    is_capturing = false;
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&mutex);
+    is_stopping = true;
+    pthread_cond_signal(&frame_available);
+    pthread_mutex_unlock(&mutex);
+
+    pthread_join(writer_thread, NULL);
+#endif
+
+    int result = is_pipe ? pclose(output) : fclose(output);
+    if (result != 0 && !failed) {
+        log_error("Failed to finish capture");
+    }
+
+    output = NULL;
+    buffers_free();
+
+    log_info("captured %i frames", frame_count);
+
+    if (dropped_count > 0) {
+        log_error("Capture dropped %i frames", dropped_count);
+    }
+}
+
+void capture_update(void) {
+    if (!is_capturing) return;
+
+    texture_t* render_texture = graphics_render_texture_get();
+
+    if (render_texture->width != width || render_texture->height != height) {
+        log_error("Resolution changed, stopping capture");
+        capture_stop();
+        return;
+    }
+
+    capture_frame_t* frame = &frames[write_index];
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&mutex);
+    bool is_full = frame->is_full;
+    pthread_mutex_unlock(&mutex);
+
+    // Writer is still busy with both frames, don't wait for it
+    if (is_full) {
+        dropped_count++;
+        return;
+    }
+#endif
+
+    memcpy(frame->pixels, render_texture->pixels, sizeof(color_t) * width * height);
+    memcpy(frame->palette, graphics_palette_get(), sizeof(frame->palette));
+    frame_count++;
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&mutex);
+    frame->is_full = true;
+    write_index = 1 - write_index;
+    pthread_cond_signal(&frame_available);
+    pthread_mutex_unlock(&mutex);
+#else
+    frame_write(frame);
+#endif
+}
@@ -0,0 +1,74 @@
+/**
+ * @file capture.h
+ * Capture module. Writes every presented frame to a file or pipe for
+ * offline encoding. Frames are copied at present time and written by a
+ * background thread, so capturing never waits on the disk or encoder.
+ *
+ * Capture is started from the command line:
+ *
+ *     --capture <file or |command> [--capture-format raw|y4m|indexed] [--capture-fps <fps>]
+ *
+ * Formats:
+ * - raw: RGBA bytes per frame without header.
+ * - y4m: YUV4MPEG2 stream with 4:4:4 chroma.
+ * - indexed: "BRASSCAP" header followed by palette and frame records.
+ *   Palette records are only written when the palette changes.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdbool.h>
+
+#define CAPTURE_MAGIC "BRASSCAP"
+#define CAPTURE_VERSION 1
+
+typedef enum {
+    CAPTURE_FORMAT_RAW,
+    CAPTURE_FORMAT_Y4M,
+    CAPTURE_FORMAT_INDEXED
+} capture_format_t;
+
+/**
+ * Indexed format record types. Palette records hold 256 RGBA colors, frame
+ * records hold one palette index per pixel.
+ */
+typedef enum {
+    CAPTURE_RECORD_PALETTE = 'P',
+    CAPTURE_RECORD_FRAME = 'F'
+} capture_record_t;
+
+/**
+ * Initialize capture system. Starts capturing if requested on the command
+ * line.
+ */
+void capture_init(void);
+
+/**
+ * Destroy capture system. Any capture in progress is finished.
+ */
+void capture_destroy(void);
+
+/**
+ * Capture current render texture if capturing. Should be called once per
+ * frame after drawing.
+ */
+void capture_update(void);
+
+/**
+ * Start capturing.
+ *
+ * @param target File to write to. If it starts with '|' the rest is run as
+ * a command and frames are piped to its standard input.
+ * @param format Format to write.
+ * @param fps Frame rate stored in formats that have one.
+ * @return bool True if capture started, false otherwise.
+ */
+bool capture_start(const char* target, capture_format_t format, int fps);
+
+/**
+ * Stop capturing. Waits for frames in flight to be written.
+ */
+void capture_stop(void);
+
+#endif
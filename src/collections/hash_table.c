@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table.h"
+#include "../log.h"
+
+/** Table grows once more than this fraction of slots are used. */
+#define MAX_LOAD 0.7
+
+hash_table_t* hash_table_new(size_t capacity) {
+    hash_table_t* table = (hash_table_t*)malloc(sizeof(hash_table_t));
+
+    if (!table) {
+        log_error("Failed to create hash table");
+        return NULL;
+    }
+
+    size_t size = 8;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    table->capacity = size;
+    table->count = 0;
+    table->entries = (hash_table_entry_t*)calloc(size, sizeof(hash_table_entry_t));
+
+    if (!table->entries) {
+        log_error("Failed to create hash table entries");
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+void hash_table_free(hash_table_t* table) {
+    for (size_t i = 0; i < table->capacity; i++) {
+        free((char*)table->entries[i].key);
+    }
+
+    free(table->entries);
+    table->entries = NULL;
+    free(table);
+    table = NULL;
+}
+
+uint32_t hash_table_hash(const char* key) {
+    uint32_t hash = 2166136261u;
+
+    for (const unsigned char* c = (const unsigned char*)key; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * Find slot for given key using linear probing.
+ *
+ * @param entries Slots to search.
+ * @param capacity Number of slots. Must be a power of two.
+ * @param key Key to look for.
+ * @param hash Hash of key.
+ * @return hash_table_entry_t* Slot holding key, or empty slot where it belongs.
+ */
+static hash_table_entry_t* find_entry(hash_table_entry_t* entries, size_t capacity, const char* key, uint32_t hash) {
+    const size_t mask = capacity - 1;
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        hash_table_entry_t* entry = &entries[i];
+
+        if (!entry->key) return entry;
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) return entry;
+    }
+}
+
+/**
+ * Double table capacity and reinsert all entries.
+ *
+ * @param table Hash table to grow.
+ * @return bool True if successful.
+ */
+static bool grow(hash_table_t* table) {
+    size_t capacity = table->capacity * 2;
+    hash_table_entry_t* entries = (hash_table_entry_t*)calloc(capacity, sizeof(hash_table_entry_t));
+
+    if (!entries) {
+        log_error("Failed to grow hash table");
+        return false;
+    }
+
+    for (size_t i = 0; i < table->capacity; i++) {
+        hash_table_entry_t* entry = &table->entries[i];
+        if (!entry->key) continue;
+
+        *find_entry(entries, capacity, entry->key, entry->hash) = *entry;
+    }
+
+    free(table->entries);
+    table->entries = entries;
+    table->capacity = capacity;
+
+    return true;
+}
+
+bool hash_table_get(hash_table_t* table, const char* key, int* value) {
+    hash_table_entry_t* entry = find_entry(table->entries, table->capacity, key, hash_table_hash(key));
+
+    if (!entry->key) return false;
+
+    *value = entry->value;
+
+    return true;
+}
+
+const char* hash_table_set(hash_table_t* table, const char* key, int value) {
+    const uint32_t hash = hash_table_hash(key);
+    hash_table_entry_t* entry = find_entry(table->entries, table->capacity, key, hash);
+
+    if (entry->key) {
+        entry->value = value;
+        return entry->key;
+    }
+
+    if (table->count + 1 > table->capacity * MAX_LOAD) {
+        if (!grow(table)) return NULL;
+
+        entry = find_entry(table->entries, table->capacity, key, hash);
+    }
+
+    size_t n = strlen(key);
+    char* copy = (char*)malloc(n + 1);
+
+    if (!copy) {
+        log_error("Failed to add key to hash table");
+        return NULL;
+    }
+
+    memcpy(copy, key, n + 1);
+
+    entry->key = copy;
+    entry->hash = hash;
+    entry->value = value;
+    table->count++;
+
+    return copy;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file hash_table.h
+ * String keyed open addressing hash table implementation. Keys are copied
+ * into the table and stay valid until the table is freed, so they can be
+ * used as interned strings.
+ */
+
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const char* key;
+    uint32_t hash;
+    int value;
+} hash_table_entry_t;
+
+typedef struct {
+    size_t capacity;
+    size_t count;
+    hash_table_entry_t* entries;
+} hash_table_t;
+
+/**
+ * Creates an empty hash table.
+ *
+ * @param capacity Initial number of slots. Rounded up to a power of two.
+ * @return hash_table_t*
+ */
+hash_table_t* hash_table_new(size_t capacity);
+
+/**
+ * Frees a hash table and all of its keys.
+ *
+ * @param table Hash table to free.
+ */
+void hash_table_free(hash_table_t* table);
+
+/**
+ * Get value for given key.
+ *
+ * @param table Hash table to search.
+ * @param key Key to look for.
+ * @param value Out value. Unchanged if key is not found.
+ * @return bool True if key was found.
+ */
+bool hash_table_get(hash_table_t* table, const char* key, int* value);
+
+/**
+ * Set value for given key. Adds key if not already present.
+ *
+ * @param table Hash table to modify.
+ * @param key Key to set.
+ * @param value New value.
+ * @return const char* Table's copy of key. NULL on failure.
+ */
+const char* hash_table_set(hash_table_t* table, const char* key, int value);
+
+/**
+ * Hash given string.
+ *
+ * @param key String to hash.
+ * @return uint32_t FNV-1a hash of string.
+ */
+uint32_t hash_table_hash(const char* key);
+
+#endif
@@ -15,6 +15,12 @@ static void defaults_set(struct config* config) {
     config->resolution.width = 320;
     config->resolution.height = 200;
     config->display.aspect = 1.0f;
+    config->scaling.enabled = true;
+    config->scaling.budget = 16.0f;
+    config->scaling.minimum = 0.5f;
+    config->scaling.step = 0.125f;
+    config->assets.lazy = false;
+    config->assets.budget = 64;
     config->console.colors.foreground = 1;
     config->console.colors.background = 0;
     config->console.colors.transparent = -1;
@@ -25,6 +31,12 @@ static void defaults_set(struct config* config) {
     strncpy(prompt, default_prompt, 3);
 
     config->console.prompt = prompt;
+
+    char* default_cache = ".brasscache";
+    char* cache = (char*)malloc(sizeof(char) * (strlen(default_cache) + 1));
+    strcpy(cache, default_cache);
+
+    config->scripts.cache = cache;
 }
 
 static bool check_extension(const char* filename, const char* ext) {
@@ -59,6 +71,61 @@ static void set(cJSON* json) {
         }
     }
 
+    cJSON* scaling = cJSON_GetObjectItemCaseSensitive(json, "scaling");
+    if (scaling) {
+        cJSON* enabled = cJSON_GetObjectItemCaseSensitive(scaling, "enabled");
+        cJSON* budget = cJSON_GetObjectItemCaseSensitive(scaling, "budget");
+        cJSON* minimum = cJSON_GetObjectItemCaseSensitive(scaling, "minimum");
+        cJSON* step = cJSON_GetObjectItemCaseSensitive(scaling, "step");
+
+        if (cJSON_IsBool(enabled)) {
+            config->scaling.enabled = cJSON_IsTrue(enabled);
+        }
+
+        if (cJSON_IsNumber(budget) && budget->valuedouble > 0) {
+            config->scaling.budget = budget->valuedouble;
+        }
+
+        if (cJSON_IsNumber(minimum) && minimum->valuedouble > 0 && minimum->valuedouble <= 1) {
+            config->scaling.minimum = minimum->valuedouble;
+        }
+
+        if (cJSON_IsNumber(step) && step->valuedouble > 0) {
+            config->scaling.step = step->valuedouble;
+        }
+    }
+
+    cJSON* assets = cJSON_GetObjectItemCaseSensitive(json, "assets");
+    if (assets) {
+        cJSON* lazy = cJSON_GetObjectItemCaseSensitive(assets, "lazy");
+        cJSON* budget = cJSON_GetObjectItemCaseSensitive(assets, "budget");
+
+        if (cJSON_IsBool(lazy)) {
+            config->assets.lazy = cJSON_IsTrue(lazy);
+        }
+
+        if (cJSON_IsNumber(budget) && budget->valueint > 0) {
+            config->assets.budget = budget->valueint;
+        }
+    }
+
+    cJSON* scripts = cJSON_GetObjectItemCaseSensitive(json, "scripts");
+    if (scripts) {
+        cJSON* cache = cJSON_GetObjectItemCaseSensitive(scripts, "cache");
+
+        if (cJSON_IsString(cache) || cJSON_IsFalse(cache)) {
+            free(config->scripts.cache);
+            config->scripts.cache = NULL;
+        }
+
+        if (cJSON_IsString(cache)) {
+            char* s = cache->valuestring;
+            char* directory = (char*)malloc(sizeof(char) * (strlen(s) + 1));
+            strcpy(directory, s);
+            config->scripts.cache = directory;
+        }
+    }
+
     cJSON* console = cJSON_GetObjectItemCaseSensitive(json, "console");
     if (console) {
         cJSON* colors = cJSON_GetObjectItemCaseSensitive(console, "colors");
@@ -172,5 +239,6 @@ void configuration_init(void) {
 
 void configuration_destroy(void) {
     free(config->console.prompt);
+    free(config->scripts.cache);
     free(config);
 }
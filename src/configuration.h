@@ -6,6 +6,8 @@
 #ifndef CONFIGURATION_H
 #define CONFIGURATION_H
 
+#include <stdbool.h>
+
 extern struct config {
     struct {
         int width;
@@ -16,6 +18,23 @@ extern struct config {
         float aspect;
     } display;
 
+    struct {
+        bool enabled;
+        float budget;
+        float minimum;
+        float step;
+    } scaling;
+
+    struct {
+        bool lazy;
+        int budget;
+    } assets;
+
+    struct {
+        /** Directory to cache compiled scripts in. NULL to disable. */
+        char* cache;
+    } scripts;
+
     struct {
         struct {
             int foreground;
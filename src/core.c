@@ -1,16 +1,23 @@
 #include <stdbool.h>
 
 #include "assets.h"
+#include "capture.h"
 #include "configuration.h"
 #include "console.h"
 #include "core.h"
 #include "event.h"
 #include "graphics.h"
 #include "input.h"
+#include "jobs.h"
 #include "log.h"
+#include "mixer.h"
 #include "platform.h"
+#include "recorder.h"
+#include "resolution.h"
 #include "script.h"
+#include "streams.h"
 #include "time.h"
+#include "watcher.h"
 
 static bool is_running = true;
 
@@ -23,26 +30,59 @@ void core_init(void) {
 
     configuration_init();
     time_init();
+    jobs_init();
     assets_init();
     platform_init();
+    streams_init();
     graphics_init();
+    resolution_init();
+    recorder_init();
+    capture_init();
+    assets_init_wait();
     input_init();
     script_init();
+    watcher_init();
 
     log_info(" ");
 }
 
 void core_destroy(void) {
+    watcher_destroy();
     input_destroy();
     script_destroy();
+    streams_destroy();
     assets_destroy();
+    recorder_destroy();
+    capture_destroy();
+    resolution_destroy();
     graphics_destroy();
     platform_destroy();
+    jobs_destroy();
     time_destroy();
     configuration_destroy();
     console_destroy();
 }
 
+int core_pack(const char* filename) {
+    console_init();
+
+    log_info("%s", ENGINE_COPYRIGHT);
+
+    configuration_init();
+    jobs_init();
+    assets_init();
+    assets_init_wait();
+
+    bool saved = assets_pack_save(filename);
+
+    assets_destroy();
+    jobs_destroy();
+    configuration_destroy();
+    console_destroy();
+
+    return saved ? 0 : 1;
+}
+
 void core_run(void) {
     while (is_running) {
         core_main_loop();
@@ -53,10 +93,16 @@ void core_main_loop(void) {
     platform_update();
     input_update();
     handle_events();
+    watcher_update();
+    mixer_update();
+    streams_update();
     script_update();
     console_update();
 
     script_draw();
+    resolution_update();
+    recorder_update();
+    capture_update();
     console_draw();
     platform_draw();
 
@@ -67,6 +113,7 @@ void core_reload(void) {
     time_reload();
     assets_reload();
     platform_reload();
+    resolution_reload();
     script_reload();
 
     log_info(" ");
@@ -95,6 +142,11 @@ static void handle_events() {
                 console_buffer_toggle();
                 return;
             }
+
+            if (event.key.code == KEYCODE_F8) {
+                recorder_toggle();
+                continue;
+            }
         }
 
         if (console_handle_event(&event)) return;
@@ -24,6 +24,14 @@ void core_init(void);
  */
 void core_destroy(void);
 
+/**
+ * Pack assets into a precompiled asset pack without starting the engine.
+ *
+ * @param filename Name of pack file to save.
+ * @return int Exit code. 0 if successful.
+ */
+int core_pack(const char* filename);
+
 /**
  * Run engine
  */
@@ -1,3 +1,7 @@
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -11,6 +15,7 @@
 
 #include "assets.h"
 #include "arguments.h"
+#include "collections/hash_table.h"
 #include "files.h"
 #include "log.h"
 
@@ -49,52 +54,278 @@ const char* files_read(const char* filename) {
     return data;
 }
 
-static FILE* open_zip_entry_as_file(const char* filename, const char* mode) {
+/** Zip archive kept open between file opens. */
+static struct zip_t* archive = NULL;
+
+/** Maps entry names to zip entry indices. */
+static hash_table_t* archive_entries = NULL;
+
+/**
+ * Open zip archive and index its entries, unless already open.
+ *
+ * @return true if archive is open, false otherwise.
+ */
+static bool archive_open(void) {
+    if (archive) return true;
+
+    const char* filename = arguments_last();
+    archive = zip_open(filename, 0, 'r');
+
+    if (!archive) {
+        log_error("Failed to open zip file: %s", filename);
+        return false;
+    }
+
+    int total_zip_entries = zip_entries_total(archive);
+    archive_entries = hash_table_new(total_zip_entries > 0 ? total_zip_entries * 2 : 16);
+
+    if (!archive_entries) {
+        log_error("Failed to create zip directory");
+        files_archive_close();
+        return false;
+    }
+
+    for (int i = 0; i < total_zip_entries; i++) {
+        zip_entry_openbyindex(archive, i);
+
+        if (!zip_entry_isdir(archive)) {
+            hash_table_set(archive_entries, zip_entry_name(archive), i);
+        }
+
+        zip_entry_close(archive);
+    }
+
+    return true;
+}
+
+void files_archive_close(void) {
+    if (archive) {
+        zip_close(archive);
+        archive = NULL;
+    }
+
+    if (archive_entries) {
+        hash_table_free(archive_entries);
+        archive_entries = NULL;
+    }
+}
+
+/**
+ * File stream over a buffer in memory. Writes grow the buffer but are never
+ * written back to the zip.
+ */
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+    size_t position;
+    bool append;
+} memory_stream_t;
+
+static size_t memory_stream_read(memory_stream_t* stream, char* buffer, size_t size) {
+    if (stream->position >= stream->size) return 0;
+
+    size_t available = stream->size - stream->position;
+    if (size > available) size = available;
+
+    memcpy(buffer, stream->data + stream->position, size);
+    stream->position += size;
+
+    return size;
+}
+
+static size_t memory_stream_write(memory_stream_t* stream, const char* buffer, size_t size) {
+    if (stream->append) {
+        stream->position = stream->size;
+    }
+
+    if (stream->position + size > stream->capacity) {
+        size_t capacity = stream->capacity ? stream->capacity * 2 : 256;
+        while (capacity < stream->position + size) capacity *= 2;
+
+        char* data = (char*)realloc(stream->data, capacity);
+        if (!data) return 0;
+
+        stream->data = data;
+        stream->capacity = capacity;
+    }
+
+    // Fill any gap left by seeking past the end
+    if (stream->position > stream->size) {
+        memset(stream->data + stream->size, 0, stream->position - stream->size);
+    }
+
+    memcpy(stream->data + stream->position, buffer, size);
+    stream->position += size;
+
+    if (stream->position > stream->size) {
+        stream->size = stream->position;
+    }
+
+    return size;
+}
+
+static bool memory_stream_seek(memory_stream_t* stream, long long* offset, int whence) {
+    long long base = 0;
+
+    switch (whence) {
+        case SEEK_SET: base = 0; break;
+        case SEEK_CUR: base = stream->position; break;
+        case SEEK_END: base = stream->size; break;
+        default: return false;
+    }
+
+    if (base + *offset < 0) return false;
+
+    stream->position = base + *offset;
+    *offset = stream->position;
+
+    return true;
+}
+
+static void memory_stream_free(memory_stream_t* stream) {
+    free(stream->data);
+    free(stream);
+}
+
+#if defined(__GLIBC__) || defined(__EMSCRIPTEN__)
+#ifdef __GLIBC__
+typedef off64_t cookie_offset_t;
+#else
+typedef off_t cookie_offset_t;
+#endif
+
+static ssize_t cookie_read(void* cookie, char* buffer, size_t size) {
+    return memory_stream_read((memory_stream_t*)cookie, buffer, size);
+}
+
+static ssize_t cookie_write(void* cookie, const char* buffer, size_t size) {
+    return memory_stream_write((memory_stream_t*)cookie, buffer, size);
+}
+
+static int cookie_seek(void* cookie, cookie_offset_t* offset, int whence) {
+    long long position = *offset;
+    if (!memory_stream_seek((memory_stream_t*)cookie, &position, whence)) return -1;
+
+    *offset = position;
+    return 0;
+}
+
+static int cookie_close(void* cookie) {
+    memory_stream_free((memory_stream_t*)cookie);
+    return 0;
+}
+
+static FILE* memory_stream_open(memory_stream_t* stream, const char* mode) {
+    cookie_io_functions_t functions = {cookie_read, cookie_write, cookie_seek, cookie_close};
+    return fopencookie(stream, mode, functions);
+}
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+static int cookie_read(void* cookie, char* buffer, int size) {
+    return memory_stream_read((memory_stream_t*)cookie, buffer, size);
+}
+
+static int cookie_write(void* cookie, const char* buffer, int size) {
+    return memory_stream_write((memory_stream_t*)cookie, buffer, size);
+}
+
+static fpos_t cookie_seek(void* cookie, fpos_t offset, int whence) {
+    long long position = offset;
+    if (!memory_stream_seek((memory_stream_t*)cookie, &position, whence)) return -1;
+
+    return position;
+}
+
+static int cookie_close(void* cookie) {
+    memory_stream_free((memory_stream_t*)cookie);
+    return 0;
+}
+
+static FILE* memory_stream_open(memory_stream_t* stream, const char* mode) {
+    return funopen(stream, cookie_read, cookie_write, cookie_seek, cookie_close);
+}
+#else
+/**
+ * No custom streams on this platform, so copy buffer to a temp file.
+ */
+static FILE* memory_stream_open(memory_stream_t* stream, const char* mode) {
     errno = 0;
 
-    // Get a temp file to write to
     FILE* temp_file = tmpfile();
     if (!temp_file) {
         log_error("Failed to open temp file: %s", strerror(errno));
         return NULL;
     }
 
-    struct zip_t* zip = zip_open(arguments_last(), 0, 'r');
-    int total_zip_entries = zip_entries_total(zip);
-    for (int i = 0; i < total_zip_entries; i++) {
-        zip_entry_openbyindex(zip, i);
+    fwrite(stream->data, 1, stream->size, temp_file);
+    if (stream->append) {
+        fseek(temp_file, 0, SEEK_END);
+    }
+    else {
+        rewind(temp_file);
+    }
 
-        // Early out on directories
-        if (zip_entry_isdir(zip)) {
-            zip_entry_close(zip);
-            continue;
-        }
+    memory_stream_free(stream);
 
-        // Find the zip entry
-        const char* name = zip_entry_name(zip);
-        if (strcmp(filename, name) != 0) {
-            zip_entry_close(zip);
-            continue;
-        }
+    return temp_file;
+}
+#endif
+
+/**
+ * Open zip entry as a stream over its decompressed data. Entries are found
+ * through the cached zip directory without scanning the archive.
+ *
+ * @param filename Name of entry to open
+ * @param mode File access mode
+ * @return FILE* File stream pointer if successful, NULL otherwise.
+ */
+static FILE* open_zip_entry_as_file(const char* filename, const char* mode) {
+    if (!archive_open()) return NULL;
 
-        // Read zip entry data
-        size_t buffer_size = zip_entry_size(zip);
-        uint8_t* buffer = calloc(buffer_size, sizeof(uint8_t));
-        zip_entry_noallocread(zip, (void*)buffer, buffer_size);
-        zip_entry_close(zip);
+    int index;
+    bool found = hash_table_get(archive_entries, filename, &index);
 
-        // Write data to temp file
-        fwrite(buffer, sizeof(uint8_t), buffer_size, temp_file);
-        rewind(temp_file);
+    if (!found && mode[0] == 'r') {
+        errno = ENOENT;
+        return NULL;
+    }
+
+    memory_stream_t* stream = (memory_stream_t*)calloc(1, sizeof(memory_stream_t));
+    if (!stream) {
+        log_error("Failed to allocate memory for file stream");
+        return NULL;
+    }
 
-        free(buffer);
+    stream->append = mode[0] == 'a';
 
-        break;
+    // Files written in write mode start out empty
+    if (found && mode[0] != 'w') {
+        if (zip_entry_openbyindex(archive, index) != 0) {
+            log_error("Failed to open zip entry: %s", filename);
+            free(stream);
+            return NULL;
+        }
+
+        stream->size = zip_entry_size(archive);
+        stream->capacity = stream->size;
+        stream->data = (char*)malloc(stream->capacity ? stream->capacity : 1);
+
+        if (!stream->data || zip_entry_noallocread(archive, stream->data, stream->size) < 0) {
+            log_error("Failed to read zip entry: %s", filename);
+            zip_entry_close(archive);
+            memory_stream_free(stream);
+            return NULL;
+        }
+
+        zip_entry_close(archive);
     }
 
-    zip_close(zip);
+    FILE* file = memory_stream_open(stream, mode);
+    if (!file) {
+        memory_stream_free(stream);
+    }
 
-    return temp_file;
+    return file;
 }
 
 FILE* files_open(const char* filename, const char* mode) {
@@ -159,3 +390,15 @@ void files_walk_directory(char* directory, void(callback)(const char*)) {
 
     closedir(dir);
 }
+
+bool files_directory_create(const char* directory) {
+#if defined(_WIN32)
+    mkdir(directory);
+#else
+    mkdir(directory, 0755);
+#endif
+
+    struct stat s;
+
+    return stat(directory, &s) == 0 && S_ISDIR(s.st_mode);
+}
@@ -19,6 +19,11 @@
  */
 FILE* files_open(const char* filename, const char* mode);
 
+/**
+ * Close zip file kept open by files_open. It is reopened on next use.
+ */
+void files_archive_close(void);
+
 /**
  * Opens and reads entire file as a string.
  *
@@ -44,4 +49,12 @@ bool files_check_extension(const char* filename, const char* ext);
  */
 void files_walk_directory(char* directory, void(callback)(const char*));
 
+/**
+ * Create directory if it doesn't already exist.
+ *
+ * @param directory Directory to create
+ * @return true if directory exists, false otherwise
+ */
+bool files_directory_create(const char* directory);
+
 #endif
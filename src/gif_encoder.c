@@ -0,0 +1,255 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <giflib/gif_lib.h>
+
+#include "graphics.h"
+#include "log.h"
+
+#include "gif_encoder.h"
+
+/**
+ * Record failure of a giflib call. Only the first failure is logged.
+ *
+ * @param encoder Encoder call was made for.
+ * @param result Result of call.
+ * @return bool True if call succeeded, false otherwise.
+ */
+static bool check(gif_encoder_t* encoder, int result) {
+    if (result != GIF_ERROR) return true;
+
+    if (!encoder->failed) {
+        log_error("Failed to save: %s - %i", encoder->filename, encoder->file->Error);
+    }
+
+    encoder->failed = true;
+
+    return false;
+}
+
+gif_encoder_t* gif_encoder_open(const char* filename, int width, int height) {
+    gif_encoder_t* encoder = (gif_encoder_t*)calloc(1, sizeof(gif_encoder_t));
+    if (!encoder) {
+        log_error("Failed to create gif encoder");
+        return NULL;
+    }
+
+    int error;
+    encoder->file = EGifOpenFileName(filename, false, &error);
+    encoder->filename = (char*)malloc(strlen(filename) + 1);
+    encoder->previous = (color_t*)malloc(sizeof(color_t) * width * height);
+
+    if (!encoder->file || !encoder->filename || !encoder->previous) {
+        log_error("Failed to open: %s", filename);
+
+        if (encoder->file) EGifCloseFile(encoder->file, &error);
+        free(encoder->filename);
+        free(encoder->previous);
+        free(encoder);
+        return NULL;
+    }
+
+    strcpy(encoder->filename, filename);
+    encoder->width = width;
+    encoder->height = height;
+
+    EGifSetGifVersion(encoder->file, true);
+
+    // Make palette
+    GifColorType colors[256];
+    uint32_t* palette = graphics_palette_get();
+
+    for (int i = 0; i < 256; i++) {
+        uint32_t rgba = palette[i];
+        colors[i].Red = rgba & 0xff;
+        colors[i].Green = (rgba >> 8) & 0xff;
+        colors[i].Blue = (rgba >> 16) & 0xff;
+    }
+
+    ColorMapObject* color_map = GifMakeMapObject(256, colors);
+    check(encoder, EGifPutScreenDesc(encoder->file, width, height, 8, 0, color_map));
+    GifFreeMapObject(color_map);
+
+    // Netscape loop
+    unsigned char params[] = {1, 0, 0};
+
+    check(encoder, EGifPutExtensionLeader(encoder->file, APPLICATION_EXT_FUNC_CODE));
+    check(encoder, EGifPutExtensionBlock(encoder->file, 11, "NETSCAPE2.0"));
+    check(encoder, EGifPutExtensionBlock(encoder->file, sizeof(params), params));
+    check(encoder, EGifPutExtensionTrailer(encoder->file));
+
+    return encoder;
+}
+
+/**
+ * Find region of frame that differs from previous frame.
+ *
+ * @param encoder Encoder holding previous frame.
+ * @param frame Frame to compare.
+ * @param rect Out changed region.
+ * @return bool True if any pixel changed, false otherwise.
+ */
+static bool changed_rect_get(gif_encoder_t* encoder, texture_t* frame, rect_t* rect) {
+    int width = encoder->width;
+    int height = encoder->height;
+
+    int top = 0;
+    while (top < height && memcmp(frame->pixels + top * width, encoder->previous + top * width, width) == 0) {
+        top++;
+    }
+
+    if (top == height) return false;
+
+    int bottom = height - 1;
+    while (bottom > top && memcmp(frame->pixels + bottom * width, encoder->previous + bottom * width, width) == 0) {
+        bottom--;
+    }
+
+    int left = width - 1;
+    int right = 0;
+
+    for (int y = top; y <= bottom; y++) {
+        const color_t* current = frame->pixels + y * width;
+        const color_t* previous = encoder->previous + y * width;
+
+        for (int x = 0; x < left; x++) {
+            if (current[x] != previous[x]) {
+                left = x;
+                break;
+            }
+        }
+
+        for (int x = width - 1; x > right; x--) {
+            if (current[x] != previous[x]) {
+                right = x;
+                break;
+            }
+        }
+    }
+
+    if (right < left) right = left;
+
+    rect->x = left;
+    rect->y = top;
+    rect->width = right - left + 1;
+    rect->height = bottom - top + 1;
+
+    return true;
+}
+
+/**
+ * Find a color not used by any changed pixel in given region, so it can
+ * stand in for unchanged pixels.
+ *
+ * @return int Unused color if found, NO_TRANSPARENT_COLOR otherwise.
+ */
+static int unused_color_get(gif_encoder_t* encoder, texture_t* frame, rect_t* rect) {
+    bool used[256];
+    memset(used, 0, sizeof(used));
+
+    for (int y = rect->y; y < rect->y + rect->height; y++) {
+        const color_t* current = frame->pixels + y * encoder->width;
+        const color_t* previous = encoder->previous + y * encoder->width;
+
+        for (int x = rect->x; x < rect->x + rect->width; x++) {
+            if (current[x] != previous[x]) {
+                used[current[x]] = true;
+            }
+        }
+    }
+
+    for (int i = 0; i < 256; i++) {
+        if (!used[i]) return i;
+    }
+
+    return NO_TRANSPARENT_COLOR;
+}
+
+bool gif_encoder_frame_add(gif_encoder_t* encoder, texture_t* frame, double delay) {
+    if (encoder->failed) return false;
+
+    if (frame->width != encoder->width || frame->height != encoder->height) {
+        log_error("Frame size does not match gif: %s", encoder->filename);
+        encoder->failed = true;
+        return false;
+    }
+
+    rect_t rect = {0, 0, encoder->width, encoder->height};
+    int transparent_color = NO_TRANSPARENT_COLOR;
+
+    if (encoder->frame_count > 0) {
+        if (changed_rect_get(encoder, frame, &rect)) {
+            transparent_color = unused_color_get(encoder, frame, &rect);
+        }
+        else {
+            // Nothing changed, repeat a single pixel to hold the frame
+            rect = (rect_t) {0, 0, 1, 1};
+        }
+    }
+
+    // Delay is stored in hundredths of a second
+    encoder->elapsed += delay;
+    int target = (int)(encoder->elapsed * 100.0 + 0.5);
+
+    GraphicsControlBlock gcb;
+    memset(&gcb, 0, sizeof(gcb));
+
+    gcb.DisposalMode = DISPOSE_DO_NOT;
+    gcb.UserInputFlag = false;
+    gcb.DelayTime = target - encoder->written;
+    gcb.TransparentColor = transparent_color;
+
+    encoder->written = target;
+
+    GifByteType extension[4];
+    EGifGCBToExtension(&gcb, extension);
+
+    if (!check(encoder, EGifPutExtension(encoder->file, GRAPHICS_EXT_FUNC_CODE, 4, extension))) return false;
+    if (!check(encoder, EGifPutImageDesc(encoder->file, rect.x, rect.y, rect.width, rect.height, false, NULL))) return false;
+
+    GifPixelType line[rect.width];
+
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        const color_t* current = frame->pixels + y * encoder->width + rect.x;
+        const color_t* previous = encoder->previous + y * encoder->width + rect.x;
+
+        if (transparent_color == NO_TRANSPARENT_COLOR) {
+            memcpy(line, current, rect.width);
+        }
+        else {
+            for (int x = 0; x < rect.width; x++) {
+                line[x] = current[x] != previous[x] ? current[x] : transparent_color;
+            }
+        }
+
+        if (!check(encoder, EGifPutLine(encoder->file, line, rect.width))) return false;
+    }
+
+    memcpy(encoder->previous, frame->pixels, sizeof(color_t) * encoder->width * encoder->height);
+    encoder->frame_count++;
+
+    return true;
+}
+
+bool gif_encoder_close(gif_encoder_t* encoder) {
+    int error;
+    if (EGifCloseFile(encoder->file, &error) == GIF_ERROR && !encoder->failed) {
+        log_error("Failed to save: %s - %i", encoder->filename, error);
+        encoder->failed = true;
+    }
+
+    bool written = !encoder->failed;
+
+    if (!written) {
+        remove(encoder->filename);
+    }
+
+    free(encoder->filename);
+    free(encoder->previous);
+    free(encoder);
+
+    return written;
+}
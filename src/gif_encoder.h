@@ -0,0 +1,65 @@
+/**
+ * @file gif_encoder.h
+ * GIF encoder module. Writes animated GIFs one frame at a time. Only the
+ * region that changed since the previous frame is stored, with unchanged
+ * pixels left transparent.
+ */
+
+#ifndef GIF_ENCODER_H
+#define GIF_ENCODER_H
+
+#include <stdbool.h>
+
+#include <giflib/gif_lib.h>
+
+#include "graphics.h"
+
+typedef struct {
+    GifFileType* file;
+    char* filename;
+    int width;
+    int height;
+
+    /** Last frame written, used to find changed region of next frame. */
+    color_t* previous;
+    int frame_count;
+
+    /** Total delay added and delay written so far, used to keep rounding
+     * errors from adding up. */
+    double elapsed;
+    int written;
+
+    bool failed;
+} gif_encoder_t;
+
+/**
+ * Create a GIF file and write its header. Frames must match the given size.
+ *
+ * @param filename Name of file to create.
+ * @param width Frame width.
+ * @param height Frame height.
+ * @return gif_encoder_t* New encoder if successful, NULL otherwise.
+ */
+gif_encoder_t* gif_encoder_open(const char* filename, int width, int height);
+
+/**
+ * Encode frame and write it to file. A frame that does not match the GIF size
+ * fails the whole file.
+ *
+ * @param encoder Encoder to write to.
+ * @param frame Frame to write.
+ * @param delay Time frame is shown for in seconds.
+ * @return bool True if frame was written, false otherwise.
+ */
+bool gif_encoder_frame_add(gif_encoder_t* encoder, texture_t* frame, double delay);
+
+/**
+ * Finish GIF file and close it. Encoder is freed. If anything failed, the
+ * partial file is removed.
+ *
+ * @param encoder Encoder to close.
+ * @return bool True if whole file was written, false otherwise.
+ */
+bool gif_encoder_close(gif_encoder_t* encoder);
+
+#endif
@@ -1,4 +1,5 @@
 #include <math.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -13,6 +14,20 @@ static int transparent_color = -1;
 
 static rect_t clip_rect;
 
+/** Number of fractional bits used by scene upscaling. */
+#define SCENE_FIXED_SHIFT 16
+
+static struct {
+    bool active;
+    int width;
+    int height;
+    rect_t clip_rect;
+
+    /** Source column for each destination column. */
+    int* columns;
+    int columns_size;
+} scene;
+
 texture_t* graphics_texture_new(int width, int height, const color_t* pixels) {
     texture_t* texture = (texture_t*)malloc(sizeof(texture_t) + width * height * sizeof(color_t));
 
@@ -99,6 +114,10 @@ void graphics_init(void) {
 
 void graphics_destroy(void) {
     graphics_texture_free(render_texture);
+
+    free(scene.columns);
+    scene.columns = NULL;
+    scene.columns_size = 0;
 }
 
 texture_t* graphics_render_texture_get(void) {
@@ -217,11 +236,14 @@ void graphics_blit(texture_t* source_texture, texture_t* destination_texture, re
 }
 
 void graphics_resolution_set(int width, int height) {
+    // Scene contents are discarded along with the old render texture
+    scene.active = false;
+
     graphics_texture_free(render_texture);
 
     render_texture = graphics_texture_new(
-        config->resolution.width,
-        config->resolution.height,
+        width,
+        height,
         NULL
     );
 
@@ -231,8 +253,8 @@ void graphics_resolution_set(int width, int height) {
 
     clip_rect.x = 0;
     clip_rect.y = 0;
-    clip_rect.width = config->resolution.width;
-    clip_rect.height = config->resolution.height;
+    clip_rect.width = width;
+    clip_rect.height = height;
 }
 
 void graphics_clipping_rectangle_set(rect_t* rect) {
@@ -248,3 +270,103 @@ void graphics_clipping_rectangle_set(rect_t* rect) {
 rect_t* graphics_clipping_rectangle_get(void) {
     return &clip_rect;
 }
+
+void graphics_scene_begin(float scale) {
+    if (scene.active) return;
+    if (scale >= 1.0f) return;
+
+    const int width = render_texture->width;
+    const int height = render_texture->height;
+    const int scaled_width = fmaxf(1.0f, roundf(width * scale));
+    const int scaled_height = fmaxf(1.0f, roundf(height * scale));
+
+    if (scaled_width == width && scaled_height == height) return;
+
+    if (scene.columns_size < width) {
+        int* columns = (int*)realloc(scene.columns, width * sizeof(int));
+
+        if (!columns) {
+            log_error("Failed to allocate scene columns");
+            return;
+        }
+
+        scene.columns = columns;
+        scene.columns_size = width;
+    }
+
+    scene.active = true;
+    scene.width = width;
+    scene.height = height;
+    scene.clip_rect = clip_rect;
+
+    // Pixel storage is left as is, the scene is packed at the front of it
+    render_texture->width = scaled_width;
+    render_texture->height = scaled_height;
+
+    clip_rect.x = 0;
+    clip_rect.y = 0;
+    clip_rect.width = scaled_width;
+    clip_rect.height = scaled_height;
+}
+
+void graphics_scene_end(void) {
+    if (!scene.active) return;
+
+    const int source_width = render_texture->width;
+    const int source_height = render_texture->height;
+    const int width = scene.width;
+    const int height = scene.height;
+
+    // Fixed-point steps, sampling the source at pixel centers
+    const int64_t x_step = ((int64_t)source_width << SCENE_FIXED_SHIFT) / width;
+    const int64_t y_step = ((int64_t)source_height << SCENE_FIXED_SHIFT) / height;
+
+    for (int x = 0; x < width; x++) {
+        scene.columns[x] = (int)((x * x_step + x_step / 2) >> SCENE_FIXED_SHIFT);
+    }
+
+    // Upscale in place. Source pixels never come after the destination pixel
+    // they fill, so walking backwards only overwrites pixels already read.
+    color_t* pixels = render_texture->pixels;
+    int previous_row = -1;
+
+    for (int y = height - 1; y >= 0; y--) {
+        const int source_row = (int)((y * y_step + y_step / 2) >> SCENE_FIXED_SHIFT);
+        color_t* destination = &pixels[y * width];
+
+        if (source_row == previous_row) {
+            memcpy(destination, destination + width, width);
+            continue;
+        }
+
+        const color_t* source = &pixels[source_row * source_width];
+
+        for (int x = width - 1; x >= 0; x--) {
+            destination[x] = source[scene.columns[x]];
+        }
+
+        previous_row = source_row;
+    }
+
+    render_texture->width = width;
+    render_texture->height = height;
+    clip_rect = scene.clip_rect;
+    scene.active = false;
+}
+
+float graphics_scene_scale_get(texture_t* texture) {
+    if (!scene.active || texture != render_texture) return 1.0f;
+
+    return render_texture->height / (float)scene.height;
+}
+
+void graphics_texture_resolution_get(texture_t* texture, int* width, int* height) {
+    if (scene.active && texture == render_texture) {
+        *width = scene.width;
+        *height = scene.height;
+        return;
+    }
+
+    *width = texture->width;
+    *height = texture->height;
+}
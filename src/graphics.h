@@ -6,6 +6,7 @@
 #ifndef GRAPHICS_H
 #define GRAPHICS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct {
@@ -225,4 +226,39 @@ void graphics_clipping_rectangle_set(rect_t* rect);
  */
 rect_t* graphics_clipping_rectangle_get(void);
 
+/**
+ * Begins a scene rendered at reduced resolution. The render texture is shrunk
+ * in place so anything targeting it, including renderers, draws fewer pixels.
+ * Does nothing if a scene is already active or scale is 1.0 or greater.
+ *
+ * @param scale Fraction of full resolution to render at.
+ */
+void graphics_scene_begin(float scale);
+
+/**
+ * Ends current scene. Upscales the scene to fill the render texture and
+ * restores its full resolution and clipping rectangle.
+ */
+void graphics_scene_end(void);
+
+/**
+ * Get vertical scale of given texture relative to its full resolution. Used
+ * to adjust features given in full resolution pixels, like horizons.
+ *
+ * @param texture Texture to check.
+ * @return float Scale of current scene if texture is the render texture, 1.0 otherwise.
+ */
+float graphics_scene_scale_get(texture_t* texture);
+
+/**
+ * Get full resolution of given texture. Differs from the texture's size only
+ * for the render texture during a scene. Renderers should size their buffers
+ * with this.
+ *
+ * @param texture Texture to get resolution of.
+ * @param width Full width in pixels.
+ * @param height Full height in pixels.
+ */
+void graphics_texture_resolution_get(texture_t* texture, int* width, int* height);
+
 #endif
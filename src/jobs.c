@@ -0,0 +1,199 @@
+#include <stdbool.h>
+
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "jobs.h"
+#include "log.h"
+
+/** Number of ranges each thread gets, so uneven work is balanced. */
+#define JOBS_RANGES_PER_THREAD 4
+
+#ifdef __EMSCRIPTEN__
+
+void jobs_init(void) {
+
+}
+
+void jobs_destroy(void) {
+
+}
+
+void jobs_parallel_for(int count, jobs_func_t func, void* data) {
+    if (count > 0) {
+        func(data, 0, count);
+    }
+}
+
+int jobs_thread_count_get(void) {
+    return 1;
+}
+
+#else
+
+static pthread_t threads[JOBS_THREAD_MAX];
+static int thread_count = 0;
+static bool running = false;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_available = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+
+/** Current batch of work. Guarded by mutex. */
+static struct {
+    jobs_func_t func;
+    void* data;
+    int count;
+    int range_size;
+    int next;
+    int pending;
+} batch;
+
+/**
+ * Claim next range of current batch. Must hold mutex.
+ *
+ * @param start First item index of claimed range
+ * @param end One past last item index of claimed range
+ * @return true If a range was claimed.
+ */
+static bool batch_range_claim(int* start, int* end) {
+    if (batch.next >= batch.count) return false;
+
+    *start = batch.next;
+    *end = batch.next + batch.range_size;
+    if (*end > batch.count) *end = batch.count;
+
+    batch.next = *end;
+
+    return true;
+}
+
+/**
+ * Mark a range of current batch as done. Must hold mutex.
+ */
+static void batch_range_complete(void) {
+    batch.pending--;
+
+    if (batch.pending == 0) {
+        pthread_cond_signal(&work_done);
+    }
+}
+
+static void* worker_main(void* arg) {
+    pthread_mutex_lock(&mutex);
+
+    while (true) {
+        int start;
+        int end;
+
+        while (running && !batch_range_claim(&start, &end)) {
+            pthread_cond_wait(&work_available, &mutex);
+        }
+
+        if (!running) break;
+
+        jobs_func_t func = batch.func;
+        void* data = batch.data;
+
+        pthread_mutex_unlock(&mutex);
+        func(data, start, end);
+        pthread_mutex_lock(&mutex);
+
+        batch_range_complete();
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    return NULL;
+}
+
+void jobs_init(void) {
+    int cpu_count = 1;
+
+#ifdef _SC_NPROCESSORS_ONLN
+    cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    // Main thread also processes work
+    int count = cpu_count - 1;
+    if (count < 0) count = 0;
+    if (count > JOBS_THREAD_MAX) count = JOBS_THREAD_MAX;
+
+    batch.count = 0;
+    batch.next = 0;
+    batch.pending = 0;
+
+    running = true;
+    thread_count = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (pthread_create(&threads[i], NULL, worker_main, NULL) != 0) {
+            log_error("Failed to create worker thread");
+            break;
+        }
+
+        thread_count++;
+    }
+}
+
+void jobs_destroy(void) {
+    pthread_mutex_lock(&mutex);
+    running = false;
+    pthread_cond_broadcast(&work_available);
+    pthread_mutex_unlock(&mutex);
+
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    thread_count = 0;
+}
+
+void jobs_parallel_for(int count, jobs_func_t func, void* data) {
+    if (count <= 0) return;
+
+    if (thread_count == 0 || count == 1) {
+        func(data, 0, count);
+        return;
+    }
+
+    int range_count = (thread_count + 1) * JOBS_RANGES_PER_THREAD;
+    int range_size = (count + range_count - 1) / range_count;
+
+    pthread_mutex_lock(&mutex);
+
+    batch.func = func;
+    batch.data = data;
+    batch.count = count;
+    batch.range_size = range_size;
+    batch.next = 0;
+    batch.pending = (count + range_size - 1) / range_size;
+
+    pthread_cond_broadcast(&work_available);
+
+    // Help out until all ranges are claimed
+    int start;
+    int end;
+
+    while (batch_range_claim(&start, &end)) {
+        pthread_mutex_unlock(&mutex);
+        func(data, start, end);
+        pthread_mutex_lock(&mutex);
+
+        batch_range_complete();
+    }
+
+    while (batch.pending > 0) {
+        pthread_cond_wait(&work_done, &mutex);
+    }
+
+    pthread_mutex_unlock(&mutex);
+}
+
+int jobs_thread_count_get(void) {
+    return thread_count + 1;
+}
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ * @file jobs.h
+ * Jobs module. Runs data parallel work on a pool of worker threads.
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+/** Maximum number of worker threads. */
+#define JOBS_THREAD_MAX 16
+
+/**
+ * Job function. Processes items in the range [start, end).
+ *
+ * @param data User data passed to jobs_parallel_for()
+ * @param start First item index
+ * @param end One past last item index
+ */
+typedef void (*jobs_func_t)(void* data, int start, int end);
+
+/**
+ * Initialize jobs system and start worker threads. Called once during
+ * application start.
+ */
+void jobs_init(void);
+
+/**
+ * Destroy jobs system and join worker threads. Called once during
+ * application shutdown.
+ */
+void jobs_destroy(void);
+
+/**
+ * Split count items into ranges and process them across worker threads and
+ * the calling thread. Returns once all items are processed. Runs serially if
+ * there are no worker threads. Must not be called from more than one thread
+ * at a time.
+ *
+ * @param count Number of items
+ * @param func Function to process a range of items
+ * @param data User data passed to func
+ */
+void jobs_parallel_for(int count, jobs_func_t func, void* data);
+
+/**
+ * Number of threads processing jobs, including the calling thread.
+ *
+ * @return int Thread count
+ */
+int jobs_thread_count_get(void);
+
+#endif
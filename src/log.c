@@ -2,9 +2,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
 #include "console.h"
 #include "log.h"
 
+#ifndef __EMSCRIPTEN__
+// Assets load on a background thread during startup
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LOG_LOCK() pthread_mutex_lock(&mutex)
+#define LOG_UNLOCK() pthread_mutex_unlock(&mutex)
+#else
+#define LOG_LOCK()
+#define LOG_UNLOCK()
+#endif
+
 void log_info(const char* format, ...) {
     // TODO: Reduce code duplication.
     va_list args1;
@@ -18,8 +32,10 @@ void log_info(const char* format, ...) {
     vsnprintf(buffer, sizeof(buffer), format, args2);
     va_end(args2);
 
+    LOG_LOCK();
     fprintf(stdout, "%s\n", buffer);
     console_buffer_write(buffer);
+    LOG_UNLOCK();
 }
 
 void log_error(const char* format, ...) {
@@ -34,8 +50,10 @@ void log_error(const char* format, ...) {
     vsnprintf(buffer, sizeof(buffer), format, args2);
     va_end(args2);
 
+    LOG_LOCK();
     fprintf(stderr, "%s\n", buffer);
     console_buffer_write(buffer);
+    LOG_UNLOCK();
 }
 
 void log_fatal(const char* format, ...) {
@@ -50,8 +68,10 @@ void log_fatal(const char* format, ...) {
     vsnprintf(buffer, sizeof(buffer), format, args2);
     va_end(args2);
 
+    LOG_LOCK();
     fprintf(stderr, "%s\n", buffer);
     console_buffer_write(buffer);
+    LOG_UNLOCK();
 
     exit(EXIT_FAILURE);
 }
@@ -1,8 +1,15 @@
 #include "arguments.h"
+#include "core.h"
 #include "platform.h"
 
 int main(int argc, char* argv[]) {
     arguments_set(argc, argv);
 
+    // Pack assets instead of running
+    int pack = arguments_check("--pack");
+    if (pack && pack + 1 < argc) {
+        return core_pack(argv[pack + 1]);
+    }
+
     return platform_main(argc, argv);
 }
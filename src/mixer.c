@@ -0,0 +1,619 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "log.h"
+#include "mixer.h"
+#include "sounds.h"
+
+/** Number of commands that can wait for the audio thread. */
+#define COMMAND_QUEUE_SIZE 256
+
+/** Number of frames mixed at a time. */
+#define MIX_CHUNK_SIZE 256
+
+/** Fixed point scale of voice gains. */
+#define GAIN_ONE 4096
+
+#define HANDLE_SLOT(handle) ((handle) & (MIXER_VOICE_COUNT - 1))
+#define HANDLE_GENERATION(handle) ((uint32_t)(handle) / MIXER_VOICE_COUNT)
+#define GENERATION_MAX (INT32_MAX / MIXER_VOICE_COUNT)
+
+typedef enum {
+    COMMAND_PLAY,
+    COMMAND_SET,
+    COMMAND_STOP,
+    COMMAND_STOP_ALL
+} command_type_t;
+
+typedef struct {
+    command_type_t type;
+    int slot;
+    uint32_t generation;
+    sound_t* sound;
+    stream_t* stream;
+    int32_t left_gain;
+    int32_t right_gain;
+    uint64_t step;
+    bool loop;
+} command_t;
+
+/** Voice state owned by the audio thread. Plays either a sound or a
+ * stream. */
+typedef struct {
+    sound_t* sound;
+    stream_t* stream;
+    uint32_t generation;
+
+    /** Playback position and step in frames, 32.32 fixed point. */
+    uint64_t position;
+    uint64_t step;
+
+    int32_t left_gain;
+    int32_t right_gain;
+    bool loop;
+    bool active;
+} voice_t;
+
+/** Voice state owned by the game thread. */
+typedef struct {
+    uint32_t generation;
+    sound_t* sound;
+    uint64_t order;
+    uint32_t sample_rate;
+    float volume;
+    float pan;
+    float pitch;
+} voice_claim_t;
+
+static bool is_running = false;
+static int output_sample_rate = 0;
+
+static voice_t voices[MIXER_VOICE_COUNT];
+static voice_claim_t claims[MIXER_VOICE_COUNT];
+static uint64_t claim_count = 0;
+
+/** Generation of last voice to finish in each slot. Written by the audio
+ * thread, a slot is free when it matches the claimed generation. */
+static uint32_t finished_generations[MIXER_VOICE_COUNT];
+
+/** Single producer single consumer queue. The game thread advances head,
+ * the audio thread advances tail. */
+static command_t commands[COMMAND_QUEUE_SIZE];
+static uint32_t command_head = 0;
+static uint32_t command_tail = 0;
+static bool is_command_queue_full = false;
+
+/** Sounds released while playing, freed once their voices stop. */
+static sound_t** retired_sounds = NULL;
+static int retired_sound_count = 0;
+static int retired_sound_capacity = 0;
+
+static int32_t mix_buffer[MIX_CHUNK_SIZE * 2];
+
+/**
+ * Queue command for the audio thread.
+ *
+ * @return bool True if queued, false if queue is full.
+ */
+static bool command_push(command_t* command) {
+    uint32_t head = command_head;
+    uint32_t tail = __atomic_load_n(&command_tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail == COMMAND_QUEUE_SIZE) {
+        // Only log once until the audio thread catches up
+        if (!is_command_queue_full) {
+            log_error("Too many sound commands");
+            is_command_queue_full = true;
+        }
+        return false;
+    }
+
+    is_command_queue_full = false;
+
+    commands[head % COMMAND_QUEUE_SIZE] = *command;
+    __atomic_store_n(&command_head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/**
+ * Mark voice as finished so its slot can be reused.
+ */
+static void voice_finish(int slot) {
+    voices[slot].active = false;
+    __atomic_store_n(&finished_generations[slot], voices[slot].generation, __ATOMIC_RELEASE);
+}
+
+/**
+ * Apply queued commands. Runs on the audio thread.
+ */
+static void commands_apply(void) {
+    uint32_t tail = command_tail;
+    uint32_t head = __atomic_load_n(&command_head, __ATOMIC_ACQUIRE);
+
+    for (; tail != head; tail++) {
+        command_t* command = &commands[tail % COMMAND_QUEUE_SIZE];
+        voice_t* voice = &voices[command->slot];
+
+        switch (command->type) {
+            case COMMAND_PLAY:
+                if (voice->active) {
+                    voice_finish(command->slot);
+                }
+
+                voice->sound = command->sound;
+                voice->stream = command->stream;
+                voice->generation = command->generation;
+                voice->position = 0;
+                voice->step = command->step;
+                voice->left_gain = command->left_gain;
+                voice->right_gain = command->right_gain;
+                voice->loop = command->loop;
+                voice->active = true;
+
+                if (voice->sound && voice->sound->frame_count == 0) {
+                    voice_finish(command->slot);
+                }
+                break;
+
+            case COMMAND_SET:
+                if (voice->active && voice->generation == command->generation) {
+                    voice->step = command->step;
+                    voice->left_gain = command->left_gain;
+                    voice->right_gain = command->right_gain;
+                }
+                break;
+
+            case COMMAND_STOP:
+                if (voice->active && voice->generation == command->generation) {
+                    voice_finish(command->slot);
+                }
+                break;
+
+            case COMMAND_STOP_ALL:
+                for (int i = 0; i < MIXER_VOICE_COUNT; i++) {
+                    if (voices[i].active) {
+                        voice_finish(i);
+                    }
+                }
+                break;
+        }
+    }
+
+    __atomic_store_n(&command_tail, tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * Interpolate between two samples as signed 16 bit.
+ *
+ * @param a First sample.
+ * @param b Second sample.
+ * @param fraction Position between samples, 16 bit fraction.
+ */
+static inline int32_t sample_interpolate(sample_t a, sample_t b, int32_t fraction) {
+    int32_t from = (int32_t)a - 128;
+    int32_t to = (int32_t)b - 128;
+
+    return (from * 65536 + (to - from) * fraction) / 256;
+}
+
+/**
+ * Mix stream voice into mix buffer. Plays what the decoder has buffered and
+ * releases played frames back to it.
+ */
+static void stream_voice_mix(int slot, int frame_count) {
+    voice_t* voice = &voices[slot];
+    stream_t* stream = voice->stream;
+    uint64_t mask = stream->buffer_frame_count - 1;
+    int channel_count = stream->source.channel_count;
+    int right_channel = channel_count > 1 ? 1 : 0;
+
+    // Check end first, so buffered frames seen below are final once ended
+    bool is_ended = __atomic_load_n(&stream->is_ended, __ATOMIC_ACQUIRE);
+    uint64_t read = stream->read_frame;
+    uint64_t available = __atomic_load_n(&stream->write_frame, __ATOMIC_ACQUIRE) - read;
+    bool is_finished = false;
+
+    for (int i = 0; i < frame_count; i++) {
+        uint64_t frame = voice->position >> 32;
+
+        if (frame + 1 >= available) {
+            if (is_ended && frame >= available) {
+                is_finished = true;
+                break;
+            }
+
+            // Decoder is behind, wait for it in silence
+            if (!is_ended) break;
+        }
+
+        uint64_t next = frame + 1 < available ? frame + 1 : frame;
+        const sample_t* a = stream->buffer + ((read + frame) & mask) * channel_count;
+        const sample_t* b = stream->buffer + ((read + next) & mask) * channel_count;
+        int32_t fraction = (voice->position >> 16) & 0xffff;
+
+        int32_t left = sample_interpolate(a[0], b[0], fraction);
+        int32_t right = right_channel ? sample_interpolate(a[right_channel], b[right_channel], fraction) : left;
+
+        mix_buffer[i * 2 + 0] += (left * voice->left_gain) / GAIN_ONE;
+        mix_buffer[i * 2 + 1] += (right * voice->right_gain) / GAIN_ONE;
+
+        voice->position += voice->step;
+    }
+
+    uint64_t played = voice->position >> 32;
+    if (played > available) played = available;
+
+    voice->position -= played << 32;
+    __atomic_store_n(&stream->read_frame, read + played, __ATOMIC_RELEASE);
+
+    if (is_finished) {
+        voice_finish(slot);
+    }
+}
+
+/**
+ * Mix voice into mix buffer.
+ */
+static void voice_mix(int slot, int frame_count) {
+    if (voices[slot].stream) {
+        stream_voice_mix(slot, frame_count);
+        return;
+    }
+
+    voice_t* voice = &voices[slot];
+    sound_t* sound = voice->sound;
+    uint64_t total = sound->frame_count;
+    int right_channel = sound->channel_count > 1 ? 1 : 0;
+
+    for (int i = 0; i < frame_count; i++) {
+        uint64_t frame = voice->position >> 32;
+
+        if (frame >= total) {
+            if (!voice->loop) {
+                voice_finish(slot);
+                return;
+            }
+
+            voice->position %= total << 32;
+            frame = voice->position >> 32;
+        }
+
+        uint64_t next = frame + 1;
+        if (next >= total) {
+            next = voice->loop ? 0 : frame;
+        }
+
+        // Linear interpolation between frames, 16 bit fraction
+        const sample_t* a = sound->pcm + frame * sound->channel_count;
+        const sample_t* b = sound->pcm + next * sound->channel_count;
+        int32_t fraction = (voice->position >> 16) & 0xffff;
+
+        int32_t left = sample_interpolate(a[0], b[0], fraction);
+        int32_t right = right_channel ? sample_interpolate(a[right_channel], b[right_channel], fraction) : left;
+
+        mix_buffer[i * 2 + 0] += (left * voice->left_gain) / GAIN_ONE;
+        mix_buffer[i * 2 + 1] += (right * voice->right_gain) / GAIN_ONE;
+
+        voice->position += voice->step;
+    }
+}
+
+void mixer_mix(int16_t* output, int frame_count) {
+    if (!is_running) {
+        memset(output, 0, sizeof(int16_t) * 2 * frame_count);
+        return;
+    }
+
+    commands_apply();
+
+    while (frame_count > 0) {
+        int count = frame_count < MIX_CHUNK_SIZE ? frame_count : MIX_CHUNK_SIZE;
+
+        memset(mix_buffer, 0, sizeof(int32_t) * 2 * count);
+
+        for (int i = 0; i < MIXER_VOICE_COUNT; i++) {
+            if (voices[i].active) {
+                voice_mix(i, count);
+            }
+        }
+
+        for (int i = 0; i < count * 2; i++) {
+            int32_t sample = mix_buffer[i];
+            if (sample > INT16_MAX) sample = INT16_MAX;
+            if (sample < INT16_MIN) sample = INT16_MIN;
+            output[i] = (int16_t)sample;
+        }
+
+        output += count * 2;
+        frame_count -= count;
+    }
+}
+
+void mixer_init(int sample_rate) {
+    memset(voices, 0, sizeof(voices));
+    memset(claims, 0, sizeof(claims));
+    memset(finished_generations, 0, sizeof(finished_generations));
+
+    command_head = 0;
+    command_tail = 0;
+    is_command_queue_full = false;
+    claim_count = 0;
+
+    output_sample_rate = sample_rate;
+    is_running = sample_rate > 0;
+}
+
+void mixer_destroy(void) {
+    is_running = false;
+
+    for (int i = 0; i < retired_sound_count; i++) {
+        free(retired_sounds[i]);
+    }
+
+    free(retired_sounds);
+    retired_sounds = NULL;
+    retired_sound_count = 0;
+    retired_sound_capacity = 0;
+}
+
+/**
+ * Check if any voice may still be using given sound. A queued play command
+ * overwrites its claim right away, while the audio thread keeps mixing the
+ * sound it displaces until the command is applied. So any sound counts as in
+ * use until the audio thread has caught up with the queue. Commands are
+ * applied before mixing, so nothing displaced is mixed after that.
+ */
+static bool sound_is_playing(sound_t* sound) {
+    if (!sound) return false;
+
+    if (__atomic_load_n(&command_tail, __ATOMIC_ACQUIRE) != command_head) return true;
+
+    for (int i = 0; i < MIXER_VOICE_COUNT; i++) {
+        if (claims[i].sound != sound) continue;
+
+        if (__atomic_load_n(&finished_generations[i], __ATOMIC_ACQUIRE) != claims[i].generation) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void mixer_update(void) {
+    for (int i = 0; i < retired_sound_count; i++) {
+        if (sound_is_playing(retired_sounds[i])) continue;
+
+        for (int j = 0; j < MIXER_VOICE_COUNT; j++) {
+            if (claims[j].sound == retired_sounds[i]) {
+                claims[j].sound = NULL;
+            }
+        }
+
+        free(retired_sounds[i]);
+        retired_sounds[i] = retired_sounds[--retired_sound_count];
+        i--;
+    }
+}
+
+/**
+ * Fill gains and step of command from voice parameters.
+ */
+static void command_parameters_set(command_t* command, float volume, float pan, float pitch, uint32_t sample_rate) {
+    if (volume < 0) volume = 0;
+    if (volume > 1) volume = 1;
+    if (pan < -1) pan = -1;
+    if (pan > 1) pan = 1;
+    if (pitch < 0) pitch = 0;
+
+    float left = volume * (pan > 0 ? 1 - pan : 1);
+    float right = volume * (pan < 0 ? 1 + pan : 1);
+
+    command->left_gain = (int32_t)(left * GAIN_ONE + 0.5f);
+    command->right_gain = (int32_t)(right * GAIN_ONE + 0.5f);
+
+    // Resample to device rate
+    double ratio = (double)pitch * sample_rate / output_sample_rate;
+    command->step = (uint64_t)(ratio * 4294967296.0);
+}
+
+/**
+ * Check if handle refers to the voice last played in its slot.
+ */
+static bool handle_is_current(int handle) {
+    if (handle < 0) return false;
+
+    return claims[HANDLE_SLOT(handle)].generation == HANDLE_GENERATION(handle);
+}
+
+/**
+ * Start sound or stream on a voice.
+ *
+ * @return int Voice handle if playing, -1 otherwise.
+ */
+static int voice_play(sound_t* sound, stream_t* stream, uint32_t sample_rate, int voice, float volume, float pan, float pitch, bool loop) {
+    int slot = -1;
+
+    if (voice >= 0 && voice < MIXER_VOICE_COUNT) {
+        slot = voice;
+    }
+    else {
+        // Use a free voice, otherwise the one playing the longest
+        for (int i = 0; i < MIXER_VOICE_COUNT; i++) {
+            if (__atomic_load_n(&finished_generations[i], __ATOMIC_ACQUIRE) == claims[i].generation) {
+                slot = i;
+                break;
+            }
+
+            if (slot < 0 || claims[i].order < claims[slot].order) {
+                slot = i;
+            }
+        }
+    }
+
+    voice_claim_t* claim = &claims[slot];
+
+    uint32_t generation = claim->generation + 1;
+    if (generation > GENERATION_MAX) {
+        generation = 1;
+    }
+
+    command_t command;
+    command.type = COMMAND_PLAY;
+    command.slot = slot;
+    command.generation = generation;
+    command.sound = sound;
+    command.stream = stream;
+    command.loop = loop;
+    command_parameters_set(&command, volume, pan, pitch, sample_rate);
+
+    if (!command_push(&command)) return -1;
+
+    claim->generation = generation;
+    claim->sound = sound;
+    claim->order = ++claim_count;
+    claim->sample_rate = sample_rate;
+    claim->volume = volume;
+    claim->pan = pan;
+    claim->pitch = pitch;
+
+    return generation * MIXER_VOICE_COUNT + slot;
+}
+
+int mixer_play(sound_t* sound, int voice, float volume, float pan, float pitch, bool loop) {
+    if (!is_running || !sound) return -1;
+
+    return voice_play(sound, NULL, SOUNDS_SAMPLE_RATE, voice, volume, pan, pitch, loop);
+}
+
+int mixer_stream_play(stream_t* stream, float volume, float pan, float pitch) {
+    if (!is_running || !stream) return -1;
+
+    return voice_play(NULL, stream, stream->source.sample_rate, -1, volume, pan, pitch, false);
+}
+
+void mixer_voice_set(int handle, float volume, float pan, float pitch) {
+    if (!mixer_voice_is_playing(handle)) return;
+
+    voice_claim_t* claim = &claims[HANDLE_SLOT(handle)];
+
+    command_t command;
+    command.type = COMMAND_SET;
+    command.slot = HANDLE_SLOT(handle);
+    command.generation = claim->generation;
+    command_parameters_set(&command, volume, pan, pitch, claim->sample_rate);
+
+    if (!command_push(&command)) return;
+
+    claim->volume = volume;
+    claim->pan = pan;
+    claim->pitch = pitch;
+}
+
+bool mixer_voice_get(int handle, float* volume, float* pan, float* pitch) {
+    if (!handle_is_current(handle)) return false;
+
+    voice_claim_t* claim = &claims[HANDLE_SLOT(handle)];
+    *volume = claim->volume;
+    *pan = claim->pan;
+    *pitch = claim->pitch;
+
+    return true;
+}
+
+void mixer_voice_stop(int handle) {
+    if (!mixer_voice_is_playing(handle)) return;
+
+    command_t command;
+    command.type = COMMAND_STOP;
+    command.slot = HANDLE_SLOT(handle);
+    command.generation = HANDLE_GENERATION(handle);
+
+    command_push(&command);
+}
+
+bool mixer_voice_is_playing(int handle) {
+    if (!is_running || !handle_is_current(handle)) return false;
+
+    int slot = HANDLE_SLOT(handle);
+
+    return __atomic_load_n(&finished_generations[slot], __ATOMIC_ACQUIRE) != claims[slot].generation;
+}
+
+void mixer_stop_all(void) {
+    if (!is_running) return;
+
+    command_t command;
+    command.type = COMMAND_STOP_ALL;
+    command.slot = 0;
+
+    command_push(&command);
+}
+
+void mixer_sync(void) {
+    if (!is_running) return;
+
+#ifdef __EMSCRIPTEN__
+    // Audio callback runs on this thread, so apply commands directly
+    commands_apply();
+#else
+    // Give up if the device stops calling back
+    for (int i = 0; i < 250; i++) {
+        if (__atomic_load_n(&command_tail, __ATOMIC_ACQUIRE) == command_head) return;
+
+#ifdef _WIN32
+        Sleep(1);
+#else
+        struct timespec delay = {0, 1000000};
+        nanosleep(&delay, NULL);
+#endif
+    }
+
+    log_error("Timed out waiting for audio");
+#endif
+}
+
+bool mixer_sound_release(sound_t* sound) {
+    if (!is_running || !sound_is_playing(sound)) return false;
+
+    if (retired_sound_count == retired_sound_capacity) {
+        int capacity = retired_sound_capacity ? retired_sound_capacity * 2 : 16;
+        sound_t** sounds = (sound_t**)realloc(retired_sounds, sizeof(sound_t*) * capacity);
+
+        // Can't defer, so wait for the audio thread instead
+        if (!sounds) {
+            for (int i = 0; i < MIXER_VOICE_COUNT; i++) {
+                if (claims[i].sound == sound) {
+                    mixer_voice_stop(claims[i].generation * MIXER_VOICE_COUNT + i);
+                }
+            }
+            mixer_sync();
+            return false;
+        }
+
+        retired_sounds = sounds;
+        retired_sound_capacity = capacity;
+    }
+
+    for (int i = 0; i < MIXER_VOICE_COUNT; i++) {
+        if (claims[i].sound == sound) {
+            mixer_voice_stop(claims[i].generation * MIXER_VOICE_COUNT + i);
+        }
+    }
+
+    retired_sounds[retired_sound_count++] = sound;
+
+    return true;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file mixer.h
+ * Mixer module. Mixes playing sounds into the audio device's output. Mixing
+ * runs on the audio thread, the game thread talks to it through a lock-free
+ * command queue.
+ */
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sounds.h"
+#include "streams.h"
+
+/** Number of sounds that can play at once. */
+#define MIXER_VOICE_COUNT 32
+
+/**
+ * Start mixer. Called by platform once its audio device is open.
+ *
+ * @param sample_rate Output sample rate of audio device.
+ */
+void mixer_init(int sample_rate);
+
+/**
+ * Stop mixer. Called by platform after its audio device is closed.
+ */
+void mixer_destroy(void);
+
+/**
+ * Free sounds released while playing once they have stopped. Called once
+ * per frame on the game thread.
+ */
+void mixer_update(void);
+
+/**
+ * Mix playing voices. Called from the audio device callback.
+ *
+ * @param output Interleaved stereo samples to fill.
+ * @param frame_count Number of stereo frames to fill.
+ */
+void mixer_mix(int16_t* output, int frame_count);
+
+/**
+ * Play sound on a voice.
+ *
+ * @param sound Sound to play.
+ * @param voice Voice to play on, or -1 for any free voice. If no voice is
+ * free the oldest one is reused.
+ * @param volume Volume from 0 to 1.
+ * @param pan Pan from -1 (left) to 1 (right).
+ * @param pitch Playback speed. 1 is normal.
+ * @param loop Restart sound when it ends.
+ * @return int Voice handle if playing, -1 otherwise.
+ */
+int mixer_play(sound_t* sound, int voice, float volume, float pan, float pitch, bool loop);
+
+/**
+ * Play stream on any free voice. Stream must stay open while playing.
+ *
+ * @param stream Stream to play.
+ * @param volume Volume from 0 to 1.
+ * @param pan Pan from -1 (left) to 1 (right).
+ * @param pitch Playback speed. 1 is normal.
+ * @return int Voice handle if playing, -1 otherwise.
+ */
+int mixer_stream_play(stream_t* stream, float volume, float pan, float pitch);
+
+/**
+ * Change parameters of a playing voice. Does nothing if voice has stopped.
+ *
+ * @param handle Voice handle returned by mixer_play.
+ * @param volume Volume from 0 to 1.
+ * @param pan Pan from -1 (left) to 1 (right).
+ * @param pitch Playback speed. 1 is normal.
+ */
+void mixer_voice_set(int handle, float volume, float pan, float pitch);
+
+/**
+ * Get parameters of a voice as last set.
+ *
+ * @param handle Voice handle returned by mixer_play.
+ * @param volume Out volume.
+ * @param pan Out pan.
+ * @param pitch Out pitch.
+ * @return bool True if handle is valid, false otherwise.
+ */
+bool mixer_voice_get(int handle, float* volume, float* pan, float* pitch);
+
+/**
+ * Stop a playing voice.
+ *
+ * @param handle Voice handle returned by mixer_play.
+ */
+void mixer_voice_stop(int handle);
+
+/**
+ * Check if a voice is still playing.
+ *
+ * @param handle Voice handle returned by mixer_play.
+ * @return bool True if playing, false otherwise.
+ */
+bool mixer_voice_is_playing(int handle);
+
+/**
+ * Stop all voices.
+ */
+void mixer_stop_all(void);
+
+/**
+ * Wait until the audio thread has applied all queued commands.
+ */
+void mixer_sync(void);
+
+/**
+ * Hand sound over to the mixer if it is still playing. The sound is stopped
+ * and freed once the audio thread no longer uses it.
+ *
+ * @param sound Sound to release.
+ * @return bool True if mixer took the sound, false if it can be freed now.
+ */
+bool mixer_sound_release(sound_t* sound);
+
+#endif
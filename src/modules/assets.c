@@ -13,27 +13,63 @@
 #include "../assets.h"
 #include "../sounds.h"
 
+/**
+ * Get asset handle for given argument, which may be a filename or a handle.
+ *
+ * @param L Lua state
+ * @param index Stack index of argument
+ * @return int Asset handle. -1 if no asset has the given name.
+ */
+static int luaL_checkassethandle(lua_State* L, int index) {
+    if (lua_type(L, index) == LUA_TNUMBER) {
+        return (int)luaL_checkinteger(L, index);
+    }
+
+    return assets_handle_get(luaL_checkstring(L, index));
+}
+
+/**
+ * Get handle for given filename. Handles can be used in place of filenames
+ * and are faster to look up. They stay valid across reloads.
+ * @function handle
+ * @tparam string filename Name of asset to look for
+ * @treturn integer Asset handle if found, nil otherwise.
+ */
+static int modules_assets_handle_get(lua_State* L) {
+    const char* name = luaL_checkstring(L, 1);
+    int handle = assets_handle_get(name);
+
+    if (handle < 0) {
+        lua_pushnil(L);
+    }
+    else {
+        lua_pushinteger(L, handle);
+    }
+
+    return 1;
+}
+
 /**
  * Get texture for given filename and frame
  * @function get_texture
- * @tparam string filename Name of texture asset to look for
+ * @tparam string|integer filename Name or handle of texture asset to look for
  * @tparam ?integer frame Index of frame (default 1)
  * @treturn texture.texture Texture userdata if found, nil otherwise.
  */
 static int modules_assets_texture_get(lua_State* L) {
-    const char* texture_name = luaL_checkstring(L, 1);
+    int handle = luaL_checkassethandle(L, 1);
     int frame = (int)luaL_optnumber(L, 2, 1);
-    texture_t* texture = assets_texture_get(texture_name, frame - 1);
+    texture_t* texture = assets_texture_handle_get(handle, frame - 1);
 
     if (texture) {
-        lua_pushtexture(L, texture);
+        lua_pushassettexture(L, texture, handle);
     }
     else {
-        if (assets_texture_get(texture_name, 0)) {
-            luaL_error(L, "bad frame: %d for asset: %s", frame, texture_name);
+        if (assets_texture_handle_get(handle, 0)) {
+            luaL_error(L, "bad frame: %d for asset: %s", frame, luaL_tolstring(L, 1, NULL));
         }
         else {
-            luaL_error(L, "missing asset: %s", texture_name);
+            luaL_error(L, "missing asset: %s", luaL_tolstring(L, 1, NULL));
         }
     }
 
@@ -43,26 +79,48 @@ static int modules_assets_texture_get(lua_State* L) {
 /**
  * Get sound for given filename
  * @function get_sound
- * @tparam string filename Name of sound asset to look for
+ * @tparam string|integer filename Name or handle of sound asset to look for
  * @treturn sound.sound Sound userdata if found, nil otherwise.
  */
 static int modules_assets_sound_get(lua_State* L) {
-    const char* sound_name = luaL_checkstring(L, 1);
-    sound_t* sound = assets_sound_get(sound_name);
+    int handle = luaL_checkassethandle(L, 1);
+    sound_t* sound = assets_sound_handle_get(handle);
 
     if (sound) {
         lua_pushsound(L, sound);
     }
     else {
-        luaL_error(L, "missing asset: %s", sound_name);
+        luaL_error(L, "missing asset: %s", luaL_tolstring(L, 1, NULL));
     }
 
     return 1;
 }
 
+/**
+ * Start loading assets in the background so they are resident by the time
+ * they are used. Only has an effect when assets are loaded lazily.
+ * @function prefetch
+ * @tparam {string|integer,...} filenames Names or handles of assets to load
+ */
+static int modules_assets_prefetch(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    lua_Integer count = luaL_len(L, 1);
+
+    for (lua_Integer i = 1; i <= count; i++) {
+        lua_geti(L, 1, i);
+        assets_prefetch(luaL_checkassethandle(L, -1));
+        lua_pop(L, 1);
+    }
+
+    return 0;
+}
+
 static const struct luaL_Reg modules_asset_functions[] = {
     {"get_texture", modules_assets_texture_get},
     {"get_sound", modules_assets_sound_get},
+    {"handle", modules_assets_handle_get},
+    {"prefetch", modules_assets_prefetch},
     {NULL, NULL}
 };
 
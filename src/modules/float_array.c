@@ -42,6 +42,32 @@ int lua_pushfloatarray(lua_State* L, float_array_t* array) {
     return 1;
 }
 
+float_array_t* lua_outfloatarray(lua_State* L, int index, size_t size) {
+    if (lua_isnoneornil(L, index)) {
+        lua_newfloatarray(L, size);
+        return luaL_checkfloatarray(L, -1);
+    }
+
+    float_array_t* array = luaL_checkfloatarray(L, index);
+
+    if (array->size < size) {
+        float_array_resize(array, size);
+        luaL_argcheck(L, array->size >= size, index, "failed to resize array");
+    }
+
+    lua_pushvalue(L, index);
+
+    return array;
+}
+
+size_t luaL_optbatchstride(lua_State* L, int index) {
+    lua_Integer stride = luaL_optinteger(L, index, 3);
+
+    luaL_argcheck(L, stride >= 3, index, "stride must be at least 3");
+
+    return (size_t)stride;
+}
+
 static int float_array_gc(lua_State* L) {
     float_array_t** handle = lua_touserdata(L, 1);
     float_array_free(*handle);
@@ -16,6 +16,12 @@ int lua_newfloatarray(lua_State* L, size_t size);
 /* Pushes a float aray onto the stack. Created userdata will not be garbage collected. */
 int lua_pushfloatarray(lua_State* L, float_array_t* array);
 
+/* Pushes the float array at index, grown to at least size elements, or a new float array of given size if there is none. */
+float_array_t* lua_outfloatarray(lua_State* L, int index, size_t size);
+
+/* Checks the optional stride argument of a batch function over float arrays. Defaults to 3, raises an error if less than 3. */
+size_t luaL_optbatchstride(lua_State* L, int index);
+
 int luaopen_floatarray(lua_State* L);
 
 #endif
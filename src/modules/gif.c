@@ -10,9 +10,26 @@
 #include "texture.h"
 
 #include "../assets.h"
+#include "../gif_encoder.h"
+#include "../graphics.h"
+#include "../recorder.h"
 
 /**
- * Save frames as an animated GIF. Result will be encoded at 50 fps.
+ * Get open encoder at given index. Raises an error if encoder is closed.
+ */
+static gif_encoder_t* luaL_checkgifencoder(lua_State* L, int index) {
+    gif_encoder_t** handle = (gif_encoder_t**)luaL_checkudata(L, index, "gif_encoder");
+
+    if (!*handle) {
+        luaL_error(L, "attempt to use a closed gif");
+    }
+
+    return *handle;
+}
+
+/**
+ * Save frames as an animated GIF. Result will be encoded at 50 fps. All frames
+ * must be the same size. Raises an error if the GIF could not be saved.
  * @function save
  * @tparam string filename Name of GIF to save.
  * @tparam {texture.texture,...} frames Array of texture userdata.
@@ -37,9 +54,9 @@ static int modules_gif_save(lua_State* L) {
             lua_pop(L, 1);
         }
 
-        lua_settop(L, 0);
-
-        assets_gif_save(filename, frame_count, frames);
+        if (!assets_gif_save(filename, frame_count, frames)) {
+            return luaL_error(L, "failed to save gif: %s", filename);
+        }
     }
     // Single texture
     else {
@@ -49,21 +66,177 @@ static int modules_gif_save(lua_State* L) {
             frame
         };
 
-        lua_settop(L, 0);
+        if (!assets_gif_save(filename, 1, frames)) {
+            return luaL_error(L, "failed to save gif: %s", filename);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Open a GIF for writing frames as they are made. Memory use does not grow
+ * with the number of frames.
+ * @function open
+ * @tparam string filename Name of GIF to save.
+ * @tparam ?integer width Frame width. Defaults to render texture width.
+ * @tparam ?integer height Frame height. Defaults to render texture height.
+ * @treturn gif.encoder Encoder userdata
+ */
+static int modules_gif_open(lua_State* L) {
+    const char* filename = luaL_checkstring(L, 1);
+    texture_t* render_texture = graphics_render_texture_get();
+    int width = luaL_optinteger(L, 2, render_texture->width);
+    int height = luaL_optinteger(L, 3, render_texture->height);
+
+    luaL_argcheck(L, width > 0, 2, "width must be positive");
+    luaL_argcheck(L, height > 0, 3, "height must be positive");
 
-        assets_gif_save(filename, 1, frames);
+    gif_encoder_t** handle = (gif_encoder_t**)lua_newuserdata(L, sizeof(gif_encoder_t*));
+    *handle = NULL;
+    luaL_setmetatable(L, "gif_encoder");
+
+    *handle = gif_encoder_open(filename, width, height);
+    if (!*handle) {
+        return luaL_error(L, "failed to open gif: %s", filename);
     }
 
+    return 1;
+}
+
+/**
+ * Write frame to GIF. Only pixels changed since the previous frame are
+ * stored.
+ * @function add_frame
+ * @tparam gif.encoder self
+ * @tparam texture.texture frame Frame to write. Must match GIF size.
+ * @tparam ?number delay Seconds frame is shown for. Defaults to 1/50.
+ */
+static int modules_gif_add_frame(lua_State* L) {
+    gif_encoder_t* encoder = luaL_checkgifencoder(L, 1);
+    texture_t* frame = luaL_checktexture(L, 2);
+    lua_Number delay = luaL_optnumber(L, 3, 0.02);
+
+    luaL_argcheck(L, frame->width == encoder->width && frame->height == encoder->height, 2, "frame size does not match gif");
+    luaL_argcheck(L, delay >= 0, 3, "delay must not be negative");
+
+    lua_settop(L, 0);
+
+    gif_encoder_frame_add(encoder, frame, delay);
+
     return 0;
 }
 
+/**
+ * Finish and close GIF.
+ * @function close
+ * @tparam gif.encoder self
+ * @treturn boolean True if whole GIF was written.
+ */
+static int modules_gif_close(lua_State* L) {
+    gif_encoder_t* encoder = luaL_checkgifencoder(L, 1);
+    gif_encoder_t** handle = (gif_encoder_t**)lua_touserdata(L, 1);
+    *handle = NULL;
+
+    lua_settop(L, 0);
+    lua_pushboolean(L, gif_encoder_close(encoder));
+
+    return 1;
+}
+
+static int modules_gif_encoder_gc(lua_State* L) {
+    gif_encoder_t** handle = (gif_encoder_t**)lua_touserdata(L, 1);
+
+    if (*handle) {
+        gif_encoder_close(*handle);
+        *handle = NULL;
+    }
+
+    return 0;
+}
+
+static int modules_gif_encoder_meta_index(lua_State* L) {
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    // Check module fields. This enables usage of the colon operator.
+    luaL_requiref(L, "gif", NULL, false);
+    if (lua_type(L, -1) == LUA_TTABLE) {
+        lua_getfield(L, -1, key);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+/**
+ * Start recording the screen to a GIF. Frames are encoded in the background.
+ * Recording can also be toggled with F8.
+ * @function record
+ * @tparam ?string filename Name of GIF to save. Defaults to a timestamped name.
+ * @treturn boolean True if recording started.
+ */
+static int modules_gif_record(lua_State* L) {
+    const char* filename = luaL_optstring(L, 1, NULL);
+
+    bool started = recorder_start(filename);
+
+    lua_settop(L, 0);
+    lua_pushboolean(L, started);
+
+    return 1;
+}
+
+/**
+ * Stop recording and save GIF.
+ * @function stop
+ */
+static int modules_gif_stop(lua_State* L) {
+    recorder_stop();
+
+    return 0;
+}
+
+/**
+ * Check if screen is being recorded.
+ * @function is_recording
+ * @treturn boolean True if recording.
+ */
+static int modules_gif_is_recording(lua_State* L) {
+    lua_pushboolean(L, recorder_is_recording());
+
+    return 1;
+}
+
 static const struct luaL_Reg modules_gif_functions[] = {
     {"save", modules_gif_save},
+    {"open", modules_gif_open},
+    {"record", modules_gif_record},
+    {"stop", modules_gif_stop},
+    {"is_recording", modules_gif_is_recording},
+    {"add_frame", modules_gif_add_frame},
+    {"close", modules_gif_close},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_gif_encoder_meta_functions[] = {
+    {"__index", modules_gif_encoder_meta_index},
+    {"__gc", modules_gif_encoder_gc},
+    {"__close", modules_gif_encoder_gc},
     {NULL, NULL}
 };
 
 int luaopen_gif(lua_State* L) {
     luaL_newlib(L, modules_gif_functions);
 
+    // Push gif encoder userdata metatable
+    luaL_newmetatable(L, "gif_encoder");
+    luaL_setfuncs(L, modules_gif_encoder_meta_functions, 0);
+
+    lua_pop(L, 1);
+
     return 1;
 }
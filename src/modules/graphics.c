@@ -15,6 +15,8 @@
 #include "../assets.h"
 #include "../graphics.h"
 #include "../platform.h"
+#include "../resolution.h"
+#include "../renderers/shading.h"
 
 /**
  * Draw a pixel at given position and color.
@@ -214,6 +216,76 @@ static int modules_graphics_resolution_set(lua_State* L) {
     return 0;
 }
 
+/**
+ * Begins a scene. Until the scene ends, the render texture is reduced in size
+ * when frames go over the budget set in config.json. Renderers using the
+ * render texture should be created outside of scenes.
+ * @function begin_scene
+ */
+static int modules_graphics_scene_begin(lua_State* L) {
+    resolution_scene_begin();
+
+    return 0;
+}
+
+/**
+ * Ends current scene and upscales it to fill the render texture. Scenes still
+ * active at the end of _draw are ended automatically.
+ * @function end_scene
+ */
+static int modules_graphics_scene_end(lua_State* L) {
+    resolution_scene_end();
+
+    return 0;
+}
+
+/**
+ * Get current scene scale.
+ * @function get_scene_scale
+ * @treturn number Fraction of full resolution scenes are rendered at.
+ */
+static int modules_graphics_scene_scale_get(lua_State* L) {
+    lua_pushnumber(L, resolution_scale_get());
+
+    return 1;
+}
+
+/**
+ * Bakes a shade table from the current palette. Each column fades all colors
+ * towards the fog color, matched to the nearest palette color. Suitable for
+ * use as a renderer 'shadetable' feature.
+ * @function bake_shade_table
+ * @tparam integer levels Number of brightness levels.
+ * @tparam ?integer r Fog red value. [0, 255] (default 0)
+ * @tparam ?integer g Fog green value. [0, 255] (default 0)
+ * @tparam ?integer b Fog blue value. [0, 255] (default 0)
+ * @treturn texture.texture Shade table texture of size levels x 256.
+ */
+static int modules_graphics_shade_table_bake(lua_State* L) {
+    int levels = (int)luaL_checknumber(L, 1);
+    int r = (int)luaL_optnumber(L, 2, 0) & 0xFF;
+    int g = (int)luaL_optnumber(L, 3, 0) & 0xFF;
+    int b = (int)luaL_optnumber(L, 4, 0) & 0xFF;
+    int a = 0xFF;
+
+    luaL_argcheck(L, levels > 0, 1, "invalid levels");
+
+    lua_settop(L, 0);
+
+    uint32_t fog_color = a << 24 | b << 16 | g << 8 | r;
+
+    texture_t* shade_table = shading_table_bake(graphics_palette_get(), levels, fog_color);
+    if (!shade_table) {
+        return luaL_error(L, "failed to bake shade table");
+    }
+
+    texture_t** handle = (texture_t**)lua_newuserdata(L, sizeof(texture_t*));
+    *handle = shade_table;
+    luaL_setmetatable(L, "texture");
+
+    return 1;
+}
+
 static const struct luaL_Reg modules_graphics_functions[] = {
     {"set_pixel", modules_graphics_pixel_set},
     {"blit", modules_graphics_blit},
@@ -223,6 +295,10 @@ static const struct luaL_Reg modules_graphics_functions[] = {
     {"set_transparent_color", modules_graphics_transparent_color_set},
     {"set_global_palette_color", modules_graphics_palette_color_set},
     {"set_resolution", modules_graphics_resolution_set},
+    {"bake_shade_table", modules_graphics_shade_table_bake},
+    {"begin_scene", modules_graphics_scene_begin},
+    {"end_scene", modules_graphics_scene_end},
+    {"get_scene_scale", modules_graphics_scene_scale_get},
     {NULL, NULL}
 };
 
@@ -42,6 +42,24 @@ int lua_pushintarray(lua_State* L, int_array_t* array) {
     return 1;
 }
 
+int_array_t* lua_outintarray(lua_State* L, int index, size_t size) {
+    if (lua_isnoneornil(L, index)) {
+        lua_newintarray(L, size);
+        return luaL_checkintarray(L, -1);
+    }
+
+    int_array_t* array = luaL_checkintarray(L, index);
+
+    if (array->size < size) {
+        int_array_resize(array, size);
+        luaL_argcheck(L, array->size >= size, index, "failed to resize array");
+    }
+
+    lua_pushvalue(L, index);
+
+    return array;
+}
+
 static int int_array_gc(lua_State* L) {
     int_array_t** handle = lua_touserdata(L, 1);
     int_array_free(*handle);
@@ -16,6 +16,9 @@ int lua_newintarray(lua_State* L, size_t size);
 /* Pushes a int aray onto the stack. Created userdata will not be garbage collected. */
 int lua_pushintarray(lua_State* L, int_array_t* array);
 
+/* Pushes the int array at index, grown to at least size elements, or a new int array of given size if there is none. */
+int_array_t* lua_outintarray(lua_State* L, int index, size_t size);
+
 int luaopen_intarray(lua_State* L);
 
 #endif
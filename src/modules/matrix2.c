@@ -12,38 +12,35 @@
 #include <mathc/mathc.h>
 
 #include "matrix2.h"
+#include "scratch.h"
 #include "vector2.h"
 
-bool lua_ismatrix2(lua_State*L, int index) {
-    void* p = luaL_testudata(L, index, "matrix2");
-    if (p == NULL) {
-        p = luaL_testudata(L, index, "matrix2_nogc");
-    }
+/**
+ * Userdata layout. Values created from Lua store their components inline and
+ * point at them, values pushed from C only store the pointer.
+ */
+typedef struct {
+    mfloat_t* components;
+    mfloat_t storage[MAT2_SIZE];
+} matrix2_userdata_t;
 
-    return p != NULL;
+bool lua_ismatrix2(lua_State* L, int index) {
+    return luaL_testudata(L, index, "matrix2") != NULL;
 }
 
 mfloat_t* luaL_checkmatrix2(lua_State* L, int index) {
-    mfloat_t** handle = NULL;
-    luaL_checktype(L, index, LUA_TUSERDATA);
-
-    handle = (mfloat_t**)luaL_testudata(L, index, "matrix2_nogc");
-    if (!handle) {
-        handle = (mfloat_t**)luaL_checkudata(L, index, "matrix2");
-    }
-
-    return *handle;
+    return *(mfloat_t**)luaL_checkudata(L, index, "matrix2");
 }
 
 int lua_newmatrix2(lua_State* L, float m11, float m21, float m12, float m22) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* m0 = (mfloat_t*)malloc(sizeof(mfloat_t) * MAT2_SIZE);
+    matrix2_userdata_t* userdata = (matrix2_userdata_t*)lua_newuserdatauv(L, sizeof(matrix2_userdata_t), 0);
+    mfloat_t* m0 = userdata->storage;
     m0[0] = m11;
     m0[1] = m21;
     m0[2] = m12;
     m0[3] = m22;
 
-    *handle = m0;
+    userdata->components = m0;
 
     luaL_setmetatable(L, "matrix2");
 
@@ -51,14 +48,14 @@ int lua_newmatrix2(lua_State* L, float m11, float m21, float m12, float m22) {
 }
 
 int lua_newmatrix2_from_matrix(lua_State* L, mfloat_t* m0) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* m1 = (mfloat_t*)malloc(sizeof(mfloat_t) * MAT2_SIZE);
+    matrix2_userdata_t* userdata = (matrix2_userdata_t*)lua_newuserdatauv(L, sizeof(matrix2_userdata_t), 0);
+    mfloat_t* m1 = userdata->storage;
     m1[0] = m0[0];
     m1[1] = m0[1];
     m1[2] = m0[2];
     m1[3] = m0[3];
 
-    *handle = m1;
+    userdata->components = m1;
 
     luaL_setmetatable(L, "matrix2");
 
@@ -66,20 +63,23 @@ int lua_newmatrix2_from_matrix(lua_State* L, mfloat_t* m0) {
 }
 
 int lua_pushmatrix2(lua_State* L, mfloat_t* matrix) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
+    mfloat_t** handle = (mfloat_t**)lua_newuserdatauv(L, sizeof(mfloat_t*), 0);
     *handle = matrix;
 
-    luaL_setmetatable(L, "matrix2_nogc");
+    luaL_setmetatable(L, "matrix2");
 
     return 1;
 }
 
-static int modules_matrix2_gc(lua_State* L) {
-    mfloat_t** handle = lua_touserdata(L, 1);
-    free(*handle);
-    *handle = NULL;
+int lua_outmatrix2(lua_State* L, int index, mfloat_t* result) {
+    if (lua_isnoneornil(L, index)) {
+        return lua_newmatrix2_from_matrix(L, result);
+    }
 
-    return 0;
+    mat2_assign(luaL_checkmatrix2(L, index), result);
+    lua_pushvalue(L, index);
+
+    return 1;
 }
 
 /**
@@ -111,17 +111,16 @@ static int modules_matrix2_determinant(lua_State* L) {
 /**
  * Negates a matrix.
  * @function negative
+ * @tparam ?matrix2 out Destination, a new matrix2 is returned if omitted
  * @treturn matrix2
  */
 static int modules_matrix2_negative(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT2_SIZE];
     mat2_negative(result, m0);
 
-    lua_newmatrix2_from_matrix(L, result);
+    lua_outmatrix2(L, 2, result);
 
     return 1;
 }
@@ -129,17 +128,16 @@ static int modules_matrix2_negative(lua_State* L) {
 /**
  * Transpose of matrix.
  * @function transpose
+ * @tparam ?matrix2 out Destination, a new matrix2 is returned if omitted
  * @treturn matrix2
  */
 static int modules_matrix2_transpose(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT2_SIZE];
     mat2_transpose(result, m0);
 
-    lua_newmatrix2_from_matrix(L, result);
+    lua_outmatrix2(L, 2, result);
 
     return 1;
 }
@@ -147,17 +145,16 @@ static int modules_matrix2_transpose(lua_State* L) {
 /**
  * Cofactor of matrix.
  * @function cofactor
+ * @tparam ?matrix2 out Destination, a new matrix2 is returned if omitted
  * @treturn matrix2
  */
 static int modules_matrix2_cofactor(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT2_SIZE];
     mat2_cofactor(result, m0);
 
-    lua_newmatrix2_from_matrix(L, result);
+    lua_outmatrix2(L, 2, result);
 
     return 1;
 }
@@ -165,17 +162,16 @@ static int modules_matrix2_cofactor(lua_State* L) {
 /**
  * Inverse of matrix.
  * @function inverse
+ * @tparam ?matrix2 out Destination, a new matrix2 is returned if omitted
  * @treturn matrix2
  */
 static int modules_matrix2_inverse(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT2_SIZE];
     mat2_inverse(result, m0);
 
-    lua_newmatrix2_from_matrix(L, result);
+    lua_outmatrix2(L, 2, result);
 
     return 1;
 }
@@ -280,13 +276,11 @@ static int modules_matrix2_rotate_z_axis(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix2(L, 1);
     mfloat_t f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT2_SIZE];
     mat2_assign(result, m0);
     mat2_rotation_z(result, f);
 
-    lua_newmatrix2_from_matrix(L, result);
+    lua_outmatrix2(L, 3, result);
 
     return 1;
 }
@@ -342,34 +336,28 @@ static int modules_matrix2_multiply(lua_State* L) {
     if (lua_isvector2(L, 2)) {
         mfloat_t* v0 = luaL_checkvector2(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t v1[VEC2_SIZE] = { v0[0], v0[1] };
         vec2_multiply_mat2(v1, v1, m0);
 
-        lua_newvector2(L, v1[0], v1[1]);
+        lua_outvector2(L, 3, v1);
     }
     // Scalar multiplication
     else if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[MAT2_SIZE];
         mat2_multiply_f(result, m0, f);
 
-        lua_newmatrix2_from_matrix(L, result);
+        lua_outmatrix2(L, 3, result);
     }
     // Matrix multiplication
     else {
         mfloat_t* m1 = luaL_checkmatrix2(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[MAT2_SIZE];
         mat2_multiply(result, m0, m1);
 
-        lua_newmatrix2_from_matrix(L, result);
+        lua_outmatrix2(L, 3, result);
     }
 
     return 1;
@@ -381,6 +369,7 @@ static int modules_matrix2_multiply(lua_State* L) {
  * @tparam matrix2.matrix2 m0
  * @tparam matrix2.matrix2 m1
  * @tparam number f
+ * @tparam ?matrix2 out Destination, a new matrix2 is returned if omitted
  * @treturn matrix2
  */
 static int modules_matrix2_lerp(lua_State* L) {
@@ -388,12 +377,37 @@ static int modules_matrix2_lerp(lua_State* L) {
     mfloat_t* m1 = luaL_checkmatrix2(L, 2);
     mfloat_t f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT2_SIZE];
     mat2_lerp(result, m0, m1, f);
 
-    lua_newmatrix2_from_matrix(L, result);
+    lua_outmatrix2(L, 4, result);
+
+    return 1;
+}
+
+/**
+ * Returns a matrix2 from a pool of temporaries. Values are handed out again
+ * next frame, so they must not be kept.
+ * @function scratch
+ * @tparam ?number ... Components, same as new
+ * @treturn matrix2
+ */
+static int modules_matrix2_scratch(lua_State* L) {
+    mfloat_t components[MAT2_SIZE];
+
+    for (int i = 0; i < MAT2_SIZE; i++) {
+        components[i] = (mfloat_t)luaL_optnumber(L, i + 1, 0);
+    }
+
+    lua_settop(L, 0);
+
+    if (lua_pushscratch(L, "matrix2")) {
+        mat2_assign(luaL_checkmatrix2(L, 1), components);
+    }
+    else {
+        lua_newmatrix2_from_matrix(L, components);
+        lua_addscratch(L, "matrix2");
+    }
 
     return 1;
 }
@@ -406,6 +420,7 @@ static const struct luaL_Reg modules_matrix2_functions[] = {
     {"transpose", modules_matrix2_transpose},
     // Module functions
     {"new", modules_matrix2_new},
+    {"scratch", modules_matrix2_scratch},
     {"zero", modules_matrix2_zero},
     {"identity", modules_matrix2_identity},
     {"rotate_z_axis", modules_matrix2_rotate_z_axis},
@@ -476,29 +491,39 @@ static int modules_matrix2_meta_newindex(lua_State* L) {
     return 0;
 }
 
+static const luaL_InPlaceReg modules_matrix2_in_place_functions[] = {
+    {"negative_", modules_matrix2_negative, 2},
+    {"transpose_", modules_matrix2_transpose, 2},
+    {"cofactor_", modules_matrix2_cofactor, 2},
+    {"inverse_", modules_matrix2_inverse, 2},
+    {"rotate_z_axis_", modules_matrix2_rotate_z_axis, 3},
+    {"multiply_", modules_matrix2_multiply, 3},
+    {"lerp_", modules_matrix2_lerp, 4},
+    {NULL, NULL, 0}
+};
+
+/* Unary minus passes its operand twice, which must not be taken as destination. */
+static int modules_matrix2_meta_unm(lua_State* L) {
+    lua_settop(L, 1);
+
+    return modules_matrix2_negative(L);
+}
+
 static const struct luaL_Reg modules_matrix2_meta_functions[] = {
     {"__index", modules_matrix2_meta_index},
     {"__newindex", modules_matrix2_meta_newindex},
     {"__mul", modules_matrix2_multiply},
-    {"__unm", modules_matrix2_negative},
+    {"__unm", modules_matrix2_meta_unm},
     {NULL, NULL}
 };
 
 int luaopen_matrix2(lua_State* L) {
     luaL_newlib(L, modules_matrix2_functions);
+    luaL_setinplacefuncs(L, modules_matrix2_in_place_functions);
 
     luaL_newmetatable(L, "matrix2");
     luaL_setfuncs(L, modules_matrix2_meta_functions, 0);
 
-    lua_pushstring(L, "__gc");
-    lua_pushcfunction(L, modules_matrix2_gc);
-    lua_settable(L, -3);
-
-    lua_pop(L, 1);
-
-    luaL_newmetatable(L, "matrix2_nogc");
-    luaL_setfuncs(L, modules_matrix2_meta_functions, 0);
-
     lua_pop(L, 1);
 
     return 1;
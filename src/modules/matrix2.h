@@ -16,9 +16,12 @@ mfloat_t* luaL_checkmatrix2(lua_State* L, int index);
 /* Creates and pushes on the stack a new matrix2 userdata. */
 int lua_newmatrix2(lua_State* L, float m11, float m21, float m12, float m22);
 
-/* Pushes a matrix2 onto the stack. Created userdata will not be garbage collected. */
+/* Pushes a matrix2 onto the stack. Created userdata references given data, which must outlive it. */
 int lua_pushmatrix2(lua_State* L, mfloat_t* matrix);
 
+/* Pushes given result, copied into the matrix2 at index if there is one or into a new matrix2 otherwise. */
+int lua_outmatrix2(lua_State* L, int index, mfloat_t* result);
+
 int luaopen_matrix2(lua_State* L);
 
 #endif
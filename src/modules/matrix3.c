@@ -13,32 +13,29 @@
 
 #include "matrix3.h"
 #include "quaternion.h"
+#include "scratch.h"
 #include "vector3.h"
 
-bool lua_ismatrix3(lua_State*L, int index) {
-    void* p = luaL_testudata(L, index, "matrix3");
-    if (p == NULL) {
-        p = luaL_testudata(L, index, "matrix3_nogc");
-    }
+/**
+ * Userdata layout. Values created from Lua store their components inline and
+ * point at them, values pushed from C only store the pointer.
+ */
+typedef struct {
+    mfloat_t* components;
+    mfloat_t storage[MAT3_SIZE];
+} matrix3_userdata_t;
 
-    return p != NULL;
+bool lua_ismatrix3(lua_State* L, int index) {
+    return luaL_testudata(L, index, "matrix3") != NULL;
 }
 
 mfloat_t* luaL_checkmatrix3(lua_State* L, int index) {
-    mfloat_t** handle = NULL;
-    luaL_checktype(L, index, LUA_TUSERDATA);
-
-    handle = (mfloat_t**)luaL_testudata(L, index, "matrix3_nogc");
-    if (!handle) {
-        handle = (mfloat_t**)luaL_checkudata(L, index, "matrix3");
-    }
-
-    return *handle;
+    return *(mfloat_t**)luaL_checkudata(L, index, "matrix3");
 }
 
 int lua_newmatrix3(lua_State* L, float m11, float m21, float m31, float m12, float m22, float m32, float m13, float m23, float m33) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* m0 = (mfloat_t*)malloc(sizeof(mfloat_t) * MAT3_SIZE);
+    matrix3_userdata_t* userdata = (matrix3_userdata_t*)lua_newuserdatauv(L, sizeof(matrix3_userdata_t), 0);
+    mfloat_t* m0 = userdata->storage;
     m0[0] = m11;
     m0[1] = m21;
     m0[2] = m31;
@@ -49,7 +46,7 @@ int lua_newmatrix3(lua_State* L, float m11, float m21, float m31, float m12, flo
     m0[7] = m23;
     m0[8] = m33;
 
-    *handle = m0;
+    userdata->components = m0;
 
     luaL_setmetatable(L, "matrix3");
 
@@ -57,8 +54,8 @@ int lua_newmatrix3(lua_State* L, float m11, float m21, float m31, float m12, flo
 }
 
 int lua_newmatrix3_from_matrix(lua_State* L, mfloat_t* m0) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* m1 = (mfloat_t*)malloc(sizeof(mfloat_t) * MAT3_SIZE);
+    matrix3_userdata_t* userdata = (matrix3_userdata_t*)lua_newuserdatauv(L, sizeof(matrix3_userdata_t), 0);
+    mfloat_t* m1 = userdata->storage;
     m1[0] = m0[0];
     m1[1] = m0[1];
     m1[2] = m0[2];
@@ -69,7 +66,7 @@ int lua_newmatrix3_from_matrix(lua_State* L, mfloat_t* m0) {
     m1[7] = m0[7];
     m1[8] = m0[8];
 
-    *handle = m1;
+    userdata->components = m1;
 
     luaL_setmetatable(L, "matrix3");
 
@@ -77,20 +74,23 @@ int lua_newmatrix3_from_matrix(lua_State* L, mfloat_t* m0) {
 }
 
 int lua_pushmatrix3(lua_State* L, mfloat_t* matrix) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
+    mfloat_t** handle = (mfloat_t**)lua_newuserdatauv(L, sizeof(mfloat_t*), 0);
     *handle = matrix;
 
-    luaL_setmetatable(L, "matrix3_nogc");
+    luaL_setmetatable(L, "matrix3");
 
     return 1;
 }
 
-static int modules_matrix3_gc(lua_State* L) {
-    mfloat_t** handle = lua_touserdata(L, 1);
-    free(*handle);
-    *handle = NULL;
+int lua_outmatrix3(lua_State* L, int index, mfloat_t* result) {
+    if (lua_isnoneornil(L, index)) {
+        return lua_newmatrix3_from_matrix(L, result);
+    }
 
-    return 0;
+    mat3_assign(luaL_checkmatrix3(L, index), result);
+    lua_pushvalue(L, index);
+
+    return 1;
 }
 
 /**
@@ -127,17 +127,16 @@ static int modules_matrix3_determinant(lua_State* L) {
 /**
  * Negates a matrix.
  * @function negative
+ * @tparam ?matrix3 out Destination, a new matrix3 is returned if omitted
  * @treturn matrix3
  */
 static int modules_matrix3_negative(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_negative(result, m0);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 2, result);
 
     return 1;
 }
@@ -145,17 +144,16 @@ static int modules_matrix3_negative(lua_State* L) {
 /**
  * Transpose of matrix.
  * @function transpose
+ * @tparam ?matrix3 out Destination, a new matrix3 is returned if omitted
  * @treturn matrix3
  */
 static int modules_matrix3_transpose(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_transpose(result, m0);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 2, result);
 
     return 1;
 }
@@ -163,17 +161,16 @@ static int modules_matrix3_transpose(lua_State* L) {
 /**
  * Cofactor of matrix.
  * @function cofactor
+ * @tparam ?matrix3 out Destination, a new matrix3 is returned if omitted
  * @treturn matrix3
  */
 static int modules_matrix3_cofactor(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_cofactor(result, m0);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 2, result);
 
     return 1;
 }
@@ -181,17 +178,16 @@ static int modules_matrix3_cofactor(lua_State* L) {
 /**
  * Inverse of matrix.
  * @function inverse
+ * @tparam ?matrix3 out Destination, a new matrix3 is returned if omitted
  * @treturn matrix3
  */
 static int modules_matrix3_inverse(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_inverse(result, m0);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 2, result);
 
     return 1;
 }
@@ -308,13 +304,11 @@ static int modules_matrix3_rotate_x_axis(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix3(L, 1);
     mfloat_t f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_assign(result, m0);
     mat3_rotation_x(result, f);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 3, result);
 
     return 1;
 }
@@ -323,13 +317,11 @@ static int modules_matrix3_rotate_y_axis(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix3(L, 1);
     mfloat_t f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_assign(result, m0);
     mat3_rotation_y(result, f);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 3, result);
 
     return 1;
 }
@@ -338,13 +330,11 @@ static int modules_matrix3_rotate_z_axis(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix3(L, 1);
     mfloat_t f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_assign(result, m0);
     mat3_rotation_z(result, f);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 3, result);
 
     return 1;
 }
@@ -354,13 +344,11 @@ static int modules_matrix3_rotate_around_axis(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 2);
     mfloat_t f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_assign(result, m0);
     mat3_rotation_axis(result, v0, f);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 4, result);
 
     return 1;
 }
@@ -369,17 +357,16 @@ static int modules_matrix3_rotate_around_axis(lua_State* L) {
  * Creates a rotation matrix
  * @function rotation
  * @tparam quaternion.quaternion q0
+ * @tparam ?matrix3 out Destination, a new matrix3 is returned if omitted
  * @treturn matrix3
  */
 static int modules_matrix3_rotation_quaternion(lua_State* L) {
     mfloat_t* q0 = luaL_checkquaternion(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_rotation_quat(result, q0);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 2, result);
 
     return 1;
 }
@@ -437,34 +424,28 @@ static int modules_matrix3_multiply(lua_State* L) {
     if (lua_isvector3(L, 2)) {
         mfloat_t* v0 = luaL_checkvector3(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t v1[VEC3_SIZE] = { v0[0], v0[1], v0[2] };
         vec3_multiply_mat3(v1, v1, m0);
 
-        lua_newvector3(L, v1[0], v1[1], v1[2]);
+        lua_outvector3(L, 3, v1);
     }
     // Scalar multiplication
     else if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[MAT3_SIZE];
         mat3_multiply_f(result, m0, f);
 
-        lua_newmatrix3_from_matrix(L, result);
+        lua_outmatrix3(L, 3, result);
     }
     // Matrix multiplication
     else {
         mfloat_t* m1 = luaL_checkmatrix3(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[MAT3_SIZE];
         mat3_multiply(result, m0, m1);
 
-        lua_newmatrix3_from_matrix(L, result);
+        lua_outmatrix3(L, 3, result);
     }
 
     return 1;
@@ -476,6 +457,7 @@ static int modules_matrix3_multiply(lua_State* L) {
  * @tparam matrix3.matrix3 m0
  * @tparam matrix3.matrix3 m1
  * @tparam number f
+ * @tparam ?matrix3 out Destination, a new matrix3 is returned if omitted
  * @treturn matrix3
  */
 static int modules_matrix3_lerp(lua_State* L) {
@@ -483,12 +465,37 @@ static int modules_matrix3_lerp(lua_State* L) {
     mfloat_t* m1 = luaL_checkmatrix3(L, 2);
     mfloat_t f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT3_SIZE];
     mat3_lerp(result, m0, m1, f);
 
-    lua_newmatrix3_from_matrix(L, result);
+    lua_outmatrix3(L, 4, result);
+
+    return 1;
+}
+
+/**
+ * Returns a matrix3 from a pool of temporaries. Values are handed out again
+ * next frame, so they must not be kept.
+ * @function scratch
+ * @tparam ?number ... Components, same as new
+ * @treturn matrix3
+ */
+static int modules_matrix3_scratch(lua_State* L) {
+    mfloat_t components[MAT3_SIZE];
+
+    for (int i = 0; i < MAT3_SIZE; i++) {
+        components[i] = (mfloat_t)luaL_optnumber(L, i + 1, 0);
+    }
+
+    lua_settop(L, 0);
+
+    if (lua_pushscratch(L, "matrix3")) {
+        mat3_assign(luaL_checkmatrix3(L, 1), components);
+    }
+    else {
+        lua_newmatrix3_from_matrix(L, components);
+        lua_addscratch(L, "matrix3");
+    }
 
     return 1;
 }
@@ -501,6 +508,7 @@ static const struct luaL_Reg modules_matrix3_functions[] = {
     {"transpose", modules_matrix3_transpose},
     // Module functions
     {"new", modules_matrix3_new},
+    {"scratch", modules_matrix3_scratch},
     {"zero", modules_matrix3_zero},
     {"identity", modules_matrix3_identity},
     {"rotate_x_axis", modules_matrix3_rotate_x_axis},
@@ -610,29 +618,42 @@ static int modules_matrix3_meta_newindex(lua_State* L) {
     return 0;
 }
 
+static const luaL_InPlaceReg modules_matrix3_in_place_functions[] = {
+    {"negative_", modules_matrix3_negative, 2},
+    {"transpose_", modules_matrix3_transpose, 2},
+    {"cofactor_", modules_matrix3_cofactor, 2},
+    {"inverse_", modules_matrix3_inverse, 2},
+    {"rotate_x_axis_", modules_matrix3_rotate_x_axis, 3},
+    {"rotate_y_axis_", modules_matrix3_rotate_y_axis, 3},
+    {"rotate_z_axis_", modules_matrix3_rotate_z_axis, 3},
+    {"rotate_around_axis_", modules_matrix3_rotate_around_axis, 4},
+    {"multiply_", modules_matrix3_multiply, 3},
+    {"lerp_", modules_matrix3_lerp, 4},
+    {NULL, NULL, 0}
+};
+
+/* Unary minus passes its operand twice, which must not be taken as destination. */
+static int modules_matrix3_meta_unm(lua_State* L) {
+    lua_settop(L, 1);
+
+    return modules_matrix3_negative(L);
+}
+
 static const struct luaL_Reg modules_matrix3_meta_functions[] = {
     {"__index", modules_matrix3_meta_index},
     {"__newindex", modules_matrix3_meta_newindex},
     {"__mul", modules_matrix3_multiply},
-    {"__unm", modules_matrix3_negative},
+    {"__unm", modules_matrix3_meta_unm},
     {NULL, NULL}
 };
 
 int luaopen_matrix3(lua_State* L) {
     luaL_newlib(L, modules_matrix3_functions);
+    luaL_setinplacefuncs(L, modules_matrix3_in_place_functions);
 
     luaL_newmetatable(L, "matrix3");
     luaL_setfuncs(L, modules_matrix3_meta_functions, 0);
 
-    lua_pushstring(L, "__gc");
-    lua_pushcfunction(L, modules_matrix3_gc);
-    lua_settable(L, -3);
-
-    lua_pop(L, 1);
-
-    luaL_newmetatable(L, "matrix3_nogc");
-    luaL_setfuncs(L, modules_matrix3_meta_functions, 0);
-
     lua_pop(L, 1);
 
     return 1;
@@ -16,9 +16,12 @@ mfloat_t* luaL_checkmatrix3(lua_State* L, int index);
 /* Creates and pushes on the stack a new matrix3 userdata. */
 int lua_newmatrix3(lua_State* L, float m11, float m21, float m31, float m12, float m22, float m32, float m13, float m23, float m33);
 
-/* Pushes a matrix3 onto the stack. Created userdata will not be garbage collected. */
+/* Pushes a matrix3 onto the stack. Created userdata references given data, which must outlive it. */
 int lua_pushmatrix3(lua_State* L, mfloat_t* matrix);
 
+/* Pushes given result, copied into the matrix3 at index if there is one or into a new matrix3 otherwise. */
+int lua_outmatrix3(lua_State* L, int index, mfloat_t* result);
+
 int luaopen_matrix3(lua_State* L);
 
 #endif
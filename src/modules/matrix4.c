@@ -11,35 +11,35 @@
 
 #include <mathc/mathc.h>
 
+#include "float_array.h"
 #include "matrix4.h"
 #include "quaternion.h"
+#include "scratch.h"
 #include "vector3.h"
 #include "vector4.h"
 
-bool lua_ismatrix4(lua_State*L, int index) {
-    void* p = luaL_testudata(L, index, "matrix4");
-    if (p == NULL) {
-        p = luaL_testudata(L, index, "matrix4_nogc");
-    }
+#include "../batch.h"
+
+/**
+ * Userdata layout. Values created from Lua store their components inline and
+ * point at them, values pushed from C only store the pointer.
+ */
+typedef struct {
+    mfloat_t* components;
+    mfloat_t storage[MAT4_SIZE];
+} matrix4_userdata_t;
 
-    return p != NULL;
+bool lua_ismatrix4(lua_State* L, int index) {
+    return luaL_testudata(L, index, "matrix4") != NULL;
 }
 
 mfloat_t* luaL_checkmatrix4(lua_State* L, int index) {
-    mfloat_t** handle = NULL;
-    luaL_checktype(L, index, LUA_TUSERDATA);
-
-    handle = (mfloat_t**)luaL_testudata(L, index, "matrix4_nogc");
-    if (!handle) {
-        handle = (mfloat_t**)luaL_checkudata(L, index, "matrix4");
-    }
-
-    return *handle;
+    return *(mfloat_t**)luaL_checkudata(L, index, "matrix4");
 }
 
 int lua_newmatrix4(lua_State* L, float m11, float m21, float m31, float m41, float m12, float m22, float m32, float m42, float m13, float m23, float m33, float m43, float m14, float m24, float m34, float m44) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* m0 = (mfloat_t*)malloc(sizeof(mfloat_t) * MAT4_SIZE);
+    matrix4_userdata_t* userdata = (matrix4_userdata_t*)lua_newuserdatauv(L, sizeof(matrix4_userdata_t), 0);
+    mfloat_t* m0 = userdata->storage;
     m0[0] = m11;
     m0[1] = m21;
     m0[2] = m31;
@@ -57,7 +57,7 @@ int lua_newmatrix4(lua_State* L, float m11, float m21, float m31, float m41, flo
     m0[14] = m34;
     m0[15] = m44;
 
-    *handle = m0;
+    userdata->components = m0;
 
     luaL_setmetatable(L, "matrix4");
 
@@ -65,8 +65,8 @@ int lua_newmatrix4(lua_State* L, float m11, float m21, float m31, float m41, flo
 }
 
 int lua_newmatrix4_from_matrix(lua_State* L, mfloat_t* m0) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* m1 = (mfloat_t*)malloc(sizeof(mfloat_t) * MAT4_SIZE);
+    matrix4_userdata_t* userdata = (matrix4_userdata_t*)lua_newuserdatauv(L, sizeof(matrix4_userdata_t), 0);
+    mfloat_t* m1 = userdata->storage;
     m1[0] = m0[0];
     m1[1] = m0[1];
     m1[2] = m0[2];
@@ -84,7 +84,7 @@ int lua_newmatrix4_from_matrix(lua_State* L, mfloat_t* m0) {
     m1[14] = m0[14];
     m1[15] = m0[15];
 
-    *handle = m1;
+    userdata->components = m1;
 
     luaL_setmetatable(L, "matrix4");
 
@@ -92,20 +92,23 @@ int lua_newmatrix4_from_matrix(lua_State* L, mfloat_t* m0) {
 }
 
 int lua_pushmatrix4(lua_State* L, mfloat_t* matrix) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
+    mfloat_t** handle = (mfloat_t**)lua_newuserdatauv(L, sizeof(mfloat_t*), 0);
     *handle = matrix;
 
-    luaL_setmetatable(L, "matrix4_nogc");
+    luaL_setmetatable(L, "matrix4");
 
     return 1;
 }
 
-static int modules_matrix4_gc(lua_State* L) {
-    mfloat_t** handle = lua_touserdata(L, 1);
-    free(*handle);
-    *handle = NULL;
+int lua_outmatrix4(lua_State* L, int index, mfloat_t* result) {
+    if (lua_isnoneornil(L, index)) {
+        return lua_newmatrix4_from_matrix(L, result);
+    }
 
-    return 0;
+    mat4_assign(luaL_checkmatrix4(L, index), result);
+    lua_pushvalue(L, index);
+
+    return 1;
 }
 
 /**
@@ -149,17 +152,16 @@ static int modules_matrix4_determinant(lua_State* L) {
 /**
  * Negates a matrix.
  * @function negative
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_negative(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_negative(result, m0);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 2, result);
 
     return 1;
 }
@@ -167,17 +169,16 @@ static int modules_matrix4_negative(lua_State* L) {
 /**
  * Transpose of matrix.
  * @function transpose
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_transpose(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_transpose(result, m0);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 2, result);
 
     return 1;
 }
@@ -185,17 +186,16 @@ static int modules_matrix4_transpose(lua_State* L) {
 /**
  * Cofactor of matrix.
  * @function cofactor
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_cofactor(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_cofactor(result, m0);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 2, result);
 
     return 1;
 }
@@ -203,17 +203,16 @@ static int modules_matrix4_cofactor(lua_State* L) {
 /**
  * Inverse of matrix.
  * @function inverse
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_inverse(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_inverse(result, m0);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 2, result);
 
     return 1;
 }
@@ -389,13 +388,11 @@ static int modules_matrix4_rotate_x_axis(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
     mfloat_t f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_assign(result, m0);
     mat4_rotation_x(result, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 3, result);
 
     return 1;
 }
@@ -404,13 +401,11 @@ static int modules_matrix4_rotate_y_axis(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
     mfloat_t f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_assign(result, m0);
     mat4_rotation_y(result, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 3, result);
 
     return 1;
 }
@@ -419,13 +414,11 @@ static int modules_matrix4_rotate_z_axis(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
     mfloat_t f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_assign(result, m0);
     mat4_rotation_z(result, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 3, result);
 
     return 1;
 }
@@ -435,13 +428,11 @@ static int modules_matrix4_rotate_around_axis(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 2);
     mfloat_t f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_assign(result, m0);
     mat4_rotation_axis(result, v0, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 4, result);
 
     return 1;
 }
@@ -450,17 +441,16 @@ static int modules_matrix4_rotate_around_axis(lua_State* L) {
  * Creates a rotation matrix
  * @function rotation
  * @tparam quaternion.quaternion q0
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_rotation_quaternion(lua_State* L) {
     mfloat_t* q0 = luaL_checkquaternion(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_rotation_quat(result, q0);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 2, result);
 
     return 1;
 }
@@ -564,45 +554,37 @@ static int modules_matrix4_multiply(lua_State* L) {
     if (lua_isvector4(L, 2)) {
         mfloat_t* v0 = luaL_checkvector4(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE] = { 0.0f, 0.0f, 0.0f, 1.0f };
         vec4_multiply_mat4(result, v0, m0);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
     }
     // vector3 multiplication
     else if (lua_isvector3(L, 2)) {
         mfloat_t* v0 = luaL_checkvector3(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t v1[VEC4_SIZE] = { v0[0], v0[1], v0[2], 1.0f };
         vec4_multiply_mat4(v1, v1, m0);
 
-        lua_newvector3(L, v1[0], v1[1], v1[2]);
+        lua_outvector3(L, 3, v1);
     }
     // Scalar multiplication
     else if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[MAT4_SIZE];
         mat4_multiply_f(result, m0, f);
 
-        lua_newmatrix4_from_matrix(L, result);
+        lua_outmatrix4(L, 3, result);
     }
     // Matrix multiplication
     else {
         mfloat_t* m1 = luaL_checkmatrix4(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[MAT4_SIZE];
         mat4_multiply(result, m0, m1);
 
-        lua_newmatrix4_from_matrix(L, result);
+        lua_outmatrix4(L, 3, result);
     }
 
     return 1;
@@ -614,6 +596,7 @@ static int modules_matrix4_multiply(lua_State* L) {
  * @tparam matrix4.matrix4 m0
  * @tparam matrix4.matrix4 m1
  * @tparam number f
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_lerp(lua_State* L) {
@@ -621,12 +604,10 @@ static int modules_matrix4_lerp(lua_State* L) {
     mfloat_t* m1 = luaL_checkmatrix4(L, 2);
     mfloat_t f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_lerp(result, m0, m1, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 4, result);
 
     return 1;
 }
@@ -637,6 +618,7 @@ static int modules_matrix4_lerp(lua_State* L) {
  * @tparam vector3.vector3 position
  * @tparam vector3.vector3 target
  * @tparam vector3.vector3 up
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_look_at(lua_State* L) {
@@ -644,12 +626,10 @@ static int modules_matrix4_look_at(lua_State* L) {
     mfloat_t* target = luaL_checkvector3(L, 2);
     mfloat_t* up = luaL_checkvector3(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[MAT4_SIZE];
     mat4_look_at(result, position, target, up);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 4, result);
 
     return 1;
 }
@@ -663,6 +643,7 @@ static int modules_matrix4_look_at(lua_State* L) {
  * @tparam number t
  * @tparam number n
  * @tparam number f
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_ortho(lua_State* L) {
@@ -676,7 +657,7 @@ static int modules_matrix4_ortho(lua_State* L) {
     mfloat_t result[MAT4_SIZE];
     mat4_ortho(result, l, r, b, t, n, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 7, result);
     return 1;
 }
 
@@ -687,6 +668,7 @@ static int modules_matrix4_ortho(lua_State* L) {
  * @tparam number aspect
  * @tparam number n
  * @tparam number f
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_perspective(lua_State* L) {
@@ -698,7 +680,7 @@ static int modules_matrix4_perspective(lua_State* L) {
     mfloat_t result[MAT4_SIZE];
     mat4_perspective(result, fov_y, aspect, n, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 5, result);
     return 1;
 }
 
@@ -710,6 +692,7 @@ static int modules_matrix4_perspective(lua_State* L) {
  * @tparam number h
  * @tparam number n
  * @tparam number f
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_perspective_fov(lua_State* L) {
@@ -722,7 +705,7 @@ static int modules_matrix4_perspective_fov(lua_State* L) {
     mfloat_t result[MAT4_SIZE];
     mat4_perspective_fov(result, fov_y, w, h, n, f);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 6, result);
     return 1;
 }
 
@@ -732,6 +715,7 @@ static int modules_matrix4_perspective_fov(lua_State* L) {
  * @tparam number fov_y
  * @tparam number aspect
  * @tparam number n
+ * @tparam ?matrix4 out Destination, a new matrix4 is returned if omitted
  * @treturn matrix4
  */
 static int modules_matrix4_perspective_infinite(lua_State* L) {
@@ -742,7 +726,84 @@ static int modules_matrix4_perspective_infinite(lua_State* L) {
     mfloat_t result[MAT4_SIZE];
     mat4_perspective_infinite(result, fov_y, aspect, n);
 
-    lua_newmatrix4_from_matrix(L, result);
+    lua_outmatrix4(L, 4, result);
+    return 1;
+}
+
+/**
+ * Transforms all points in a floatarray. Points have w of 1.
+ * @function transform_points
+ * @tparam matrix4 m0
+ * @tparam floatarray points Points with x, y and z components.
+ * @tparam ?floatarray out Destination, grown if needed. May be points. A new floatarray is returned if omitted.
+ * @tparam ?integer stride Floats between points, default 3. With 4 or more, w is stored as fourth component.
+ * @treturn floatarray
+ */
+static int modules_matrix4_transform_points(lua_State* L) {
+    mfloat_t* m0 = luaL_checkmatrix4(L, 1);
+    float_array_t* points = luaL_checkfloatarray(L, 2);
+    size_t stride = luaL_optbatchstride(L, 4);
+    size_t count = points->size / stride;
+
+    float_array_t* out = lua_outfloatarray(L, 3, count * stride);
+
+    batch_points_transform(out->data, points->data, count, stride, m0);
+
+    return 1;
+}
+
+/**
+ * Projects all points in a floatarray to screen. Points are transformed,
+ * divided by w and mapped to the viewport. Stores screen x and y and depth,
+ * plus w if stride is 4 or more. Points with w of 0 or less are behind the
+ * camera.
+ * @function project_points
+ * @tparam matrix4 m0 View projection matrix.
+ * @tparam floatarray points Points with x, y and z components.
+ * @tparam ?floatarray out Destination, grown if needed. May be points. A new floatarray is returned if omitted.
+ * @tparam number width Viewport width.
+ * @tparam number height Viewport height.
+ * @tparam ?integer stride Floats between points, default 3.
+ * @treturn floatarray
+ */
+static int modules_matrix4_project_points(lua_State* L) {
+    mfloat_t* m0 = luaL_checkmatrix4(L, 1);
+    float_array_t* points = luaL_checkfloatarray(L, 2);
+    float viewport[4] = {0.0f, 0.0f, (float)luaL_checknumber(L, 4), (float)luaL_checknumber(L, 5)};
+    size_t stride = luaL_optbatchstride(L, 6);
+    size_t count = points->size / stride;
+
+    float_array_t* out = lua_outfloatarray(L, 3, count * stride);
+
+    batch_points_project(out->data, points->data, count, stride, m0, viewport);
+
+    return 1;
+}
+
+/**
+ * Returns a matrix4 from a pool of temporaries. Values are handed out again
+ * next frame, so they must not be kept.
+ * @function scratch
+ * @tparam ?number ... Components, same as new
+ * @treturn matrix4
+ */
+static int modules_matrix4_scratch(lua_State* L) {
+    mfloat_t components[MAT4_SIZE];
+
+    for (int i = 0; i < MAT4_SIZE; i++) {
+        components[i] = (mfloat_t)luaL_optnumber(L, i + 1, 0);
+    }
+
+    lua_settop(L, 0);
+
+    if (lua_pushscratch(L, "matrix4")) {
+        mat4_assign(luaL_checkmatrix4(L, 1), components);
+    }
+    else {
+        lua_newmatrix4_from_matrix(L, components);
+        lua_addscratch(L, "matrix4");
+    }
+
     return 1;
 }
 
@@ -755,6 +816,7 @@ static const struct luaL_Reg modules_matrix4_functions[] = {
     {"transpose", modules_matrix4_transpose},
     // Module functions
     {"new", modules_matrix4_new},
+    {"scratch", modules_matrix4_scratch},
     {"zero", modules_matrix4_zero},
     {"identity", modules_matrix4_identity},
     {"rotate_x_axis", modules_matrix4_rotate_x_axis},
@@ -771,6 +833,8 @@ static const struct luaL_Reg modules_matrix4_functions[] = {
     {"perspective", modules_matrix4_perspective},
     {"perspective_fov", modules_matrix4_perspective_fov},
     {"perspective_infinite", modules_matrix4_perspective_infinite},
+    {"transform_points", modules_matrix4_transform_points},
+    {"project_points", modules_matrix4_project_points},
     {NULL, NULL}
 };
 
@@ -919,29 +983,42 @@ static int modules_matrix4_meta_newindex(lua_State* L) {
     return 0;
 }
 
+static const luaL_InPlaceReg modules_matrix4_in_place_functions[] = {
+    {"negative_", modules_matrix4_negative, 2},
+    {"transpose_", modules_matrix4_transpose, 2},
+    {"cofactor_", modules_matrix4_cofactor, 2},
+    {"inverse_", modules_matrix4_inverse, 2},
+    {"rotate_x_axis_", modules_matrix4_rotate_x_axis, 3},
+    {"rotate_y_axis_", modules_matrix4_rotate_y_axis, 3},
+    {"rotate_z_axis_", modules_matrix4_rotate_z_axis, 3},
+    {"rotate_around_axis_", modules_matrix4_rotate_around_axis, 4},
+    {"multiply_", modules_matrix4_multiply, 3},
+    {"lerp_", modules_matrix4_lerp, 4},
+    {NULL, NULL, 0}
+};
+
+/* Unary minus passes its operand twice, which must not be taken as destination. */
+static int modules_matrix4_meta_unm(lua_State* L) {
+    lua_settop(L, 1);
+
+    return modules_matrix4_negative(L);
+}
+
 static const struct luaL_Reg modules_matrix4_meta_functions[] = {
     {"__index", modules_matrix4_meta_index},
     {"__newindex", modules_matrix4_meta_newindex},
     {"__mul", modules_matrix4_multiply},
-    {"__unm", modules_matrix4_negative},
+    {"__unm", modules_matrix4_meta_unm},
     {NULL, NULL}
 };
 
 int luaopen_matrix4(lua_State* L) {
     luaL_newlib(L, modules_matrix4_functions);
+    luaL_setinplacefuncs(L, modules_matrix4_in_place_functions);
 
     luaL_newmetatable(L, "matrix4");
     luaL_setfuncs(L, modules_matrix4_meta_functions, 0);
 
-    lua_pushstring(L, "__gc");
-    lua_pushcfunction(L, modules_matrix4_gc);
-    lua_settable(L, -3);
-
-    lua_pop(L, 1);
-
-    luaL_newmetatable(L, "matrix4_nogc");
-    luaL_setfuncs(L, modules_matrix4_meta_functions, 0);
-
     lua_pop(L, 1);
 
     return 1;
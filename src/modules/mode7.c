@@ -0,0 +1,310 @@
+/**
+ * Module for mode7 renderer
+ *
+ * @usage
+ * mode7 = require('mode7')
+ *
+ * -- Ground plane and sprite
+ * track = assets.get_texture('track.gif')
+ * kart = assets.get_texture('kart.gif')
+ * kart_position = vector3.new(8, 8, 0)
+ *
+ * -- Camera info. The z-component of the position is height above the plane.
+ * position = vector3.new(0, 0, 1)
+ * direction = vector2.new(0, 1)
+ * fov = 90
+ *
+ * renderer = mode7.Renderer:new()
+ * renderer:feature('fogdistance', 48)
+ *
+ * -- Render loop
+ * renderer:clear('all')
+ * renderer:camera(position, direction, fov)
+ * renderer:render(track)
+ * renderer:render(kart, kart_position)
+ *
+ * @module mode7
+ */
+
+#include <float.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <lua/lua.h>
+#include <lua/lauxlib.h>
+#include <lua/lualib.h>
+
+#include <mathc/mathc.h>
+
+#include "mode7.h"
+#include "texture.h"
+#include "vector2.h"
+#include "vector3.h"
+
+#include "../renderers/mode7.h"
+
+static mode7_renderer_t* luaL_checkmode7renderer(lua_State* L, int index) {
+    mode7_renderer_t** handle = NULL;
+    luaL_checktype(L, index, LUA_TUSERDATA);
+    handle = (mode7_renderer_t**)luaL_checkudata(L, index, "mode7_renderer");
+
+    if (!handle) {
+        luaL_typeerror(L, index, "mode7_renderer");
+    }
+
+    return *handle;
+}
+
+static int lua_newmode7renderer(lua_State* L) {
+    texture_t* render_texture = luaL_opttexture(L, 2, graphics_render_texture_get());
+    mode7_renderer_t** handle = (mode7_renderer_t**)lua_newuserdata(L, sizeof(mode7_renderer_t*));
+    *handle = mode7_renderer_new(render_texture);
+    luaL_setmetatable(L, "mode7_renderer");
+
+    return 1;
+}
+
+/**
+ * @type Renderer
+ */
+
+/**
+ * Creates a mode7 renderer object.
+ * @function Renderer:new
+ * @tparam ?texture.texture texture Texture to render to. Defaults to the render texture.
+ * @treturn Renderer
+ */
+static int modules_mode7_renderer_new(lua_State* L) {
+    return lua_newmode7renderer(L);
+}
+
+/**
+ * Clears internal buffers.
+ * @function Renderer:clear
+ * @tparam ?string target One of: "all" (default), "color", or "depth".
+ */
+static int modules_mode7_renderer_clear(lua_State* L) {
+    mode7_renderer_t* renderer = luaL_checkmode7renderer(L, 1);
+
+    const char* name = luaL_optstring(L, 2, "all");
+
+    if (strcmp(name, "all") == 0) {
+        color_t color = (color_t)luaL_optnumber(L, 3, 0);
+        float depth = luaL_optnumber(L, 4, FLT_MAX);
+
+        mode7_renderer_clear_color(renderer, color);
+        mode7_renderer_clear_depth(renderer, depth);
+    }
+    else if (strcmp(name, "depth") == 0) {
+        float depth = luaL_optnumber(L, 3, FLT_MAX);
+        mode7_renderer_clear_depth(renderer, depth);
+    }
+    else if (strcmp(name, "color") == 0) {
+        color_t color = (color_t)luaL_optnumber(L, 3, 0);
+        mode7_renderer_clear_color(renderer, color);
+    }
+    else {
+        luaL_argerror(L, 2, lua_pushfstring(L, "invalid option '%s'", name));
+    }
+
+    return 0;
+}
+
+/**
+ * Renders given texture as the ground plane.
+ * @function Renderer:render
+ * @tparam texture.texture plane Texture to render.
+ */
+
+/**
+ * Renders given sprite standing on the plane.
+ * @function Renderer:render
+ * @tparam texture.texture sprite Sprite to render.
+ * @tparam vector3.vector3 position Position of sprite. The z-component is height above the plane.
+ */
+static int modules_mode7_renderer_render(lua_State* L) {
+    mode7_renderer_t* renderer = luaL_checkmode7renderer(L, 1);
+    texture_t* texture = luaL_checktexture(L, 2);
+
+    if (lua_gettop(L) > 2) {
+        mfloat_t* position = luaL_checkvector3(L, 3);
+        mode7_renderer_render_sprite(renderer, texture, position);
+    }
+    else {
+        mode7_renderer_render_plane(renderer, texture);
+    }
+
+    return 0;
+}
+
+/**
+ * Set renderer's camera data.
+ * @function Renderer:camera
+ * @tparam vector3.vector3 position Camera position. The z-component is height above the plane.
+ * @tparam vector2.vector2 direction Camera forward vector.
+ * @tparam number fov Camera field of view in degrees.
+*/
+static int modules_mode7_renderer_camera(lua_State* L) {
+    mode7_renderer_t* renderer = luaL_checkmode7renderer(L, 1);
+    mfloat_t* position = luaL_checkvector3(L, 2);
+    mfloat_t* direction = luaL_checkvector2(L, 3);
+    float fov = luaL_checknumber(L, 4);
+
+    mode7_renderer_camera(renderer, position, direction, fov);
+
+    return 0;
+}
+
+/**
+ * Access renderer's features. If just the feature name is provided, the value of
+ * that feature will be returned. If a value is provided, the feature will be set to that value.
+ *
+ * **Features:**
+ *
+ *  * <span class="parameter">'fogdistance'</span> number Distance at which fog is fully dark.
+ *  * <span class="parameter">'shadetable'</span> @{texture} Texture to use to shade colors using distance. Setting to nil will render full bright.
+ *  * <span class="parameter">'wrap'</span> boolean Should the plane repeat infinitely?
+ *  * <span class="parameter">'horizon'</span> number Screen y-coordinate of the horizon.
+ *  * <span class="parameter">'pixelsperunit'</span> number Number of texels per world unit for planes and sprites.
+ *
+ * @function Renderer:feature
+ * @tparam string name Feature name.
+ * @tparam ?any value Value to set feature to.
+ */
+static int modules_mode7_renderer_feature(lua_State* L) {
+    mode7_renderer_t* renderer = luaL_checkmode7renderer(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+    bool is_setter = lua_gettop(L) > 2;
+
+    if (strcmp(key, "fogdistance") == 0) {
+        if (is_setter) {
+            float fog_distance = luaL_checknumber(L, 3);
+            renderer->features.fog_distance = fog_distance;
+
+            return 0;
+        }
+
+        lua_pushnumber(L, renderer->features.fog_distance);
+
+        return 1;
+    }
+    else if (strcmp(key, "shadetable") == 0) {
+        if (is_setter) {
+            if (lua_isnil(L, 3)) {
+                renderer->features.shade_table = NULL;
+            }
+            else {
+                texture_t* shade_table = luaL_checktexture(L, 3);
+                renderer->features.shade_table = shade_table;
+            }
+
+            return 0;
+        }
+
+        if (renderer->features.shade_table) {
+            lua_pushtexture(L, renderer->features.shade_table);
+        }
+        else {
+            lua_pushnil(L);
+        }
+
+        return 1;
+    }
+    else if (strcmp(key, "wrap") == 0) {
+        if (is_setter) {
+            bool wrap = lua_toboolean(L, 3);
+            renderer->features.wrap = wrap;
+
+            return 0;
+        }
+
+        lua_pushboolean(L, renderer->features.wrap);
+
+        return 1;
+    }
+    else if (strcmp(key, "horizon") == 0) {
+        if (is_setter) {
+            float horizon = luaL_checknumber(L, 3);
+            renderer->features.horizon = horizon;
+
+            return 0;
+        }
+
+        lua_pushnumber(L, renderer->features.horizon);
+
+        return 1;
+    }
+    else if (strcmp(key, "pixelsperunit") == 0) {
+        if (is_setter) {
+            float pixels_per_unit = luaL_checknumber(L, 3);
+            luaL_argcheck(L, pixels_per_unit > 0, 3, "must be greater than 0");
+            renderer->features.pixels_per_unit = pixels_per_unit;
+
+            return 0;
+        }
+
+        lua_pushnumber(L, renderer->features.pixels_per_unit);
+
+        return 1;
+    }
+    else {
+        luaL_argerror(L, 2, lua_pushfstring(L, "invalid feature '%s'", key));
+    }
+
+    return 0;
+}
+
+static int modules_mode7_renderer_meta_index(lua_State* L) {
+    luaL_checkmode7renderer(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    luaL_requiref(L, "mode7", NULL, false);
+    lua_getfield(L, -1, "Renderer");
+    if (lua_type(L, -1) == LUA_TTABLE) {
+        lua_getfield(L, -1, key);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+static int modules_mode7_renderer_meta_gc(lua_State* L) {
+    mode7_renderer_t** handle = lua_touserdata(L, 1);
+    mode7_renderer_free(*handle);
+    *handle = NULL;
+
+    return 0;
+}
+
+static const struct luaL_Reg modules_mode7_renderer_functions[] = {
+    {"new", modules_mode7_renderer_new},
+    {"clear", modules_mode7_renderer_clear},
+    {"render", modules_mode7_renderer_render},
+    {"camera", modules_mode7_renderer_camera},
+    {"feature", modules_mode7_renderer_feature},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_mode7_renderer_meta_functions[] = {
+    {"__index", modules_mode7_renderer_meta_index},
+    {"__gc", modules_mode7_renderer_meta_gc},
+    {NULL, NULL}
+};
+
+int luaopen_mode7(lua_State* L) {
+    lua_newtable(L);
+
+    lua_pushstring(L, "Renderer");
+    luaL_newlib(L, modules_mode7_renderer_functions);
+    lua_settable(L, -3);
+
+    luaL_newmetatable(L, "mode7_renderer");
+    luaL_setfuncs(L, modules_mode7_renderer_meta_functions, 0);
+    lua_pop(L, 1);
+
+    return 1;
+}
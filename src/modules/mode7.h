@@ -0,0 +1,8 @@
+#ifndef MODULES_MODE7_H
+#define MODULES_MODE7_H
+
+#include <lua/lua.h>
+
+int luaopen_mode7(lua_State* L);
+
+#endif
@@ -13,7 +13,6 @@
 #include <stdbool.h>
 
 #include <SDL.h>
-#include <SDL_mixer.h>
 
 #include <lua/lua.h>
 #include <lua/lauxlib.h>
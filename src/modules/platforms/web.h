@@ -10,7 +10,6 @@
  */
 
 #include <SDL.h>
-#include <SDL_mixer.h>
 #include <emscripten.h>
 
 #include <lua/lua.h>
@@ -11,32 +11,37 @@
 
 #include <mathc/mathc.h>
 
+#include "float_array.h"
 #include "matrix4.h"
 #include "quaternion.h"
+#include "scratch.h"
 #include "vector3.h"
 
-mfloat_t* luaL_checkquaternion(lua_State* L, int index) {
-    mfloat_t** handle = NULL;
-    luaL_checktype(L, index, LUA_TUSERDATA);
+#include "../batch.h"
 
-    handle = (mfloat_t**)luaL_testudata(L, index, "quaternion_nogc");
-    if (!handle) {
-        handle = (mfloat_t**)luaL_checkudata(L, index, "quaternion");
-    }
+/**
+ * Userdata layout. Values created from Lua store their components inline and
+ * point at them, values pushed from C only store the pointer.
+ */
+typedef struct {
+    mfloat_t* components;
+    mfloat_t storage[QUAT_SIZE];
+} quaternion_userdata_t;
 
-    return *handle;
+mfloat_t* luaL_checkquaternion(lua_State* L, int index) {
+    return *(mfloat_t**)luaL_checkudata(L, index, "quaternion");
 }
 
 int lua_newquaternion(lua_State* L, float x, float y, float z, float w) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* q0 = (mfloat_t*)malloc(sizeof(mfloat_t) * QUAT_SIZE);
+    quaternion_userdata_t* userdata = (quaternion_userdata_t*)lua_newuserdatauv(L, sizeof(quaternion_userdata_t), 0);
+    mfloat_t* q0 = userdata->storage;
 
     q0[0] = x;
     q0[1] = y;
     q0[2] = z;
     q0[3] = w;
 
-    *handle = q0;
+    userdata->components = q0;
 
     luaL_setmetatable(L, "quaternion");
 
@@ -44,20 +49,23 @@ int lua_newquaternion(lua_State* L, float x, float y, float z, float w) {
 }
 
 int lua_pushquaternion(lua_State* L, mfloat_t* quaternion) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
+    mfloat_t** handle = (mfloat_t**)lua_newuserdatauv(L, sizeof(mfloat_t*), 0);
     *handle = quaternion;
 
-    luaL_setmetatable(L, "quaternion_nogc");
+    luaL_setmetatable(L, "quaternion");
 
     return 1;
 }
 
-static int modules_quaternion_gc(lua_State* L) {
-    mfloat_t** handle = lua_touserdata(L, 1);
-    free(*handle);
-    *handle = NULL;
+int lua_outquaternion(lua_State* L, int index, mfloat_t* result) {
+    if (lua_isnoneornil(L, index)) {
+        return lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    }
 
-    return 0;
+    quat_assign(luaL_checkquaternion(L, index), result);
+    lua_pushvalue(L, index);
+
+    return 1;
 }
 
 /**
@@ -68,17 +76,16 @@ static int modules_quaternion_gc(lua_State* L) {
 /**
  * Conjugate of quaternion.
  * @function conjugate
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_conjugate(lua_State* L) {
     mfloat_t* q0 = luaL_checkquaternion(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_conjugate(result, q0);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 2, result);
 
     return 1;
 }
@@ -86,17 +93,16 @@ static int modules_quaternion_conjugate(lua_State* L) {
 /**
  * Inverse of quaternion.
  * @function inverse
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_inverse(lua_State* L) {
     mfloat_t* q0 = luaL_checkquaternion(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_inverse(result, q0);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 2, result);
 
     return 1;
 }
@@ -213,12 +219,10 @@ static int modules_quaternion_multiply(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[QUAT_SIZE];
         quat_multiply_f(result, q0, f);
 
-        lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+        lua_outquaternion(L, 3, result);
 
         return 1;
     }
@@ -226,12 +230,10 @@ static int modules_quaternion_multiply(lua_State* L) {
     // Component-wise multiplication
     mfloat_t* q1 = luaL_checkquaternion(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_multiply(result, q0, q1);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 3, result);
 
     return 1;
 }
@@ -243,12 +245,10 @@ static int modules_quaternion_divide(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[QUAT_SIZE];
         quat_divide_f(result, q0, f);
 
-        lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+        lua_outquaternion(L, 3, result);
 
         return 1;
     }
@@ -256,12 +256,10 @@ static int modules_quaternion_divide(lua_State* L) {
     // Component-wise multiplication
     mfloat_t* q1 = luaL_checkquaternion(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_divide(result, q0, q1);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 3, result);
 
     return 1;
 }
@@ -269,12 +267,10 @@ static int modules_quaternion_divide(lua_State* L) {
 static int modules_quaternion_negative(lua_State* L) {
     mfloat_t* q0 = luaL_checkquaternion(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_negative(result, q0);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 2, result);
 
     return 1;
 }
@@ -296,17 +292,16 @@ static int modules_quaternion_equal(lua_State* L) {
  * Creates quaternion with same rotation, but magnitude of 1.
  * @function normalize
  * @tparam quaternion q0
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_normalize(lua_State* L) {
     mfloat_t* q0 = luaL_checkquaternion(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_normalize(result, q0);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 2, result);
 
     return 1;
 }
@@ -335,12 +330,10 @@ static int modules_quaternion_power(lua_State* L) {
     mfloat_t* q0 = luaL_checkquaternion(L, 1);
     mfloat_t exponent = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_power(result, q0, exponent);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 3, result);
 
     return 1;
 }
@@ -350,18 +343,17 @@ static int modules_quaternion_power(lua_State* L) {
  * @function from_axis_angle
  * @tparam vector3.vector3 v0
  * @tparam number radians
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_from_axis_angle(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t angle = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_from_axis_angle(result, v0, angle);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 3, result);
 
     return 1;
 }
@@ -371,18 +363,17 @@ static int modules_quaternion_from_axis_angle(lua_State* L) {
  * @function from_vector3
  * @tparam vector3.vector3 v0
  * @tparam vector3.vector3 v1
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_from_vector3(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_from_vec3(result, v0, v1);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 3, result);
 
     return 1;
 }
@@ -391,17 +382,16 @@ static int modules_quaternion_from_vector3(lua_State* L) {
  * Create a rotation from a rotation matrix.
  * @function from_matrix4
  * @tparam matrix4.matrix4 m0
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_from_matrix4(lua_State* L) {
     mfloat_t* m0 = luaL_checkmatrix4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_from_mat4(result, m0);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 2, result);
 
     return 1;
 }
@@ -518,6 +508,7 @@ static int modules_quaternion_to_euler(lua_State* L) {
  * @tparam quaternion q0
  * @tparam quaternion q1
  * @tparam number t Value used to interpolate between q0 and q1.
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_lerp(lua_State* L) {
@@ -525,12 +516,10 @@ static int modules_quaternion_lerp(lua_State* L) {
     mfloat_t* q1 = luaL_checkquaternion(L, 2);
     mfloat_t f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_lerp(result, q0, q1, f);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 4, result);
 
     return 1;
 }
@@ -541,6 +530,7 @@ static int modules_quaternion_lerp(lua_State* L) {
  * @tparam quaternion q0
  * @tparam quaternion q1
  * @tparam number t Value used to interpolate between q0 and q1.
+ * @tparam ?quaternion out Destination, a new quaternion is returned if omitted
  * @treturn quaternion
  */
 static int modules_quaternion_slerp(lua_State* L) {
@@ -548,12 +538,10 @@ static int modules_quaternion_slerp(lua_State* L) {
     mfloat_t* q1 = luaL_checkquaternion(L, 2);
     mfloat_t f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[QUAT_SIZE];
     quat_slerp(result, q0, q1, f);
 
-    lua_newquaternion(L, result[0], result[1], result[2], result[3]);
+    lua_outquaternion(L, 4, result);
 
     return 1;
 }
@@ -578,6 +566,73 @@ static int modules_quaternion_angle(lua_State* L) {
     return 1;
 }
 
+/**
+ * Spherically interpolates quaternion pairs in two floatarrays. Quaternions
+ * are packed with x, y, z and w components.
+ * @function slerp_array
+ * @tparam floatarray a Start quaternions.
+ * @tparam floatarray b End quaternions.
+ * @tparam number|floatarray t Interpolation value, or one value per pair.
+ * @tparam ?floatarray out Destination, grown if needed. May be a or b. A new floatarray is returned if omitted.
+ * @treturn floatarray
+ */
+static int modules_quaternion_slerp_array(lua_State* L) {
+    float_array_t* a = luaL_checkfloatarray(L, 1);
+    float_array_t* b = luaL_checkfloatarray(L, 2);
+    size_t count = (a->size < b->size ? a->size : b->size) / QUAT_SIZE;
+
+    float f = 0.0f;
+    const float* t = &f;
+    size_t t_stride = 0;
+
+    if (lua_isnumber(L, 3)) {
+        f = (float)lua_tonumber(L, 3);
+    }
+    else {
+        float_array_t* values = luaL_checkfloatarray(L, 3);
+
+        if (values->size < count) {
+            count = values->size;
+        }
+
+        t = values->data;
+        t_stride = 1;
+    }
+
+    float_array_t* out = lua_outfloatarray(L, 4, count * QUAT_SIZE);
+
+    batch_quaternions_slerp(out->data, a->data, b->data, t, t_stride, count);
+
+    return 1;
+}
+
+/**
+ * Returns a quaternion from a pool of temporaries. Values are handed out again
+ * next frame, so they must not be kept.
+ * @function scratch
+ * @tparam ?number ... Components, same as new
+ * @treturn quaternion
+ */
+static int modules_quaternion_scratch(lua_State* L) {
+    mfloat_t components[QUAT_SIZE];
+
+    for (int i = 0; i < QUAT_SIZE; i++) {
+        components[i] = (mfloat_t)luaL_optnumber(L, i + 1, 0);
+    }
+
+    lua_settop(L, 0);
+
+    if (lua_pushscratch(L, "quaternion")) {
+        quat_assign(luaL_checkquaternion(L, 1), components);
+    }
+    else {
+        lua_newquaternion(L, components[0], components[1], components[2], components[3]);
+        lua_addscratch(L, "quaternion");
+    }
+
+    return 1;
+}
+
 static const struct luaL_Reg modules_quaternion_functions[] = {
     // Class functions
     {"conjugate", modules_quaternion_conjugate},
@@ -587,6 +642,7 @@ static const struct luaL_Reg modules_quaternion_functions[] = {
     {"length_squared", modules_quaternion_length_squared},
     // Module functions
     {"new", modules_quaternion_new},
+    {"scratch", modules_quaternion_scratch},
     {"zero", modules_quaternion_zero},
     {"identity", modules_quaternion_identity},
     {"dot", modules_quaternion_dot},
@@ -597,6 +653,7 @@ static const struct luaL_Reg modules_quaternion_functions[] = {
     {"to_euler", modules_quaternion_to_euler},
     {"lerp", modules_quaternion_lerp},
     {"slerp", modules_quaternion_slerp},
+    {"slerp_array", modules_quaternion_slerp_array},
     {"angle", modules_quaternion_angle},
     {NULL, NULL}
 };
@@ -662,12 +719,32 @@ static int modules_quaternion_meta_newindex(lua_State* L) {
     return 0;
 }
 
+static const luaL_InPlaceReg modules_quaternion_in_place_functions[] = {
+    {"conjugate_", modules_quaternion_conjugate, 2},
+    {"inverse_", modules_quaternion_inverse, 2},
+    {"multiply_", modules_quaternion_multiply, 3},
+    {"divide_", modules_quaternion_divide, 3},
+    {"negative_", modules_quaternion_negative, 2},
+    {"normalize_", modules_quaternion_normalize, 2},
+    {"power_", modules_quaternion_power, 3},
+    {"lerp_", modules_quaternion_lerp, 4},
+    {"slerp_", modules_quaternion_slerp, 4},
+    {NULL, NULL, 0}
+};
+
+/* Unary minus passes its operand twice, which must not be taken as destination. */
+static int modules_quaternion_meta_unm(lua_State* L) {
+    lua_settop(L, 1);
+
+    return modules_quaternion_negative(L);
+}
+
 static const struct luaL_Reg modules_quaternion_meta_functions[] = {
     {"__index", modules_quaternion_meta_index},
     {"__newindex", modules_quaternion_meta_newindex},
     {"__mul", modules_quaternion_multiply},
     {"__div", modules_quaternion_divide},
-    {"__unm", modules_quaternion_negative},
+    {"__unm", modules_quaternion_meta_unm},
     {"__eq", modules_quaternion_equal},
     {"__pow", modules_quaternion_power},
     {NULL, NULL}
@@ -675,19 +752,11 @@ static const struct luaL_Reg modules_quaternion_meta_functions[] = {
 
 int luaopen_quaternion(lua_State* L) {
     luaL_newlib(L, modules_quaternion_functions);
+    luaL_setinplacefuncs(L, modules_quaternion_in_place_functions);
 
     luaL_newmetatable(L, "quaternion");
     luaL_setfuncs(L, modules_quaternion_meta_functions, 0);
 
-    lua_pushstring(L, "__gc");
-    lua_pushcfunction(L, modules_quaternion_gc);
-    lua_settable(L, -3);
-
-    lua_pop(L, 1);
-
-    luaL_newmetatable(L, "quaternion_nogc");
-    luaL_setfuncs(L, modules_quaternion_meta_functions, 0);
-
     lua_pop(L, 1);
 
     return 1;
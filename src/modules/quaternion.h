@@ -11,9 +11,12 @@ mfloat_t* luaL_checkquaternion(lua_State* L, int index);
 /* Creates and pushes on the stack a new quaternion userdata. */
 int lua_newquaternion(lua_State* L, float x, float y, float z, float w);
 
-/* Pushes a quaternion onto the stack. Created userdata will not be garbage collected. */
+/* Pushes a quaternion onto the stack. Created userdata references given data, which must outlive it. */
 int lua_pushquaternion(lua_State* L, mfloat_t* matrix);
 
+/* Pushes given result, copied into the quaternion at index if there is one or into a new quaternion otherwise. */
+int lua_outquaternion(lua_State* L, int index, mfloat_t* result);
+
 int luaopen_quaternion(lua_State* L);
 
 #endif
@@ -44,11 +44,15 @@
 
 #include <mathc/mathc.h>
 
+#include "float_array.h"
+#include "int_array.h"
 #include "raycaster.h"
 #include "texture.h"
 #include "vector2.h"
 #include "vector3.h"
 
+#include "../collections/float_array.h"
+#include "../collections/int_array.h"
 #include "../renderers/raycaster.h"
 
 static raycaster_renderer_t* luaL_checkrayrenderer(lua_State* L, int index) {
@@ -358,79 +362,146 @@ static raycaster_map_t* luaL_checkraycastermap(lua_State* L, int index) {
     return *handle;
 }
 
-static int modules_raycaster_map_meta_index(lua_State* L) {
-    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
-    const char* key = luaL_checkstring(L, 2);
-
-    lua_pop(L, -1);
+static const char* const map_layer_names[] = {"walls", "floors", "ceilings", NULL};
 
-    int* data = NULL;
+static raycaster_map_layer_t luaL_checkmaplayer(lua_State* L, int index) {
+    return (raycaster_map_layer_t)luaL_checkoption(L, index, NULL, map_layer_names);
+}
 
-    if (strcmp(key, "walls") == 0) {
-        data = map->walls;
+/**
+ * Get layer for given name.
+ *
+ * @param name Layer name
+ * @param layer Found layer
+ * @return true If name is a valid layer.
+ */
+static bool map_layer_find(const char* name, raycaster_map_layer_t* layer) {
+    for (int i = 0; map_layer_names[i]; i++) {
+        if (strcmp(name, map_layer_names[i]) == 0) {
+            *layer = (raycaster_map_layer_t)i;
+            return true;
+        }
     }
-    else if (strcmp(key, "floors") == 0) {
-        data = map->floors;
+
+    return false;
+}
+
+/**
+ * Load layer from value at given stack index. Value can be a table, an
+ * intarray or a texture. Userdata is copied in a single pass without going
+ * through the Lua API per cell. Values must be in range 0-65535, as with
+ * Map:set. Layer is left untouched if any value is invalid.
+ */
+static int map_layer_load(lua_State* L, raycaster_map_t* map, raycaster_map_layer_t layer, int index) {
+    size_t size = map->width * map->height;
+
+    if (lua_type(L, index) == LUA_TUSERDATA) {
+        texture_t* texture = luaL_testtexture(L, index);
+
+        // Colors are always in range
+        if (texture) {
+            if (texture->width * texture->height != size) {
+                return luaL_error(L, "texture size does not match map size");
+            }
+
+            raycaster_map_layer_load_colors(map, layer, texture->pixels);
+
+            return 0;
+        }
+
+        int_array_t* array = luaL_checkintarray(L, index);
+
+        if (array->size != size) {
+            return luaL_error(L, "intarray size does not match map size");
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            if (array->data[i] < 0 || array->data[i] > UINT16_MAX) {
+                return luaL_error(L, "map data out of range at index %d", (int)i + 1);
+            }
+        }
+
+        raycaster_map_layer_load(map, layer, array->data);
+
+        return 0;
     }
-    else if (strcmp(key, "ceilings") == 0) {
-        data = map->ceilings;
+
+    luaL_checktype(L, index, LUA_TTABLE);
+
+    if (lua_rawlen(L, index) != size) {
+        return luaL_error(L, "table size does not match map size");
     }
 
-    if (data) {
-        size_t size = map->width * map->height;
+    // Buffer is owned by Lua so errors below do not leak it
+    int* data = (int*)lua_newuserdatauv(L, size * sizeof(int), 0);
 
-        lua_newtable(L);
+    for (size_t i = 0; i < size; i++) {
+        lua_rawgeti(L, index, i + 1);
 
-        for (int i = 0; i < size; i++) {
-            lua_pushinteger(L, i + 1);
-            lua_pushinteger(L, data[i]);
-            lua_settable(L, -3);
+        if (!lua_isnumber(L, -1)) {
+            return luaL_error(L, "map data must be numbers");
         }
-    }
-    else {
-        lua_pushnil(L);
+
+        lua_Number value = lua_tonumber(L, -1);
+
+        if (!(value >= 0 && value <= UINT16_MAX)) {
+            return luaL_error(L, "map data out of range at index %d", (int)i + 1);
+        }
+
+        data[i] = (int)value;
+
+        lua_pop(L, 1);
     }
 
-    return 1;
+    raycaster_map_layer_load(map, layer, data);
+
+    lua_pop(L, 1);
+
+    return 0;
 }
 
-static int modules_raycaster_map_meta_newindex(lua_State* L) {
+static int modules_raycaster_map_meta_index(lua_State* L) {
     raycaster_map_t* map = luaL_checkraycastermap(L, 1);
     const char* key = luaL_checkstring(L, 2);
 
-    int* data = NULL;
+    lua_pop(L, -1);
 
-    if (strcmp(key, "walls") == 0) {
-        data = map->walls;
-    }
-    else if (strcmp(key, "floors") == 0) {
-        data = map->floors;
-    }
-    else if (strcmp(key, "ceilings") == 0) {
-        data = map->ceilings;
-    }
+    raycaster_map_layer_t layer;
 
-    if (data) {
+    if (map_layer_find(key, &layer)) {
         size_t size = map->width * map->height;
-        size_t table_size = lua_rawlen(L, 3);
 
-        if (table_size == size) {
-            for (int i = 0; i < size; i++) {
-                int index = i + 1;
-                lua_pushinteger(L, index);
-                lua_gettable(L, 3);
-
-                data[i] = (int)luaL_checknumber(L, -1);
-
-                lua_pop(L, 1);
-            }
+        lua_createtable(L, size, 0);
 
-            lua_settop(L, 0);
+        for (int i = 0; i < size; i++) {
+            lua_pushinteger(L, raycaster_map_get(map, i % map->width, i / map->width, layer));
+            lua_rawseti(L, -2, i + 1);
+        }
+    }
+    else {
+        // Check module fields. This enables usage of the colon operator.
+        luaL_requiref(L, "raycaster", NULL, false);
+        lua_getfield(L, -1, "Map");
+        if (lua_type(L, -1) == LUA_TTABLE) {
+            lua_getfield(L, -1, key);
         }
         else {
-            luaL_error(L, "BAD!");
+            lua_pushnil(L);
         }
     }
+
+    return 1;
+}
+
+static int modules_raycaster_map_meta_newindex(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    raycaster_map_layer_t layer;
+
+    if (map_layer_find(key, &layer)) {
+        map_layer_load(L, map, layer, 3);
+    }
     else {
         luaL_error(L, "attempt to index a raycaster_map value");
     }
@@ -471,22 +542,213 @@ static int modules_raycaster_map_new(lua_State* L) {
 }
 
 /**
- * Tile indices for walls.
+ * Enables or disables empty space skipping. Speeds up rendering of large,
+ * open maps. Rendered output is unchanged.
+ * @function Map:accelerate
+ * @tparam ?boolean enabled Build acceleration structure if true (default), free it if false.
+ */
+static int modules_raycaster_map_accelerate(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    bool enabled = lua_isnoneornil(L, 2) || lua_toboolean(L, 2);
+
+    raycaster_map_acceleration_set(map, enabled);
+
+    return 0;
+}
+
+/**
+ * Get layer data at given cell.
+ * @function Map:get
+ * @tparam integer x Cell x-coordinate
+ * @tparam integer y Cell y-coordinate
+ * @tparam string layer One of: "walls", "floors", or "ceilings".
+ * @treturn integer Layer data. 0 if cell is outside of map.
+ */
+static int modules_raycaster_map_get(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    int x = (int)luaL_checknumber(L, 2);
+    int y = (int)luaL_checknumber(L, 3);
+    raycaster_map_layer_t layer = luaL_checkmaplayer(L, 4);
+
+    lua_settop(L, 0);
+
+    lua_pushinteger(L, raycaster_map_get(map, x, y, layer));
+
+    return 1;
+}
+
+/**
+ * Set layer data at given cell.
+ * @function Map:set
+ * @tparam integer x Cell x-coordinate
+ * @tparam integer y Cell y-coordinate
+ * @tparam string layer One of: "walls", "floors", or "ceilings".
+ * @tparam integer value Layer data. Valid range is 0-65535.
+ */
+static int modules_raycaster_map_set(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    int x = (int)luaL_checknumber(L, 2);
+    int y = (int)luaL_checknumber(L, 3);
+    raycaster_map_layer_t layer = luaL_checkmaplayer(L, 4);
+    int value = (int)luaL_checknumber(L, 5);
+
+    luaL_argcheck(L, 0 <= value && value <= UINT16_MAX, 5, "value out of range");
+
+    lua_settop(L, 0);
+
+    raycaster_map_set(map, x, y, layer, value);
+
+    return 0;
+}
+
+/**
+ * Load entire layer. Same as assigning to the layer field.
+ * @function Map:load
+ * @tparam string layer One of: "walls", "floors", or "ceilings".
+ * @tparam {integer,...}|intarray.intarray|texture.texture data Layer data. Size must match map size.
+ */
+static int modules_raycaster_map_load(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    raycaster_map_layer_t layer = luaL_checkmaplayer(L, 2);
+
+    map_layer_load(L, map, layer, 3);
+
+    return 0;
+}
+
+/**
+ * Copy entire layer into an intarray.
+ * @function Map:store
+ * @tparam string layer One of: "walls", "floors", or "ceilings".
+ * @tparam ?intarray.intarray array Array to copy into. Grown to map size if needed.
+ * @treturn intarray.intarray Given array or a new array if none was given.
+ */
+static int modules_raycaster_map_store(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    raycaster_map_layer_t layer = luaL_checkmaplayer(L, 2);
+    size_t size = map->width * map->height;
+
+    int_array_t* array = lua_outintarray(L, 3, size);
+
+    raycaster_map_layer_store(map, layer, array->data);
+
+    return 1;
+}
+
+/**
+ * Casts a ray against map walls. Uses the same traversal as the renderer.
+ * @function Map:cast
+ * @tparam vector2.vector2 origin Ray origin.
+ * @tparam vector2.vector2 direction Ray direction.
+ * @tparam ?number max_distance Distance after which the ray stops. Defaults to math.huge.
+ * @treturn ?number Hit distance or nil if nothing was hit.
+ * @treturn integer Hit cell x-coordinate
+ * @treturn integer Hit cell y-coordinate
+ * @treturn integer Hit side. 0 for north/south facing walls, 1 for east/west facing walls.
+ * @treturn number Normalized horizontal texture offset of hit.
+ */
+static int modules_raycaster_map_cast(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    mfloat_t* origin = luaL_checkvector2(L, 2);
+    mfloat_t* direction = luaL_checkvector2(L, 3);
+    float max_distance = luaL_optnumber(L, 4, HUGE_VAL);
+
+    lua_settop(L, 0);
+
+    raycaster_hit_t hit;
+
+    if (!raycaster_map_cast(map, origin, direction, max_distance, &hit)) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    lua_pushnumber(L, hit.distance);
+    lua_pushinteger(L, hit.cell[0]);
+    lua_pushinteger(L, hit.cell[1]);
+    lua_pushinteger(L, hit.was_vertical ? 1 : 0);
+    lua_pushnumber(L, hit.offset);
+
+    return 5;
+}
+
+/**
+ * Casts many rays against map walls. Origins and directions are packed as
+ * x, y pairs. Results are written to out as five values per ray: distance,
+ * cell x, cell y, side and texture offset. Rays that hit nothing have a
+ * distance of math.huge and a cell of -1, -1.
+ * @function Map:cast_many
+ * @tparam floatarray.floatarray origins Ray origins.
+ * @tparam floatarray.floatarray directions Ray directions.
+ * @tparam ?floatarray.floatarray out Results, grown if needed. Must not be origins or directions. A new floatarray is returned if omitted.
+ * @tparam ?number max_distance Distance after which rays stop. Defaults to math.huge.
+ * @treturn integer Number of rays that hit a wall.
+ * @treturn floatarray.floatarray Results.
+ */
+static int modules_raycaster_map_cast_many(lua_State* L) {
+    raycaster_map_t* map = luaL_checkraycastermap(L, 1);
+    float_array_t* origins = luaL_checkfloatarray(L, 2);
+    float_array_t* directions = luaL_checkfloatarray(L, 3);
+    float max_distance = luaL_optnumber(L, 5, HUGE_VAL);
+
+    luaL_argcheck(L, origins->size % 2 == 0, 2, "size must be a multiple of 2");
+    luaL_argcheck(L, directions->size == origins->size, 3, "size must match origins");
+
+    // Results would overwrite rays not cast yet
+    if (!lua_isnoneornil(L, 4)) {
+        float_array_t* array = luaL_checkfloatarray(L, 4);
+        luaL_argcheck(L, array != origins && array != directions, 4, "out must not be origins or directions");
+    }
+
+    size_t count = origins->size / 2;
+    float_array_t* out = lua_outfloatarray(L, 4, count * 5);
+
+    int hit_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        raycaster_hit_t hit;
+
+        if (raycaster_map_cast(map, &origins->data[i * 2], &directions->data[i * 2], max_distance, &hit)) {
+            hit_count++;
+        }
+
+        float* result = &out->data[i * 5];
+        result[0] = hit.distance;
+        result[1] = hit.cell[0];
+        result[2] = hit.cell[1];
+        result[3] = hit.was_vertical ? 1 : 0;
+        result[4] = hit.offset;
+    }
+
+    lua_pushinteger(L, hit_count);
+    lua_insert(L, -2);
+
+    return 2;
+}
+
+/**
+ * Tile indices for walls. Can be assigned a table, an intarray or a texture.
  * @tfield {integer,...} walls Array of integers
  */
 
 /**
- * Tile indices for floors.
+ * Tile indices for floors. Can be assigned a table, an intarray or a texture.
  * @tfield {integer,...} floors Array of integers
  */
 
 /**
- * Tile indices for ceilings.
+ * Tile indices for ceilings. Can be assigned a table, an intarray or a texture.
  * @tfield {integer,...} ceilings Array of integers
  */
 
 static const struct luaL_Reg modules_raycaster_map_functions[] = {
     {"new", modules_raycaster_map_new},
+    {"accelerate", modules_raycaster_map_accelerate},
+    {"get", modules_raycaster_map_get},
+    {"set", modules_raycaster_map_set},
+    {"load", modules_raycaster_map_load},
+    {"store", modules_raycaster_map_store},
+    {"cast", modules_raycaster_map_cast},
+    {"cast_many", modules_raycaster_map_cast_many},
     {NULL, NULL}
 };
 
@@ -0,0 +1,104 @@
+/**
+ * Helpers shared by the math modules to write results into existing userdata
+ * instead of allocating a new one for every operation.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <lua/lua.h>
+#include <lua/lauxlib.h>
+
+#include "../time.h"
+
+#include "scratch.h"
+
+/**
+ * Calls operation in first upvalue with the first argument passed as its
+ * destination. Arguments after the operation's own are dropped.
+ */
+static int in_place_call(lua_State* L) {
+    lua_CFunction func = lua_tocfunction(L, lua_upvalueindex(1));
+    int destination = (int)lua_tointeger(L, lua_upvalueindex(2));
+
+    lua_settop(L, destination - 1);
+    lua_pushvalue(L, 1);
+
+    return func(L);
+}
+
+void luaL_setinplacefuncs(lua_State* L, const luaL_InPlaceReg* l) {
+    for (; l->name != NULL; l++) {
+        lua_pushcfunction(L, l->func);
+        lua_pushinteger(L, l->destination);
+        lua_pushcclosure(L, in_place_call, 2);
+        lua_setfield(L, -2, l->name);
+    }
+}
+
+/**
+ * Push scratch pool of given metatable, creating it if needed. Pool is stored
+ * in the metatable and reset lazily here, on first use after time_frames_get
+ * has changed since the pool was last used.
+ *
+ * @return lua_Integer Number of values handed out this frame.
+ */
+static lua_Integer pool_push(lua_State* L, const char* name) {
+    luaL_getmetatable(L, name);
+
+    if (lua_getfield(L, -1, "__scratch") != LUA_TTABLE) {
+        lua_pop(L, 1);
+        lua_createtable(L, 16, 2);
+        lua_pushvalue(L, -1);
+        lua_setfield(L, -3, "__scratch");
+    }
+
+    lua_remove(L, -2);
+
+    lua_Integer frame = (lua_Integer)time_frames_get();
+
+    lua_getfield(L, -1, "frame");
+    lua_getfield(L, -2, "count");
+
+    lua_Integer count = lua_tointeger(L, -1);
+
+    if (lua_tointeger(L, -2) != frame) {
+        count = 0;
+
+        lua_pushinteger(L, frame);
+        lua_setfield(L, -4, "frame");
+
+        lua_pushinteger(L, 0);
+        lua_setfield(L, -4, "count");
+    }
+
+    lua_pop(L, 2);
+
+    return count;
+}
+
+bool lua_pushscratch(lua_State* L, const char* name) {
+    lua_Integer count = pool_push(L, name);
+
+    if (lua_rawgeti(L, -1, count + 1) == LUA_TNIL) {
+        lua_pop(L, 2);
+        return false;
+    }
+
+    lua_pushinteger(L, count + 1);
+    lua_setfield(L, -3, "count");
+    lua_remove(L, -2);
+
+    return true;
+}
+
+void lua_addscratch(lua_State* L, const char* name) {
+    lua_Integer count = pool_push(L, name);
+
+    lua_pushvalue(L, -2);
+    lua_rawseti(L, -2, count + 1);
+
+    lua_pushinteger(L, count + 1);
+    lua_setfield(L, -2, "count");
+
+    lua_pop(L, 1);
+}
@@ -0,0 +1,24 @@
+#ifndef MODULES_SCRATCH_H
+#define MODULES_SCRATCH_H
+
+#include <stdbool.h>
+
+#include <lua/lua.h>
+
+/* In-place variant of an operation. Destination is the index of its optional out argument. */
+typedef struct {
+    const char* name;
+    lua_CFunction func;
+    int destination;
+} luaL_InPlaceReg;
+
+/* Registers in-place variants into the table on top of the stack. Variants write their result to the first argument. */
+void luaL_setinplacefuncs(lua_State* L, const luaL_InPlaceReg* l);
+
+/* Pushes a scratch value of given metatable not yet handed out this frame. Returns false and pushes nothing if pool is exhausted. */
+bool lua_pushscratch(lua_State* L, const char* name);
+
+/* Adds value on top of the stack to the scratch pool of given metatable, marked as handed out this frame. */
+void lua_addscratch(lua_State* L, const char* name);
+
+#endif
@@ -0,0 +1,479 @@
+/**
+ * Module for sector renderer. Maps are made of convex sectors with their own
+ * floor and ceiling heights, joined together by portals.
+ *
+ * @usage
+ * sector = require('sector')
+ *
+ * -- Tile palette for rendering the map
+ * tiles = {
+ *    [1] = assets.get_texture('stonewall.gif'),
+ *    [2] = assets.get_texture('floor.gif'),
+ * }
+ *
+ * -- Two rooms joined by a portal. Walls wind clockwise with y pointing down.
+ * map = sector.Map.new()
+ * room = map:add_sector(0, 2, 2, 2)
+ * hall = map:add_sector(0.25, 1.5, 2, 2)
+ *
+ * map:add_wall(room, vector2.new(0, 0), vector2.new(4, 0), 1)
+ * map:add_wall(room, vector2.new(4, 0), vector2.new(4, 4), 1, hall)
+ * map:add_wall(room, vector2.new(4, 4), vector2.new(0, 4), 1)
+ * map:add_wall(room, vector2.new(0, 4), vector2.new(0, 0), 1)
+ * -- ...
+ *
+ * -- Camera info. The z-component of the position is eye height.
+ * position = vector3.new(2, 2, 1)
+ * direction = vector2.new(1, 0)
+ * fov = 90
+ *
+ * renderer = sector.Renderer:new()
+ *
+ * -- Render loop
+ * renderer:clear()
+ * renderer:camera(position, direction, fov)
+ * renderer:render(map, tiles)
+ *
+ * @module sector
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <lua/lua.h>
+#include <lua/lauxlib.h>
+#include <lua/lualib.h>
+
+#include <mathc/mathc.h>
+
+#include "sector.h"
+#include "texture.h"
+#include "vector2.h"
+#include "vector3.h"
+
+#include "../renderers/sector.h"
+
+static sector_renderer_t* luaL_checksectorrenderer(lua_State* L, int index) {
+    sector_renderer_t** handle = NULL;
+    luaL_checktype(L, index, LUA_TUSERDATA);
+    handle = (sector_renderer_t**)luaL_checkudata(L, index, "sector_renderer");
+
+    if (!handle) {
+        luaL_typeerror(L, index, "sector_renderer");
+    }
+
+    return *handle;
+}
+
+static sector_map_t* luaL_checksectormap(lua_State* L, int index) {
+    sector_map_t** handle = NULL;
+    luaL_checktype(L, index, LUA_TUSERDATA);
+    handle = (sector_map_t**)luaL_checkudata(L, index, "sector_map");
+
+    return *handle;
+}
+
+static int luaL_checksectorindex(lua_State* L, sector_map_t* map, int index) {
+    int sector = (int)luaL_checkinteger(L, index);
+    luaL_argcheck(L, 0 <= sector && sector < map->sector_count, index, "invalid sector");
+
+    return sector;
+}
+
+static int lua_newsectorrenderer(lua_State* L) {
+    texture_t* render_texture = luaL_opttexture(L, 2, graphics_render_texture_get());
+    sector_renderer_t** handle = (sector_renderer_t**)lua_newuserdata(L, sizeof(sector_renderer_t*));
+    *handle = sector_renderer_new(render_texture);
+    luaL_setmetatable(L, "sector_renderer");
+
+    return 1;
+}
+
+/**
+ * @type Renderer
+ */
+
+/**
+ * Creates a sector renderer object.
+ * @function Renderer:new
+ * @tparam ?texture.texture texture Texture to render to. Defaults to the render texture.
+ * @treturn Renderer
+ */
+static int modules_sector_renderer_new(lua_State* L) {
+    return lua_newsectorrenderer(L);
+}
+
+/**
+ * Clears color buffer.
+ * @function Renderer:clear
+ * @tparam ?integer color Clear color. Defaults to 0.
+ */
+static int modules_sector_renderer_clear(lua_State* L) {
+    sector_renderer_t* renderer = luaL_checksectorrenderer(L, 1);
+    color_t color = (color_t)luaL_optnumber(L, 2, 0);
+
+    sector_renderer_clear_color(renderer, color);
+
+    return 0;
+}
+
+#define MAX_PALETTE_SIZE 256
+static texture_t* palette[MAX_PALETTE_SIZE];
+
+/**
+ * Renders given map. Only sectors visible through portals from the camera's
+ * sector are processed.
+ * @function Renderer:render
+ * @tparam Map map Map to render.
+ * @tparam {texture.texture,...} tiles An array of textures. Valid range of indices is 0-255.
+ */
+static int modules_sector_renderer_render(lua_State* L) {
+    sector_renderer_t* renderer = luaL_checksectorrenderer(L, 1);
+    sector_map_t* map = luaL_checksectormap(L, 2);
+
+    if (lua_istable(L, 3)) {
+        for (int i = 0; i < MAX_PALETTE_SIZE; i++) {
+            lua_pushinteger(L, i);
+            lua_gettable(L, 3);
+
+            if (lua_type(L, -1) == LUA_TNIL) {
+                palette[i] = NULL;
+            }
+            else {
+                palette[i] = luaL_checktexture(L, -1);
+            }
+
+            lua_pop(L, 1);
+        }
+
+        lua_settop(L, 0);
+    }
+
+    sector_renderer_render_map(renderer, map, palette);
+
+    return 0;
+}
+
+/**
+ * Set renderer's camera data.
+ * @function Renderer:camera
+ * @tparam vector3.vector3 position Camera position. The z-component is eye height.
+ * @tparam vector2.vector2 direction Camera forward vector.
+ * @tparam number fov Camera field of view in degrees.
+*/
+static int modules_sector_renderer_camera(lua_State* L) {
+    sector_renderer_t* renderer = luaL_checksectorrenderer(L, 1);
+    mfloat_t* position = luaL_checkvector3(L, 2);
+    mfloat_t* direction = luaL_checkvector2(L, 3);
+    float fov = luaL_checknumber(L, 4);
+
+    sector_renderer_camera(renderer, position, direction, fov);
+
+    return 0;
+}
+
+/**
+ * Access renderer's features. If just the feature name is provided, the value of
+ * that feature will be returned. If a value is provided, the feature will be set to that value.
+ *
+ * **Features:**
+ *
+ *  * <span class="parameter">'fogdistance'</span> number Distance at which fog is fully dark.
+ *  * <span class="parameter">'shadetable'</span> @{texture} Texture to use to shade colors using distance and sector brightness. Setting to nil will render full bright.
+ *  * <span class="parameter">'horizon'</span> number Screen y-coordinate of the horizon.
+ *  * <span class="parameter">'pixelsperunit'</span> number Number of texels per world unit.
+ *
+ * @function Renderer:feature
+ * @tparam string name Feature name.
+ * @tparam ?any value Value to set feature to.
+ */
+static int modules_sector_renderer_feature(lua_State* L) {
+    sector_renderer_t* renderer = luaL_checksectorrenderer(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+    bool is_setter = lua_gettop(L) > 2;
+
+    if (strcmp(key, "shadetable") == 0) {
+        if (is_setter) {
+            if (lua_isnil(L, 3)) {
+                renderer->features.shade_table = NULL;
+            }
+            else {
+                texture_t* shade_table = luaL_checktexture(L, 3);
+                renderer->features.shade_table = shade_table;
+            }
+
+            return 0;
+        }
+
+        if (renderer->features.shade_table) {
+            lua_pushtexture(L, renderer->features.shade_table);
+        }
+        else {
+            lua_pushnil(L);
+        }
+
+        return 1;
+    }
+
+    float* value = NULL;
+
+    if (strcmp(key, "fogdistance") == 0) {
+        value = &renderer->features.fog_distance;
+    }
+    else if (strcmp(key, "horizon") == 0) {
+        value = &renderer->features.horizon;
+    }
+    else if (strcmp(key, "pixelsperunit") == 0) {
+        value = &renderer->features.pixels_per_unit;
+    }
+    else {
+        luaL_argerror(L, 2, lua_pushfstring(L, "invalid feature '%s'", key));
+    }
+
+    if (is_setter) {
+        *value = luaL_checknumber(L, 3);
+
+        return 0;
+    }
+
+    lua_pushnumber(L, *value);
+
+    return 1;
+}
+
+static int modules_sector_renderer_meta_index(lua_State* L) {
+    luaL_checksectorrenderer(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    luaL_requiref(L, "sector", NULL, false);
+    lua_getfield(L, -1, "Renderer");
+    if (lua_type(L, -1) == LUA_TTABLE) {
+        lua_getfield(L, -1, key);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+static int modules_sector_renderer_meta_gc(lua_State* L) {
+    sector_renderer_t** handle = lua_touserdata(L, 1);
+    sector_renderer_free(*handle);
+    *handle = NULL;
+
+    return 0;
+}
+
+/**
+ * @type Map
+ */
+
+/**
+ * Create a new empty map.
+ * @function Map.new
+ * @treturn Map
+ */
+static int modules_sector_map_new(lua_State* L) {
+    sector_map_t** handle = (sector_map_t**)lua_newuserdata(L, sizeof(sector_map_t*));
+    *handle = sector_map_new();
+    luaL_setmetatable(L, "sector_map");
+
+    return 1;
+}
+
+/**
+ * Adds a sector with no walls.
+ * @function Map:add_sector
+ * @tparam number floor Floor height
+ * @tparam number ceiling Ceiling height
+ * @tparam integer floor_tile Floor tile index
+ * @tparam integer ceiling_tile Ceiling tile index
+ * @tparam ?number brightness Sector light level. 1.0 = full bright (default) 0.0 = full dark
+ * @treturn integer Sector index. Indices start at 0.
+ */
+static int modules_sector_map_add_sector(lua_State* L) {
+    sector_map_t* map = luaL_checksectormap(L, 1);
+    float floor_height = luaL_checknumber(L, 2);
+    float ceiling_height = luaL_checknumber(L, 3);
+    int floor_texture = (int)luaL_checknumber(L, 4);
+    int ceiling_texture = (int)luaL_checknumber(L, 5);
+    float brightness = luaL_optnumber(L, 6, 1.0);
+
+    lua_settop(L, 0);
+
+    int sector = sector_map_sector_add(map, floor_height, ceiling_height, floor_texture, ceiling_texture, brightness);
+
+    if (sector < 0) {
+        luaL_error(L, "failed to add sector");
+    }
+
+    lua_pushinteger(L, sector);
+
+    return 1;
+}
+
+/**
+ * Adds a wall to a sector. Walls wind clockwise around their sector when the
+ * map is viewed with the y-axis pointing down. Portals need a matching wall
+ * in the other sector to be visible from both sides.
+ * @function Map:add_wall
+ * @tparam integer sector Sector index
+ * @tparam vector2.vector2 start Wall start point
+ * @tparam vector2.vector2 end Wall end point
+ * @tparam integer tile Wall tile index. Used for upper and lower walls of portals.
+ * @tparam ?integer portal Index of sector on the other side. Solid wall if nil.
+ */
+static int modules_sector_map_add_wall(lua_State* L) {
+    sector_map_t* map = luaL_checksectormap(L, 1);
+    int sector = luaL_checksectorindex(L, map, 2);
+    mfloat_t* start = luaL_checkvector2(L, 3);
+    mfloat_t* end = luaL_checkvector2(L, 4);
+    int texture = (int)luaL_checknumber(L, 5);
+    int portal = -1;
+
+    if (!lua_isnoneornil(L, 6)) {
+        portal = luaL_checksectorindex(L, map, 6);
+    }
+
+    if (!sector_map_wall_add(map, sector, start, end, texture, portal)) {
+        luaL_error(L, "failed to add wall");
+    }
+
+    return 0;
+}
+
+/**
+ * Access sector floor and ceiling heights. If heights are provided, the sector
+ * is updated. Useful for doors and lifts.
+ * @function Map:heights
+ * @tparam integer sector Sector index
+ * @tparam ?number floor New floor height
+ * @tparam ?number ceiling New ceiling height
+ * @treturn number Floor height
+ * @treturn number Ceiling height
+ */
+static int modules_sector_map_heights(lua_State* L) {
+    sector_map_t* map = luaL_checksectormap(L, 1);
+    sector_t* sector = &map->sectors[luaL_checksectorindex(L, map, 2)];
+
+    if (!lua_isnoneornil(L, 3)) {
+        sector->floor_height = luaL_checknumber(L, 3);
+    }
+
+    if (!lua_isnoneornil(L, 4)) {
+        sector->ceiling_height = luaL_checknumber(L, 4);
+    }
+
+    lua_settop(L, 0);
+
+    lua_pushnumber(L, sector->floor_height);
+    lua_pushnumber(L, sector->ceiling_height);
+
+    return 2;
+}
+
+/**
+ * Find sector containing given point.
+ * @function Map:find
+ * @tparam vector2.vector2 point Point to find.
+ * @treturn ?integer Sector index or nil if point is outside all sectors.
+ */
+static int modules_sector_map_find(lua_State* L) {
+    sector_map_t* map = luaL_checksectormap(L, 1);
+    mfloat_t* point = luaL_checkvector2(L, 2);
+
+    lua_settop(L, 0);
+
+    int sector = sector_map_sector_find(map, point, -1);
+
+    if (sector < 0) {
+        lua_pushnil(L);
+    }
+    else {
+        lua_pushinteger(L, sector);
+    }
+
+    return 1;
+}
+
+static int modules_sector_map_meta_index(lua_State* L) {
+    luaL_checksectormap(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    // Check module fields. This enables usage of the colon operator.
+    luaL_requiref(L, "sector", NULL, false);
+    lua_getfield(L, -1, "Map");
+    if (lua_type(L, -1) == LUA_TTABLE) {
+        lua_getfield(L, -1, key);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+static int modules_sector_map_meta_gc(lua_State* L) {
+    sector_map_t** handle = lua_touserdata(L, 1);
+    sector_map_free(*handle);
+    *handle = NULL;
+
+    return 0;
+}
+
+static const struct luaL_Reg modules_sector_map_functions[] = {
+    {"new", modules_sector_map_new},
+    {"add_sector", modules_sector_map_add_sector},
+    {"add_wall", modules_sector_map_add_wall},
+    {"heights", modules_sector_map_heights},
+    {"find", modules_sector_map_find},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_sector_renderer_functions[] = {
+    {"new", modules_sector_renderer_new},
+    {"clear", modules_sector_renderer_clear},
+    {"render", modules_sector_renderer_render},
+    {"camera", modules_sector_renderer_camera},
+    {"feature", modules_sector_renderer_feature},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_sector_renderer_meta_functions[] = {
+    {"__index", modules_sector_renderer_meta_index},
+    {"__gc", modules_sector_renderer_meta_gc},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_sector_map_meta_functions[] = {
+    {"__index", modules_sector_map_meta_index},
+    {"__gc", modules_sector_map_meta_gc},
+    {NULL, NULL}
+};
+
+int luaopen_sector(lua_State* L) {
+    lua_newtable(L);
+
+    lua_pushstring(L, "Renderer");
+    luaL_newlib(L, modules_sector_renderer_functions);
+    lua_settable(L, -3);
+
+    luaL_newmetatable(L, "sector_renderer");
+    luaL_setfuncs(L, modules_sector_renderer_meta_functions, 0);
+    lua_pop(L, 1);
+
+    lua_pushstring(L, "Map");
+    luaL_newlib(L, modules_sector_map_functions);
+    lua_settable(L, -3);
+
+    luaL_newmetatable(L, "sector_map");
+    luaL_setfuncs(L, modules_sector_map_meta_functions, 0);
+    lua_pop(L, 1);
+
+    return 1;
+}
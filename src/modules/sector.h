@@ -0,0 +1,8 @@
+#ifndef MODULES_SECTOR_H
+#define MODULES_SECTOR_H
+
+#include <lua/lua.h>
+
+int luaopen_sector(lua_State* L);
+
+#endif
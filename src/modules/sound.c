@@ -9,9 +9,12 @@
 #include <lua/lauxlib.h>
 #include <lua/lualib.h>
 
+#include "float_array.h"
 #include "sound.h"
 
+#include "../mixer.h"
 #include "../sounds.h"
+#include "../streams.h"
 
 sound_t* luaL_checksound(lua_State* L, int index) {
     sound_t** handle = NULL;
@@ -33,6 +36,27 @@ int lua_pushsound(lua_State* L, sound_t* sound) {
     return 1;
 }
 
+/**
+ * Get open stream at given index. Raises an error if stream is closed.
+ */
+static stream_t* luaL_checkstream(lua_State* L, int index) {
+    stream_t** handle = (stream_t**)luaL_checkudata(L, index, "sound_stream");
+
+    if (!*handle) {
+        luaL_error(L, "attempt to use a closed stream");
+    }
+
+    return *handle;
+}
+
+int lua_newsound(lua_State* L, sound_t* sound) {
+    sound_t** handle = (sound_t**)lua_newuserdata(L, sizeof(sound_t*));
+    *handle = sound;
+    luaL_setmetatable(L, "sound");
+
+    return 1;
+}
+
 static int modules_sound_gc(lua_State* L) {
     sound_t** sound = lua_touserdata(L, 1);
     sounds_sound_free(*sound);
@@ -130,21 +154,156 @@ static int modules_sound_new(lua_State* L) {
     return 1;
 }
 
+/**
+ * Stops a playing voice.
+ * @function stop
+ * @tparam integer voice Voice returned by play.
+ */
+static int modules_sound_stop(lua_State* L) {
+    int voice = (int)luaL_checkinteger(L, 1);
+    mixer_voice_stop(voice);
+
+    return 0;
+}
+
+/**
+ * Stops all playing voices.
+ * @function stop_all
+ */
+static int modules_sound_stop_all(lua_State* L) {
+    mixer_stop_all();
+
+    return 0;
+}
+
+/**
+ * Checks if a voice is still playing.
+ * @function is_playing
+ * @tparam integer voice Voice returned by play.
+ * @treturn boolean
+ */
+static int modules_sound_is_playing(lua_State* L) {
+    int voice = (int)luaL_checkinteger(L, 1);
+    lua_pushboolean(L, mixer_voice_is_playing(voice));
+
+    return 1;
+}
+
+/**
+ * Changes parameters of a playing voice.
+ * @function set_voice
+ * @tparam integer voice Voice returned by play.
+ * @tparam number volume Volume from 0 to 1. Unchanged if nil. (optional)
+ * @tparam number pan Pan from -1 (left) to 1 (right). Unchanged if nil. (optional)
+ * @tparam number pitch Playback speed, 1 is normal. Unchanged if nil. (optional)
+ */
+static int modules_sound_voice_set(lua_State* L) {
+    int voice = (int)luaL_checkinteger(L, 1);
+
+    float volume, pan, pitch;
+    if (!mixer_voice_get(voice, &volume, &pan, &pitch)) return 0;
+
+    volume = (float)luaL_optnumber(L, 2, volume);
+    pan = (float)luaL_optnumber(L, 3, pan);
+    pitch = (float)luaL_optnumber(L, 4, pitch);
+
+    mixer_voice_set(voice, volume, pan, pitch);
+
+    return 0;
+}
+
+/**
+ * Gets parameters of a voice.
+ * @function get_voice
+ * @tparam integer voice Voice returned by play.
+ * @treturn number Volume
+ * @treturn number Pan
+ * @treturn number Pitch
+ */
+static int modules_sound_voice_get(lua_State* L) {
+    int voice = (int)luaL_checkinteger(L, 1);
+
+    float volume, pan, pitch;
+    if (!mixer_voice_get(voice, &volume, &pan, &pitch)) return 0;
+
+    lua_pushnumber(L, volume);
+    lua_pushnumber(L, pan);
+    lua_pushnumber(L, pitch);
+
+    return 3;
+}
+
+/**
+ * Open a sound for streaming. Streams are decoded a little at a time while
+ * they play instead of being loaded up front, use them for music and other
+ * long sounds. Streams opened from a zip file hold their entry inflated in
+ * memory, use an asset pack to stream from disk.
+ * @function stream
+ * @tparam string filename Name of WAV file to stream.
+ * @treturn stream
+ */
+static int modules_sound_stream_open(lua_State* L) {
+    const char* filename = luaL_checkstring(L, 1);
+
+    stream_t* stream = streams_stream_open(filename);
+    if (!stream) {
+        return luaL_error(L, "failed to open stream: %s", filename);
+    }
+
+    stream_t** handle = (stream_t**)lua_newuserdata(L, sizeof(stream_t*));
+    *handle = stream;
+    luaL_setmetatable(L, "sound_stream");
+
+    return 1;
+}
+
 /**
  * @type sound
  */
 
 /**
- * Plays sound.
+ * Plays sound. Options can be given instead of a channel.
  * @function play
- * @tparam integer channel Channel to play sound on. (optional)
+ * @tparam[opt] integer|table channel Channel to play sound on, or table of
+ * options: channel, volume (0 to 1), pan (-1 to 1), pitch and loop.
+ * @treturn integer Voice playing sound, nil if sound could not be played.
  */
 static int modules_sound_play(lua_State* L) {
     sound_t* sound = luaL_checksound(L, 1);
-    int channel = luaL_optnumber(L, 2, -1);
-    sounds_sound_play(sound, channel);
 
-    return 0;
+    int channel = -1;
+    float volume = 1.0f;
+    float pan = 0.0f;
+    float pitch = 1.0f;
+    bool loop = false;
+
+    if (lua_istable(L, 2)) {
+        lua_getfield(L, 2, "channel");
+        channel = (int)luaL_optinteger(L, -1, channel);
+        lua_getfield(L, 2, "volume");
+        volume = (float)luaL_optnumber(L, -1, volume);
+        lua_getfield(L, 2, "pan");
+        pan = (float)luaL_optnumber(L, -1, pan);
+        lua_getfield(L, 2, "pitch");
+        pitch = (float)luaL_optnumber(L, -1, pitch);
+        lua_getfield(L, 2, "loop");
+        loop = lua_toboolean(L, -1);
+        lua_pop(L, 5);
+    }
+    else {
+        channel = (int)luaL_optnumber(L, 2, -1);
+    }
+
+    int voice = mixer_play(sound, channel, volume, pan, pitch, loop);
+
+    if (voice < 0) {
+        lua_pushnil(L);
+    }
+    else {
+        lua_pushinteger(L, voice);
+    }
+
+    return 1;
 }
 
 /**
@@ -205,6 +364,54 @@ static int modules_sound_frame_get(lua_State* L) {
     return frame_size;
 }
 
+/**
+ * Sets PCM data for a run of frames from a floatarray. Samples are
+ * interleaved by channel and range from -1 to 1.
+ * @function set_frames
+ * @tparam floatarray samples Samples to copy.
+ * @tparam[opt=0] integer offset Index of first frame to set.
+ * @treturn integer Number of frames set.
+ */
+static int modules_sound_frames_set(lua_State* L) {
+    sound_t* sound = luaL_checksound(L, 1);
+    float_array_t* array = luaL_checkfloatarray(L, 2);
+    lua_Integer offset = luaL_optinteger(L, 3, 0);
+
+    luaL_argcheck(L, offset >= 0, 3, "offset must not be negative");
+
+    uint64_t frame_count = array->size / sound->channel_count;
+    lua_pushinteger(L, (lua_Integer)sounds_sound_frames_set(sound, offset, frame_count, array->data));
+
+    return 1;
+}
+
+/**
+ * Gets PCM data for a run of frames as a floatarray. Samples are
+ * interleaved by channel and range from -1 to 1.
+ * @function get_frames
+ * @tparam[opt=0] integer offset Index of first frame to get.
+ * @tparam[opt] integer count Number of frames to get. Defaults to rest of sound.
+ * @treturn floatarray
+ */
+static int modules_sound_frames_get(lua_State* L) {
+    sound_t* sound = luaL_checksound(L, 1);
+    lua_Integer offset = luaL_optinteger(L, 2, 0);
+
+    luaL_argcheck(L, offset >= 0, 2, "offset must not be negative");
+
+    uint64_t remaining = (uint64_t)offset < sound->frame_count ? sound->frame_count - offset : 0;
+    lua_Integer count = luaL_optinteger(L, 3, (lua_Integer)remaining);
+
+    luaL_argcheck(L, count >= 0, 3, "count must not be negative");
+    if ((uint64_t)count > remaining) count = remaining;
+
+    lua_newfloatarray(L, count * sound->channel_count);
+    float_array_t* array = luaL_checkfloatarray(L, -1);
+    sounds_sound_frames_get(sound, offset, count, array->data);
+
+    return 1;
+}
+
 /**
  * An array copy of PCM data.
  * @tfield {integer,...} pcm
@@ -215,12 +422,183 @@ static int modules_sound_frame_get(lua_State* L) {
  * @tfield integer frame_count (read-only)
  */
 
+/**
+ * @type stream
+ */
+
+/**
+ * Plays stream from its current position. Restarts stream if it has ended.
+ * @function play
+ * @tparam[opt] table options Table of options: volume (0 to 1), pan (-1 to 1),
+ * pitch and loop.
+ * @treturn integer Voice playing stream, nil if stream could not be played.
+ */
+static int modules_sound_stream_play(lua_State* L) {
+    stream_t* stream = luaL_checkstream(L, 1);
+
+    float volume = 1.0f;
+    float pan = 0.0f;
+    float pitch = 1.0f;
+
+    if (lua_istable(L, 2)) {
+        lua_getfield(L, 2, "volume");
+        volume = (float)luaL_optnumber(L, -1, volume);
+        lua_getfield(L, 2, "pan");
+        pan = (float)luaL_optnumber(L, -1, pan);
+        lua_getfield(L, 2, "pitch");
+        pitch = (float)luaL_optnumber(L, -1, pitch);
+        lua_getfield(L, 2, "loop");
+        if (!lua_isnil(L, -1)) {
+            streams_stream_loop_set(stream, lua_toboolean(L, -1));
+        }
+        lua_pop(L, 4);
+    }
+
+    int voice = streams_stream_play(stream, volume, pan, pitch);
+
+    if (voice < 0) {
+        lua_pushnil(L);
+    }
+    else {
+        lua_pushinteger(L, voice);
+    }
+
+    return 1;
+}
+
+/**
+ * Stops stream and moves back to its start.
+ * @function stop
+ */
+static int modules_sound_stream_stop(lua_State* L) {
+    stream_t* stream = luaL_checkstream(L, 1);
+    streams_stream_stop(stream);
+
+    return 0;
+}
+
+/**
+ * Moves stream to given position. A playing stream continues from there.
+ * @function seek
+ * @tparam number seconds Position in seconds.
+ */
+static int modules_sound_stream_seek(lua_State* L) {
+    stream_t* stream = luaL_checkstream(L, 1);
+    double seconds = luaL_checknumber(L, 2);
+
+    streams_stream_seek(stream, seconds);
+
+    return 0;
+}
+
+/**
+ * Checks if stream is playing.
+ * @function is_playing
+ * @treturn boolean
+ */
+static int modules_sound_stream_is_playing(lua_State* L) {
+    stream_t* stream = luaL_checkstream(L, 1);
+    lua_pushboolean(L, streams_stream_is_playing(stream));
+
+    return 1;
+}
+
+/**
+ * Stops and closes stream. Happens automatically when stream is garbage
+ * collected.
+ * @function close
+ */
+static int modules_sound_stream_close(lua_State* L) {
+    stream_t** handle = (stream_t**)luaL_checkudata(L, 1, "sound_stream");
+
+    if (*handle) {
+        streams_stream_free(*handle);
+        *handle = NULL;
+    }
+
+    return 0;
+}
+
+/**
+ * Restart stream when it reaches its end.
+ * @tfield boolean loop
+ */
+
+/**
+ * Current position in seconds.
+ * @tfield number position (read-only)
+ */
+
+/**
+ * Length in seconds.
+ * @tfield number duration (read-only)
+ */
+
+static int modules_sound_stream_meta_index(lua_State* L) {
+    luaL_checkudata(L, 1, "sound_stream");
+    const char* key = luaL_checkstring(L, 2);
+
+    if (strcmp(key, "loop") == 0) {
+        lua_pushboolean(L, luaL_checkstream(L, 1)->is_looping);
+    }
+    else if (strcmp(key, "position") == 0) {
+        lua_pushnumber(L, streams_stream_position_get(luaL_checkstream(L, 1)));
+    }
+    else if (strcmp(key, "duration") == 0) {
+        stream_t* stream = luaL_checkstream(L, 1);
+        uint32_t sample_rate = stream->source.sample_rate;
+        lua_pushnumber(L, sample_rate ? (double)stream->source.frame_count / sample_rate : 0);
+    }
+    else {
+        // Methods are stored in the metatable
+        lua_getmetatable(L, 1);
+        lua_getfield(L, -1, key);
+    }
+
+    return 1;
+}
+
+static int modules_sound_stream_meta_newindex(lua_State* L) {
+    stream_t* stream = luaL_checkstream(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    if (strcmp(key, "loop") == 0) {
+        streams_stream_loop_set(stream, lua_toboolean(L, 3));
+    }
+    else {
+        luaL_error(L, "attempt to index a stream value");
+    }
+
+    return 0;
+}
+
+static const struct luaL_Reg modules_sound_stream_meta_functions[] = {
+    {"__index", modules_sound_stream_meta_index},
+    {"__newindex", modules_sound_stream_meta_newindex},
+    {"__gc", modules_sound_stream_close},
+    {"__close", modules_sound_stream_close},
+    {"play", modules_sound_stream_play},
+    {"stop", modules_sound_stream_stop},
+    {"seek", modules_sound_stream_seek},
+    {"is_playing", modules_sound_stream_is_playing},
+    {"close", modules_sound_stream_close},
+    {NULL, NULL}
+};
+
 static const struct luaL_Reg modules_sound_functions[] = {
     {"new", modules_sound_new},
+    {"stream", modules_sound_stream_open},
     {"copy", modules_sound_copy},
     {"set_frame", modules_sound_frame_set},
     {"get_frame", modules_sound_frame_get},
+    {"set_frames", modules_sound_frames_set},
+    {"get_frames", modules_sound_frames_get},
     {"play", modules_sound_play},
+    {"stop", modules_sound_stop},
+    {"stop_all", modules_sound_stop_all},
+    {"is_playing", modules_sound_is_playing},
+    {"set_voice", modules_sound_voice_set},
+    {"get_voice", modules_sound_voice_get},
     {NULL, NULL}
 };
 
@@ -243,5 +621,11 @@ int luaopen_sound(lua_State* L) {
 
     lua_pop(L, 1);
 
+    // Push stream userdata metatable
+    luaL_newmetatable(L, "sound_stream");
+    luaL_setfuncs(L, modules_sound_stream_meta_functions, 0);
+
+    lua_pop(L, 1);
+
     return 1;
 }
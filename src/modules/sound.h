@@ -11,6 +11,9 @@ sound_t* luaL_checksound(lua_State* L, int index);
 /* Pushes a texture onto the stack. Created userdata will not be garbage collected. */
 int lua_pushsound(lua_State* L, sound_t* sound);
 
+/* Pushes a sound onto the stack. Created userdata owns sound and will be garbage collected. */
+int lua_newsound(lua_State* L, sound_t* sound);
+
 int luaopen_sound(lua_State* L);
 
 #endif
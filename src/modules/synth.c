@@ -0,0 +1,174 @@
+/**
+ * Module for generating sound effects.
+ *
+ * @usage
+ * synth = require("synth")
+ *
+ * jump = synth.render({wave = "square", frequency = 300, frequency_end = 600, release = 0.2})
+ * jump:play()
+ *
+ * @module synth
+ */
+
+#include <lua/lua.h>
+#include <lua/lauxlib.h>
+#include <lua/lualib.h>
+
+#include "sound.h"
+#include "synth.h"
+
+#include "../synth.h"
+
+static const char* const wave_names[] = {"square", "saw", "sine", "triangle", "noise", NULL};
+
+/**
+ * Get number field of table at index, or default if missing.
+ */
+static float field_number_get(lua_State* L, int index, const char* key, float value) {
+    lua_getfield(L, index, key);
+    value = (float)luaL_optnumber(L, -1, value);
+    lua_pop(L, 1);
+
+    return value;
+}
+
+/**
+ * Render a sound effect. Sound length is the sum of attack, decay, hold and
+ * release.
+ * @function render
+ * @tparam table params Effect parameters, all optional:
+ * wave ("square", "saw", "sine", "triangle" or "noise"),
+ * frequency and frequency_end (Hz), duty (0 to 1),
+ * vibrato_depth (fraction of frequency), vibrato_speed (Hz), volume (0 to 1),
+ * attack, decay, hold and release (seconds), sustain (0 to 1),
+ * lowpass and highpass (cutoff Hz) and seed.
+ * @treturn sound.sound
+ */
+static int modules_synth_render(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    synth_params_t params;
+    synth_params_default(&params);
+
+    lua_getfield(L, 1, "wave");
+    params.wave = (synth_wave_t)luaL_checkoption(L, -1, "square", wave_names);
+    lua_pop(L, 1);
+
+    params.frequency = field_number_get(L, 1, "frequency", params.frequency);
+    params.frequency_end = field_number_get(L, 1, "frequency_end", params.frequency);
+    params.duty = field_number_get(L, 1, "duty", params.duty);
+    params.vibrato_depth = field_number_get(L, 1, "vibrato_depth", params.vibrato_depth);
+    params.vibrato_speed = field_number_get(L, 1, "vibrato_speed", params.vibrato_speed);
+    params.volume = field_number_get(L, 1, "volume", params.volume);
+    params.attack = field_number_get(L, 1, "attack", params.attack);
+    params.decay = field_number_get(L, 1, "decay", params.decay);
+    params.sustain = field_number_get(L, 1, "sustain", params.sustain);
+    params.hold = field_number_get(L, 1, "hold", params.hold);
+    params.release = field_number_get(L, 1, "release", params.release);
+    params.lowpass = field_number_get(L, 1, "lowpass", params.lowpass);
+    params.highpass = field_number_get(L, 1, "highpass", params.highpass);
+
+    lua_getfield(L, 1, "seed");
+    params.seed = (uint32_t)luaL_optinteger(L, -1, params.seed);
+    lua_pop(L, 1);
+
+    sound_t* sound = synth_render(&params);
+    if (!sound) {
+        luaL_error(L, "failed to render sound");
+    }
+
+    lua_newsound(L, sound);
+
+    return 1;
+}
+
+/**
+ * Render an oscillator into a sound, replacing its contents.
+ * @function oscillator
+ * @tparam sound.sound sound Sound to render into.
+ * @tparam string wave "square", "saw", "sine", "triangle" or "noise".
+ * @tparam number frequency Frequency in Hz at start.
+ * @tparam[opt] number frequency_end Frequency in Hz at end. Defaults to frequency.
+ * @tparam[opt=0.5] number duty Portion of square wave period spent high.
+ * @tparam[opt=0.5] number volume Volume from 0 to 1.
+ * @tparam[opt=1] integer seed Noise seed.
+ */
+static int modules_synth_oscillator(lua_State* L) {
+    sound_t* sound = luaL_checksound(L, 1);
+    synth_wave_t wave = (synth_wave_t)luaL_checkoption(L, 2, NULL, wave_names);
+    float frequency = (float)luaL_checknumber(L, 3);
+    float frequency_end = (float)luaL_optnumber(L, 4, frequency);
+    float duty = (float)luaL_optnumber(L, 5, 0.5);
+    float volume = (float)luaL_optnumber(L, 6, 0.5);
+    uint32_t seed = (uint32_t)luaL_optinteger(L, 7, 1);
+
+    synth_oscillator_render(sound, wave, frequency, frequency_end, duty, volume, seed);
+
+    return 0;
+}
+
+/**
+ * Shape a sound with an ADSR envelope. Sustain lasts until release starts
+ * at the end of the sound.
+ * @function envelope
+ * @tparam sound.sound sound Sound to shape.
+ * @tparam number attack Attack time in seconds.
+ * @tparam number decay Decay time in seconds.
+ * @tparam number sustain Sustain level from 0 to 1.
+ * @tparam number release Release time in seconds.
+ */
+static int modules_synth_envelope(lua_State* L) {
+    sound_t* sound = luaL_checksound(L, 1);
+    float attack = (float)luaL_checknumber(L, 2);
+    float decay = (float)luaL_checknumber(L, 3);
+    float sustain = (float)luaL_checknumber(L, 4);
+    float release = (float)luaL_checknumber(L, 5);
+
+    synth_envelope_apply(sound, attack, decay, sustain, release);
+
+    return 0;
+}
+
+/**
+ * Filter out frequencies above cutoff.
+ * @function lowpass
+ * @tparam sound.sound sound Sound to filter.
+ * @tparam number cutoff Cutoff frequency in Hz.
+ */
+static int modules_synth_lowpass(lua_State* L) {
+    sound_t* sound = luaL_checksound(L, 1);
+    float cutoff = (float)luaL_checknumber(L, 2);
+
+    synth_lowpass_apply(sound, cutoff);
+
+    return 0;
+}
+
+/**
+ * Filter out frequencies below cutoff.
+ * @function highpass
+ * @tparam sound.sound sound Sound to filter.
+ * @tparam number cutoff Cutoff frequency in Hz.
+ */
+static int modules_synth_highpass(lua_State* L) {
+    sound_t* sound = luaL_checksound(L, 1);
+    float cutoff = (float)luaL_checknumber(L, 2);
+
+    synth_highpass_apply(sound, cutoff);
+
+    return 0;
+}
+
+static const struct luaL_Reg modules_synth_functions[] = {
+    {"render", modules_synth_render},
+    {"oscillator", modules_synth_oscillator},
+    {"envelope", modules_synth_envelope},
+    {"lowpass", modules_synth_lowpass},
+    {"highpass", modules_synth_highpass},
+    {NULL, NULL}
+};
+
+int luaopen_synth(lua_State* L) {
+    luaL_newlib(L, modules_synth_functions);
+    return 1;
+}
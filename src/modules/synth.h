@@ -0,0 +1,8 @@
+#ifndef MODULES_SYNTH_H
+#define MODULES_SYNTH_H
+
+#include <lua/lua.h>
+
+int luaopen_synth(lua_State* L);
+
+#endif
@@ -9,17 +9,43 @@
 #include <lua/lauxlib.h>
 #include <lua/lualib.h>
 
+#include "int_array.h"
 #include "texture.h"
 
 #include "../assets.h"
 #include "../graphics.h"
 
+/**
+ * Texture userdata of a texture owned by an asset. Keeps the asset pinned
+ * while referenced. Texture must be the first member so the userdata can be
+ * used as texture_t**.
+ */
+typedef struct {
+    texture_t* texture;
+    int handle;
+} texture_asset_ref_t;
+
+texture_t* luaL_testtexture(lua_State* L, int index) {
+    texture_t** handle = (texture_t**)luaL_testudata(L, index, "texture_nogc");
+    if (!handle) {
+        handle = (texture_t**)luaL_testudata(L, index, "texture_asset");
+    }
+    if (!handle) {
+        handle = (texture_t**)luaL_testudata(L, index, "texture");
+    }
+
+    return handle ? *handle : NULL;
+}
+
 texture_t* luaL_checktexture(lua_State* L, int index) {
     texture_t** handle = NULL;
     luaL_checktype(L, index, LUA_TUSERDATA);
 
     // Ensure we have correct userdata
     handle = (texture_t**)luaL_testudata(L, index, "texture_nogc");
+    if (!handle) {
+        handle = (texture_t**)luaL_testudata(L, index, "texture_asset");
+    }
     if (!handle) {
         handle = (texture_t**)luaL_checkudata(L, index, "texture");
     }
@@ -30,20 +56,11 @@ texture_t* luaL_checktexture(lua_State* L, int index) {
 texture_t* luaL_opttexture(lua_State* L, int index, texture_t* default_) {
     if (lua_isnoneornil(L, 2)) return default_;
 
-    texture_t** handle = NULL;
     luaL_checktype(L, index, LUA_TUSERDATA);
 
-    // Ensure we have correct userdata
-    handle = (texture_t**)luaL_testudata(L, index, "texture_nogc");
-    if (!handle) {
-        handle = (texture_t**)luaL_testudata(L, index, "texture");
-    }
-
-    if (!handle) {
-        return default_;
-    }
+    texture_t* texture = luaL_testtexture(L, index);
 
-    return *handle;
+    return texture ? texture : default_;
 }
 
 int lua_newtexture(lua_State* L, int width, int height) {
@@ -62,6 +79,17 @@ int lua_pushtexture(lua_State* L, texture_t* texture) {
     return 1;
 }
 
+int lua_pushassettexture(lua_State* L, texture_t* texture, int handle) {
+    texture_asset_ref_t* ref = (texture_asset_ref_t*)lua_newuserdata(L, sizeof(texture_asset_ref_t));
+    ref->texture = texture;
+    ref->handle = handle;
+    luaL_setmetatable(L, "texture_asset");
+
+    assets_pin(handle);
+
+    return 1;
+}
+
 static int texture_gc(lua_State* L) {
     texture_t** texture = lua_touserdata(L, 1);
     graphics_texture_free(*texture);
@@ -70,6 +98,14 @@ static int texture_gc(lua_State* L) {
     return 0;
 }
 
+static int texture_asset_gc(lua_State* L) {
+    texture_asset_ref_t* ref = lua_touserdata(L, 1);
+    assets_unpin(ref->handle);
+    ref->texture = NULL;
+
+    return 0;
+}
+
 static int modules_texture_meta_index(lua_State* L) {
     texture_t* texture = luaL_checktexture(L, 1);
     const char* key = luaL_checkstring(L, 2);
@@ -77,12 +113,12 @@ static int modules_texture_meta_index(lua_State* L) {
     lua_settop(L, 0);
 
     if (strcmp(key, "pixels") == 0) {
-        lua_newtable(L);
+        int pixel_count = texture->width * texture->height;
+        lua_createtable(L, pixel_count, 0);
 
-        for (int i = 0; i < texture->width * texture->height; i++) {
-            lua_pushinteger(L, i + 1);
+        for (int i = 0; i < pixel_count; i++) {
             lua_pushinteger(L, texture->pixels[i]);
-            lua_settable(L, -3);
+            lua_rawseti(L, -2, i + 1);
         }
     }
     else if (strcmp(key, "width") == 0) {
@@ -105,6 +141,67 @@ static int modules_texture_meta_index(lua_State* L) {
     return 1;
 }
 
+/**
+ * Get rect from optional x, y, width and height arguments starting at given
+ * index. Missing width and height extend to the texture edge, and no arguments
+ * at all select the entire texture. Raises an error if rect is not inside the
+ * texture.
+ */
+static rect_t rect_check(lua_State* L, int index, texture_t* texture) {
+    rect_t rect = {0, 0, texture->width, texture->height};
+
+    if (!lua_isnoneornil(L, index)) {
+        rect.x = (int)luaL_checknumber(L, index);
+        rect.y = (int)luaL_checknumber(L, index + 1);
+        rect.width = (int)luaL_optnumber(L, index + 2, texture->width - rect.x);
+        rect.height = (int)luaL_optnumber(L, index + 3, texture->height - rect.y);
+    }
+
+    bool inside = rect.x >= 0 && rect.y >= 0 && rect.width >= 0 && rect.height >= 0 &&
+        rect.x <= texture->width && rect.y <= texture->height &&
+        rect.width <= texture->width - rect.x && rect.height <= texture->height - rect.y;
+
+    luaL_argcheck(L, inside, index, "rect outside texture");
+
+    return rect;
+}
+
+/**
+ * Push pixels of given rect as a string of bytes, one row after another.
+ */
+static void bytes_push(lua_State* L, texture_t* texture, rect_t rect) {
+    size_t size = (size_t)rect.width * rect.height;
+
+    // Whole rows are contiguous in memory
+    if (rect.width == texture->width) {
+        lua_pushlstring(L, (const char*)(texture->pixels + rect.y * texture->width), size);
+        return;
+    }
+
+    luaL_Buffer buffer;
+    char* bytes = luaL_buffinitsize(L, &buffer, size);
+
+    for (int y = 0; y < rect.height; y++) {
+        memcpy(bytes + y * rect.width, texture->pixels + (rect.y + y) * texture->width + rect.x, rect.width);
+    }
+
+    luaL_pushresultsize(&buffer, size);
+}
+
+/**
+ * Copy string of bytes at given index to pixels of given rect.
+ */
+static void bytes_set(lua_State* L, int index, texture_t* texture, rect_t rect) {
+    size_t length = 0;
+    const char* bytes = luaL_checklstring(L, index, &length);
+
+    luaL_argcheck(L, length == (size_t)rect.width * rect.height, index, "byte count does not match rect size");
+
+    for (int y = 0; y < rect.height; y++) {
+        memcpy(texture->pixels + (rect.y + y) * texture->width + rect.x, bytes + y * rect.width, rect.width);
+    }
+}
+
 static int modules_texture_meta_newindex(lua_State* L) {
     texture_t* texture = luaL_checktexture(L, 1);
     const char* key = luaL_checkstring(L, 2);
@@ -115,9 +212,7 @@ static int modules_texture_meta_newindex(lua_State* L) {
 
         if (table_size == pixel_count) {
             for (int i = 0; i < pixel_count; i++) {
-                int index = i + 1;
-                lua_pushinteger(L, index);
-                lua_gettable(L, 3);
+                lua_rawgeti(L, 3, i + 1);
 
                 texture->pixels[i] = (int)luaL_checknumber(L, -1);
 
@@ -127,7 +222,7 @@ static int modules_texture_meta_newindex(lua_State* L) {
             lua_settop(L, 0);
         }
         else {
-            luaL_error(L, "BAD!");
+            luaL_error(L, "pixel table size does not match texture size");
         }
     }
     else {
@@ -313,8 +408,140 @@ static int modules_texture_blit(lua_State* L) {
     return 0;
 }
 
+/**
+ * Returns pixels as a string with one byte per pixel, one row after another.
+ * Much faster than the pixels field for reading a whole texture.
+ * @function get_bytes
+ * @tparam[opt] integer x Rect x-offset
+ * @tparam[opt] integer y Rect y-offset
+ * @tparam[opt] integer w Rect width, defaults to rest of the row
+ * @tparam[opt] integer h Rect height, defaults to rest of the texture
+ * @treturn string Pixel bytes
+ */
+static int modules_texture_bytes_get(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    rect_t rect = rect_check(L, 2, texture);
+
+    bytes_push(L, texture, rect);
+
+    return 1;
+}
+
+/**
+ * Sets pixels from a string with one byte per pixel, one row after another.
+ * String length must match the rect size.
+ * @function set_bytes
+ * @tparam string bytes Pixel bytes
+ * @tparam[opt] integer x Rect x-offset
+ * @tparam[opt] integer y Rect y-offset
+ * @tparam[opt] integer w Rect width, defaults to rest of the row
+ * @tparam[opt] integer h Rect height, defaults to rest of the texture
+ */
+static int modules_texture_bytes_set(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    rect_t rect = rect_check(L, 3, texture);
+
+    bytes_set(L, 2, texture, rect);
+
+    return 0;
+}
+
+/**
+ * Returns a row of pixels as a string with one byte per pixel.
+ * @function get_row
+ * @tparam integer y Row y-coordinate
+ * @treturn string Pixel bytes
+ */
+static int modules_texture_row_get(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    int y = (int)luaL_checknumber(L, 2);
+
+    luaL_argcheck(L, y >= 0 && y < texture->height, 2, "row outside texture");
+
+    bytes_push(L, texture, (rect_t) {0, y, texture->width, 1});
+
+    return 1;
+}
+
+/**
+ * Sets a row of pixels from a string with one byte per pixel. String length
+ * must match the texture width.
+ * @function set_row
+ * @tparam integer y Row y-coordinate
+ * @tparam string bytes Pixel bytes
+ */
+static int modules_texture_row_set(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    int y = (int)luaL_checknumber(L, 2);
+
+    luaL_argcheck(L, y >= 0 && y < texture->height, 2, "row outside texture");
+
+    bytes_set(L, 3, texture, (rect_t) {0, y, texture->width, 1});
+
+    return 0;
+}
+
+/**
+ * Copies pixels to an intarray, one row after another.
+ * @function to_intarray
+ * @tparam[opt] intarray.intarray out Array to store pixels in, grown if needed
+ * @tparam[opt] integer x Rect x-offset
+ * @tparam[opt] integer y Rect y-offset
+ * @tparam[opt] integer w Rect width, defaults to rest of the row
+ * @tparam[opt] integer h Rect height, defaults to rest of the texture
+ * @treturn intarray.intarray Array of pixels
+ */
+static int modules_texture_to_intarray(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    rect_t rect = rect_check(L, 3, texture);
+
+    int_array_t* array = lua_outintarray(L, 2, (size_t)rect.width * rect.height);
+    int* data = array->data;
+
+    for (int y = 0; y < rect.height; y++) {
+        const color_t* row = texture->pixels + (rect.y + y) * texture->width + rect.x;
+
+        for (int x = 0; x < rect.width; x++) {
+            *data++ = row[x];
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Sets pixels from an intarray, one row after another. Array must hold at
+ * least as many values as the rect has pixels.
+ * @function from_intarray
+ * @tparam intarray.intarray array Array of pixels
+ * @tparam[opt] integer x Rect x-offset
+ * @tparam[opt] integer y Rect y-offset
+ * @tparam[opt] integer w Rect width, defaults to rest of the row
+ * @tparam[opt] integer h Rect height, defaults to rest of the texture
+ */
+static int modules_texture_from_intarray(lua_State* L) {
+    texture_t* texture = luaL_checktexture(L, 1);
+    int_array_t* array = luaL_checkintarray(L, 2);
+    rect_t rect = rect_check(L, 3, texture);
+
+    luaL_argcheck(L, array->size >= (size_t)rect.width * rect.height, 2, "array smaller than rect");
+
+    const int* data = array->data;
+
+    for (int y = 0; y < rect.height; y++) {
+        color_t* row = texture->pixels + (rect.y + y) * texture->width + rect.x;
+
+        for (int x = 0; x < rect.width; x++) {
+            row[x] = (color_t)*data++;
+        }
+    }
+
+    return 0;
+}
+
 /**
  * An array copy of pixel indices.
+ * Use get_bytes or to_intarray when reading whole textures.
  * @tfield {integer,...} pixels
  */
 
@@ -335,6 +562,12 @@ static const struct luaL_Reg modules_texture_functions[] = {
     {"set_pixel", modules_texture_pixel_set},
     {"get_pixel", modules_texture_pixel_get},
     {"blit", modules_texture_blit},
+    {"get_bytes", modules_texture_bytes_get},
+    {"set_bytes", modules_texture_bytes_set},
+    {"get_row", modules_texture_row_get},
+    {"set_row", modules_texture_row_set},
+    {"to_intarray", modules_texture_to_intarray},
+    {"from_intarray", modules_texture_from_intarray},
     {NULL, NULL}
 };
 
@@ -357,5 +590,15 @@ int luaopen_texture(lua_State* L) {
 
     lua_pop(L, 1);
 
+    // Push texture_asset userdata metatable
+    luaL_newmetatable(L, "texture_asset");
+    luaL_setfuncs(L, modules_texture_meta_functions, 0);
+
+    lua_pushstring(L, "__gc");
+    lua_pushcfunction(L, texture_asset_gc);
+    lua_settable(L, -3);
+
+    lua_pop(L, 1);
+
     return 1;
 }
@@ -5,6 +5,9 @@
 
 #include "../graphics.h"
 
+/* If value at given index is a texture, return it. Otherwise return NULL. */
+texture_t* luaL_testtexture(lua_State* L, int index);
+
 /* Checks whether the function argument arg is a texture and returns a texure_t*. */
 texture_t* luaL_checktexture(lua_State* L, int index);
 
@@ -17,6 +20,9 @@ int lua_newtexture(lua_State* L, int width, int height);
 /* Pushes a texture onto the stack. Created userdata will not be garbage collected. */
 int lua_pushtexture(lua_State* L, texture_t* texture);
 
+/* Pushes a texture owned by given asset onto the stack. Asset stays pinned until userdata is garbage collected. */
+int lua_pushassettexture(lua_State* L, texture_t* texture, int handle);
+
 int luaopen_texture(lua_State* L);
 
 #endif
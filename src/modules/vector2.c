@@ -11,55 +11,55 @@
 
 #include <mathc/mathc.h>
 
+#include "scratch.h"
 #include "vector2.h"
 
-bool lua_isvector2(lua_State*L, int index) {
-    void* p = luaL_testudata(L, index, "vector2");
-    if (p == NULL) {
-        p = luaL_testudata(L, index, "vector2_nogc");
-    }
+/**
+ * Userdata layout. Values created from Lua store their components inline and
+ * point at them, values pushed from C only store the pointer.
+ */
+typedef struct {
+    mfloat_t* components;
+    mfloat_t storage[VEC2_SIZE];
+} vector2_userdata_t;
 
-    return p != NULL;
+bool lua_isvector2(lua_State* L, int index) {
+    return luaL_testudata(L, index, "vector2") != NULL;
 }
 
 mfloat_t* luaL_checkvector2(lua_State* L, int index) {
-    mfloat_t** handle = NULL;
-    luaL_checktype(L, index, LUA_TUSERDATA);
-
-    handle = (mfloat_t**)luaL_testudata(L, index, "vector2_nogc");
-    if (!handle) {
-        handle = (mfloat_t**)luaL_checkudata(L, index, "vector2");
-    }
-
-    return *handle;
+    return *(mfloat_t**)luaL_checkudata(L, index, "vector2");
 }
 
 int lua_newvector2(lua_State* L, float x, float y) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* vector = (mfloat_t*)malloc(sizeof(mfloat_t) * 2);
+    vector2_userdata_t* userdata = (vector2_userdata_t*)lua_newuserdatauv(L, sizeof(vector2_userdata_t), 0);
+    mfloat_t* vector = userdata->storage;
     vector[0] = x;
     vector[1] = y;
-    *handle = vector;
+    userdata->components = vector;
     luaL_setmetatable(L, "vector2");
 
     return 1;
 }
 
 int lua_pushvector2(lua_State* L, mfloat_t* vector) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
+    mfloat_t** handle = (mfloat_t**)lua_newuserdatauv(L, sizeof(mfloat_t*), 0);
     *handle = vector;
 
-    luaL_setmetatable(L, "vector2_nogc");
+    luaL_setmetatable(L, "vector2");
 
     return 1;
 }
 
-static int modules_vector2_gc(lua_State* L) {
-    mfloat_t** handle = lua_touserdata(L, 1);
-    free(*handle);
-    *handle = NULL;
+int lua_outvector2(lua_State* L, int index, mfloat_t* result) {
+    if (lua_isnoneornil(L, index)) {
+        return lua_newvector2(L, result[0], result[1]);
+    }
 
-    return 0;
+    vec2_assign(luaL_checkvector2(L, index), result);
+    lua_pushvalue(L, index);
+
+    return 1;
 }
 
 /**
@@ -122,13 +122,14 @@ static int modules_vector2_equal(lua_State* L) {
  * Returns a vector made from the sign of it's components.
  * @function sign
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_sign(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
     mfloat_t result[VEC2_SIZE];
     vec2_sign(result, v0);
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -139,22 +140,18 @@ static int modules_vector2_add(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC2_SIZE];
         vec2_add_f(result, v0, f);
 
-        lua_newvector2(L, result[0], result[1]);
+        lua_outvector2(L, 3, result);
     }
     else {
         mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC2_SIZE];
         vec2_add(result, v0, v1);
 
-        lua_newvector2(L, result[0], result[1]);
+        lua_outvector2(L, 3, result);
     }
 
    return 1;
@@ -166,22 +163,18 @@ static int modules_vector2_subtract(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC2_SIZE];
         vec2_subtract_f(result, v0, f);
 
-        lua_newvector2(L, result[0], result[1]);
+        lua_outvector2(L, 3, result);
     }
     else {
         mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC2_SIZE];
         vec2_subtract(result, v0, v1);
 
-        lua_newvector2(L, result[0], result[1]);
+        lua_outvector2(L, 3, result);
     }
 
     return 1;
@@ -194,12 +187,10 @@ static int modules_vector2_multiply(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC2_SIZE];
         vec2_multiply_f(result, v0, f);
 
-        lua_newvector2(L, result[0], result[1]);
+        lua_outvector2(L, 3, result);
 
         return 1;
     }
@@ -207,12 +198,10 @@ static int modules_vector2_multiply(lua_State* L) {
     // Component-wise multiplication
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_multiply(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -224,12 +213,10 @@ static int modules_vector2_divide(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC2_SIZE];
         vec2_divide_f(result, v0, f);
 
-        lua_newvector2(L, result[0], result[1]);
+        lua_outvector2(L, 3, result);
 
         return 1;
     }
@@ -237,12 +224,10 @@ static int modules_vector2_divide(lua_State* L) {
     // Component-wise division
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_divide(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -252,6 +237,7 @@ static int modules_vector2_divide(lua_State* L) {
  * @function snap
  * @tparam vector2 v0
  * @tparam number f Resolution of snap
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_snap(lua_State* L) {
@@ -261,12 +247,10 @@ static int vector2_snap(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC2_SIZE];
         vec2_snap_f(result, v0, f);
 
-        lua_newvector2(L, result[0], result[1]);
+        lua_outvector2(L, 3, result);
 
         return 1;
     }
@@ -274,12 +258,10 @@ static int vector2_snap(lua_State* L) {
     // Component-wise snapping
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_snap(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -288,17 +270,16 @@ static int vector2_snap(lua_State* L) {
  * Negates a vector.
  * @function negative
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int modules_vector2_negative(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_negative(result, v0);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -307,17 +288,16 @@ static int modules_vector2_negative(lua_State* L) {
  * Returns a vector made from the absolute values of the components.
  * @function abs
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_abs(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_abs(result, v0);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -326,17 +306,16 @@ static int vector2_abs(lua_State* L) {
  * Returns a vector made from the floor of the components.
  * @function floor
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_floor(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_floor(result, v0);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -345,17 +324,16 @@ static int vector2_floor(lua_State* L) {
  * Returns a vector made from the ceil of the components.
  * @function ceil
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_ceil(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_ceil(result, v0);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -364,17 +342,16 @@ static int vector2_ceil(lua_State* L) {
  * Returns a vector made from rounding the components.
  * @function round
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_round(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_round(result, v0);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -384,18 +361,17 @@ static int vector2_round(lua_State* L) {
  * @function max
  * @tparam vector2 v0
  * @tparam vector2 v1
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_max(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_max(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -405,18 +381,17 @@ static int vector2_max(lua_State* L) {
  * @function min
  * @tparam vector2 v0
  * @tparam vector2 v1
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_min(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_min(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -427,6 +402,7 @@ static int vector2_min(lua_State* L) {
  * @tparam vector2 v0 Vector to clamp
  * @tparam vector2 min Min vector
  * @tparam vector2 max Max vector
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_clamp(lua_State* L) {
@@ -434,12 +410,10 @@ static int vector2_clamp(lua_State* L) {
     mfloat_t* v1 = luaL_checkvector2(L, 2);
     mfloat_t* v2 = luaL_checkvector2(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_clamp(result, v0, v1, v2);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 4, result);
 
     return 1;
 }
@@ -448,17 +422,16 @@ static int vector2_clamp(lua_State* L) {
  * Returns a vector in the direction of v0 with magnitude 1.
  * @function normalize
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_normalize(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_normalize(result, v0);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -488,18 +461,17 @@ static int vector2_dot(lua_State* L) {
  * @function project
  * @tparam vector2 v0
  * @tparam vector2 v1
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_project(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_project(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -508,12 +480,10 @@ static int vector2_slide(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_slide(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -523,18 +493,17 @@ static int vector2_slide(lua_State* L) {
  * @function reflect
  * @tparam vector2 v0
  * @tparam vector2 normal Plane normal
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_reflect(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
     mfloat_t* v1 = luaL_checkvector2(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_reflect(result, v0, v1);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -543,17 +512,16 @@ static int vector2_reflect(lua_State* L) {
  * Returns a vector rotated 90 degrees clockwise from v0.
  * @function tangent
  * @tparam vector2 v0
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_tangent(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_tangent(result, v0);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 2, result);
 
     return 1;
 }
@@ -563,18 +531,17 @@ static int vector2_tangent(lua_State* L) {
  * @function rotate
  * @tparam vector2 v0
  * @tparam number radians Angle to rotate
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_rotate(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector2(L, 1);
     float f = luaL_checknumber(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_rotate(result, v0, f);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 3, result);
 
     return 1;
 }
@@ -585,6 +552,7 @@ static int vector2_rotate(lua_State* L) {
  * @tparam vector2 v0
  * @tparam vector2 v1
  * @tparam number t Value used to interpolate between v0 and v1.
+ * @tparam ?vector2 out Destination, a new vector2 is returned if omitted
  * @treturn vector2
  */
 static int vector2_lerp(lua_State* L) {
@@ -592,12 +560,10 @@ static int vector2_lerp(lua_State* L) {
     mfloat_t* v1 = luaL_checkvector2(L, 2);
     float f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC2_SIZE];
     vec2_lerp(result, v0, v1, f);
 
-    lua_newvector2(L, result[0], result[1]);
+    lua_outvector2(L, 4, result);
 
     return 1;
 }
@@ -696,8 +662,36 @@ static int vector2_distance_squared(lua_State* L) {
     return 1;
 }
 
+/**
+ * Returns a vector2 from a pool of temporaries. Values are handed out again
+ * next frame, so they must not be kept.
+ * @function scratch
+ * @tparam ?number ... Components, same as new
+ * @treturn vector2
+ */
+static int modules_vector2_scratch(lua_State* L) {
+    mfloat_t components[VEC2_SIZE];
+
+    for (int i = 0; i < VEC2_SIZE; i++) {
+        components[i] = (mfloat_t)luaL_optnumber(L, i + 1, 0);
+    }
+
+    lua_settop(L, 0);
+
+    if (lua_pushscratch(L, "vector2")) {
+        vec2_assign(luaL_checkvector2(L, 1), components);
+    }
+    else {
+        lua_newvector2(L, components[0], components[1]);
+        lua_addscratch(L, "vector2");
+    }
+
+    return 1;
+}
+
 static const struct luaL_Reg modules_vector2_functions[] = {
     {"new", vector2_new},
+    {"scratch", modules_vector2_scratch},
     {"sign", vector2_sign},
     {"snap", vector2_snap},
     {"abs", vector2_abs},
@@ -773,6 +767,38 @@ static int modules_vector2_meta_newindex(lua_State* L) {
     return 0;
 }
 
+static const luaL_InPlaceReg modules_vector2_in_place_functions[] = {
+    {"sign_", vector2_sign, 2},
+    {"add_", modules_vector2_add, 3},
+    {"subtract_", modules_vector2_subtract, 3},
+    {"multiply_", modules_vector2_multiply, 3},
+    {"divide_", modules_vector2_divide, 3},
+    {"snap_", vector2_snap, 3},
+    {"negative_", modules_vector2_negative, 2},
+    {"abs_", vector2_abs, 2},
+    {"floor_", vector2_floor, 2},
+    {"ceil_", vector2_ceil, 2},
+    {"round_", vector2_round, 2},
+    {"max_", vector2_max, 3},
+    {"min_", vector2_min, 3},
+    {"clamp_", vector2_clamp, 4},
+    {"normalize_", vector2_normalize, 2},
+    {"project_", vector2_project, 3},
+    {"slide_", vector2_slide, 3},
+    {"reflect_", vector2_reflect, 3},
+    {"tangent_", vector2_tangent, 2},
+    {"rotate_", vector2_rotate, 3},
+    {"lerp_", vector2_lerp, 4},
+    {NULL, NULL, 0}
+};
+
+/* Unary minus passes its operand twice, which must not be taken as destination. */
+static int modules_vector2_meta_unm(lua_State* L) {
+    lua_settop(L, 1);
+
+    return modules_vector2_negative(L);
+}
+
 static const struct luaL_Reg modules_vector2_meta_functions[] = {
     {"__index", modules_vector2_meta_index},
     {"__newindex", modules_vector2_meta_newindex},
@@ -780,26 +806,18 @@ static const struct luaL_Reg modules_vector2_meta_functions[] = {
     {"__sub", modules_vector2_subtract},
     {"__mul", modules_vector2_multiply},
     {"__div", modules_vector2_divide},
-    {"__unm", modules_vector2_negative},
+    {"__unm", modules_vector2_meta_unm},
     {"__eq", modules_vector2_equal},
     {NULL, NULL}
 };
 
 int luaopen_vector2(lua_State* L) {
     luaL_newlib(L, modules_vector2_functions);
+    luaL_setinplacefuncs(L, modules_vector2_in_place_functions);
 
     luaL_newmetatable(L, "vector2");
     luaL_setfuncs(L, modules_vector2_meta_functions, 0);
 
-    lua_pushstring(L, "__gc");
-    lua_pushcfunction(L, modules_vector2_gc);
-    lua_settable(L, -3);
-
-    lua_pop(L, 1);
-
-    luaL_newmetatable(L, "vector2_nogc");
-    luaL_setfuncs(L, modules_vector2_meta_functions, 0);
-
     lua_pop(L, 1);
 
     return 1;
@@ -14,9 +14,12 @@ mfloat_t* luaL_checkvector2(lua_State* L, int index);
 /* Creates and pushes on the stack a new vector2 userdata. */
 int lua_newvector2(lua_State* L, float x, float y);
 
-/* Pushes a vector2 onto the stack. Created userdata will not be garbage collected. */
+/* Pushes a vector2 onto the stack. Created userdata references given data, which must outlive it. */
 int lua_pushvector2(lua_State* L, mfloat_t* vector);
 
+/* Pushes given result, copied into the vector2 at index if there is one or into a new vector2 otherwise. */
+int lua_outvector2(lua_State* L, int index, mfloat_t* result);
+
 int luaopen_vector2(lua_State* L);
 
 #endif
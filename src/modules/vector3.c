@@ -12,56 +12,59 @@
 
 #include <mathc/mathc.h>
 
+#include "float_array.h"
+#include "scratch.h"
 #include "vector3.h"
 
-bool lua_isvector3(lua_State*L, int index) {
-    void* p = luaL_testudata(L, index, "vector3");
-    if (p == NULL) {
-        p = luaL_testudata(L, index, "vector3_nogc");
-    }
+#include "../batch.h"
+
+/**
+ * Userdata layout. Values created from Lua store their components inline and
+ * point at them, values pushed from C only store the pointer.
+ */
+typedef struct {
+    mfloat_t* components;
+    mfloat_t storage[VEC3_SIZE];
+} vector3_userdata_t;
 
-    return p != NULL;
+bool lua_isvector3(lua_State* L, int index) {
+    return luaL_testudata(L, index, "vector3") != NULL;
 }
 
 mfloat_t* luaL_checkvector3(lua_State* L, int index) {
-    mfloat_t** handle = NULL;
-    luaL_checktype(L, index, LUA_TUSERDATA);
-
-    handle = (mfloat_t**)luaL_testudata(L, index, "vector3_nogc");
-    if (!handle) {
-        handle = (mfloat_t**)luaL_checkudata(L, index, "vector3");
-    }
-
-    return *handle;
+    return *(mfloat_t**)luaL_checkudata(L, index, "vector3");
 }
 
 int lua_newvector3(lua_State* L, float x, float y, float z) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* vector = (mfloat_t*)malloc(sizeof(mfloat_t) * VEC3_SIZE);
+    vector3_userdata_t* userdata = (vector3_userdata_t*)lua_newuserdatauv(L, sizeof(vector3_userdata_t), 0);
+    mfloat_t* vector = userdata->storage;
     vector[0] = x;
     vector[1] = y;
     vector[2] = z;
-    *handle = vector;
+    userdata->components = vector;
     luaL_setmetatable(L, "vector3");
 
     return 1;
 }
 
 int lua_pushvector3(lua_State* L, mfloat_t* vector) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
+    mfloat_t** handle = (mfloat_t**)lua_newuserdatauv(L, sizeof(mfloat_t*), 0);
     *handle = vector;
 
-    luaL_setmetatable(L, "vector3_nogc");
+    luaL_setmetatable(L, "vector3");
 
     return 1;
 }
 
-static int vector3_gc(lua_State* L) {
-    mfloat_t** handle = lua_touserdata(L, 1);
-    free(*handle);
-    *handle = NULL;
+int lua_outvector3(lua_State* L, int index, mfloat_t* result) {
+    if (lua_isnoneornil(L, index)) {
+        return lua_newvector3(L, result[0], result[1], result[2]);
+    }
 
-    return 0;
+    vec3_assign(luaL_checkvector3(L, index), result);
+    lua_pushvalue(L, index);
+
+    return 1;
 }
 
 /**
@@ -147,13 +150,14 @@ static int modules_vector3_one(lua_State* L) {
  * Returns a vector made from the sign of it's components.
  * @function sign
  * @tparam vector3 v0
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_sign(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t result[VEC3_SIZE];
     vec3_sign(result, v0);
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 2, result);
 
     return 1;
 }
@@ -164,22 +168,18 @@ static int modules_vector3_add(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC3_SIZE];
         vec3_add_f(result, v0, f);
 
-        lua_newvector3(L, result[0], result[1], result[2]);
+        lua_outvector3(L, 3, result);
     }
     else {
         mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC3_SIZE];
         vec3_add(result, v0, v1);
 
-        lua_newvector3(L, result[0], result[1], result[2]);
+        lua_outvector3(L, 3, result);
     }
 
     return 1;
@@ -191,22 +191,18 @@ static int modules_vector3_subtract(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC3_SIZE];
         vec3_subtract_f(result, v0, f);
 
-        lua_newvector3(L, result[0], result[1], result[2]);
+        lua_outvector3(L, 3, result);
     }
     else {
         mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC3_SIZE];
         vec3_subtract(result, v0, v1);
 
-        lua_newvector3(L, result[0], result[1], result[2]);
+        lua_outvector3(L, 3, result);
     }
 
     return 1;
@@ -219,12 +215,10 @@ static int modules_vector3_multiply(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC3_SIZE];
         vec3_multiply_f(result, v0, f);
 
-        lua_newvector3(L, result[0], result[1], result[2]);
+        lua_outvector3(L, 3, result);
 
         return 1;
     }
@@ -232,12 +226,10 @@ static int modules_vector3_multiply(lua_State* L) {
     // Component-wise multiplication
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_multiply(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -258,12 +250,10 @@ static int modules_vector3_divide(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC3_SIZE];
         vec3_divide_f(result, v0, f);
 
-        lua_newvector3(L, result[0], result[1], result[2]);
+        lua_outvector3(L, 3, result);
 
         return 1;
     }
@@ -271,12 +261,10 @@ static int modules_vector3_divide(lua_State* L) {
     // Component-wise division
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_divide(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -286,6 +274,7 @@ static int modules_vector3_divide(lua_State* L) {
  * @function snap
  * @tparam vector3 v0
  * @tparam number f Resolution of snap
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_snap(lua_State* L) {
@@ -295,12 +284,10 @@ static int modules_vector3_snap(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC3_SIZE];
         vec3_snap_f(result, v0, f);
 
-        lua_newvector3(L, result[0], result[1], result[2]);
+        lua_outvector3(L, 3, result);
 
         return 1;
     }
@@ -308,12 +295,10 @@ static int modules_vector3_snap(lua_State* L) {
     // Component-wise snapping
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_snap(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -322,17 +307,16 @@ static int modules_vector3_snap(lua_State* L) {
  * Negates a vector.
  * @function negative
  * @tparam vector3 v0
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_negative(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_negative(result, v0);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 2, result);
 
     return 1;
 }
@@ -341,17 +325,16 @@ static int modules_vector3_negative(lua_State* L) {
  * Returns a vector made from the absolute values of the components.
  * @function abs
  * @tparam vector3 v0
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_abs(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_abs(result, v0);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 2, result);
 
     return 1;
 }
@@ -360,17 +343,16 @@ static int modules_vector3_abs(lua_State* L) {
  * Returns a vector made from the floor of the components.
  * @function floor
  * @tparam vector3 v0
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_floor(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_floor(result, v0);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 2, result);
 
     return 1;
 }
@@ -379,17 +361,16 @@ static int modules_vector3_floor(lua_State* L) {
  * Returns a vector made from the ceil of the components.
  * @function ceil
  * @tparam vector3 v0
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_ceil(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_ceil(result, v0);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 2, result);
 
     return 1;
 }
@@ -398,17 +379,16 @@ static int modules_vector3_ceil(lua_State* L) {
  * Returns a vector made from rounding the components.
  * @function round
  * @tparam vector3 v0
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_round(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_round(result, v0);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 2, result);
 
     return 1;
 }
@@ -418,18 +398,17 @@ static int modules_vector3_round(lua_State* L) {
  * @function max
  * @tparam vector3 v0
  * @tparam vector3 v1
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_max(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_max(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -439,18 +418,17 @@ static int modules_vector3_max(lua_State* L) {
  * @function min
  * @tparam vector3 v0
  * @tparam vector3 v1
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_min(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_min(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -461,6 +439,7 @@ static int modules_vector3_min(lua_State* L) {
  * @tparam vector3 v0 Vector to clamp
  * @tparam vector3 min Min vector
  * @tparam vector3 max Max vector
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_clamp(lua_State* L) {
@@ -468,12 +447,10 @@ static int modules_vector3_clamp(lua_State* L) {
     mfloat_t* v1 = luaL_checkvector3(L, 2);
     mfloat_t* v2 = luaL_checkvector3(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_clamp(result, v0, v1, v2);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 4, result);
 
     return 1;
 }
@@ -483,18 +460,17 @@ static int modules_vector3_clamp(lua_State* L) {
  * @function cross
  * @tparam vector3 v0
  * @tparam vector3 v1
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_cross(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_cross(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -503,17 +479,16 @@ static int modules_vector3_cross(lua_State* L) {
  * Returns a vector in the direction of v0 with magnitude 1.
  * @function normalize
  * @tparam vector3 v0
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_normalize(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_normalize(result, v0);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 2, result);
 
     return 1;
 }
@@ -543,18 +518,17 @@ static int modules_vector3_dot(lua_State* L) {
  * @function project
  * @tparam vector3 v0
  * @tparam vector3 v1
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_project(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_project(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -563,12 +537,10 @@ static int modules_vector3_slide(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_slide(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -578,18 +550,17 @@ static int modules_vector3_slide(lua_State* L) {
  * @function reflect
  * @tparam vector3 v0
  * @tparam vector3 normal Plane normal
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_reflect(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector3(L, 1);
     mfloat_t* v1 = luaL_checkvector3(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_reflect(result, v0, v1);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 3, result);
 
     return 1;
 }
@@ -600,6 +571,7 @@ static int modules_vector3_reflect(lua_State* L) {
  * @tparam vector3 v0
  * @tparam vector3 ra Vector to rotate around
  * @tparam number radians Angle to rotate in radians
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_rotate(lua_State* L) {
@@ -607,12 +579,10 @@ static int modules_vector3_rotate(lua_State* L) {
     mfloat_t* ra = luaL_checkvector3(L, 2);
     float f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_rotate(result, v0, ra, f);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 4, result);
 
     return 1;
 }
@@ -623,6 +593,7 @@ static int modules_vector3_rotate(lua_State* L) {
  * @tparam vector3 v0
  * @tparam vector3 v1
  * @tparam number t Value used to interpolate between v0 and v1.
+ * @tparam ?vector3 out Destination, a new vector3 is returned if omitted
  * @treturn vector3
  */
 static int modules_vector3_lerp(lua_State* L) {
@@ -630,12 +601,10 @@ static int modules_vector3_lerp(lua_State* L) {
     mfloat_t* v1 = luaL_checkvector3(L, 2);
     float f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_lerp(result, v0, v1, f);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 4, result);
 
     return 1;
 }
@@ -647,12 +616,10 @@ static int modules_vector3_bezier3(lua_State* L) {
     mfloat_t* v2 = luaL_checkvector3(L, 3);
     float f = luaL_checknumber(L, 4);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_bezier3(result, v0, v1, v2, f);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 5, result);
 
     return 1;
 }
@@ -665,12 +632,10 @@ static int modules_vector3_bezier4(lua_State* L) {
     mfloat_t* v3 = luaL_checkvector3(L, 4);
     float f = luaL_checknumber(L, 5);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC3_SIZE];
     vec3_bezier4(result, v0, v1, v2, v3, f);
 
-    lua_newvector3(L, result[0], result[1], result[2]);
+    lua_outvector3(L, 6, result);
 
     return 1;
 }
@@ -752,8 +717,101 @@ static int modules_vector3_distance_squared(lua_State* L) {
 }
 
 
+/**
+ * Normalizes all vectors in a floatarray. Zero length vectors stay zero.
+ * @function normalize_array
+ * @tparam floatarray vectors Vectors with x, y and z components.
+ * @tparam ?floatarray out Destination, grown if needed. May be vectors. A new floatarray is returned if omitted.
+ * @tparam ?integer stride Floats between vectors, default 3.
+ * @treturn floatarray
+ */
+static int modules_vector3_normalize_array(lua_State* L) {
+    float_array_t* vectors = luaL_checkfloatarray(L, 1);
+    size_t stride = luaL_optbatchstride(L, 3);
+    size_t count = vectors->size / stride;
+
+    float_array_t* out = lua_outfloatarray(L, 2, count * stride);
+
+    batch_vectors_normalize(out->data, vectors->data, count, stride);
+
+    return 1;
+}
+
+/**
+ * Dot products of vector pairs in two floatarrays. Results are packed, one
+ * float per pair.
+ * @function dot_array
+ * @tparam floatarray a Vectors with x, y and z components.
+ * @tparam floatarray b Vectors with x, y and z components.
+ * @tparam ?floatarray out Destination, grown if needed. A new floatarray is returned if omitted.
+ * @tparam ?integer stride Floats between vectors, default 3.
+ * @treturn floatarray
+ */
+static int modules_vector3_dot_array(lua_State* L) {
+    float_array_t* a = luaL_checkfloatarray(L, 1);
+    float_array_t* b = luaL_checkfloatarray(L, 2);
+    size_t stride = luaL_optbatchstride(L, 4);
+    size_t count = (a->size < b->size ? a->size : b->size) / stride;
+
+    float_array_t* out = lua_outfloatarray(L, 3, count);
+
+    batch_vectors_dot(out->data, a->data, b->data, count, stride);
+
+    return 1;
+}
+
+/**
+ * Cross products of vector pairs in two floatarrays.
+ * @function cross_array
+ * @tparam floatarray a Vectors with x, y and z components.
+ * @tparam floatarray b Vectors with x, y and z components.
+ * @tparam ?floatarray out Destination, grown if needed. May be a or b. A new floatarray is returned if omitted.
+ * @tparam ?integer stride Floats between vectors, default 3.
+ * @treturn floatarray
+ */
+static int modules_vector3_cross_array(lua_State* L) {
+    float_array_t* a = luaL_checkfloatarray(L, 1);
+    float_array_t* b = luaL_checkfloatarray(L, 2);
+    size_t stride = luaL_optbatchstride(L, 4);
+    size_t count = (a->size < b->size ? a->size : b->size) / stride;
+
+    float_array_t* out = lua_outfloatarray(L, 3, count * stride);
+
+    batch_vectors_cross(out->data, a->data, b->data, count, stride);
+
+    return 1;
+}
+
+/**
+ * Returns a vector3 from a pool of temporaries. Values are handed out again
+ * next frame, so they must not be kept.
+ * @function scratch
+ * @tparam ?number ... Components, same as new
+ * @treturn vector3
+ */
+static int modules_vector3_scratch(lua_State* L) {
+    mfloat_t components[VEC3_SIZE];
+
+    for (int i = 0; i < VEC3_SIZE; i++) {
+        components[i] = (mfloat_t)luaL_optnumber(L, i + 1, 0);
+    }
+
+    lua_settop(L, 0);
+
+    if (lua_pushscratch(L, "vector3")) {
+        vec3_assign(luaL_checkvector3(L, 1), components);
+    }
+    else {
+        lua_newvector3(L, components[0], components[1], components[2]);
+        lua_addscratch(L, "vector3");
+    }
+
+    return 1;
+}
+
 static const struct luaL_Reg modules_vector3_functions[] = {
     {"new", modules_vector3_new},
+    {"scratch", modules_vector3_scratch},
     {"zero", modules_vector3_zero},
     {"one", modules_vector3_one},
     {"sign", modules_vector3_sign},
@@ -784,6 +842,9 @@ static const struct luaL_Reg modules_vector3_functions[] = {
     {"length_squared", modules_vector3_length_squared},
     {"distance", modules_vector3_distance},
     {"distance_squared", modules_vector3_distance_squared},
+    {"normalize_array", modules_vector3_normalize_array},
+    {"dot_array", modules_vector3_dot_array},
+    {"cross_array", modules_vector3_cross_array},
     {NULL, NULL}
 };
 
@@ -844,6 +905,40 @@ static int modules_vector3_meta_newindex(lua_State* L) {
     return 0;
 }
 
+static const luaL_InPlaceReg modules_vector3_in_place_functions[] = {
+    {"sign_", modules_vector3_sign, 2},
+    {"add_", modules_vector3_add, 3},
+    {"subtract_", modules_vector3_subtract, 3},
+    {"multiply_", modules_vector3_multiply, 3},
+    {"divide_", modules_vector3_divide, 3},
+    {"snap_", modules_vector3_snap, 3},
+    {"negative_", modules_vector3_negative, 2},
+    {"abs_", modules_vector3_abs, 2},
+    {"floor_", modules_vector3_floor, 2},
+    {"ceil_", modules_vector3_ceil, 2},
+    {"round_", modules_vector3_round, 2},
+    {"max_", modules_vector3_max, 3},
+    {"min_", modules_vector3_min, 3},
+    {"clamp_", modules_vector3_clamp, 4},
+    {"cross_", modules_vector3_cross, 3},
+    {"normalize_", modules_vector3_normalize, 2},
+    {"project_", modules_vector3_project, 3},
+    {"slide_", modules_vector3_slide, 3},
+    {"reflect_", modules_vector3_reflect, 3},
+    {"rotate_", modules_vector3_rotate, 4},
+    {"lerp_", modules_vector3_lerp, 4},
+    {"bezier3_", modules_vector3_bezier3, 5},
+    {"bezier4_", modules_vector3_bezier4, 6},
+    {NULL, NULL, 0}
+};
+
+/* Unary minus passes its operand twice, which must not be taken as destination. */
+static int modules_vector3_meta_unm(lua_State* L) {
+    lua_settop(L, 1);
+
+    return modules_vector3_negative(L);
+}
+
 static const struct luaL_Reg modules_vector3_meta_functions[] = {
     {"__index", modules_vector3_meta_index},
     {"__newindex", modules_vector3_meta_newindex},
@@ -851,26 +946,18 @@ static const struct luaL_Reg modules_vector3_meta_functions[] = {
     {"__sub", modules_vector3_subtract},
     {"__mul", modules_vector3_multiply},
     {"__div", modules_vector3_divide},
-    {"__unm", modules_vector3_negative},
+    {"__unm", modules_vector3_meta_unm},
     {"__eq", modules_vector3_equal},
     {NULL, NULL}
 };
 
 int luaopen_vector3(lua_State* L) {
     luaL_newlib(L, modules_vector3_functions);
+    luaL_setinplacefuncs(L, modules_vector3_in_place_functions);
 
     luaL_newmetatable(L, "vector3");
     luaL_setfuncs(L, modules_vector3_meta_functions, 0);
 
-    lua_pushstring(L, "__gc");
-    lua_pushcfunction(L, vector3_gc);
-    lua_settable(L, -3);
-
-    lua_pop(L, 1);
-
-    luaL_newmetatable(L, "vector3_nogc");
-    luaL_setfuncs(L, modules_vector3_meta_functions, 0);
-
     lua_pop(L, 1);
 
     return 1;
@@ -16,9 +16,12 @@ mfloat_t* luaL_checkvector3(lua_State* L, int index);
 /* Creates and pushes on the stack a new vector3 userdata. */
 int lua_newvector3(lua_State* L, float x, float y, float z);
 
-/* Pushes a vector3 onto the stack. Created userdata will not be garbage collected. */
+/* Pushes a vector3 onto the stack. Created userdata references given data, which must outlive it. */
 int lua_pushvector3(lua_State* L, mfloat_t* vector);
 
+/* Pushes given result, copied into the vector3 at index if there is one or into a new vector3 otherwise. */
+int lua_outvector3(lua_State* L, int index, mfloat_t* result);
+
 int luaopen_vector3(lua_State* L);
 
 #endif
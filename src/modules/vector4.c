@@ -12,57 +12,57 @@
 
 #include <mathc/mathc.h>
 
+#include "scratch.h"
 #include "vector4.h"
 
-bool lua_isvector4(lua_State*L, int index) {
-    void* p = luaL_testudata(L, index, "vector4");
-    if (p == NULL) {
-        p = luaL_testudata(L, index, "vector4_nogc");
-    }
+/**
+ * Userdata layout. Values created from Lua store their components inline and
+ * point at them, values pushed from C only store the pointer.
+ */
+typedef struct {
+    mfloat_t* components;
+    mfloat_t storage[VEC4_SIZE];
+} vector4_userdata_t;
 
-    return p != NULL;
+bool lua_isvector4(lua_State* L, int index) {
+    return luaL_testudata(L, index, "vector4") != NULL;
 }
 
 mfloat_t* luaL_checkvector4(lua_State* L, int index) {
-    mfloat_t** handle = NULL;
-    luaL_checktype(L, index, LUA_TUSERDATA);
-
-    handle = (mfloat_t**)luaL_testudata(L, index, "vector4_nogc");
-    if (!handle) {
-        handle = (mfloat_t**)luaL_checkudata(L, index, "vector4");
-    }
-
-    return *handle;
+    return *(mfloat_t**)luaL_checkudata(L, index, "vector4");
 }
 
 int lua_newvector4(lua_State* L, float x, float y, float z, float w) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
-    mfloat_t* vector = (mfloat_t*)malloc(sizeof(mfloat_t) * VEC4_SIZE);
+    vector4_userdata_t* userdata = (vector4_userdata_t*)lua_newuserdatauv(L, sizeof(vector4_userdata_t), 0);
+    mfloat_t* vector = userdata->storage;
     vector[0] = x;
     vector[1] = y;
     vector[2] = z;
     vector[3] = w;
-    *handle = vector;
+    userdata->components = vector;
     luaL_setmetatable(L, "vector4");
 
     return 1;
 }
 
 int lua_pushvector4(lua_State* L, mfloat_t* vector) {
-    mfloat_t** handle = (mfloat_t**)lua_newuserdata(L, sizeof(mfloat_t*));
+    mfloat_t** handle = (mfloat_t**)lua_newuserdatauv(L, sizeof(mfloat_t*), 0);
     *handle = vector;
 
-    luaL_setmetatable(L, "vector4_nogc");
+    luaL_setmetatable(L, "vector4");
 
     return 1;
 }
 
-static int vector4_gc(lua_State* L) {
-    mfloat_t** handle = lua_touserdata(L, 1);
-    free(*handle);
-    *handle = NULL;
+int lua_outvector4(lua_State* L, int index, mfloat_t* result) {
+    if (lua_isnoneornil(L, index)) {
+        return lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    }
+
+    vec4_assign(luaL_checkvector4(L, index), result);
+    lua_pushvalue(L, index);
 
-    return 0;
+    return 1;
 }
 
 /**
@@ -150,13 +150,14 @@ static int modules_vector4_one(lua_State* L) {
  * Returns a vector made from the sign of it's components.
  * @function sign
  * @tparam vector4 v0
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_sign(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
     mfloat_t result[VEC4_SIZE];
     vec4_sign(result, v0);
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 2, result);
 
     return 1;
 }
@@ -167,22 +168,18 @@ static int modules_vector4_add(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE];
         vec4_add_f(result, v0, f);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
     }
     else {
         mfloat_t* v1 = luaL_checkvector4(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE];
         vec4_add(result, v0, v1);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
     }
 
     return 1;
@@ -194,22 +191,18 @@ static int modules_vector4_subtract(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         mfloat_t f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE];
         vec4_subtract_f(result, v0, f);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
     }
     else {
         mfloat_t* v1 = luaL_checkvector4(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE];
         vec4_subtract(result, v0, v1);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
     }
 
     return 1;
@@ -222,12 +215,10 @@ static int modules_vector4_multiply(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE];
         vec4_multiply_f(result, v0, f);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
 
         return 1;
     }
@@ -235,12 +226,10 @@ static int modules_vector4_multiply(lua_State* L) {
     // Component-wise multiplication
     mfloat_t* v1 = luaL_checkvector4(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_multiply(result, v0, v1);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 3, result);
 
     return 1;
 }
@@ -252,12 +241,10 @@ static int modules_vector4_divide(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE];
         vec4_divide_f(result, v0, f);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
 
         return 1;
     }
@@ -265,12 +252,10 @@ static int modules_vector4_divide(lua_State* L) {
     // Component-wise division
     mfloat_t* v1 = luaL_checkvector4(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_divide(result, v0, v1);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 3, result);
 
     return 1;
 }
@@ -280,6 +265,7 @@ static int modules_vector4_divide(lua_State* L) {
  * @function snap
  * @tparam vector4 v0
  * @tparam number f Resolution of snap
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_snap(lua_State* L) {
@@ -289,12 +275,10 @@ static int modules_vector4_snap(lua_State* L) {
     if (lua_isnumber(L, 2)) {
         float f = luaL_checknumber(L, 2);
 
-        lua_settop(L, 0);
-
         mfloat_t result[VEC4_SIZE];
         vec4_snap_f(result, v0, f);
 
-        lua_newvector4(L, result[0], result[1], result[2], result[3]);
+        lua_outvector4(L, 3, result);
 
         return 1;
     }
@@ -302,12 +286,10 @@ static int modules_vector4_snap(lua_State* L) {
     // Component-wise snapping
     mfloat_t* v1 = luaL_checkvector4(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_snap(result, v0, v1);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 3, result);
 
     return 1;
 }
@@ -316,17 +298,16 @@ static int modules_vector4_snap(lua_State* L) {
  * Negates a vector.
  * @function negative
  * @tparam vector4 v0
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_negative(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_negative(result, v0);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 2, result);
 
     return 1;
 }
@@ -335,17 +316,16 @@ static int modules_vector4_negative(lua_State* L) {
  * Returns a vector made from the absolute values of the components.
  * @function abs
  * @tparam vector4 v0
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_abs(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_abs(result, v0);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 2, result);
 
     return 1;
 }
@@ -354,17 +334,16 @@ static int modules_vector4_abs(lua_State* L) {
  * Returns a vector made from the floor of the components.
  * @function floor
  * @tparam vector4 v0
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_floor(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_floor(result, v0);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 2, result);
 
     return 1;
 }
@@ -373,17 +352,16 @@ static int modules_vector4_floor(lua_State* L) {
  * Returns a vector made from the ceil of the components.
  * @function ceil
  * @tparam vector4 v0
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_ceil(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_ceil(result, v0);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 2, result);
 
     return 1;
 }
@@ -392,17 +370,16 @@ static int modules_vector4_ceil(lua_State* L) {
  * Returns a vector made from rounding the components.
  * @function round
  * @tparam vector4 v0
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_round(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_round(result, v0);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 2, result);
 
     return 1;
 }
@@ -412,18 +389,17 @@ static int modules_vector4_round(lua_State* L) {
  * @function max
  * @tparam vector4 v0
  * @tparam vector4 v1
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_max(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
     mfloat_t* v1 = luaL_checkvector4(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_max(result, v0, v1);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 3, result);
 
     return 1;
 }
@@ -433,18 +409,17 @@ static int modules_vector4_max(lua_State* L) {
  * @function min
  * @tparam vector4 v0
  * @tparam vector4 v1
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_min(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
     mfloat_t* v1 = luaL_checkvector4(L, 2);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_min(result, v0, v1);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 3, result);
 
     return 1;
 }
@@ -455,6 +430,7 @@ static int modules_vector4_min(lua_State* L) {
  * @tparam vector4 v0 Vector to clamp
  * @tparam vector4 min Min vector
  * @tparam vector4 max Max vector
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_clamp(lua_State* L) {
@@ -462,12 +438,10 @@ static int modules_vector4_clamp(lua_State* L) {
     mfloat_t* v1 = luaL_checkvector4(L, 2);
     mfloat_t* v2 = luaL_checkvector4(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_clamp(result, v0, v1, v2);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 4, result);
 
     return 1;
 }
@@ -476,17 +450,16 @@ static int modules_vector4_clamp(lua_State* L) {
  * Returns a vector in the direction of v0 with magnitude 1.
  * @function normalize
  * @tparam vector4 v0
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_normalize(lua_State* L) {
     mfloat_t* v0 = luaL_checkvector4(L, 1);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_normalize(result, v0);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 2, result);
 
     return 1;
 }
@@ -497,6 +470,7 @@ static int modules_vector4_normalize(lua_State* L) {
  * @tparam vector4 v0
  * @tparam vector4 v1
  * @tparam number t Value used to interpolate between v0 and v1.
+ * @tparam ?vector4 out Destination, a new vector4 is returned if omitted
  * @treturn vector4
  */
 static int modules_vector4_lerp(lua_State* L) {
@@ -504,18 +478,44 @@ static int modules_vector4_lerp(lua_State* L) {
     mfloat_t* v1 = luaL_checkvector4(L, 2);
     float f = luaL_checknumber(L, 3);
 
-    lua_settop(L, 0);
-
     mfloat_t result[VEC4_SIZE];
     vec4_lerp(result, v0, v1, f);
 
-    lua_newvector4(L, result[0], result[1], result[2], result[3]);
+    lua_outvector4(L, 4, result);
+
+    return 1;
+}
+
+/**
+ * Returns a vector4 from a pool of temporaries. Values are handed out again
+ * next frame, so they must not be kept.
+ * @function scratch
+ * @tparam ?number ... Components, same as new
+ * @treturn vector4
+ */
+static int modules_vector4_scratch(lua_State* L) {
+    mfloat_t components[VEC4_SIZE];
+
+    for (int i = 0; i < VEC4_SIZE; i++) {
+        components[i] = (mfloat_t)luaL_optnumber(L, i + 1, 0);
+    }
+
+    lua_settop(L, 0);
+
+    if (lua_pushscratch(L, "vector4")) {
+        vec4_assign(luaL_checkvector4(L, 1), components);
+    }
+    else {
+        lua_newvector4(L, components[0], components[1], components[2], components[3]);
+        lua_addscratch(L, "vector4");
+    }
 
     return 1;
 }
 
 static const struct luaL_Reg modules_vector4_functions[] = {
     {"new", modules_vector4_new},
+    {"scratch", modules_vector4_scratch},
     {"zero", modules_vector4_zero},
     {"one", modules_vector4_one},
     {"sign", modules_vector4_sign},
@@ -598,6 +598,33 @@ static int modules_vector4_meta_newindex(lua_State* L) {
     return 0;
 }
 
+static const luaL_InPlaceReg modules_vector4_in_place_functions[] = {
+    {"sign_", modules_vector4_sign, 2},
+    {"add_", modules_vector4_add, 3},
+    {"subtract_", modules_vector4_subtract, 3},
+    {"multiply_", modules_vector4_multiply, 3},
+    {"divide_", modules_vector4_divide, 3},
+    {"snap_", modules_vector4_snap, 3},
+    {"negative_", modules_vector4_negative, 2},
+    {"abs_", modules_vector4_abs, 2},
+    {"floor_", modules_vector4_floor, 2},
+    {"ceil_", modules_vector4_ceil, 2},
+    {"round_", modules_vector4_round, 2},
+    {"max_", modules_vector4_max, 3},
+    {"min_", modules_vector4_min, 3},
+    {"clamp_", modules_vector4_clamp, 4},
+    {"normalize_", modules_vector4_normalize, 2},
+    {"lerp_", modules_vector4_lerp, 4},
+    {NULL, NULL, 0}
+};
+
+/* Unary minus passes its operand twice, which must not be taken as destination. */
+static int modules_vector4_meta_unm(lua_State* L) {
+    lua_settop(L, 1);
+
+    return modules_vector4_negative(L);
+}
+
 static const struct luaL_Reg modules_vector4_meta_functions[] = {
     {"__index", modules_vector4_meta_index},
     {"__newindex", modules_vector4_meta_newindex},
@@ -605,26 +632,18 @@ static const struct luaL_Reg modules_vector4_meta_functions[] = {
     {"__sub", modules_vector4_subtract},
     {"__mul", modules_vector4_multiply},
     {"__div", modules_vector4_divide},
-    {"__unm", modules_vector4_negative},
+    {"__unm", modules_vector4_meta_unm},
     {"__eq", modules_vector4_equal},
     {NULL, NULL}
 };
 
 int luaopen_vector4(lua_State* L) {
     luaL_newlib(L, modules_vector4_functions);
+    luaL_setinplacefuncs(L, modules_vector4_in_place_functions);
 
     luaL_newmetatable(L, "vector4");
     luaL_setfuncs(L, modules_vector4_meta_functions, 0);
 
-    lua_pushstring(L, "__gc");
-    lua_pushcfunction(L, vector4_gc);
-    lua_settable(L, -3);
-
-    lua_pop(L, 1);
-
-    luaL_newmetatable(L, "vector4_nogc");
-    luaL_setfuncs(L, modules_vector4_meta_functions, 0);
-
     lua_pop(L, 1);
 
     return 1;
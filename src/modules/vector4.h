@@ -16,9 +16,12 @@ mfloat_t* luaL_checkvector4(lua_State* L, int index);
 /* Creates and pushes on the stack a new vector4 userdata. */
 int lua_newvector4(lua_State* L, float x, float y, float z, float w);
 
-/* Pushes a vector4 onto the stack. Created userdata will not be garbage collected. */
+/* Pushes a vector4 onto the stack. Created userdata references given data, which must outlive it. */
 int lua_pushvector4(lua_State* L, mfloat_t* vector);
 
+/* Pushes given result, copied into the vector4 at index if there is one or into a new vector4 otherwise. */
+int lua_outvector4(lua_State* L, int index, mfloat_t* result);
+
 int luaopen_vector4(lua_State* L);
 
 #endif
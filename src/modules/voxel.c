@@ -0,0 +1,258 @@
+/**
+ * Module for voxel space terrain renderer
+ *
+ * @usage
+ * voxel = require('voxel')
+ *
+ * -- Terrain. Height map and color map must be the same size.
+ * heights = assets.get_texture('heights.gif')
+ * colors = assets.get_texture('colors.gif')
+ *
+ * -- Camera info. The z-component of the position is height above zero.
+ * position = vector3.new(0, 0, 120)
+ * direction = vector2.new(0, 1)
+ * fov = 90
+ *
+ * renderer = voxel.Renderer:new()
+ * renderer:feature('drawdistance', 800)
+ *
+ * -- Render loop
+ * renderer:clear(sky_color)
+ * renderer:camera(position, direction, fov)
+ * renderer:render(heights, colors)
+ *
+ * @module voxel
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <lua/lua.h>
+#include <lua/lauxlib.h>
+#include <lua/lualib.h>
+
+#include <mathc/mathc.h>
+
+#include "texture.h"
+#include "vector2.h"
+#include "vector3.h"
+#include "voxel.h"
+
+#include "../renderers/voxel.h"
+
+static voxel_renderer_t* luaL_checkvoxelrenderer(lua_State* L, int index) {
+    voxel_renderer_t** handle = NULL;
+    luaL_checktype(L, index, LUA_TUSERDATA);
+    handle = (voxel_renderer_t**)luaL_checkudata(L, index, "voxel_renderer");
+
+    if (!handle) {
+        luaL_typeerror(L, index, "voxel_renderer");
+    }
+
+    return *handle;
+}
+
+static int lua_newvoxelrenderer(lua_State* L) {
+    texture_t* render_texture = luaL_opttexture(L, 2, graphics_render_texture_get());
+    voxel_renderer_t** handle = (voxel_renderer_t**)lua_newuserdata(L, sizeof(voxel_renderer_t*));
+    *handle = voxel_renderer_new(render_texture);
+    luaL_setmetatable(L, "voxel_renderer");
+
+    return 1;
+}
+
+/**
+ * @type Renderer
+ */
+
+/**
+ * Creates a voxel renderer object.
+ * @function Renderer:new
+ * @tparam ?texture.texture texture Texture to render to. Defaults to the render texture.
+ * @treturn Renderer
+ */
+static int modules_voxel_renderer_new(lua_State* L) {
+    return lua_newvoxelrenderer(L);
+}
+
+/**
+ * Clears color buffer.
+ * @function Renderer:clear
+ * @tparam ?integer color Clear color. Defaults to 0.
+ */
+static int modules_voxel_renderer_clear(lua_State* L) {
+    voxel_renderer_t* renderer = luaL_checkvoxelrenderer(L, 1);
+    color_t color = (color_t)luaL_optnumber(L, 2, 0);
+
+    voxel_renderer_clear_color(renderer, color);
+
+    return 0;
+}
+
+/**
+ * Renders terrain. Each texel is one world unit and both maps repeat infinitely.
+ * @function Renderer:render
+ * @tparam texture.texture heights Height map. Texel values are scaled by the 'heightscale' feature.
+ * @tparam texture.texture colors Color map. Must be the same size as the height map.
+ */
+static int modules_voxel_renderer_render(lua_State* L) {
+    voxel_renderer_t* renderer = luaL_checkvoxelrenderer(L, 1);
+    texture_t* height_map = luaL_checktexture(L, 2);
+    texture_t* color_map = luaL_checktexture(L, 3);
+
+    luaL_argcheck(L, height_map->width == color_map->width && height_map->height == color_map->height, 3, "size must match height map");
+
+    voxel_renderer_render(renderer, height_map, color_map);
+
+    return 0;
+}
+
+/**
+ * Set renderer's camera data.
+ * @function Renderer:camera
+ * @tparam vector3.vector3 position Camera position. The z-component is height above zero.
+ * @tparam vector2.vector2 direction Camera forward vector.
+ * @tparam number fov Camera field of view in degrees.
+*/
+static int modules_voxel_renderer_camera(lua_State* L) {
+    voxel_renderer_t* renderer = luaL_checkvoxelrenderer(L, 1);
+    mfloat_t* position = luaL_checkvector3(L, 2);
+    mfloat_t* direction = luaL_checkvector2(L, 3);
+    float fov = luaL_checknumber(L, 4);
+
+    voxel_renderer_camera(renderer, position, direction, fov);
+
+    return 0;
+}
+
+/**
+ * Access renderer's features. If just the feature name is provided, the value of
+ * that feature will be returned. If a value is provided, the feature will be set to that value.
+ *
+ * **Features:**
+ *
+ *  * <span class="parameter">'fogdistance'</span> number Distance at which fog is fully dark.
+ *  * <span class="parameter">'shadetable'</span> @{texture} Texture to use to shade colors using distance. Setting to nil will render full bright.
+ *  * <span class="parameter">'drawdistance'</span> number Distance after which terrain is not drawn.
+ *  * <span class="parameter">'heightscale'</span> number Height of terrain per height map value.
+ *  * <span class="parameter">'horizon'</span> number Screen y-coordinate of the horizon.
+ *  * <span class="parameter">'lod'</span> number Growth of sample spacing per sample. Larger values are faster but less detailed.
+ *
+ * @function Renderer:feature
+ * @tparam string name Feature name.
+ * @tparam ?any value Value to set feature to.
+ */
+static int modules_voxel_renderer_feature(lua_State* L) {
+    voxel_renderer_t* renderer = luaL_checkvoxelrenderer(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+    bool is_setter = lua_gettop(L) > 2;
+
+    if (strcmp(key, "shadetable") == 0) {
+        if (is_setter) {
+            if (lua_isnil(L, 3)) {
+                renderer->features.shade_table = NULL;
+            }
+            else {
+                texture_t* shade_table = luaL_checktexture(L, 3);
+                renderer->features.shade_table = shade_table;
+            }
+
+            return 0;
+        }
+
+        if (renderer->features.shade_table) {
+            lua_pushtexture(L, renderer->features.shade_table);
+        }
+        else {
+            lua_pushnil(L);
+        }
+
+        return 1;
+    }
+
+    float* value = NULL;
+
+    if (strcmp(key, "fogdistance") == 0) {
+        value = &renderer->features.fog_distance;
+    }
+    else if (strcmp(key, "drawdistance") == 0) {
+        value = &renderer->features.draw_distance;
+    }
+    else if (strcmp(key, "heightscale") == 0) {
+        value = &renderer->features.height_scale;
+    }
+    else if (strcmp(key, "horizon") == 0) {
+        value = &renderer->features.horizon;
+    }
+    else if (strcmp(key, "lod") == 0) {
+        value = &renderer->features.lod;
+    }
+    else {
+        luaL_argerror(L, 2, lua_pushfstring(L, "invalid feature '%s'", key));
+    }
+
+    if (is_setter) {
+        *value = luaL_checknumber(L, 3);
+
+        return 0;
+    }
+
+    lua_pushnumber(L, *value);
+
+    return 1;
+}
+
+static int modules_voxel_renderer_meta_index(lua_State* L) {
+    luaL_checkvoxelrenderer(L, 1);
+    const char* key = luaL_checkstring(L, 2);
+
+    lua_settop(L, 0);
+
+    luaL_requiref(L, "voxel", NULL, false);
+    lua_getfield(L, -1, "Renderer");
+    if (lua_type(L, -1) == LUA_TTABLE) {
+        lua_getfield(L, -1, key);
+    }
+    else {
+        lua_pushnil(L);
+    }
+
+    return 1;
+}
+
+static int modules_voxel_renderer_meta_gc(lua_State* L) {
+    voxel_renderer_t** handle = lua_touserdata(L, 1);
+    voxel_renderer_free(*handle);
+    *handle = NULL;
+
+    return 0;
+}
+
+static const struct luaL_Reg modules_voxel_renderer_functions[] = {
+    {"new", modules_voxel_renderer_new},
+    {"clear", modules_voxel_renderer_clear},
+    {"render", modules_voxel_renderer_render},
+    {"camera", modules_voxel_renderer_camera},
+    {"feature", modules_voxel_renderer_feature},
+    {NULL, NULL}
+};
+
+static const struct luaL_Reg modules_voxel_renderer_meta_functions[] = {
+    {"__index", modules_voxel_renderer_meta_index},
+    {"__gc", modules_voxel_renderer_meta_gc},
+    {NULL, NULL}
+};
+
+int luaopen_voxel(lua_State* L) {
+    lua_newtable(L);
+
+    lua_pushstring(L, "Renderer");
+    luaL_newlib(L, modules_voxel_renderer_functions);
+    lua_settable(L, -3);
+
+    luaL_newmetatable(L, "voxel_renderer");
+    luaL_setfuncs(L, modules_voxel_renderer_meta_functions, 0);
+    lua_pop(L, 1);
+
+    return 1;
+}
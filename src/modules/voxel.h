@@ -0,0 +1,8 @@
+#ifndef MODULES_VOXEL_H
+#define MODULES_VOXEL_H
+
+#include <lua/lua.h>
+
+int luaopen_voxel(lua_State* L);
+
+#endif
@@ -0,0 +1,363 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "collections/hash_table.h"
+#include "graphics.h"
+#include "log.h"
+#include "sounds.h"
+
+#include "pack.h"
+
+/**
+ * Check that range lies within given size without overflowing.
+ */
+static bool range_check(uint64_t offset, uint64_t length, uint64_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+/**
+ * Check pack header and directory are well formed, so entries can be used
+ * without further bounds checks.
+ *
+ * @param pack Pack to validate.
+ * @return true if pack is valid, false otherwise.
+ */
+static bool pack_validate(pack_t* pack) {
+    if (pack->size < sizeof(pack_header_t)) return false;
+
+    const pack_header_t* header = (const pack_header_t*)pack->data;
+
+    if (memcmp(header->magic, PACK_MAGIC, sizeof(header->magic)) != 0) return false;
+    if (header->version != PACK_VERSION) return false;
+
+    if (header->texture_header_size != sizeof(texture_t) || header->sound_header_size != sizeof(sound_t)) {
+        log_error("Pack was built for a different engine build");
+        return false;
+    }
+
+    uint32_t directory_size = header->directory_size;
+    if (directory_size == 0 || (directory_size & (directory_size - 1)) != 0) return false;
+    if (header->directory_offset % sizeof(uint64_t) != 0) return false;
+    if (!range_check(header->directory_offset, (uint64_t)directory_size * sizeof(pack_entry_t), pack->size)) return false;
+
+    if (header->strings_size == 0) return false;
+    if (!range_check(header->strings_offset, header->strings_size, pack->size)) return false;
+
+    pack->header = header;
+    pack->directory = (const pack_entry_t*)(pack->data + header->directory_offset);
+    pack->strings = (const char*)(pack->data + header->strings_offset);
+
+    if (pack->strings[header->strings_size - 1] != '\0') return false;
+
+    for (uint32_t i = 0; i < directory_size; i++) {
+        const pack_entry_t* entry = &pack->directory[i];
+
+        if (entry->type == PACK_ENTRY_EMPTY) continue;
+        if (entry->type > PACK_ENTRY_SOUND) return false;
+        if (entry->name_offset >= header->strings_size) return false;
+        if (entry->offset % PACK_ALIGNMENT != 0) return false;
+        if (!range_check(entry->offset, entry->size, pack->size)) return false;
+    }
+
+    return true;
+}
+
+pack_t* pack_open(const char* filename) {
+    pack_t* pack = (pack_t*)calloc(1, sizeof(pack_t));
+    if (!pack) {
+        log_error("Failed to create pack");
+        return NULL;
+    }
+
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        log_error("Failed to open pack file: %s", filename);
+        free(pack);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        log_error("Failed to read pack file: %s", filename);
+        close(fd);
+        free(pack);
+        return NULL;
+    }
+
+    // Private mapping so scripts can draw on pack textures
+    void* data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        log_error("Failed to map pack file: %s", filename);
+        free(pack);
+        return NULL;
+    }
+
+    pack->data = (uint8_t*)data;
+    pack->size = st.st_size;
+#else
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) {
+        log_error("Failed to open pack file: %s", filename);
+        free(pack);
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    pack->size = ftell(fp);
+    rewind(fp);
+
+    pack->data = (uint8_t*)_aligned_malloc(pack->size ? pack->size : 1, PACK_ALIGNMENT);
+
+    if (!pack->data || fread(pack->data, 1, pack->size, fp) != pack->size) {
+        log_error("Failed to read pack file: %s", filename);
+        fclose(fp);
+        pack_close(pack);
+        return NULL;
+    }
+
+    fclose(fp);
+#endif
+
+    if (!pack_validate(pack)) {
+        log_error("Invalid pack file: %s", filename);
+        pack_close(pack);
+        return NULL;
+    }
+
+    return pack;
+}
+
+void pack_close(pack_t* pack) {
+    if (!pack) return;
+
+#ifndef _WIN32
+    if (pack->data) {
+        munmap(pack->data, pack->size);
+    }
+#else
+    _aligned_free(pack->data);
+#endif
+
+    pack->data = NULL;
+    free(pack);
+    pack = NULL;
+}
+
+const pack_entry_t* pack_entry_find(pack_t* pack, const char* name) {
+    uint32_t hash = hash_table_hash(name);
+    uint32_t mask = pack->header->directory_size - 1;
+
+    for (uint32_t i = 0; i <= mask; i++) {
+        const pack_entry_t* entry = &pack->directory[(hash + i) & mask];
+
+        if (entry->type == PACK_ENTRY_EMPTY) return NULL;
+
+        if (entry->hash == hash && strcmp(pack->strings + entry->name_offset, name) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+const char* pack_entry_name_get(pack_t* pack, const pack_entry_t* entry) {
+    return pack->strings + entry->name_offset;
+}
+
+void* pack_entry_data_get(pack_t* pack, const pack_entry_t* entry) {
+    return pack->data + entry->offset;
+}
+
+/**
+ * Write bytes to pack file, recording any failure.
+ */
+static void writer_bytes_write(pack_writer_t* writer, const void* data, size_t size) {
+    if (writer->failed || size == 0) return;
+
+    if (fwrite(data, 1, size, writer->file) != size) {
+        writer->failed = true;
+        return;
+    }
+
+    writer->offset += size;
+}
+
+/**
+ * Pad pack file with zeros to given alignment.
+ */
+static void writer_align(pack_writer_t* writer, uint64_t alignment) {
+    static const uint8_t zeros[PACK_ALIGNMENT] = {0};
+
+    size_t padding = (alignment - writer->offset % alignment) % alignment;
+    writer_bytes_write(writer, zeros, padding);
+}
+
+pack_writer_t* pack_writer_open(const char* filename) {
+    pack_writer_t* writer = (pack_writer_t*)calloc(1, sizeof(pack_writer_t));
+    if (!writer) {
+        log_error("Failed to create pack writer");
+        return NULL;
+    }
+
+    writer->file = fopen(filename, "wb");
+    writer->filename = (char*)malloc(strlen(filename) + 1);
+
+    if (!writer->file || !writer->filename) {
+        log_error("Failed to create pack file: %s", filename);
+
+        if (writer->file) fclose(writer->file);
+        free(writer->filename);
+        free(writer);
+        return NULL;
+    }
+
+    strcpy(writer->filename, filename);
+
+    // Header is written last, once offsets are known
+    pack_header_t header;
+    memset(&header, 0, sizeof(pack_header_t));
+    writer_bytes_write(writer, &header, sizeof(pack_header_t));
+
+    return writer;
+}
+
+void pack_writer_entry_add(pack_writer_t* writer, const char* name, pack_entry_type_t type, uint32_t count) {
+    if (writer->failed) return;
+
+    if (writer->entry_count == writer->entry_capacity) {
+        int capacity = writer->entry_capacity ? writer->entry_capacity * 2 : 256;
+        pack_entry_t* entries = (pack_entry_t*)realloc(writer->entries, sizeof(pack_entry_t) * capacity);
+
+        if (!entries) {
+            writer->failed = true;
+            return;
+        }
+
+        writer->entries = entries;
+        writer->entry_capacity = capacity;
+    }
+
+    size_t length = strlen(name) + 1;
+
+    if (writer->strings_size + length > writer->strings_capacity) {
+        size_t capacity = writer->strings_capacity ? writer->strings_capacity * 2 : 4096;
+        while (capacity < writer->strings_size + length) capacity *= 2;
+
+        char* strings = (char*)realloc(writer->strings, capacity);
+
+        if (!strings) {
+            writer->failed = true;
+            return;
+        }
+
+        writer->strings = strings;
+        writer->strings_capacity = capacity;
+    }
+
+    writer_align(writer, PACK_ALIGNMENT);
+
+    pack_entry_t* entry = &writer->entries[writer->entry_count++];
+    entry->hash = hash_table_hash(name);
+    entry->type = type;
+    entry->name_offset = writer->strings_size;
+    entry->count = count;
+    entry->offset = writer->offset;
+    entry->size = 0;
+
+    memcpy(writer->strings + writer->strings_size, name, length);
+    writer->strings_size += length;
+}
+
+void pack_writer_write(pack_writer_t* writer, const void* data, size_t size) {
+    if (writer->failed || writer->entry_count == 0) return;
+
+    pack_entry_t* entry = &writer->entries[writer->entry_count - 1];
+
+    writer_align(writer, PACK_ALIGNMENT);
+    writer_bytes_write(writer, data, size);
+
+    entry->size = writer->offset - entry->offset;
+}
+
+bool pack_writer_close(pack_writer_t* writer, const uint32_t* palette, int transparent_color) {
+    // Keep directory at most half full so probes stay short
+    uint32_t directory_size = 16;
+    while (directory_size < (uint32_t)writer->entry_count * 2) {
+        directory_size *= 2;
+    }
+
+    pack_entry_t* directory = (pack_entry_t*)calloc(directory_size, sizeof(pack_entry_t));
+    if (!directory) {
+        writer->failed = true;
+    }
+
+    pack_header_t header;
+    memset(&header, 0, sizeof(pack_header_t));
+
+    if (!writer->failed) {
+        for (int i = 0; i < writer->entry_count; i++) {
+            pack_entry_t* entry = &writer->entries[i];
+            uint32_t slot = entry->hash & (directory_size - 1);
+
+            while (directory[slot].type != PACK_ENTRY_EMPTY) {
+                slot = (slot + 1) & (directory_size - 1);
+            }
+
+            directory[slot] = *entry;
+        }
+
+        writer_align(writer, sizeof(uint64_t));
+        header.directory_offset = writer->offset;
+        writer_bytes_write(writer, directory, sizeof(pack_entry_t) * directory_size);
+
+        // Always store at least a terminator so empty packs are valid
+        header.strings_offset = writer->offset;
+        header.strings_size = writer->strings_size ? writer->strings_size : 1;
+        writer_bytes_write(writer, writer->strings_size ? writer->strings : "", header.strings_size);
+
+        memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+        header.version = PACK_VERSION;
+        header.texture_header_size = sizeof(texture_t);
+        header.sound_header_size = sizeof(sound_t);
+        header.directory_size = directory_size;
+        memcpy(header.palette, palette, sizeof(header.palette));
+        header.transparent_color = transparent_color;
+
+        if (fseek(writer->file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(pack_header_t), 1, writer->file) != 1) {
+            writer->failed = true;
+        }
+    }
+
+    if (fclose(writer->file) != 0) {
+        writer->failed = true;
+    }
+
+    bool written = !writer->failed;
+
+    if (!written) {
+        log_error("Failed to write pack file: %s", writer->filename);
+        remove(writer->filename);
+    }
+
+    free(directory);
+    free(writer->entries);
+    free(writer->strings);
+    free(writer->filename);
+    free(writer);
+    writer = NULL;
+
+    return written;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file pack.h
+ * Asset pack module. Reads and writes precompiled asset packs. Packs hold
+ * assets already decoded into engine structs so they can be memory mapped
+ * and used in place.
+ */
+
+#ifndef PACK_H
+#define PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define PACK_MAGIC "BRASSPAK"
+#define PACK_VERSION 1
+
+/** Alignment of entry data in bytes. */
+#define PACK_ALIGNMENT 64
+
+typedef enum {
+    PACK_ENTRY_EMPTY,
+    PACK_ENTRY_TEXTURE,
+    PACK_ENTRY_SCRIPT,
+    PACK_ENTRY_SOUND
+} pack_entry_type_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+
+    /** Sizes of texture_t and sound_t. Packs only load in matching builds. */
+    uint32_t texture_header_size;
+    uint32_t sound_header_size;
+
+    /** Number of directory slots. Always a power of two. */
+    uint32_t directory_size;
+    uint64_t directory_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+
+    uint32_t palette[256];
+    int32_t transparent_color;
+    uint32_t reserved;
+} pack_header_t;
+
+/**
+ * Directory entry. The directory is an open addressed hash table keyed by
+ * name hash, so entries can be found without building an index at load.
+ *
+ * Texture data is a sequence of texture_t frames, script data is Lua
+ * bytecode or text and sound data is a single sound_t.
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t type;
+
+    /** Offset of null terminated name in string table. */
+    uint32_t name_offset;
+
+    /** Number of frames for textures. */
+    uint32_t count;
+
+    uint64_t offset;
+    uint64_t size;
+} pack_entry_t;
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    const pack_header_t* header;
+    const pack_entry_t* directory;
+    const char* strings;
+} pack_t;
+
+/**
+ * Open pack file. Pack is mapped copy-on-write, so entry data may be
+ * modified without changing the file.
+ *
+ * @param filename Pack file to open.
+ * @return pack_t* Opened pack if successful, NULL otherwise.
+ */
+pack_t* pack_open(const char* filename);
+
+/**
+ * Close pack. Entry data is no longer valid.
+ *
+ * @param pack Pack to close.
+ */
+void pack_close(pack_t* pack);
+
+/**
+ * Find entry for given name.
+ *
+ * @param pack Pack to search.
+ * @param name Name to search for.
+ * @return const pack_entry_t* Entry if found, NULL otherwise.
+ */
+const pack_entry_t* pack_entry_find(pack_t* pack, const char* name);
+
+/**
+ * Get name of given entry.
+ *
+ * @param pack Pack entry belongs to.
+ * @param entry Entry to get name of.
+ * @return const char* Entry name.
+ */
+const char* pack_entry_name_get(pack_t* pack, const pack_entry_t* entry);
+
+/**
+ * Get data of given entry.
+ *
+ * @param pack Pack entry belongs to.
+ * @param entry Entry to get data of.
+ * @return void* Entry data.
+ */
+void* pack_entry_data_get(pack_t* pack, const pack_entry_t* entry);
+
+typedef struct {
+    FILE* file;
+    char* filename;
+    uint64_t offset;
+    bool failed;
+
+    pack_entry_t* entries;
+    int entry_count;
+    int entry_capacity;
+
+    char* strings;
+    size_t strings_size;
+    size_t strings_capacity;
+} pack_writer_t;
+
+/**
+ * Create a pack file for writing.
+ *
+ * @param filename Pack file to create.
+ * @return pack_writer_t* New writer if successful, NULL otherwise.
+ */
+pack_writer_t* pack_writer_open(const char* filename);
+
+/**
+ * Start a new entry. Following writes are stored as its data.
+ *
+ * @param writer Writer to add entry to.
+ * @param name Entry name. Must be unique.
+ * @param type Entry type.
+ * @param count Number of frames for textures.
+ */
+void pack_writer_entry_add(pack_writer_t* writer, const char* name, pack_entry_type_t type, uint32_t count);
+
+/**
+ * Append data to current entry. Data starts PACK_ALIGNMENT aligned.
+ *
+ * @param writer Writer to write to.
+ * @param data Data to write.
+ * @param size Size of data in bytes.
+ */
+void pack_writer_write(pack_writer_t* writer, const void* data, size_t size);
+
+/**
+ * Write directory and header and close pack file. Writer is freed.
+ *
+ * @param writer Writer to close.
+ * @param palette Palette to store.
+ * @param transparent_color Transparent color to store. -1 for none.
+ * @return bool True if whole pack was written, false otherwise.
+ */
+bool pack_writer_close(pack_writer_t* writer, const uint32_t* palette, int transparent_color);
+
+#endif
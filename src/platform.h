@@ -12,8 +12,6 @@
 
 #include <stdbool.h>
 
-#include "sounds.h"
-
 /**
  * Platform specific engine main entry point.
  *
@@ -47,11 +45,6 @@ void platform_update(void);
  */
 void platform_draw(void);
 
-/**
- * Plays given sound.
- */
-void platform_sound_play(sound_t* sound, int channel);
-
 void platform_display_resolution_set(int width, int height);
 
 /**
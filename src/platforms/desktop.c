@@ -1,7 +1,6 @@
 #include <stdbool.h>
 
 #include <SDL.h>
-#include <SDL_mixer.h>
 
 #include "../arguments.h"
 #include "../assets.h"
@@ -11,6 +10,7 @@
 #include "../graphics.h"
 #include "../log.h"
 #include "../math.h"
+#include "../mixer.h"
 #include "../platform.h"
 #include "../sounds.h"
 
@@ -25,6 +25,7 @@ static SDL_Texture* render_buffer_texture = NULL;
 static uint32_t* render_buffer = NULL;
 static int ticks_last_frame;
 static SDL_Rect display_rect;
+static SDL_AudioDeviceID audio_device = 0;
 
 static void sdl_handle_events(void);
 static void sdl_fix_frame_rate(void);
@@ -43,21 +44,51 @@ int platform_main(int argc, char* argv[]) {
     return 0;
 }
 
+/**
+ * Fill audio device buffer with mixed sound.
+ */
+static void SDLCALL sdl_audio_callback(void* userdata, uint8_t* stream, int length) {
+    mixer_mix((int16_t*)stream, length / (int)(sizeof(int16_t) * 2));
+}
+
+/**
+ * Open audio device and start mixer. Runs without sound if no device is
+ * available.
+ */
+static void sdl_audio_open(void) {
+    SDL_AudioSpec want;
+    SDL_AudioSpec have;
+
+    SDL_zero(want);
+    want.freq = 44100;
+    want.format = AUDIO_S16SYS;
+    want.channels = 2;
+    want.samples = 512;
+    want.callback = sdl_audio_callback;
+
+    audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+
+    if (!audio_device) {
+        log_error("Error opening audio device: %s", SDL_GetError());
+        return;
+    }
+
+    mixer_init(have.freq);
+    SDL_PauseAudioDevice(audio_device, 0);
+}
+
 void platform_init(void) {
     // Get platform version info
     SDL_version version;
     SDL_GetVersion(&version);
 
-    const SDL_version* mix_version = Mix_Linked_Version();
-
     char buffer[128];
 
     snprintf(
         buffer,
         sizeof(buffer),
-        "platform init (SDL %i.%i.%i, SDL Mixer %i.%i.%i)",
-        version.major, version.minor, version.patch,
-        mix_version->major, mix_version->minor, mix_version->patch
+        "platform init (SDL %i.%i.%i)",
+        version.major, version.minor, version.patch
     );
 
     log_info(buffer);
@@ -83,9 +114,7 @@ void platform_init(void) {
     // 3. Flexibility to change the hint based on the target platform
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, PLATFORM_RENDER_HINT);
 
-    if (Mix_OpenAudioDevice(11025, AUDIO_U8, 1, 2048, NULL, 0) < 0) {
-        log_fatal("Error intializing SDL Mixer");
-    }
+    sdl_audio_open();
 
     window = SDL_CreateWindow(
         NULL,
@@ -146,7 +175,11 @@ void platform_destroy(void) {
     free(render_buffer);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
-    Mix_Quit();
+    if (audio_device) {
+        SDL_CloseAudioDevice(audio_device);
+        audio_device = 0;
+    }
+    mixer_destroy();
     SDL_Quit();
 }
 
@@ -291,11 +324,6 @@ static void sdl_fix_frame_rate(void) {
     ticks_last_frame = SDL_GetTicks();
 }
 
-void platform_sound_play(sound_t* sound, int channel) {
-    Mix_Chunk* chunk = Mix_QuickLoad_RAW((uint8_t*)sound->pcm, sound->frame_count * sound->channel_count * sizeof(sample_t));
-    Mix_PlayChannel(channel, chunk, 0);
-}
-
 void platform_display_resolution_set(int width, int height) {
     SDL_DestroyTexture(render_buffer_texture);
     free(render_buffer);
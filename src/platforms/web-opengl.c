@@ -2,7 +2,6 @@
 #include <string.h>
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_mixer.h>
 #include <GL/glew.h>
 #include <SDL_opengl.h>
 #include <emscripten.h>
@@ -14,6 +13,7 @@
 #include "../graphics.h"
 #include "../log.h"
 #include "../math.h"
+#include "../mixer.h"
 #include "../platform.h"
 #include "../sounds.h"
 #include "../time.h"
@@ -23,6 +23,7 @@
 static SDL_Window* window = NULL;
 static uint32_t* render_buffer = NULL;
 static SDL_Rect display_rect;
+static SDL_AudioDeviceID audio_device = 0;
 
 static char* fragment_shader_source = NULL;
 
@@ -52,22 +53,52 @@ int platform_main(int argc, char* argv[]) {
     return 0;
 }
 
+/**
+ * Fill audio device buffer with mixed sound.
+ */
+static void SDLCALL sdl_audio_callback(void* userdata, uint8_t* stream, int length) {
+    mixer_mix((int16_t*)stream, length / (int)(sizeof(int16_t) * 2));
+}
+
+/**
+ * Open audio device and start mixer. Runs without sound if no device is
+ * available.
+ */
+static void sdl_audio_open(void) {
+    SDL_AudioSpec want;
+    SDL_AudioSpec have;
+
+    SDL_zero(want);
+    want.freq = 44100;
+    want.format = AUDIO_S16SYS;
+    want.channels = 2;
+    want.samples = 1024;
+    want.callback = sdl_audio_callback;
+
+    audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+
+    if (!audio_device) {
+        log_error("Error opening audio device: %s", SDL_GetError());
+        return;
+    }
+
+    mixer_init(have.freq);
+    SDL_PauseAudioDevice(audio_device, 0);
+}
+
 void platform_init(void) {
     // Get platform version info
     SDL_version version;
     SDL_GetVersion(&version);
 
-    const SDL_version* mix_version = Mix_Linked_Version();
-
     char buffer[128];
 
     snprintf(
         buffer,
         sizeof(buffer),
-        "platform init (Emscripten %i.%i.%i, SDL %i.%i.%i, SDL Mixer %i.%i.%i, OpenGL ES %i.%i)",
+        "platform init (Emscripten %i.%i.%i, SDL %i.%i.%i, OpenGL ES %i.%i)",
         __EMSCRIPTEN_major__, __EMSCRIPTEN_minor__, __EMSCRIPTEN_tiny__,
         version.major, version.minor, version.patch,
-        mix_version->major, mix_version->minor, mix_version->patch,
         OPENGL_VERSION_MAJOR, OPENGL_VERSION_MINOR
     );
 
@@ -80,9 +111,7 @@ void platform_init(void) {
         log_fatal("Error initializing SDL");
     }
 
-    if (Mix_OpenAudioDevice(11025, AUDIO_U8, 1, 2048, NULL, 0) < 0) {
-        log_fatal("Error intializing SDL Mixer");
-    }
+    sdl_audio_open();
 
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, OPENGL_VERSION_MAJOR);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, OPENGL_VERSION_MINOR);
@@ -167,7 +196,11 @@ void platform_destroy(void) {
     if (fragment_shader_source) free(fragment_shader_source);
     free(render_buffer);
     SDL_DestroyWindow(window);
-    Mix_Quit();
+    if (audio_device) {
+        SDL_CloseAudioDevice(audio_device);
+        audio_device = 0;
+    }
+    mixer_destroy();
     SDL_Quit();
 }
 
@@ -328,11 +361,6 @@ static void sdl_handle_events(void) {
     }
 }
 
-void platform_sound_play(sound_t* sound, int channel) {
-    Mix_Chunk* chunk = Mix_QuickLoad_RAW((uint8_t*)sound->pcm, sound->frame_count * sound->channel_count * sizeof(sample_t));
-    Mix_PlayChannel(channel, chunk, 0);
-}
-
 /**
  * Log any diagnostic info for given shader.
  *
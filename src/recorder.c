@@ -0,0 +1,256 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
+#include "gif_encoder.h"
+#include "graphics.h"
+#include "log.h"
+#include "recorder.h"
+#include "time.h"
+
+/** Number of frames that can wait for the encoder. */
+#define RECORDER_FRAME_COUNT 64
+
+typedef struct {
+    texture_t* texture;
+
+    /** Time frame was captured in milliseconds. */
+    double time;
+} recorder_frame_t;
+
+static gif_encoder_t* encoder = NULL;
+static recorder_frame_t frames[RECORDER_FRAME_COUNT];
+
+/** Ring buffer positions. Frames in [read, write) are waiting to be encoded. */
+static int read_index = 0;
+static int write_index = 0;
+static int queued_count = 0;
+
+/** Frames not captured while the ring buffer was full. */
+static int dropped_count = 0;
+
+static bool is_recording = false;
+
+/**
+ * Encode frame shown from its capture until given time. Dropped frames need
+ * no special handling, as the frame before them is simply shown longer.
+ *
+ * @param frame Frame to encode.
+ * @param end_time Time next frame was captured, or recording stopped.
+ */
+static void frame_encode(recorder_frame_t* frame, double end_time) {
+    gif_encoder_frame_add(encoder, frame->texture, (end_time - frame->time) / 1000.0);
+}
+
+#ifndef __EMSCRIPTEN__
+static pthread_t encoder_thread;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t frame_available = PTHREAD_COND_INITIALIZER;
+static bool is_stopping = false;
+
+/** Time recording stopped in milliseconds. Ends the last frame. */
+static double stop_time = 0;
+
+/**
+ * Encode queued frames until recording is stopped and queue is empty. A frame
+ * is encoded once the next one is queued, as its duration is not known until
+ * then.
+ */
+static void* encoder_thread_run(void* arg) {
+    pthread_mutex_lock(&mutex);
+
+    while (true) {
+        while (queued_count < 2 && !is_stopping) {
+            pthread_cond_wait(&frame_available, &mutex);
+        }
+
+        if (queued_count == 0) break;
+
+        recorder_frame_t* frame = &frames[read_index];
+        double end_time = queued_count > 1 ? frames[(read_index + 1) % RECORDER_FRAME_COUNT].time : stop_time;
+
+        // Frame slot is not reused until it is released below
+        pthread_mutex_unlock(&mutex);
+        frame_encode(frame, end_time);
+        pthread_mutex_lock(&mutex);
+
+        read_index = (read_index + 1) % RECORDER_FRAME_COUNT;
+        queued_count--;
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    return NULL;
+}
+#endif
+
+/**
+ * Free ring buffer frames.
+ */
+static void frames_free(void) {
+    for (int i = 0; i < RECORDER_FRAME_COUNT; i++) {
+        graphics_texture_free(frames[i].texture);
+        frames[i].texture = NULL;
+    }
+}
+
+void recorder_init(void) {
+    memset(frames, 0, sizeof(frames));
+}
+
+void recorder_destroy(void) {
+    recorder_stop();
+}
+
+bool recorder_start(const char* filename) {
+    if (is_recording) return false;
+
+    char name[64];
+    if (!filename) {
+        time_t now = time(NULL);
+        strftime(name, sizeof(name), "recording_%Y%m%d%H%M%S.gif", localtime(&now));
+        filename = name;
+    }
+
+    texture_t* render_texture = graphics_render_texture_get();
+    int width = render_texture->width;
+    int height = render_texture->height;
+
+    // Allocate ring buffer up front so capturing never allocates
+    for (int i = 0; i < RECORDER_FRAME_COUNT; i++) {
+        frames[i].texture = graphics_texture_new(width, height, NULL);
+
+        if (!frames[i].texture) {
+            log_error("Failed to allocate recording buffer");
+            frames_free();
+            return false;
+        }
+    }
+
+    encoder = gif_encoder_open(filename, width, height);
+    if (!encoder) {
+        frames_free();
+        return false;
+    }
+
+    read_index = 0;
+    write_index = 0;
+    queued_count = 0;
+    dropped_count = 0;
+
+#ifndef __EMSCRIPTEN__
+    is_stopping = false;
+
+    if (pthread_create(&encoder_thread, NULL, encoder_thread_run, NULL) != 0) {
+        log_error("Failed to create recorder thread");
+        gif_encoder_close(encoder);
+        encoder = NULL;
+        frames_free();
+        return false;
+    }
+#endif
+
+    is_recording = true;
+
+    log_info("recording: %s", filename);
+
+    return true;
+}
+
+void recorder_stop(void) {
+    if (!is_recording) return;
+
+    is_recording = false;
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&mutex);
+    stop_time = time_millis_get();
+    is_stopping = true;
+    pthread_cond_signal(&frame_available);
+    pthread_mutex_unlock(&mutex);
+
+    pthread_join(encoder_thread, NULL);
+#else
+    if (queued_count > 0) {
+        frame_encode(&frames[read_index], time_millis_get());
+    }
+#endif
+
+    if (dropped_count > 0) {
+        log_info("recording dropped %i frames", dropped_count);
+    }
+
+    if (gif_encoder_close(encoder)) {
+        log_info("recording saved");
+    }
+
+    encoder = NULL;
+    frames_free();
+}
+
+void recorder_toggle(void) {
+    if (is_recording) {
+        recorder_stop();
+    }
+    else {
+        recorder_start(NULL);
+    }
+}
+
+bool recorder_is_recording(void) {
+    return is_recording;
+}
+
+void recorder_update(void) {
+    if (!is_recording) return;
+
+    texture_t* render_texture = graphics_render_texture_get();
+
+    if (render_texture->width != encoder->width || render_texture->height != encoder->height) {
+        log_error("Resolution changed, stopping recording");
+        recorder_stop();
+        return;
+    }
+
+    double now = time_millis_get();
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&mutex);
+    bool is_full = queued_count == RECORDER_FRAME_COUNT;
+    pthread_mutex_unlock(&mutex);
+
+    // Encoder is behind, so hold previous frame longer instead of waiting
+    if (is_full) {
+        dropped_count++;
+        return;
+    }
+#else
+    // Previous frame ends now
+    if (queued_count > 0) {
+        frame_encode(&frames[read_index], now);
+        read_index = (read_index + 1) % RECORDER_FRAME_COUNT;
+        queued_count--;
+    }
+#endif
+
+    recorder_frame_t* frame = &frames[write_index];
+    size_t size = sizeof(color_t) * render_texture->width * render_texture->height;
+    memcpy(frame->texture->pixels, render_texture->pixels, size);
+    frame->time = now;
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&mutex);
+#endif
+    write_index = (write_index + 1) % RECORDER_FRAME_COUNT;
+    queued_count++;
+#ifndef __EMSCRIPTEN__
+    pthread_cond_signal(&frame_available);
+    pthread_mutex_unlock(&mutex);
+#endif
+}
@@ -0,0 +1,54 @@
+/**
+ * @file recorder.h
+ * Recorder module. Records the render texture to an animated GIF. Frames are
+ * copied into a ring buffer as they are presented and encoded on a
+ * background thread.
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdbool.h>
+
+/**
+ * Initialize recorder system.
+ */
+void recorder_init(void);
+
+/**
+ * Destroy recorder system. Any recording in progress is finished.
+ */
+void recorder_destroy(void);
+
+/**
+ * Capture current render texture if recording. Should be called once per
+ * frame after drawing.
+ */
+void recorder_update(void);
+
+/**
+ * Start recording.
+ *
+ * @param filename Name of GIF to save. If NULL a timestamped name is used.
+ * @return bool True if recording started, false otherwise.
+ */
+bool recorder_start(const char* filename);
+
+/**
+ * Stop recording and finish GIF. Waits for queued frames to be encoded.
+ */
+void recorder_stop(void);
+
+/**
+ * Start recording if not recording, stop otherwise.
+ */
+void recorder_toggle(void);
+
+/**
+ * Check if recording.
+ *
+ * @return bool True if recording, false otherwise.
+ */
+bool recorder_is_recording(void);
+
+#endif
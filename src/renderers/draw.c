@@ -408,7 +408,13 @@ void draw_filled_pattern_circle(int x, int y, int radius, texture_t* pattern, in
 }
 
 void draw_text(const char* message, int x, int y) {
-    texture_t* font_texture = assets_texture_get("font.gif", 0);
+    // Handles are stable across reloads
+    static int font_handle = -1;
+    if (font_handle < 0) {
+        font_handle = assets_handle_get("font.gif");
+    }
+
+    texture_t* font_texture = assets_texture_handle_get(font_handle, 0);
     if (!font_texture) {
         log_fatal("Missing font.gif asset");
     }
@@ -0,0 +1,288 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <mathc/mathc.h>
+
+#include "../graphics.h"
+#include "../log.h"
+#include "../math.h"
+#include "shading.h"
+
+#include "mode7.h"
+
+/** Number of fractional bits used by fixed-point texture coordinates. */
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+
+/** Sprites closer than this are culled. */
+#define NEAR_DISTANCE 0.01f
+
+mode7_renderer_t* mode7_renderer_new(texture_t* render_texture) {
+    mode7_renderer_t* renderer = (mode7_renderer_t*)malloc(sizeof(mode7_renderer_t));
+
+    if (!renderer) {
+        log_error("Failed to create mode7 renderer");
+        return NULL;
+    }
+
+    if (!render_texture) {
+        render_texture = graphics_render_texture_get();
+    }
+
+    int width, height;
+    graphics_texture_resolution_get(render_texture, &width, &height);
+    size_t size = width * height;
+
+    renderer->render_texture = render_texture;
+    renderer->depth_buffer = (float*)malloc(size * sizeof(float));
+    renderer->shading = shading_lut_new();
+    renderer->features.shade_table = NULL;
+    renderer->features.fog_distance = 32.0f;
+    renderer->features.wrap = true;
+    renderer->features.horizon = height / 2.0f;
+    renderer->features.pixels_per_unit = 64.0f;
+
+    vec3(renderer->camera.position, 0, 0, 1);
+    vec2(renderer->camera.direction, 0, 1);
+    renderer->camera.fov = 90.0f;
+
+    mode7_renderer_clear_depth(renderer, FLT_MAX);
+
+    return renderer;
+}
+
+void mode7_renderer_free(mode7_renderer_t* renderer) {
+    free(renderer->depth_buffer);
+    renderer->depth_buffer = NULL;
+
+    shading_lut_free(renderer->shading);
+    renderer->shading = NULL;
+
+    free(renderer);
+    renderer = NULL;
+}
+
+void mode7_renderer_clear_color(mode7_renderer_t* renderer, color_t color) {
+    graphics_texture_clear(renderer->render_texture, color);
+}
+
+void mode7_renderer_clear_depth(mode7_renderer_t* renderer, float depth) {
+    size_t size = renderer->render_texture->width * renderer->render_texture->height;
+
+    for (int i = 0; i < size; i++) {
+        renderer->depth_buffer[i] = depth;
+    }
+}
+
+void mode7_renderer_camera(mode7_renderer_t* renderer, mfloat_t* position, mfloat_t* direction, float fov) {
+    vec3_assign(renderer->camera.position, position);
+    vec2_assign(renderer->camera.direction, direction);
+    renderer->camera.fov = fov;
+}
+
+/**
+ * Get brightness for given distance.
+ *
+ * @param renderer Renderer to get fog distance from.
+ * @param distance Distance from camera
+ * @return float Brightness where 1.0 is full bright and 0.0 is full dark.
+ */
+static float get_distance_based_brightness(mode7_renderer_t* renderer, float distance) {
+    return 1.0f - distance / renderer->features.fog_distance;
+}
+
+/**
+ * Ensure renderer shade lookup is built from the current shade table.
+ *
+ * @param renderer Renderer to prepare.
+ */
+static void update_shading(mode7_renderer_t* renderer) {
+    if (renderer->shading->source != renderer->features.shade_table) {
+        shading_lut_update(renderer->shading, renderer->features.shade_table);
+    }
+}
+
+/**
+ * Get camera basis and distance to projection plane.
+ *
+ * @param renderer Renderer to get camera from.
+ * @param forward Normalized camera direction.
+ * @param right Screen space right vector on the plane.
+ * @return float Distance to projection plane in pixels.
+ */
+static float get_camera_basis(mode7_renderer_t* renderer, mfloat_t* forward, mfloat_t* right) {
+    vec2_normalize(forward, renderer->camera.direction);
+
+    // Matches raycaster renderer's screen orientation
+    vec2_tangent(right, forward);
+    vec2_negative(right, right);
+
+    return (renderer->render_texture->width / 2.0f) / tanf(to_radians(renderer->camera.fov) / 2.0f);
+}
+
+void mode7_renderer_render_plane(mode7_renderer_t* renderer, texture_t* plane) {
+    if (!renderer->render_texture) return;
+    if (!plane) return;
+
+    texture_t* render_texture = renderer->render_texture;
+    const int width = render_texture->width;
+    const int height = render_texture->height;
+
+    const float camera_height = renderer->camera.position[2];
+    if (camera_height <= 0.0f) return;
+
+    update_shading(renderer);
+
+    mfloat_t forward[VEC2_SIZE];
+    mfloat_t right[VEC2_SIZE];
+    const float distance_to_projection_plane = get_camera_basis(renderer, forward, right);
+
+    const float pixels_per_unit = renderer->features.pixels_per_unit;
+    const bool wrap = renderer->features.wrap;
+    const float horizon = renderer->features.horizon * graphics_scene_scale_get(render_texture);
+    const int plane_width = plane->width;
+    const int plane_height = plane->height;
+    const bool power_of_two = (plane_width & (plane_width - 1)) == 0 && (plane_height & (plane_height - 1)) == 0;
+
+    int top = fmaxf(0.0f, ceilf(horizon - 0.5f));
+
+    for (int j = top; j < height; j++) {
+        // Distance to plane along this row
+        float dy = j + 0.5f - horizon;
+        if (dy <= 0.0f) continue;
+
+        float distance = camera_height * distance_to_projection_plane / dy;
+
+        // Rows past the fog distance are fully shaded but still drawn so the
+        // plane reaches the horizon.
+        const color_t* shade = shading_lut_row_get(renderer->shading, get_distance_based_brightness(renderer, distance));
+
+        // Affine parameters for this row in texels. Start at the center of
+        // the leftmost pixel and step one pixel to the right.
+        double scale = distance / distance_to_projection_plane;
+        double u = (renderer->camera.position[0] + forward[0] * distance + right[0] * (0.5 - width / 2.0) * scale) * pixels_per_unit;
+        double v = (renderer->camera.position[1] + forward[1] * distance + right[1] * (0.5 - width / 2.0) * scale) * pixels_per_unit;
+        double du = right[0] * scale * pixels_per_unit;
+        double dv = right[1] * scale * pixels_per_unit;
+
+        // Keep wrapped coordinates small to preserve fixed-point range
+        if (wrap) {
+            u = fmod(u, plane_width);
+            v = fmod(v, plane_height);
+        }
+
+        int64_t fu = (int64_t)floor(u * FIXED_ONE);
+        int64_t fv = (int64_t)floor(v * FIXED_ONE);
+        const int64_t fdu = (int64_t)floor(du * FIXED_ONE);
+        const int64_t fdv = (int64_t)floor(dv * FIXED_ONE);
+
+        color_t* pixels = &render_texture->pixels[j * width];
+        float* depths = &renderer->depth_buffer[j * width];
+
+        for (int i = 0; i < width; i++, fu += fdu, fv += fdv) {
+            if (depths[i] <= distance) continue;
+
+            int x = (int)(fu >> FIXED_SHIFT);
+            int y = (int)(fv >> FIXED_SHIFT);
+
+            if (wrap) {
+                if (power_of_two) {
+                    x &= plane_width - 1;
+                    y &= plane_height - 1;
+                }
+                else {
+                    x %= plane_width;
+                    y %= plane_height;
+                    if (x < 0) x += plane_width;
+                    if (y < 0) y += plane_height;
+                }
+            }
+            else if (x < 0 || x >= plane_width || y < 0 || y >= plane_height) {
+                continue;
+            }
+
+            pixels[i] = shade[plane->pixels[y * plane_width + x]];
+            depths[i] = distance;
+        }
+    }
+}
+
+void mode7_renderer_render_sprite(mode7_renderer_t* renderer, texture_t* sprite, mfloat_t* position) {
+    if (!renderer->render_texture) return;
+    if (!sprite) return;
+
+    texture_t* render_texture = renderer->render_texture;
+    const int width = render_texture->width;
+    const int height = render_texture->height;
+
+    update_shading(renderer);
+
+    mfloat_t forward[VEC2_SIZE];
+    mfloat_t right[VEC2_SIZE];
+    const float distance_to_projection_plane = get_camera_basis(renderer, forward, right);
+
+    // Calculate sprite projected distance
+    mfloat_t camera_space_position[VEC2_SIZE];
+    vec2_subtract(camera_space_position, position, renderer->camera.position);
+    float distance = vec2_dot(forward, camera_space_position);
+
+    // Cull sprites outside near/far planes
+    if (distance < NEAR_DISTANCE) return;
+    if (distance >= renderer->features.fog_distance) return;
+
+    // Screen pixels per sprite texel
+    float projection = distance_to_projection_plane / distance;
+    float scale = projection / renderer->features.pixels_per_unit;
+    if (scale <= 0.0f) return;
+
+    float sprite_width = sprite->width * scale;
+    float sprite_height = sprite->height * scale;
+
+    // Sprite is centered horizontally and stands on the plane
+    float center = width / 2.0f + vec2_dot(camera_space_position, right) * projection;
+    float horizon = renderer->features.horizon * graphics_scene_scale_get(render_texture);
+    float ground = horizon + (renderer->camera.position[2] - position[2]) * projection;
+
+    float left = center - sprite_width / 2.0f;
+    float top = ground - sprite_height;
+
+    int x0 = fmaxf(0.0f, ceilf(left - 0.5f));
+    int x1 = fminf(width, ceilf(left + sprite_width - 0.5f));
+    int y0 = fmaxf(0.0f, ceilf(top - 0.5f));
+    int y1 = fminf(height, ceilf(top + sprite_height - 0.5f));
+
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Fixed-point texel coordinates sampled at pixel centers
+    const int64_t step = (int64_t)(FIXED_ONE / scale);
+    const int64_t s_left = (int64_t)((x0 + 0.5f - left) / scale * FIXED_ONE);
+    int64_t t = (int64_t)((y0 + 0.5f - top) / scale * FIXED_ONE);
+
+    const color_t* shade = shading_lut_row_get(renderer->shading, get_distance_based_brightness(renderer, distance));
+    const int transparent_color = graphics_transparent_color_get();
+
+    for (int y = y0; y < y1; y++, t += step) {
+        int ty = (int)(t >> FIXED_SHIFT);
+        if (ty >= sprite->height) break;
+
+        const color_t* source = &sprite->pixels[ty * sprite->width];
+        color_t* pixels = &render_texture->pixels[y * width];
+        float* depths = &renderer->depth_buffer[y * width];
+
+        int64_t s = s_left;
+
+        for (int x = x0; x < x1; x++, s += step) {
+            int tx = (int)(s >> FIXED_SHIFT);
+            if (tx >= sprite->width) break;
+
+            if (depths[x] <= distance) continue;
+
+            color_t color = source[tx];
+            if (color == transparent_color) continue;
+
+            pixels[x] = shade[color];
+            depths[x] = distance;
+        }
+    }
+}
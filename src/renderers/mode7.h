@@ -0,0 +1,89 @@
+#ifndef RENDERERS_MODE7_H
+#define RENDERERS_MODE7_H
+
+#include <stdbool.h>
+#include <mathc/mathc.h>
+
+#include "../graphics.h"
+#include "shading.h"
+
+typedef struct {
+    texture_t* render_texture;
+    float* depth_buffer;
+    shading_lut_t* shading;
+
+    struct {
+        texture_t* shade_table;
+        float fog_distance;
+        bool wrap;
+        float horizon;
+        float pixels_per_unit;
+    } features;
+
+    struct {
+        mfloat_t position[VEC3_SIZE];
+        mfloat_t direction[VEC2_SIZE];
+        float fov;
+    } camera;
+} mode7_renderer_t;
+
+/**
+ * Creates a new renderer.
+ *
+ * @param render_texture Texture to render to. NULL to use the render texture.
+ * @return mode7_renderer_t* Newly created renderer.
+ */
+mode7_renderer_t* mode7_renderer_new(texture_t* render_texture);
+
+/**
+ * Frees a renderer.
+ *
+ * @param renderer Renderer to free.
+ */
+void mode7_renderer_free(mode7_renderer_t* renderer);
+
+/**
+ * Clears color buffer for given color.
+ *
+ * @param renderer Renderer to clear color buffer.
+ * @param color Clear color.
+ */
+void mode7_renderer_clear_color(mode7_renderer_t* renderer, color_t color);
+
+/**
+ * Clears depth buffer for given depth.
+ *
+ * @param renderer Renderer to clear depth buffer.
+ * @param depth Clear depth.
+ */
+void mode7_renderer_clear_depth(mode7_renderer_t* renderer, float depth);
+
+/**
+ * Set camera data.
+ *
+ * @param renderer Renderer to set camera data for.
+ * @param position Camera position. The z-component is height above the plane.
+ * @param direction Camera direction.
+ * @param fov Camera fov.
+ */
+void mode7_renderer_camera(mode7_renderer_t* renderer, mfloat_t* position, mfloat_t* direction, float fov);
+
+/**
+ * Render given texture as a ground plane. Only rows below the horizon are
+ * drawn.
+ *
+ * @param renderer Renderer to render to.
+ * @param plane Texture to render.
+ */
+void mode7_renderer_render_plane(mode7_renderer_t* renderer, texture_t* plane);
+
+/**
+ * Render given texture as a billboarded sprite standing on the plane.
+ *
+ * @param renderer Renderer to render to.
+ * @param sprite Texture to render.
+ * @param position Sprite position. The z-component is height above the plane.
+ */
+void mode7_renderer_render_sprite(mode7_renderer_t* renderer, texture_t* sprite, mfloat_t* position);
+
+#endif
@@ -9,17 +9,12 @@
 #include "../log.h"
 #include "../math.h"
 #include "draw.h"
+#include "shading.h"
 
 #include "raycaster.h"
 
 typedef int map_data_t;
 
-/**
- * Shade table. Used for shading a given pixel. The y-coordinate corresponds
- * to original color and the x-coordinate corresponds to desired brightness.
- */
-static texture_t* shade_table;
-
 static float fog_distance = 32.0f;
 
 static raycaster_renderer_t* active_renderer;
@@ -31,25 +26,226 @@ raycaster_map_t* raycaster_map_new(int width, int height) {
 
     size_t size = width * height;
 
-    map->walls = (int*)malloc(size * sizeof(int));
-    map->floors = (int*)malloc(size * sizeof(int));
-    map->ceilings = (int*)malloc(size * sizeof(int));
+    map->cells = (raycaster_cell_t*)calloc(size, sizeof(raycaster_cell_t));
+    map->wall_distances = NULL;
 
     return map;
 }
 
 void raycaster_map_free(raycaster_map_t* map) {
-    free(map->walls);
-    map->walls = NULL;
-    free(map->floors);
-    map->floors = NULL;
-    free(map->ceilings);
-    map->ceilings = NULL;
+    free(map->cells);
+    map->cells = NULL;
+    free(map->wall_distances);
+    map->wall_distances = NULL;
 
     free(map);
     map = NULL;
 }
 
+void raycaster_map_acceleration_set(raycaster_map_t* map, bool enabled) {
+    if (!enabled) {
+        free(map->wall_distances);
+        map->wall_distances = NULL;
+        return;
+    }
+
+    if (map->wall_distances) return;
+
+    map->wall_distances = (uint8_t*)malloc(map->width * map->height * sizeof(uint8_t));
+
+    if (!map->wall_distances) {
+        log_error("Failed to create map acceleration structure");
+        return;
+    }
+
+    raycaster_map_acceleration_update(map, 0, 0, map->width, map->height);
+}
+
+void raycaster_map_acceleration_update(raycaster_map_t* map, int x, int y, int width, int height) {
+    if (!map->wall_distances) return;
+
+    const int max_distance = RAYCASTER_MAP_DISTANCE_MAX;
+
+    /*
+     * Distances are computed with a two pass chamfer over a window padded by
+     * the max distance. Any wall that can affect a cell in the region lies
+     * inside the window, so region distances are exact. Only the region is
+     * written back.
+     */
+    const int left = fmaxf(x - max_distance, 0);
+    const int top = fmaxf(y - max_distance, 0);
+    const int right = fminf(x + width + max_distance, map->width);
+    const int bottom = fminf(y + height + max_distance, map->height);
+    const int window_width = right - left;
+    const int window_height = bottom - top;
+
+    if (window_width <= 0 || window_height <= 0) return;
+
+    uint8_t* window = (uint8_t*)malloc(window_width * window_height * sizeof(uint8_t));
+
+    if (!window) {
+        log_error("Failed to update map acceleration structure");
+        return;
+    }
+
+    for (int j = 0; j < window_height; j++) {
+        for (int i = 0; i < window_width; i++) {
+            bool solid = map->cells[(top + j) * map->width + left + i].wall > 0;
+            window[j * window_width + i] = solid ? 0 : max_distance;
+        }
+    }
+
+    // Forward pass
+    for (int j = 0; j < window_height; j++) {
+        for (int i = 0; i < window_width; i++) {
+            int d = window[j * window_width + i];
+            if (i > 0) d = fminf(d, window[j * window_width + i - 1] + 1);
+            if (j > 0) {
+                if (i > 0) d = fminf(d, window[(j - 1) * window_width + i - 1] + 1);
+                d = fminf(d, window[(j - 1) * window_width + i] + 1);
+                if (i < window_width - 1) d = fminf(d, window[(j - 1) * window_width + i + 1] + 1);
+            }
+            window[j * window_width + i] = d;
+        }
+    }
+
+    // Backward pass
+    for (int j = window_height - 1; j >= 0; j--) {
+        for (int i = window_width - 1; i >= 0; i--) {
+            int d = window[j * window_width + i];
+            if (i < window_width - 1) d = fminf(d, window[j * window_width + i + 1] + 1);
+            if (j < window_height - 1) {
+                if (i < window_width - 1) d = fminf(d, window[(j + 1) * window_width + i + 1] + 1);
+                d = fminf(d, window[(j + 1) * window_width + i] + 1);
+                if (i > 0) d = fminf(d, window[(j + 1) * window_width + i - 1] + 1);
+            }
+            window[j * window_width + i] = d;
+        }
+    }
+
+    // Write back region
+    const int region_left = fmaxf(x, 0);
+    const int region_top = fmaxf(y, 0);
+    const int region_right = fminf(x + width, map->width);
+    const int region_bottom = fminf(y + height, map->height);
+
+    for (int j = region_top; j < region_bottom; j++) {
+        for (int i = region_left; i < region_right; i++) {
+            map->wall_distances[j * map->width + i] = window[(j - top) * window_width + i - left];
+        }
+    }
+
+    free(window);
+}
+
+/**
+ * Get pointer to given layer's data in the first cell. Consecutive cells are
+ * sizeof(raycaster_cell_t) bytes apart.
+ *
+ * @param map Map to access
+ * @param layer Layer to access
+ * @return uint16_t* Layer data for first cell.
+ */
+static uint16_t* map_layer_get(raycaster_map_t* map, raycaster_map_layer_t layer) {
+    switch (layer) {
+        case RAYCASTER_MAP_LAYER_WALLS:
+            return &map->cells[0].wall;
+        case RAYCASTER_MAP_LAYER_FLOORS:
+            return &map->cells[0].floor;
+        case RAYCASTER_MAP_LAYER_CEILINGS:
+            return &map->cells[0].ceiling;
+    }
+
+    return NULL;
+}
+
+int raycaster_map_get(raycaster_map_t* map, int x, int y, raycaster_map_layer_t layer) {
+    if (x < 0 || x >= map->width) return 0;
+    if (y < 0 || y >= map->height) return 0;
+
+    raycaster_cell_t* cell = &map->cells[y * map->width + x];
+
+    switch (layer) {
+        case RAYCASTER_MAP_LAYER_WALLS:
+            return cell->wall;
+        case RAYCASTER_MAP_LAYER_FLOORS:
+            return cell->floor;
+        case RAYCASTER_MAP_LAYER_CEILINGS:
+            return cell->ceiling;
+    }
+
+    return 0;
+}
+
+void raycaster_map_set(raycaster_map_t* map, int x, int y, raycaster_map_layer_t layer, int value) {
+    if (x < 0 || x >= map->width) return;
+    if (y < 0 || y >= map->height) return;
+
+    raycaster_cell_t* cell = &map->cells[y * map->width + x];
+
+    switch (layer) {
+        case RAYCASTER_MAP_LAYER_WALLS: {
+            bool was_solid = cell->wall > 0;
+            cell->wall = value;
+
+            if (was_solid != (cell->wall > 0)) {
+                raycaster_map_acceleration_update(map, x - RAYCASTER_MAP_DISTANCE_MAX, y - RAYCASTER_MAP_DISTANCE_MAX, RAYCASTER_MAP_DISTANCE_MAX * 2 + 1, RAYCASTER_MAP_DISTANCE_MAX * 2 + 1);
+            }
+            break;
+        }
+        case RAYCASTER_MAP_LAYER_FLOORS:
+            cell->floor = value;
+            break;
+        case RAYCASTER_MAP_LAYER_CEILINGS:
+            cell->ceiling = value;
+            break;
+    }
+}
+
+void raycaster_map_layer_load(raycaster_map_t* map, raycaster_map_layer_t layer, const int* data) {
+    uint16_t* dest = map_layer_get(map, layer);
+    if (!dest) return;
+
+    const size_t size = map->width * map->height;
+    const size_t stride = sizeof(raycaster_cell_t) / sizeof(uint16_t);
+
+    for (size_t i = 0; i < size; i++) {
+        dest[i * stride] = data[i];
+    }
+
+    if (layer == RAYCASTER_MAP_LAYER_WALLS) {
+        raycaster_map_acceleration_update(map, 0, 0, map->width, map->height);
+    }
+}
+
+void raycaster_map_layer_load_colors(raycaster_map_t* map, raycaster_map_layer_t layer, const color_t* colors) {
+    uint16_t* dest = map_layer_get(map, layer);
+    if (!dest) return;
+
+    const size_t size = map->width * map->height;
+    const size_t stride = sizeof(raycaster_cell_t) / sizeof(uint16_t);
+
+    for (size_t i = 0; i < size; i++) {
+        dest[i * stride] = colors[i];
+    }
+
+    if (layer == RAYCASTER_MAP_LAYER_WALLS) {
+        raycaster_map_acceleration_update(map, 0, 0, map->width, map->height);
+    }
+}
+
+void raycaster_map_layer_store(raycaster_map_t* map, raycaster_map_layer_t layer, int* data) {
+    const uint16_t* source = map_layer_get(map, layer);
+    if (!source) return;
+
+    const size_t size = map->width * map->height;
+    const size_t stride = sizeof(raycaster_cell_t) / sizeof(uint16_t);
+
+    for (size_t i = 0; i < size; i++) {
+        data[i] = source[i * stride];
+    }
+}
+
 /**
  * Determine if given point is contained in the map bounds.
  *
@@ -78,7 +274,7 @@ static map_data_t map_get_wall(raycaster_map_t* map, int x, int y) {
     if (x < 0 || x >= map->width) return 0;
     if (y < 0 || y >= map->height) return 0;
 
-    return map->walls[y * map->width + x];
+    return map->cells[y * map->width + x].wall;
 }
 
 /**
@@ -93,7 +289,7 @@ static map_data_t map_get_floor(raycaster_map_t* map, int x, int y) {
     if (x < 0 || x >= map->width) return 0;
     if (y < 0 || y >= map->height) return 0;
 
-    return map->floors[y * map->width + x];
+    return map->cells[y * map->width + x].floor;
 }
 
 
@@ -109,7 +305,7 @@ static map_data_t map_get_ceiling(raycaster_map_t* map, int x, int y) {
     if (x < 0 || x >= map->width) return 0;
     if (y < 0 || y >= map->height) return 0;
 
-    return map->ceilings[y * map->width + x];
+    return map->cells[y * map->width + x].ceiling;
 }
 
 /**
@@ -125,16 +321,43 @@ static bool map_is_solid(raycaster_map_t* map, int x, int y) {
     return map_get_wall(map, x, y) > 0;
 }
 
+/**
+ * Get number of upcoming ray steps guaranteed to only visit empty cells.
+ *
+ * Each ray step moves exactly one cell along its major axis and at most
+ * cross_step cells along the other. Allowing one cell for rounding on each
+ * axis, every cell visited in the next n steps is within n * max(1, cross_step)
+ * + 1 cells of the current one, so it is empty if that is less than the
+ * distance to the nearest wall.
+ *
+ * @param map Map to check
+ * @param x Current cell x-coordinate
+ * @param y Current cell y-coordinate
+ * @param cross_step Absolute ray movement along the minor axis per step.
+ * @return int Number of steps that can be skipped.
+ */
+static int map_get_empty_steps(raycaster_map_t* map, int x, int y, float cross_step) {
+    if (!map->wall_distances) return 0;
+    if (!map_contains(map, x, y)) return 0;
+
+    int distance = map->wall_distances[y * map->width + x];
+    if (distance <= 2) return 0;
+
+    return (distance - 2) / fmaxf(1.0f, cross_step);
+}
+
 typedef struct {
     mfloat_t position[VEC2_SIZE];
     float distance;
     map_data_t data;
     bool was_vertical;
+    int cell[2];
 } ray_hit_info_t;
 
 typedef struct {
     mfloat_t position[VEC2_SIZE];
     mfloat_t direction[VEC2_SIZE];
+    float max_distance;
     ray_hit_info_t hit_info;
 } ray_t;
 
@@ -152,6 +375,7 @@ static void ray_hit_info_reset(ray_hit_info_t* hit_info) {
 static void ray_set(ray_t* ray, mfloat_t* position, mfloat_t* direction) {
     vec2_assign(ray->position, position);
     vec2_assign(ray->direction, direction);
+    ray->max_distance = FLT_MAX;
 
     vec2_assign(ray->hit_info.position, position);
     ray_hit_info_reset(&ray->hit_info);
@@ -202,11 +426,15 @@ static void ray_cast(ray_t* ray, raycaster_map_t* map) {
         int ray_direction_offset = ray_facing_down ? 0 : -1;
 
         int bound = map->height;
+        float cross_step = fabsf(step[0]);
 
         for(int s = 0; s < bound; s++) {
             // Ensure we are still inside map bounds
             if (!map_contains(map, intersection[0], intersection[1])) break;
 
+            // Stop once past the max distance
+            if (distance > ray->max_distance) break;
+
             int i = floorf(intersection[0]);
             int j = floorf(intersection[1] + 0.001f) + ray_direction_offset;
 
@@ -217,10 +445,21 @@ static void ray_cast(ray_t* ray, raycaster_map_t* map) {
                 ray->hit_info.distance = distance;
                 ray->hit_info.was_vertical = false;
                 ray->hit_info.data = map_get_wall(map, i, j);
+                ray->hit_info.cell[0] = i;
+                ray->hit_info.cell[1] = j;
 
                 break;
             }
 
+            // Skip over empty cells. Intersections are still accumulated
+            // one step at a time so hits are identical to a full traversal.
+            int skip = fminf(map_get_empty_steps(map, i, j, cross_step), bound - s - 1);
+            for (int k = 0; k < skip; k++) {
+                vec2_add(intersection, intersection, step);
+                distance += fabsf(inv_y);
+            }
+            s += skip;
+
             // Otherwise next iteration
             vec2_add(intersection, intersection, step);
             distance += fabsf(inv_y);
@@ -265,6 +504,7 @@ static void ray_cast(ray_t* ray, raycaster_map_t* map) {
         int ray_direction_offset = ray_facing_right ? 0 : -1;
 
         int bound = map->width;
+        float cross_step = fabsf(step[1]);
 
         for(int s = 0; s < bound; s++) {
             // Ensure we are still inside map bounds
@@ -273,6 +513,9 @@ static void ray_cast(ray_t* ray, raycaster_map_t* map) {
             // Early out if further than horizontal intersection
             if (distance > ray->hit_info.distance) break;
 
+            // Stop once past the max distance
+            if (distance > ray->max_distance) break;
+
             int i = floorf(intersection[0] + 0.001f) + ray_direction_offset;
             int j = floorf(intersection[1]);
 
@@ -283,10 +526,21 @@ static void ray_cast(ray_t* ray, raycaster_map_t* map) {
                 ray->hit_info.distance = distance;
                 ray->hit_info.was_vertical = true;
                 ray->hit_info.data = map_get_wall(map, i, j);
+                ray->hit_info.cell[0] = i;
+                ray->hit_info.cell[1] = j;
 
                 break;
             }
 
+            // Skip over empty cells. Intersections are still accumulated
+            // one step at a time so hits are identical to a full traversal.
+            int skip = fminf(map_get_empty_steps(map, i, j, cross_step), bound - s - 1);
+            for (int k = 0; k < skip; k++) {
+                vec2_add(intersection, intersection, step);
+                distance += fabsf(inv_x);
+            }
+            s += skip;
+
             // Otherwise next iteration
             vec2_add(intersection, intersection, step);
             distance += fabsf(inv_x);
@@ -295,26 +549,88 @@ static void ray_cast(ray_t* ray, raycaster_map_t* map) {
 }
 
 /**
- * Shades given pixel to given brightness using the shade table.
+ * Calculate the normalized horizontal texture offset (u-coordinate) of a ray's
+ * hit. The offset is flipped as needed to maintain correct orientation.
  *
- * @param color Original color
- * @param brightness Amount to shade pixel. 1.0 = full bright 0.0 = full dark
- * @return color_t Shaded color
+ * @param ray Ray that was cast.
+ * @return float Texture offset in the range 0-1.
  */
-static color_t shade_pixel(color_t color, float brightness) {
-    if (!shade_table) return color;
-    if (color >= shade_table->height) return color;
+static float ray_hit_offset_get(ray_t* ray) {
+    float offset = 0.0f;
 
-    brightness = clamp(brightness, 0.0f, 1.0f);
-    brightness = 1.0f - brightness;
+    if (ray->hit_info.was_vertical) {
+        offset = frac(ray->hit_info.position[1]);
 
-    const int amount = brightness * (shade_table->width - 1);
+        if (ray->direction[0] < 0) {
+            offset = 1.0f - offset;
+        }
+    }
+    else {
+        offset = frac(ray->hit_info.position[0]);
 
-    return graphics_texture_pixel_get(
-        shade_table,
-        amount,
-        color
-    );
+        if (ray->direction[1] > 0) {
+            offset = 1.0f - offset;
+        }
+    }
+
+    return offset;
+}
+
+bool raycaster_map_cast(raycaster_map_t* map, mfloat_t* origin, mfloat_t* direction, float max_distance, raycaster_hit_t* hit) {
+    hit->distance = INFINITY;
+    hit->cell[0] = -1;
+    hit->cell[1] = -1;
+    hit->was_vertical = false;
+    hit->offset = 0.0f;
+    hit->data = 0;
+
+    if (direction[0] == 0.0f && direction[1] == 0.0f) return false;
+
+    ray_t ray;
+    ray_set(&ray, origin, direction);
+    vec2_normalize(ray.direction, ray.direction);
+    ray.max_distance = max_distance;
+
+    ray_cast(&ray, map);
+
+    if (ray.hit_info.distance > max_distance) return false;
+
+    hit->distance = ray.hit_info.distance;
+    hit->cell[0] = ray.hit_info.cell[0];
+    hit->cell[1] = ray.hit_info.cell[1];
+    hit->was_vertical = ray.hit_info.was_vertical;
+    hit->offset = ray_hit_offset_get(&ray);
+    hit->data = ray.hit_info.data;
+
+    return true;
+}
+
+/**
+ * Get shade row for given brightness. Brightness is constant along a wall
+ * column, a floor row, and a sprite, so this is resolved once per each and
+ * shading a pixel is a single lookup.
+ *
+ * @param brightness Amount to shade. 1.0 = full bright 0.0 = full dark
+ * @return const color_t* Row of shaded colors indexed by original color.
+ */
+static const color_t* get_shade_row(float brightness) {
+    return shading_lut_row_get(active_renderer->shading, brightness);
+}
+
+/**
+ * Ensure renderer shade lookup is built from the current shade table. Lookup
+ * is only rebuilt when the shade table was swapped or its pixels changed.
+ *
+ * @param renderer Renderer to prepare.
+ * @param check_pixels Also look for changes made to the same shade table.
+ */
+static void update_shading(raycaster_renderer_t* renderer, bool check_pixels) {
+    shading_lut_t* lut = renderer->shading;
+    texture_t* shade_table = renderer->features.shade_table;
+
+    if (lut->source != shade_table || (check_pixels && !shading_lut_is_current(lut, shade_table))) {
+        shading_lut_update(lut, shade_table);
+    }
 }
 
 /**
@@ -356,9 +672,9 @@ static float get_depth_buffer_pixel(raycaster_renderer_t* renderer, int x, int y
  * @param y0 Top of wall y-coordinate on destination texture
  * @param y1 Bottom of wall y-coordinate on destination texture
  * @param offset Wall texture x-coordinate offset.
- * @param brightness How light/dark to shade wall.
+ * @param shade Shade row for this strip.
  */
-static void draw_wall_strip(texture_t* wall_texture, texture_t* destination_texture, int x, int y0, int y1, float offset, float brightness, float depth) {
+static void draw_wall_strip(texture_t* wall_texture, texture_t* destination_texture, int x, int y0, int y1, float offset, const color_t* shade, float depth) {
     const int length = y1 - y0;
     const int start = y0 < 0 ? abs(y0) : 0;
     const int bottom = destination_texture->height;
@@ -380,14 +696,16 @@ static void draw_wall_strip(texture_t* wall_texture, texture_t* destination_text
 
         set_depth_buffer_pixel(active_renderer, x, y, depth);
 
-        c = shade_pixel(c, brightness);
-        graphics_texture_pixel_set(destination_texture, x, y, c);
+        graphics_texture_pixel_set(destination_texture, x, y, shade[c]);
     }
 }
 
 /** Depth of currently rendering sprite. */
 static float sprite_depth = FLT_MAX;
 
+/** Shade row of currently rendering sprite. */
+static const color_t* sprite_shade;
+
 /**
  * Pixel drawing function that respects ray depth.
  *
@@ -412,10 +730,7 @@ static void sprite_depth_blit_func(texture_t* source_texture, texture_t* destina
 
     set_depth_buffer_pixel(active_renderer, dx, dy, depth);
 
-    float brightness = get_distance_based_brightness(sprite_depth);
-    pixel = shade_pixel(pixel, brightness);
-
-    graphics_texture_pixel_set(destination_texture, dx, dy, pixel);
+    graphics_texture_pixel_set(destination_texture, dx, dy, sprite_shade[pixel]);
 }
 
 raycaster_renderer_t* raycaster_renderer_new(texture_t* render_texture) {
@@ -425,10 +740,13 @@ raycaster_renderer_t* raycaster_renderer_new(texture_t* render_texture) {
         render_texture = graphics_render_texture_get();
     }
 
-    size_t size = render_texture->width * render_texture->height;
+    int width, height;
+    graphics_texture_resolution_get(render_texture, &width, &height);
+    size_t size = width * height;
 
     renderer->render_texture = render_texture;
     renderer->depth_buffer = (float*)malloc(size * sizeof(float));
+    renderer->shading = shading_lut_new();
     renderer->features.shade_table = NULL;
     renderer->features.fog_distance = 32.0f;
     renderer->features.draw_walls = true;
@@ -449,6 +767,9 @@ void raycaster_renderer_free(raycaster_renderer_t* renderer) {
     free(renderer->depth_buffer);
     renderer->depth_buffer = NULL;
 
+    shading_lut_free(renderer->shading);
+    renderer->shading = NULL;
+
     free(renderer);
     renderer = NULL;
 }
@@ -487,7 +808,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
         render_texture = graphics_render_texture_get();
     }
 
-    shade_table = renderer->features.shade_table;
+    update_shading(renderer, true);
     fog_distance = renderer->features.fog_distance;
 
     const float width = render_texture->width;
@@ -559,7 +880,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
     float vertical_wall_brightness = renderer->features.vertical_wall_brightness;
 
     // Draw walls
-    if (renderer->features.draw_walls && map->walls) {
+    if (renderer->features.draw_walls) {
         for (int i = 0; i < width; i++) {
             ray_cast(&ray, map);
 
@@ -575,23 +896,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
             float bottom = top + wall_height;
 
             // Calculate the texture normalized horizontal offset (u-coordinate).
-            float offset = 0.0f;
-            if (ray.hit_info.was_vertical) {
-                offset = frac(ray.hit_info.position[1]);
-
-                // Flip texture to maintain correct orienation
-                if (ray.direction[0] < 0) {
-                    offset = 1.0f - offset;
-                }
-            }
-            else {
-                offset = frac(ray.hit_info.position[0]);
-
-                // Flip texture to maintain correct orienation
-                if (ray.direction[1] > 0) {
-                    offset = 1.0f - offset;
-                }
-            }
+            float offset = ray_hit_offset_get(&ray);
 
             texture_t* wall_texture = palette[ray.hit_info.data];
             if (wall_texture) {
@@ -606,7 +911,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
                     top,
                     bottom,
                     offset,
-                    brightness,
+                    get_shade_row(brightness),
                     corrected_distance
                 );
             }
@@ -639,7 +944,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
         // Determine floor horizontal step.
         vec2_multiply_f(floor_step, step, scale);
 
-        float brightness = get_distance_based_brightness(distance);
+        const color_t* shade = get_shade_row(get_distance_based_brightness(distance));
 
         // Draw current scanline for both floor and ceiling
         for (int i = 0; i < width; i++) {
@@ -648,7 +953,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
 
             // Draw floor
             float d = get_depth_buffer_pixel(active_renderer, i, j);
-            if (d > distance && renderer->features.draw_floors && map->floors) {
+            if (d > distance && renderer->features.draw_floors) {
                 int index = map_get_floor(map, tx, ty);
                 texture_t* texture = palette[index];
 
@@ -660,7 +965,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
 
                     // Floor
                     graphics_texture_pixel_set(
-                        render_texture, i, j, shade_pixel(color, brightness)
+                        render_texture, i, j, shade[color]
                     );
                     set_depth_buffer_pixel(active_renderer, i, j, distance);
                 }
@@ -668,7 +973,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
 
             // Draw ceiling
             d = get_depth_buffer_pixel(active_renderer, i, height - j - 1);
-            if (d > distance && renderer->features.draw_ceilings && map->ceilings) {
+            if (d > distance && renderer->features.draw_ceilings) {
                 int index = map_get_ceiling(map, tx, ty);
                 texture_t* texture = palette[index];
 
@@ -680,7 +985,7 @@ void raycaster_renderer_render_map(raycaster_renderer_t* renderer, raycaster_map
 
                     // Ceiling
                     graphics_texture_pixel_set(
-                        render_texture, i, height - j - 1, shade_pixel(color, brightness)
+                        render_texture, i, height - j - 1, shade[color]
                     );
                     set_depth_buffer_pixel(active_renderer, i, height - j - 1, distance);
                 }
@@ -701,7 +1006,7 @@ void raycaster_renderer_render_sprite(raycaster_renderer_t* renderer, texture_t*
     mfloat_t* direction = renderer->camera.direction;
     mfloat_t* camera_position = renderer->camera.position;
 
-    shade_table = renderer->features.shade_table;
+    update_shading(renderer, false);
     fog_distance = renderer->features.fog_distance;
 
     const float fov = renderer->camera.fov;
@@ -753,8 +1058,9 @@ void raycaster_renderer_render_sprite(raycaster_renderer_t* renderer, texture_t*
         sprite_height
     };
 
-    // Set sprite depth for blit func
+    // Set sprite depth and shade for blit func
     sprite_depth = distance;
+    sprite_shade = get_shade_row(get_distance_based_brightness(distance));
 
     // Draw sprite
     graphics_blit(
@@ -818,6 +1124,9 @@ void raycaster_renderer_render_sprite_oriented(raycaster_renderer_t* renderer, t
     mfloat_t* direction = renderer->camera.direction;
     mfloat_t* camera_position = renderer->camera.position;
 
+    update_shading(renderer, false);
+    fog_distance = renderer->features.fog_distance;
+
     float horizontal_wall_brightness = renderer->features.horizontal_wall_brightness;
     float vertical_wall_brightness = renderer->features.vertical_wall_brightness;
     float ppu = renderer->features.pixels_per_unit;
@@ -1073,7 +1382,7 @@ void raycaster_renderer_render_sprite_oriented(raycaster_renderer_t* renderer, t
                 top,
                 bottom,
                 offset,
-                brightness,
+                get_shade_row(brightness),
                 distance
             );
         }
@@ -2,20 +2,45 @@
 #define RENDERERS_RAYCASTER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <mathc/mathc.h>
 
 #include "../graphics.h"
 #include "../collections/list.h"
+#include "shading.h"
+
+/**
+ * Map data for a single cell. Layers are packed together so a cell's wall,
+ * floor and ceiling share a cache line.
+ */
+typedef struct {
+    uint16_t wall;
+    uint16_t floor;
+    uint16_t ceiling;
+} raycaster_cell_t;
+
+typedef enum {
+    RAYCASTER_MAP_LAYER_WALLS,
+    RAYCASTER_MAP_LAYER_FLOORS,
+    RAYCASTER_MAP_LAYER_CEILINGS
+} raycaster_map_layer_t;
 
 typedef struct {
     int width;
     int height;
 
-    int* walls;
-    int* floors;
-    int* ceilings;
+    raycaster_cell_t* cells;
+
+    /**
+     * Optional acceleration structure. Chebyshev distance from each cell to
+     * the nearest wall, capped at RAYCASTER_MAP_DISTANCE_MAX. Rays use it to
+     * step over empty space without testing each cell. NULL if disabled.
+     */
+    uint8_t* wall_distances;
 } raycaster_map_t;
 
+#define RAYCASTER_MAP_DISTANCE_MAX 32
+
 /**
  * Creates a new map.
  *
@@ -30,9 +55,106 @@ raycaster_map_t* raycaster_map_new(int width, int height);
  */
 void raycaster_map_free(raycaster_map_t* map);
 
+/**
+ * Enables or disables empty space skipping for a map. Enabling builds the
+ * acceleration structure from the map's walls.
+ *
+ * @param map Map to modify.
+ * @param enabled True to build acceleration structure, false to free it.
+ */
+void raycaster_map_acceleration_set(raycaster_map_t* map, bool enabled);
+
+/**
+ * Rebuilds acceleration structure for given region of walls. Must be called
+ * after modifying walls directly. Does nothing if acceleration is disabled.
+ *
+ * @param map Map to update.
+ * @param x Region top left x-coordinate
+ * @param y Region top left y-coordinate
+ * @param width Region width
+ * @param height Region height
+ */
+void raycaster_map_acceleration_update(raycaster_map_t* map, int x, int y, int width, int height);
+
+/**
+ * Get layer data at given cell.
+ *
+ * @param map Map to access.
+ * @param x Cell x-coordinate
+ * @param y Cell y-coordinate
+ * @param layer Layer to read.
+ * @return int Layer data. 0 if cell is outside of map.
+ */
+int raycaster_map_get(raycaster_map_t* map, int x, int y, raycaster_map_layer_t layer);
+
+/**
+ * Set layer data at given cell. Setting walls incrementally updates the
+ * acceleration structure if enabled.
+ *
+ * @param map Map to modify.
+ * @param x Cell x-coordinate
+ * @param y Cell y-coordinate
+ * @param layer Layer to write.
+ * @param value Layer data
+ */
+void raycaster_map_set(raycaster_map_t* map, int x, int y, raycaster_map_layer_t layer, int value);
+
+/**
+ * Copy width * height values into given layer. Setting walls rebuilds the
+ * acceleration structure if enabled.
+ *
+ * @param map Map to modify.
+ * @param layer Layer to write.
+ * @param data Source data.
+ */
+void raycaster_map_layer_load(raycaster_map_t* map, raycaster_map_layer_t layer, const int* data);
+
+/**
+ * Copy width * height color values into given layer. Used to load layers
+ * directly from texture pixels.
+ *
+ * @param map Map to modify.
+ * @param layer Layer to write.
+ * @param colors Source colors.
+ */
+void raycaster_map_layer_load_colors(raycaster_map_t* map, raycaster_map_layer_t layer, const color_t* colors);
+
+/**
+ * Copy width * height values out of given layer.
+ *
+ * @param map Map to read.
+ * @param layer Layer to read.
+ * @param data Destination data.
+ */
+void raycaster_map_layer_store(raycaster_map_t* map, raycaster_map_layer_t layer, int* data);
+
+/**
+ * Result of a ray cast against a map.
+ */
+typedef struct {
+    float distance;
+    int cell[2];
+    bool was_vertical;
+    float offset;
+    int data;
+} raycaster_hit_t;
+
+/**
+ * Casts a ray against map walls using the same traversal as the renderer.
+ *
+ * @param map Map to cast against.
+ * @param origin Ray origin.
+ * @param direction Ray direction. Does not need to be normalized.
+ * @param max_distance Distance after which the ray stops.
+ * @param hit Hit info. Distance is infinity and cell is -1, -1 if nothing was hit.
+ * @return true If a wall was hit within max distance.
+ */
+bool raycaster_map_cast(raycaster_map_t* map, mfloat_t* origin, mfloat_t* direction, float max_distance, raycaster_hit_t* hit);
+
 typedef struct {
     texture_t* render_texture;
     float* depth_buffer;
+    shading_lut_t* shading;
 
     struct {
         texture_t* shade_table;
@@ -0,0 +1,552 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mathc/mathc.h>
+
+#include "../graphics.h"
+#include "../log.h"
+#include "../math.h"
+#include "shading.h"
+
+#include "sector.h"
+
+/** Walls closer than this are clipped. */
+#define NEAR_DISTANCE 0.01f
+
+/** Maximum number of portal windows waiting to be rendered. */
+#define PORTAL_QUEUE_SIZE 1024
+
+/** Maximum number of times a sector can be entered per frame. */
+#define SECTOR_VISIT_MAX 32
+
+/** Number of entries in texture palette. */
+#define PALETTE_SIZE 256
+
+/** Number of fractional bits used by fixed-point texture coordinates. */
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+
+/** Screen columns of a sector visible through a portal. */
+typedef struct {
+    int sector;
+    int left;
+    int right;
+} portal_window_t;
+
+/** State shared by everything drawn in a frame. */
+typedef struct {
+    sector_renderer_t* renderer;
+    texture_t** palette;
+    mfloat_t forward[VEC2_SIZE];
+    mfloat_t right[VEC2_SIZE];
+    float distance_to_projection_plane;
+    float half_width;
+    float horizon;
+    float eye_height;
+    float pixels_per_unit;
+} render_context_t;
+
+static portal_window_t portal_queue[PORTAL_QUEUE_SIZE];
+
+sector_map_t* sector_map_new(void) {
+    sector_map_t* map = (sector_map_t*)malloc(sizeof(sector_map_t));
+
+    if (!map) {
+        log_error("Failed to create sector map");
+        return NULL;
+    }
+
+    map->sectors = NULL;
+    map->sector_count = 0;
+    map->sector_capacity = 0;
+
+    return map;
+}
+
+void sector_map_free(sector_map_t* map) {
+    for (int i = 0; i < map->sector_count; i++) {
+        free(map->sectors[i].walls);
+        map->sectors[i].walls = NULL;
+    }
+
+    free(map->sectors);
+    map->sectors = NULL;
+
+    free(map);
+    map = NULL;
+}
+
+int sector_map_sector_add(sector_map_t* map, float floor_height, float ceiling_height, int floor_texture, int ceiling_texture, float brightness) {
+    if (map->sector_count == map->sector_capacity) {
+        int capacity = map->sector_capacity ? map->sector_capacity * 2 : 16;
+        sector_t* sectors = (sector_t*)realloc(map->sectors, capacity * sizeof(sector_t));
+
+        if (!sectors) {
+            log_error("Failed to add sector");
+            return -1;
+        }
+
+        map->sectors = sectors;
+        map->sector_capacity = capacity;
+    }
+
+    sector_t* sector = &map->sectors[map->sector_count];
+    sector->floor_height = floor_height;
+    sector->ceiling_height = ceiling_height;
+    sector->floor_texture = floor_texture;
+    sector->ceiling_texture = ceiling_texture;
+    sector->brightness = brightness;
+    sector->walls = NULL;
+    sector->wall_count = 0;
+    sector->wall_capacity = 0;
+
+    return map->sector_count++;
+}
+
+bool sector_map_wall_add(sector_map_t* map, int sector_index, mfloat_t* start, mfloat_t* end, int texture, int portal) {
+    if (sector_index < 0 || sector_index >= map->sector_count) return false;
+
+    sector_t* sector = &map->sectors[sector_index];
+
+    if (sector->wall_count == sector->wall_capacity) {
+        int capacity = sector->wall_capacity ? sector->wall_capacity * 2 : 4;
+        sector_wall_t* walls = (sector_wall_t*)realloc(sector->walls, capacity * sizeof(sector_wall_t));
+
+        if (!walls) {
+            log_error("Failed to add sector wall");
+            return false;
+        }
+
+        sector->walls = walls;
+        sector->wall_capacity = capacity;
+    }
+
+    sector_wall_t* wall = &sector->walls[sector->wall_count++];
+    vec2_assign(wall->start, start);
+    vec2_assign(wall->end, end);
+    wall->texture = texture;
+    wall->portal = portal;
+
+    return true;
+}
+
+/**
+ * Determine if given point is inside of sector.
+ *
+ * @param sector Sector to check against
+ * @param point Point to check
+ * @return true If point is inside sector.
+ */
+static bool sector_contains(sector_t* sector, mfloat_t* point) {
+    bool inside = false;
+
+    for (int i = 0; i < sector->wall_count; i++) {
+        mfloat_t* a = sector->walls[i].start;
+        mfloat_t* b = sector->walls[i].end;
+
+        // Count edge crossings of a ray pointing along the x-axis
+        if ((a[1] > point[1]) != (b[1] > point[1])) {
+            float x = a[0] + (point[1] - a[1]) / (b[1] - a[1]) * (b[0] - a[0]);
+            if (point[0] < x) inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+int sector_map_sector_find(sector_map_t* map, mfloat_t* point, int hint) {
+    // Camera usually stays in the same sector or moves into a neighbor
+    if (hint >= 0 && hint < map->sector_count) {
+        sector_t* sector = &map->sectors[hint];
+
+        if (sector_contains(sector, point)) return hint;
+
+        for (int i = 0; i < sector->wall_count; i++) {
+            int portal = sector->walls[i].portal;
+
+            if (portal >= 0 && portal < map->sector_count && sector_contains(&map->sectors[portal], point)) {
+                return portal;
+            }
+        }
+    }
+
+    for (int i = 0; i < map->sector_count; i++) {
+        if (sector_contains(&map->sectors[i], point)) return i;
+    }
+
+    return -1;
+}
+
+sector_renderer_t* sector_renderer_new(texture_t* render_texture) {
+    sector_renderer_t* renderer = (sector_renderer_t*)malloc(sizeof(sector_renderer_t));
+
+    if (!renderer) {
+        log_error("Failed to create sector renderer");
+        return NULL;
+    }
+
+    if (!render_texture) {
+        render_texture = graphics_render_texture_get();
+    }
+
+    int width, height;
+    graphics_texture_resolution_get(render_texture, &width, &height);
+
+    renderer->render_texture = render_texture;
+    renderer->shading = shading_lut_new();
+    renderer->clip_top = (int*)malloc(width * sizeof(int));
+    renderer->clip_bottom = (int*)malloc(width * sizeof(int));
+    renderer->visits = NULL;
+    renderer->visits_size = 0;
+    renderer->sector = -1;
+    renderer->features.shade_table = NULL;
+    renderer->features.fog_distance = 32.0f;
+    renderer->features.horizon = height / 2.0f;
+    renderer->features.pixels_per_unit = 64.0f;
+
+    vec3(renderer->camera.position, 0, 0, 0.5f);
+    vec2(renderer->camera.direction, 0, 1);
+    renderer->camera.fov = 90.0f;
+
+    return renderer;
+}
+
+void sector_renderer_free(sector_renderer_t* renderer) {
+    free(renderer->clip_top);
+    renderer->clip_top = NULL;
+    free(renderer->clip_bottom);
+    renderer->clip_bottom = NULL;
+    free(renderer->visits);
+    renderer->visits = NULL;
+
+    shading_lut_free(renderer->shading);
+    renderer->shading = NULL;
+
+    free(renderer);
+    renderer = NULL;
+}
+
+void sector_renderer_clear_color(sector_renderer_t* renderer, color_t color) {
+    graphics_texture_clear(renderer->render_texture, color);
+}
+
+void sector_renderer_camera(sector_renderer_t* renderer, mfloat_t* position, mfloat_t* direction, float fov) {
+    vec3_assign(renderer->camera.position, position);
+    vec2_assign(renderer->camera.direction, direction);
+    renderer->camera.fov = fov;
+}
+
+static texture_t* palette_get(texture_t** palette, int index) {
+    if (index < 0 || index >= PALETTE_SIZE) return NULL;
+
+    return palette[index];
+}
+
+static int wrap(int value, int size) {
+    value %= size;
+    if (value < 0) value += size;
+
+    return value;
+}
+
+/**
+ * Get shade row for given sector brightness and distance.
+ */
+static const color_t* get_shade_row(render_context_t* context, float brightness, float distance) {
+    sector_renderer_t* renderer = context->renderer;
+
+    return shading_lut_row_get(renderer->shading, brightness * (1.0f - distance / renderer->features.fog_distance));
+}
+
+/**
+ * Draw part of a floor or ceiling in a single column.
+ *
+ * @param context Render context
+ * @param sector Sector the plane belongs to
+ * @param x Column
+ * @param y0 First row
+ * @param y1 One past last row
+ * @param plane_height Height of plane
+ * @param texture Plane texture
+ */
+static void draw_plane_span(render_context_t* context, sector_t* sector, int x, int y0, int y1, float plane_height, texture_t* texture) {
+    if (!texture || y0 >= y1) return;
+
+    sector_renderer_t* renderer = context->renderer;
+    texture_t* render_texture = renderer->render_texture;
+
+    const float relative_height = plane_height - context->eye_height;
+    const float offset = (x + 0.5f - context->half_width) / context->distance_to_projection_plane;
+    const float ray_x = context->forward[0] + context->right[0] * offset;
+    const float ray_y = context->forward[1] + context->right[1] * offset;
+
+    for (int y = y0; y < y1; y++) {
+        float dy = context->horizon - (y + 0.5f);
+        if (dy == 0.0f) continue;
+
+        float distance = relative_height * context->distance_to_projection_plane / dy;
+        if (distance <= 0.0f) continue;
+
+        float world_x = renderer->camera.position[0] + ray_x * distance;
+        float world_y = renderer->camera.position[1] + ray_y * distance;
+
+        int tx = wrap(floorf(world_x * context->pixels_per_unit), texture->width);
+        int ty = wrap(floorf(world_y * context->pixels_per_unit), texture->height);
+
+        const color_t* shade = get_shade_row(context, sector->brightness, distance);
+
+        render_texture->pixels[y * render_texture->width + x] = shade[texture->pixels[ty * texture->width + tx]];
+    }
+}
+
+/**
+ * Draw part of a wall in a single column.
+ *
+ * @param context Render context
+ * @param x Column
+ * @param y0 First row
+ * @param y1 One past last row
+ * @param texture Wall texture
+ * @param u Wall texture x-coordinate in texels
+ * @param scale Screen pixels per world unit at this column's depth
+ * @param anchor_height World height texture is aligned to
+ * @param shade Shade row for this column
+ */
+static void draw_wall_span(render_context_t* context, int x, int y0, int y1, texture_t* texture, float u, float scale, float anchor_height, const color_t* shade) {
+    if (!texture || y0 >= y1) return;
+
+    texture_t* render_texture = context->renderer->render_texture;
+
+    const int tx = wrap(floorf(u), texture->width);
+
+    // World height at center of first pixel
+    float height = context->eye_height + (context->horizon - (y0 + 0.5f)) / scale;
+
+    int64_t v = (int64_t)floorf((anchor_height - height) * context->pixels_per_unit * FIXED_ONE);
+    const int64_t step = (int64_t)(context->pixels_per_unit / scale * FIXED_ONE);
+
+    color_t* pixel = &render_texture->pixels[y0 * render_texture->width + x];
+
+    for (int y = y0; y < y1; y++, v += step, pixel += render_texture->width) {
+        int ty = wrap((int)(v >> FIXED_SHIFT), texture->height);
+        *pixel = shade[texture->pixels[ty * texture->width + tx]];
+    }
+}
+
+/**
+ * Transform world point to camera space.
+ *
+ * @param context Render context
+ * @param result Lateral offset in x-component, depth in y-component
+ * @param point World point
+ */
+static void to_camera_space(render_context_t* context, mfloat_t* result, mfloat_t* point) {
+    mfloat_t relative[VEC2_SIZE];
+    vec2_subtract(relative, point, context->renderer->camera.position);
+
+    result[0] = vec2_dot(relative, context->right);
+    result[1] = vec2_dot(relative, context->forward);
+}
+
+/**
+ * Render sector walls, floor and ceiling visible through given window.
+ * Portals narrow the clip windows of their columns and queue the sector
+ * behind them.
+ *
+ * @param context Render context
+ * @param map Map being rendered
+ * @param window Window to render
+ * @param queue_tail Index to queue next window at
+ * @param queue_count Number of queued windows
+ */
+static void render_sector(render_context_t* context, sector_map_t* map, portal_window_t* window, int* queue_tail, int* queue_count) {
+    sector_renderer_t* renderer = context->renderer;
+    sector_t* sector = &map->sectors[window->sector];
+
+    const float dpp = context->distance_to_projection_plane;
+    const float eye_height = context->eye_height;
+    const float horizon = context->horizon;
+
+    texture_t* floor_texture = palette_get(context->palette, sector->floor_texture);
+    texture_t* ceiling_texture = palette_get(context->palette, sector->ceiling_texture);
+
+    for (int w = 0; w < sector->wall_count; w++) {
+        sector_wall_t* wall = &sector->walls[w];
+
+        mfloat_t a[VEC2_SIZE];
+        mfloat_t b[VEC2_SIZE];
+        to_camera_space(context, a, wall->start);
+        to_camera_space(context, b, wall->end);
+
+        // Clip against near plane to find screen extents
+        if (a[1] < NEAR_DISTANCE && b[1] < NEAR_DISTANCE) continue;
+
+        mfloat_t clipped_a[VEC2_SIZE];
+        mfloat_t clipped_b[VEC2_SIZE];
+        vec2_assign(clipped_a, a);
+        vec2_assign(clipped_b, b);
+
+        if (a[1] < NEAR_DISTANCE) {
+            float t = (NEAR_DISTANCE - a[1]) / (b[1] - a[1]);
+            vec2_lerp(clipped_a, a, b, t);
+        }
+        else if (b[1] < NEAR_DISTANCE) {
+            float t = (NEAR_DISTANCE - b[1]) / (a[1] - b[1]);
+            vec2_lerp(clipped_b, b, a, t);
+        }
+
+        float screen_left = context->half_width + clipped_a[0] * dpp / clipped_a[1];
+        float screen_right = context->half_width + clipped_b[0] * dpp / clipped_b[1];
+
+        // Back facing
+        if (screen_left >= screen_right) continue;
+
+        int left = fmaxf(window->left, ceilf(screen_left - 0.5f));
+        int right = fminf(window->right, ceilf(screen_right - 0.5f));
+
+        if (left >= right) continue;
+
+        sector_t* neighbor = NULL;
+        if (wall->portal >= 0 && wall->portal < map->sector_count) {
+            neighbor = &map->sectors[wall->portal];
+        }
+
+        texture_t* wall_texture = palette_get(context->palette, wall->texture);
+        float wall_length = vec2_distance(wall->start, wall->end);
+
+        int portal_left = right;
+        int portal_right = left;
+
+        for (int x = left; x < right; x++) {
+            int top = renderer->clip_top[x];
+            int bottom = renderer->clip_bottom[x];
+
+            if (top >= bottom) continue;
+
+            // Intersect column ray with unclipped wall so textures stay fixed
+            float offset = (x + 0.5f - context->half_width) / dpp;
+            float denominator = (b[0] - a[0]) - offset * (b[1] - a[1]);
+            if (denominator == 0.0f) continue;
+
+            float t = clamp((offset * a[1] - a[0]) / denominator, 0.0f, 1.0f);
+            float depth = fmaxf(a[1] + t * (b[1] - a[1]), NEAR_DISTANCE);
+            float scale = dpp / depth;
+
+            int ceiling_y = clampi(ceilf(horizon - (sector->ceiling_height - eye_height) * scale - 0.5f), top, bottom);
+            int floor_y = clampi(ceilf(horizon - (sector->floor_height - eye_height) * scale - 0.5f), ceiling_y, bottom);
+
+            draw_plane_span(context, sector, x, top, ceiling_y, sector->ceiling_height, ceiling_texture);
+            draw_plane_span(context, sector, x, floor_y, bottom, sector->floor_height, floor_texture);
+
+            float u = t * wall_length * context->pixels_per_unit;
+            const color_t* shade = get_shade_row(context, sector->brightness, depth);
+
+            if (neighbor) {
+                int neighbor_ceiling_y = clampi(ceilf(horizon - (neighbor->ceiling_height - eye_height) * scale - 0.5f), ceiling_y, floor_y);
+                int neighbor_floor_y = clampi(ceilf(horizon - (neighbor->floor_height - eye_height) * scale - 0.5f), neighbor_ceiling_y, floor_y);
+
+                // Upper and lower walls
+                draw_wall_span(context, x, ceiling_y, neighbor_ceiling_y, wall_texture, u, scale, sector->ceiling_height, shade);
+                draw_wall_span(context, x, neighbor_floor_y, floor_y, wall_texture, u, scale, neighbor->floor_height, shade);
+
+                // Remaining opening is visible through the portal
+                renderer->clip_top[x] = neighbor_ceiling_y;
+                renderer->clip_bottom[x] = neighbor_floor_y;
+
+                if (neighbor_ceiling_y < neighbor_floor_y) {
+                    if (x < portal_left) portal_left = x;
+                    if (x + 1 > portal_right) portal_right = x + 1;
+                }
+            }
+            else {
+                draw_wall_span(context, x, ceiling_y, floor_y, wall_texture, u, scale, sector->ceiling_height, shade);
+
+                // Column is fully covered
+                renderer->clip_top[x] = bottom;
+            }
+        }
+
+        if (neighbor && portal_left < portal_right && *queue_count < PORTAL_QUEUE_SIZE) {
+            portal_window_t* next = &portal_queue[*queue_tail];
+            next->sector = wall->portal;
+            next->left = portal_left;
+            next->right = portal_right;
+
+            *queue_tail = (*queue_tail + 1) % PORTAL_QUEUE_SIZE;
+            (*queue_count)++;
+        }
+    }
+}
+
+void sector_renderer_render_map(sector_renderer_t* renderer, sector_map_t* map, texture_t** palette) {
+    if (!renderer->render_texture) return;
+
+    texture_t* render_texture = renderer->render_texture;
+    const int width = render_texture->width;
+    const int height = render_texture->height;
+
+    renderer->sector = sector_map_sector_find(map, renderer->camera.position, renderer->sector);
+    if (renderer->sector < 0) return;
+
+    if (renderer->visits_size < map->sector_count) {
+        uint8_t* visits = (uint8_t*)realloc(renderer->visits, map->sector_count * sizeof(uint8_t));
+
+        if (!visits) {
+            log_error("Failed to resize sector visits");
+            return;
+        }
+
+        renderer->visits = visits;
+        renderer->visits_size = map->sector_count;
+    }
+
+    memset(renderer->visits, 0, map->sector_count * sizeof(uint8_t));
+
+    for (int x = 0; x < width; x++) {
+        renderer->clip_top[x] = 0;
+        renderer->clip_bottom[x] = height;
+    }
+
+    if (renderer->shading->source != renderer->features.shade_table) {
+        shading_lut_update(renderer->shading, renderer->features.shade_table);
+    }
+
+    render_context_t context;
+    context.renderer = renderer;
+    context.palette = palette;
+
+    // Matches raycaster renderer's screen orientation
+    vec2_normalize(context.forward, renderer->camera.direction);
+    vec2_tangent(context.right, context.forward);
+    vec2_negative(context.right, context.right);
+
+    context.half_width = width / 2.0f;
+    context.distance_to_projection_plane = context.half_width / tanf(to_radians(renderer->camera.fov) / 2.0f);
+    context.horizon = renderer->features.horizon * graphics_scene_scale_get(renderer->render_texture);
+    context.eye_height = renderer->camera.position[2];
+    context.pixels_per_unit = renderer->features.pixels_per_unit;
+
+    // Breadth first traversal of visible portals
+    int queue_head = 0;
+    int queue_tail = 0;
+    int queue_count = 0;
+
+    portal_queue[queue_tail].sector = renderer->sector;
+    portal_queue[queue_tail].left = 0;
+    portal_queue[queue_tail].right = width;
+    queue_tail = (queue_tail + 1) % PORTAL_QUEUE_SIZE;
+    queue_count++;
+
+    while (queue_count > 0) {
+        portal_window_t window = portal_queue[queue_head];
+        queue_head = (queue_head + 1) % PORTAL_QUEUE_SIZE;
+        queue_count--;
+
+        if (renderer->visits[window.sector] >= SECTOR_VISIT_MAX) continue;
+        renderer->visits[window.sector]++;
+
+        render_sector(&context, map, &window, &queue_tail, &queue_count);
+    }
+}
@@ -0,0 +1,167 @@
+#ifndef RENDERERS_SECTOR_H
+#define RENDERERS_SECTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <mathc/mathc.h>
+
+#include "../graphics.h"
+#include "shading.h"
+
+/**
+ * A wall edge of a sector. Walls wind clockwise around their sector when the
+ * map is viewed with the y-axis pointing down.
+ */
+typedef struct {
+    mfloat_t start[VEC2_SIZE];
+    mfloat_t end[VEC2_SIZE];
+    int texture;
+
+    /** Sector on the other side of this wall. -1 for solid walls. */
+    int portal;
+} sector_wall_t;
+
+/**
+ * A convex region of the map with its own floor and ceiling heights.
+ */
+typedef struct {
+    float floor_height;
+    float ceiling_height;
+    int floor_texture;
+    int ceiling_texture;
+    float brightness;
+
+    sector_wall_t* walls;
+    int wall_count;
+    int wall_capacity;
+} sector_t;
+
+typedef struct {
+    sector_t* sectors;
+    int sector_count;
+    int sector_capacity;
+} sector_map_t;
+
+/**
+ * Creates a new empty map.
+ *
+ * @return sector_map_t* Newly created map.
+ */
+sector_map_t* sector_map_new(void);
+
+/**
+ * Frees a map.
+ *
+ * @param map Map to free.
+ */
+void sector_map_free(sector_map_t* map);
+
+/**
+ * Adds a sector with no walls.
+ *
+ * @param map Map to modify.
+ * @param floor_height Floor height
+ * @param ceiling_height Ceiling height
+ * @param floor_texture Floor texture palette index
+ * @param ceiling_texture Ceiling texture palette index
+ * @param brightness Sector light level. 1.0 = full bright 0.0 = full dark
+ * @return int Index of new sector. -1 on failure.
+ */
+int sector_map_sector_add(sector_map_t* map, float floor_height, float ceiling_height, int floor_texture, int ceiling_texture, float brightness);
+
+/**
+ * Adds a wall to a sector.
+ *
+ * @param map Map to modify.
+ * @param sector Sector index
+ * @param start Wall start point
+ * @param end Wall end point
+ * @param texture Wall texture palette index. Used for upper and lower parts of portals.
+ * @param portal Index of sector on the other side. -1 for a solid wall.
+ * @return bool True if wall was added.
+ */
+bool sector_map_wall_add(sector_map_t* map, int sector, mfloat_t* start, mfloat_t* end, int texture, int portal);
+
+/**
+ * Find sector containing given point.
+ *
+ * @param map Map to search.
+ * @param point Point to find.
+ * @param hint Sector to check first, along with its neighbors. -1 for none.
+ * @return int Index of containing sector. -1 if point is outside all sectors.
+ */
+int sector_map_sector_find(sector_map_t* map, mfloat_t* point, int hint);
+
+typedef struct {
+    texture_t* render_texture;
+    shading_lut_t* shading;
+
+    /** Per-column clip windows. Rows in [top, bottom) are still drawable. */
+    int* clip_top;
+    int* clip_bottom;
+
+    /** Number of times each sector was entered this frame. */
+    uint8_t* visits;
+    int visits_size;
+
+    /** Sector camera was last found in. */
+    int sector;
+
+    struct {
+        texture_t* shade_table;
+        float fog_distance;
+        float horizon;
+        float pixels_per_unit;
+    } features;
+
+    struct {
+        mfloat_t position[VEC3_SIZE];
+        mfloat_t direction[VEC2_SIZE];
+        float fov;
+    } camera;
+} sector_renderer_t;
+
+/**
+ * Creates a new renderer.
+ *
+ * @param render_texture Texture to render to. NULL to use the render texture.
+ * @return sector_renderer_t* Newly created renderer.
+ */
+sector_renderer_t* sector_renderer_new(texture_t* render_texture);
+
+/**
+ * Frees a renderer.
+ *
+ * @param renderer Renderer to free.
+ */
+void sector_renderer_free(sector_renderer_t* renderer);
+
+/**
+ * Clears color buffer for given color.
+ *
+ * @param renderer Renderer to clear color buffer.
+ * @param color Clear color.
+ */
+void sector_renderer_clear_color(sector_renderer_t* renderer, color_t color);
+
+/**
+ * Set camera data.
+ *
+ * @param renderer Renderer to set camera data for.
+ * @param position Camera position. The z-component is eye height.
+ * @param direction Camera direction.
+ * @param fov Camera fov.
+ */
+void sector_renderer_camera(sector_renderer_t* renderer, mfloat_t* position, mfloat_t* direction, float fov);
+
+/**
+ * Render given map. Rendering starts in the sector containing the camera and
+ * only continues into sectors visible through portals.
+ *
+ * @param renderer Renderer to render to.
+ * @param map Map to render.
+ * @param palette Texture array look up table.
+ */
+void sector_renderer_render_map(sector_renderer_t* renderer, sector_map_t* map, texture_t** palette);
+
+#endif
@@ -0,0 +1,181 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../graphics.h"
+#include "../log.h"
+#include "../math.h"
+
+#include "shading.h"
+
+/** Row used when there is no shade table. Maps every color to itself. */
+static color_t identity_row[256];
+static bool identity_row_initialized = false;
+
+shading_lut_t* shading_lut_new(void) {
+    shading_lut_t* lut = (shading_lut_t*)malloc(sizeof(shading_lut_t));
+
+    if (!lut) {
+        log_error("Failed to create shade lookup");
+        return NULL;
+    }
+
+    lut->source = NULL;
+    lut->level_count = 0;
+    lut->rows = NULL;
+    lut->source_width = 0;
+    lut->source_height = 0;
+    lut->source_pixels = NULL;
+
+    if (!identity_row_initialized) {
+        for (int i = 0; i < 256; i++) {
+            identity_row[i] = i;
+        }
+
+        identity_row_initialized = true;
+    }
+
+    return lut;
+}
+
+void shading_lut_free(shading_lut_t* lut) {
+    free(lut->rows);
+    lut->rows = NULL;
+
+    free(lut->source_pixels);
+    lut->source_pixels = NULL;
+
+    free(lut);
+    lut = NULL;
+}
+
+/**
+ * Keep a copy of the shade table so in place changes to it can be detected.
+ */
+static void source_copy(shading_lut_t* lut, texture_t* shade_table) {
+    size_t size = (size_t)shade_table->width * shade_table->height;
+
+    if (shade_table->width != lut->source_width || shade_table->height != lut->source_height) {
+        color_t* pixels = (color_t*)realloc(lut->source_pixels, size);
+
+        if (!pixels && size > 0) {
+            log_error("Failed to resize shade lookup");
+            lut->source = NULL;
+            return;
+        }
+
+        lut->source_pixels = pixels;
+        lut->source_width = shade_table->width;
+        lut->source_height = shade_table->height;
+    }
+
+    memcpy(lut->source_pixels, shade_table->pixels, size);
+}
+
+void shading_lut_update(shading_lut_t* lut, texture_t* shade_table) {
+    lut->source = shade_table;
+
+    if (!shade_table || shade_table->width <= 0) {
+        lut->level_count = 0;
+        return;
+    }
+
+    source_copy(lut, shade_table);
+
+    const int level_count = shade_table->width;
+
+    if (level_count != lut->level_count) {
+        color_t* rows = (color_t*)realloc(lut->rows, level_count * 256 * sizeof(color_t));
+
+        if (!rows) {
+            log_error("Failed to resize shade lookup");
+            lut->level_count = 0;
+            return;
+        }
+
+        lut->rows = rows;
+        lut->level_count = level_count;
+    }
+
+    // Transpose shade table so each brightness level is contiguous. Colors
+    // outside of the shade table are left unshaded.
+    for (int level = 0; level < level_count; level++) {
+        color_t* row = &lut->rows[level * 256];
+
+        for (int color = 0; color < 256; color++) {
+            if (color < shade_table->height) {
+                row[color] = shade_table->pixels[color * level_count + level];
+            }
+            else {
+                row[color] = color;
+            }
+        }
+    }
+}
+
+bool shading_lut_is_current(shading_lut_t* lut, texture_t* shade_table) {
+    if (lut->source != shade_table) return false;
+    if (!shade_table || shade_table->width <= 0) return true;
+
+    if (shade_table->width != lut->source_width || shade_table->height != lut->source_height) return false;
+
+    return memcmp(lut->source_pixels, shade_table->pixels, (size_t)shade_table->width * shade_table->height) == 0;
+}
+
+const color_t* shading_lut_row_get(shading_lut_t* lut, float brightness) {
+    if (lut->level_count == 0) return identity_row;
+
+    brightness = clamp(brightness, 0.0f, 1.0f);
+    brightness = 1.0f - brightness;
+
+    const int level = brightness * (lut->level_count - 1);
+
+    return &lut->rows[level * 256];
+}
+
+texture_t* shading_table_bake(uint32_t* palette, int levels, uint32_t fog_color) {
+    if (levels < 1) return NULL;
+
+    texture_t* shade_table = graphics_texture_new(levels, 256, NULL);
+    if (!shade_table) return NULL;
+
+    const int fog_r = fog_color & 0xFF;
+    const int fog_g = (fog_color >> 8) & 0xFF;
+    const int fog_b = (fog_color >> 16) & 0xFF;
+
+    for (int color = 0; color < 256; color++) {
+        const int r = palette[color] & 0xFF;
+        const int g = (palette[color] >> 8) & 0xFF;
+        const int b = (palette[color] >> 16) & 0xFF;
+
+        for (int level = 0; level < levels; level++) {
+            float t = levels > 1 ? level / (float)(levels - 1) : 0.0f;
+
+            int target_r = lerp(r, fog_r, t);
+            int target_g = lerp(g, fog_g, t);
+            int target_b = lerp(b, fog_b, t);
+
+            // Find nearest palette color, preferring the original color
+            int best_color = color;
+            int best_distance = INT32_MAX;
+
+            for (int i = -1; i < 256 && best_distance > 0; i++) {
+                int candidate = i < 0 ? color : i;
+                int dr = (int)(palette[candidate] & 0xFF) - target_r;
+                int dg = (int)((palette[candidate] >> 8) & 0xFF) - target_g;
+                int db = (int)((palette[candidate] >> 16) & 0xFF) - target_b;
+                int distance = dr * dr + dg * dg + db * db;
+
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best_color = candidate;
+                }
+            }
+
+            shade_table->pixels[color * levels + level] = best_color;
+        }
+    }
+
+    return shade_table;
+}
@@ -0,0 +1,79 @@
+#ifndef RENDERERS_SHADING_H
+#define RENDERERS_SHADING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../graphics.h"
+
+/**
+ * Shade table lookup rows. Each row maps all 256 colors to their shaded
+ * color for a single brightness level, so shading a pixel is a single
+ * byte lookup.
+ */
+typedef struct {
+    texture_t* source;
+    int level_count;
+    color_t* rows;
+
+    /** Copy of the shade table the rows were built from. */
+    int source_width;
+    int source_height;
+    color_t* source_pixels;
+} shading_lut_t;
+
+/**
+ * Creates a new shade lookup.
+ *
+ * @return shading_lut_t* Newly created shade lookup.
+ */
+shading_lut_t* shading_lut_new(void);
+
+/**
+ * Frees a shade lookup.
+ *
+ * @param lut Shade lookup to free.
+ */
+void shading_lut_free(shading_lut_t* lut);
+
+/**
+ * Rebuilds lookup rows from given shade table. The x-coordinate of the shade
+ * table corresponds to darkness and the y-coordinate to original color.
+ *
+ * @param lut Shade lookup to rebuild.
+ * @param shade_table Shade table to build from. NULL for full bright.
+ */
+void shading_lut_update(shading_lut_t* lut, texture_t* shade_table);
+
+/**
+ * Check if lookup rows are still built from given shade table. Detects both a
+ * different shade table and changes made to the same one.
+ *
+ * @param lut Shade lookup.
+ * @param shade_table Shade table to check against. NULL for full bright.
+ * @return true if lookup is current, false if it needs an update.
+ */
+bool shading_lut_is_current(shading_lut_t* lut, texture_t* shade_table);
+
+/**
+ * Get lookup row for given brightness.
+ *
+ * @param lut Shade lookup
+ * @param brightness Amount to shade. 1.0 = full bright 0.0 = full dark
+ * @return const color_t* Row of 256 shaded colors.
+ */
+const color_t* shading_lut_row_get(shading_lut_t* lut, float brightness);
+
+/**
+ * Bakes a shade table from given palette. Each column fades all 256 colors
+ * towards the fog color, and each faded color is matched to the nearest
+ * palette color.
+ *
+ * @param palette 256 color palette.
+ * @param levels Number of brightness levels.
+ * @param fog_color Color to fade towards.
+ * @return texture_t* Shade table texture of size levels x 256.
+ */
+texture_t* shading_table_bake(uint32_t* palette, int levels, uint32_t fog_color);
+
+#endif
@@ -0,0 +1,194 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <mathc/mathc.h>
+
+#include "../graphics.h"
+#include "../jobs.h"
+#include "../log.h"
+#include "../math.h"
+#include "shading.h"
+
+#include "voxel.h"
+
+/** Distance of the first sample from the camera. */
+#define NEAR_DISTANCE 1.0f
+
+/** Data shared by all column render jobs. */
+typedef struct {
+    voxel_renderer_t* renderer;
+    texture_t* height_map;
+    texture_t* color_map;
+    mfloat_t forward[VEC2_SIZE];
+    mfloat_t right[VEC2_SIZE];
+    float distance_to_projection_plane;
+} render_job_t;
+
+voxel_renderer_t* voxel_renderer_new(texture_t* render_texture) {
+    voxel_renderer_t* renderer = (voxel_renderer_t*)malloc(sizeof(voxel_renderer_t));
+
+    if (!renderer) {
+        log_error("Failed to create voxel renderer");
+        return NULL;
+    }
+
+    if (!render_texture) {
+        render_texture = graphics_render_texture_get();
+    }
+
+    int width, height;
+    graphics_texture_resolution_get(render_texture, &width, &height);
+
+    renderer->render_texture = render_texture;
+    renderer->y_buffer = (int*)malloc(width * sizeof(int));
+    renderer->shading = shading_lut_new();
+    renderer->features.shade_table = NULL;
+    renderer->features.fog_distance = 512.0f;
+    renderer->features.draw_distance = 512.0f;
+    renderer->features.height_scale = 1.0f;
+    renderer->features.horizon = height / 2.0f;
+    renderer->features.lod = 0.01f;
+
+    vec3(renderer->camera.position, 0, 0, 128);
+    vec2(renderer->camera.direction, 0, 1);
+    renderer->camera.fov = 90.0f;
+
+    return renderer;
+}
+
+void voxel_renderer_free(voxel_renderer_t* renderer) {
+    free(renderer->y_buffer);
+    renderer->y_buffer = NULL;
+
+    shading_lut_free(renderer->shading);
+    renderer->shading = NULL;
+
+    free(renderer);
+    renderer = NULL;
+}
+
+void voxel_renderer_clear_color(voxel_renderer_t* renderer, color_t color) {
+    graphics_texture_clear(renderer->render_texture, color);
+}
+
+void voxel_renderer_camera(voxel_renderer_t* renderer, mfloat_t* position, mfloat_t* direction, float fov) {
+    vec3_assign(renderer->camera.position, position);
+    vec2_assign(renderer->camera.direction, direction);
+    renderer->camera.fov = fov;
+}
+
+/**
+ * Render a range of screen columns. Each column marches front to back along
+ * its ray, and the y-buffer tracks the highest pixel drawn so far so hidden
+ * terrain is never overdrawn. Columns are independent so ranges can be
+ * rendered in parallel.
+ *
+ * @param data Render job
+ * @param start First column
+ * @param end One past last column
+ */
+static void render_columns(void* data, int start, int end) {
+    render_job_t* job = (render_job_t*)data;
+    voxel_renderer_t* renderer = job->renderer;
+    texture_t* render_texture = renderer->render_texture;
+    texture_t* height_map = job->height_map;
+    texture_t* color_map = job->color_map;
+
+    const int width = render_texture->width;
+    const int height = render_texture->height;
+    const int map_width = height_map->width;
+    const int map_height = height_map->height;
+    const bool power_of_two = (map_width & (map_width - 1)) == 0 && (map_height & (map_height - 1)) == 0;
+
+    const float distance_to_projection_plane = job->distance_to_projection_plane;
+    const float camera_x = renderer->camera.position[0];
+    const float camera_y = renderer->camera.position[1];
+    const float camera_height = renderer->camera.position[2];
+    const float horizon = renderer->features.horizon * graphics_scene_scale_get(render_texture);
+    const float height_scale = renderer->features.height_scale;
+    const float draw_distance = renderer->features.draw_distance;
+    const float fog_distance = renderer->features.fog_distance;
+    const float lod = renderer->features.lod;
+
+    for (int i = start; i < end; i++) {
+        // Ray direction scaled so distance along it is depth
+        float offset = (i + 0.5f - width / 2.0f) / distance_to_projection_plane;
+        float dx = job->forward[0] + job->right[0] * offset;
+        float dy = job->forward[1] + job->right[1] * offset;
+
+        int y_buffer = height;
+
+        float z = NEAR_DISTANCE;
+        float dz = 1.0f;
+
+        while (z < draw_distance && y_buffer > 0) {
+            int x = floorf(camera_x + dx * z);
+            int y = floorf(camera_y + dy * z);
+
+            if (power_of_two) {
+                x &= map_width - 1;
+                y &= map_height - 1;
+            }
+            else {
+                x %= map_width;
+                y %= map_height;
+                if (x < 0) x += map_width;
+                if (y < 0) y += map_height;
+            }
+
+            int index = y * map_width + x;
+            float terrain_height = height_map->pixels[index] * height_scale;
+
+            int top = (camera_height - terrain_height) / z * distance_to_projection_plane + horizon;
+
+            if (top < y_buffer) {
+                if (top < 0) top = 0;
+
+                const color_t* shade = shading_lut_row_get(renderer->shading, 1.0f - z / fog_distance);
+                color_t color = shade[color_map->pixels[index]];
+
+                color_t* pixel = &render_texture->pixels[top * width + i];
+                for (int j = top; j < y_buffer; j++, pixel += width) {
+                    *pixel = color;
+                }
+
+                y_buffer = top;
+            }
+
+            // Sample less often further away
+            z += dz;
+            dz += lod;
+        }
+
+        renderer->y_buffer[i] = y_buffer;
+    }
+}
+
+void voxel_renderer_render(voxel_renderer_t* renderer, texture_t* height_map, texture_t* color_map) {
+    if (!renderer->render_texture) return;
+    if (!height_map || !color_map) return;
+
+    if (height_map->width != color_map->width || height_map->height != color_map->height) {
+        log_error("Voxel height map and color map sizes do not match");
+        return;
+    }
+
+    if (renderer->shading->source != renderer->features.shade_table) {
+        shading_lut_update(renderer->shading, renderer->features.shade_table);
+    }
+
+    render_job_t job;
+    job.renderer = renderer;
+    job.height_map = height_map;
+    job.color_map = color_map;
+
+    // Matches raycaster renderer's screen orientation
+    vec2_normalize(job.forward, renderer->camera.direction);
+    vec2_tangent(job.right, job.forward);
+    vec2_negative(job.right, job.right);
+
+    job.distance_to_projection_plane = (renderer->render_texture->width / 2.0f) / tanf(to_radians(renderer->camera.fov) / 2.0f);
+
+    jobs_parallel_for(renderer->render_texture->width, render_columns, &job);
+}
@@ -0,0 +1,73 @@
+#ifndef RENDERERS_VOXEL_H
+#define RENDERERS_VOXEL_H
+
+#include <mathc/mathc.h>
+
+#include "../graphics.h"
+#include "shading.h"
+
+typedef struct {
+    texture_t* render_texture;
+    int* y_buffer;
+    shading_lut_t* shading;
+
+    struct {
+        texture_t* shade_table;
+        float fog_distance;
+        float draw_distance;
+        float height_scale;
+        float horizon;
+        float lod;
+    } features;
+
+    struct {
+        mfloat_t position[VEC3_SIZE];
+        mfloat_t direction[VEC2_SIZE];
+        float fov;
+    } camera;
+} voxel_renderer_t;
+
+/**
+ * Creates a new renderer.
+ *
+ * @param render_texture Texture to render to. NULL to use the render texture.
+ * @return voxel_renderer_t* Newly created renderer.
+ */
+voxel_renderer_t* voxel_renderer_new(texture_t* render_texture);
+
+/**
+ * Frees a renderer.
+ *
+ * @param renderer Renderer to free.
+ */
+void voxel_renderer_free(voxel_renderer_t* renderer);
+
+/**
+ * Clears color buffer for given color.
+ *
+ * @param renderer Renderer to clear color buffer.
+ * @param color Clear color.
+ */
+void voxel_renderer_clear_color(voxel_renderer_t* renderer, color_t color);
+
+/**
+ * Set camera data.
+ *
+ * @param renderer Renderer to set camera data for.
+ * @param position Camera position. The z-component is height above zero.
+ * @param direction Camera direction.
+ * @param fov Camera fov.
+ */
+void voxel_renderer_camera(voxel_renderer_t* renderer, mfloat_t* position, mfloat_t* direction, float fov);
+
+/**
+ * Render terrain. Each texel of the height map is one world unit and its
+ * color is scaled by the height scale feature. Both maps repeat infinitely.
+ *
+ * @param renderer Renderer to render to.
+ * @param height_map Terrain heights.
+ * @param color_map Terrain colors. Must be the same size as height map.
+ */
+void voxel_renderer_render(voxel_renderer_t* renderer, texture_t* height_map, texture_t* color_map);
+
+#endif
@@ -0,0 +1,108 @@
+#include <math.h>
+#include <stdbool.h>
+
+#include "configuration.h"
+#include "graphics.h"
+#include "log.h"
+#include "resolution.h"
+#include "script.h"
+
+/** Weight of newest draw time in the running average. */
+#define SMOOTHING 0.1
+
+/** Frames to wait after a scale change before measuring again. */
+#define COOLDOWN_FRAMES 30
+
+/** Fraction of budget a larger scale must be predicted to fit in. */
+#define HEADROOM 0.85
+
+static float scale = 1.0f;
+static double average_time = -1.0;
+static int cooldown = 0;
+static bool scene_used = false;
+
+void resolution_init(void) {
+    log_info("resolution init");
+
+    resolution_reload();
+}
+
+void resolution_destroy(void) {
+
+}
+
+void resolution_reload(void) {
+    graphics_scene_end();
+
+    scale = 1.0f;
+    average_time = -1.0;
+    cooldown = 0;
+    scene_used = false;
+}
+
+void resolution_update(void) {
+    graphics_scene_end();
+
+    // Only govern frames that draw scenes, otherwise scaling can't help
+    if (!scene_used) return;
+    scene_used = false;
+
+    if (!config->scaling.enabled) {
+        scale = 1.0f;
+        return;
+    }
+
+    double draw_time = script_draw_time_get();
+
+    if (average_time < 0) {
+        average_time = draw_time;
+    }
+    else {
+        average_time += (draw_time - average_time) * SMOOTHING;
+    }
+
+    if (cooldown > 0) {
+        cooldown--;
+        return;
+    }
+
+    const float budget = config->scaling.budget;
+    const float minimum = config->scaling.minimum;
+    const float step = config->scaling.step;
+    float next = scale;
+
+    if (average_time > budget) {
+        next = fmaxf(minimum, scale - step);
+    }
+    else if (scale < 1.0f) {
+        // Assume cost grows with pixel count
+        float candidate = fminf(1.0f, scale + step);
+        double predicted_time = average_time * (candidate * candidate) / (scale * scale);
+
+        if (predicted_time < budget * HEADROOM) {
+            next = candidate;
+        }
+    }
+
+    if (next == scale) return;
+
+    average_time *= (next * next) / (scale * scale);
+    scale = next;
+    cooldown = COOLDOWN_FRAMES;
+}
+
+void resolution_scene_begin(void) {
+    scene_used = true;
+
+    if (!config->scaling.enabled) return;
+
+    graphics_scene_begin(scale);
+}
+
+void resolution_scene_end(void) {
+    graphics_scene_end();
+}
+
+float resolution_scale_get(void) {
+    return scale;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file resolution.h
+ * Dynamic resolution module. Trades scene resolution for frame time.
+ */
+
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+/**
+ * Initialize dynamic resolution system. Called once during application start.
+ */
+void resolution_init(void);
+
+/**
+ * Destroy dynamic resolution system. Called once during application shutdown.
+ */
+void resolution_destroy(void);
+
+/**
+ * Update dynamic resolution system. Called after drawing each frame. Ends
+ * any scene left open and adjusts the scene scale to fit the frame budget.
+ */
+void resolution_update(void);
+
+/**
+ * Reset scene scale and timings.
+ */
+void resolution_reload(void);
+
+/**
+ * Begins a scene at the current scene scale.
+ */
+void resolution_scene_begin(void);
+
+/**
+ * Ends current scene and upscales it to the render texture.
+ */
+void resolution_scene_end(void);
+
+/**
+ * Current scene scale.
+ *
+ * @return float Fraction of full resolution scenes are rendered at.
+ */
+float resolution_scale_get(void);
+
+#endif
@@ -1,3 +1,4 @@
+#include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -8,6 +9,7 @@
 #include <lua/lualib.h>
 
 #include "assets.h"
+#include "configuration.h"
 #include "event.h"
 #include "files.h"
 #include "graphics.h"
@@ -30,15 +32,19 @@
 #include "modules/matrix3.h"
 #include "modules/matrix4.h"
 #include "modules/math_extensions.h"
+#include "modules/mode7.h"
 #include "modules/mouse.h"
 #include "modules/quaternion.h"
 #include "modules/raycaster.h"
+#include "modules/sector.h"
 #include "modules/sound.h"
 #include "modules/statistics.h"
+#include "modules/synth.h"
 #include "modules/texture.h"
 #include "modules/vector2.h"
 #include "modules/vector3.h"
 #include "modules/vector4.h"
+#include "modules/voxel.h"
 
 static lua_State* L = NULL;
 static bool is_in_error_state = false;
@@ -49,6 +55,7 @@ static double draw_time;
 
 static int lua_package_searcher(lua_State* L);
 static int io_open(lua_State* L);
+static int io_lines(lua_State* L);
 static int call(lua_State* L, int narg, int nresults);
 
 static const luaL_Reg modules[] = {
@@ -64,14 +71,18 @@ static const luaL_Reg modules[] = {
     {"matrix2", luaopen_matrix2},
     {"matrix3", luaopen_matrix3},
     {"matrix4", luaopen_matrix4},
+    {"mode7", luaopen_mode7},
     {"mouse", luaopen_mouse},
     {"quaternion", luaopen_quaternion},
     {"raycaster", luaopen_raycaster},
+    {"sector", luaopen_sector},
     {"sound", luaopen_sound},
     {"statistics", luaopen_statistics},
+    {"synth", luaopen_synth},
     {"vector2", luaopen_vector2},
     {"vector3", luaopen_vector3},
     {"vector4", luaopen_vector4},
+    {"voxel", luaopen_voxel},
     {NULL, NULL}
 };
 
@@ -113,6 +124,190 @@ static bool do_string(lua_State*L, char* str) {
     return true;
 }
 
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} chunk_buffer_t;
+
+/**
+ * Writer for lua_dump that appends to a chunk buffer.
+ */
+static int chunk_buffer_write(lua_State* L, const void* p, size_t size, void* ud) {
+    chunk_buffer_t* buffer = (chunk_buffer_t*)ud;
+
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        while (capacity < buffer->size + size) capacity *= 2;
+
+        char* data = (char*)realloc(buffer->data, capacity);
+        if (!data) return 1;
+
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->size, p, size);
+    buffer->size += size;
+
+    return 0;
+}
+
+/**
+ * Hash bytes with 64-bit FNV-1a.
+ *
+ * @param hash Hash to continue from
+ * @param data Bytes to hash
+ * @param size Number of bytes
+ * @return uint64_t Updated hash
+ */
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * Read cached bytecode file. Files start with the content hash of the chunk
+ * they were compiled from, followed by the bytecode.
+ *
+ * @param path Cache file path
+ * @param hash Content hash of current chunk
+ * @param size Out bytecode size in bytes
+ * @return char* Bytecode if found and current, NULL otherwise. Caller must free.
+ */
+static char* chunk_cache_read(const char* path, uint64_t hash, size_t* size) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    fseek(fp, 0, SEEK_END);
+    long length = ftell(fp) - (long)sizeof(hash);
+
+    uint64_t cached_hash = 0;
+    rewind(fp);
+
+    // Chunk has changed since it was cached
+    if (length <= 0 || fread(&cached_hash, sizeof(cached_hash), 1, fp) != 1 || cached_hash != hash) {
+        fclose(fp);
+        *size = 0;
+        return NULL;
+    }
+
+    char* data = (char*)malloc(length);
+
+    if (data && fread(data, 1, length, fp) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(fp);
+
+    *size = data ? length : 0;
+
+    return data;
+}
+
+/**
+ * Write function on top of stack to bytecode cache file, replacing the file
+ * of any previous version of the chunk. Written to a temporary file first so
+ * a partial write is never loaded.
+ *
+ * @param L Lua VM
+ * @param directory Cache directory
+ * @param path Cache file path
+ * @param hash Content hash of chunk
+ */
+static void chunk_cache_write(lua_State* L, const char* directory, const char* path, uint64_t hash) {
+    chunk_buffer_t buffer = {NULL, 0, 0};
+
+    if (lua_dump(L, chunk_buffer_write, &buffer, 0) != 0) {
+        free(buffer.data);
+        return;
+    }
+
+    files_directory_create(directory);
+
+    size_t size = strlen(path) + 5;
+    char temp_path[size];
+    snprintf(temp_path, size, "%s.tmp", path);
+
+    FILE* fp = fopen(temp_path, "wb");
+
+    if (fp) {
+        bool written = fwrite(&hash, sizeof(hash), 1, fp) == 1;
+        written = written && fwrite(buffer.data, 1, buffer.size, fp) == buffer.size;
+        written = fclose(fp) == 0 && written;
+
+#ifdef _WIN32
+        // Rename does not replace existing files on Windows
+        remove(path);
+#endif
+
+        if (!written || rename(temp_path, path) != 0) {
+            remove(temp_path);
+        }
+    }
+
+    free(buffer.data);
+}
+
+/**
+ * Load script chunk as a function onto the stack. Compiled scripts are cached
+ * on disk, one file per chunk name, and reused while the content hash and Lua
+ * version match, so unchanged scripts skip compilation.
+ *
+ * @param L Lua VM
+ * @param chunk Script text or bytecode
+ * @param size Size of chunk in bytes
+ * @param name Chunk name
+ * @return int Lua status code
+ */
+static int chunk_load(lua_State* L, const char* chunk, size_t size, const char* name) {
+    const char* directory = config->scripts.cache;
+
+    // Chunks from asset packs are already bytecode
+    if (!directory || (size > 0 && chunk[0] == LUA_SIGNATURE[0])) {
+        return luaL_loadbuffer(L, chunk, size, name);
+    }
+
+    // File is named after the chunk, so edits replace it instead of adding
+    // another file
+    uint64_t name_hash = hash_bytes(0xcbf29ce484222325ULL, name, strlen(name) + 1);
+
+    // Chunk name is part of the content, as bytecode keeps it for error messages
+    uint64_t hash = hash_bytes(name_hash, LUA_RELEASE, sizeof(LUA_RELEASE));
+    hash = hash_bytes(hash, chunk, size);
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%016llx.luac", directory, (unsigned long long)name_hash);
+
+    size_t cached_size;
+    char* cached = chunk_cache_read(path, hash, &cached_size);
+
+    if (cached) {
+        int status = luaL_loadbufferx(L, cached, cached_size, name, "b");
+        free(cached);
+
+        if (status == LUA_OK) return status;
+
+        // Cache file is stale or damaged, so compile from source
+        lua_pop(L, 1);
+    }
+
+    int status = luaL_loadbuffer(L, chunk, size, name);
+
+    if (status == LUA_OK) {
+        chunk_cache_write(L, directory, path, hash);
+    }
+
+    return status;
+}
+
 /**
  * Create and configure Lua VM.
  */
@@ -135,6 +330,10 @@ static void init_lua_vm(void) {
     lua_register(L, "_io_open", io_open);
     if (!do_string(L, "io.open = _io_open")) return;
 
+    // Override default io.lines behavior
+    lua_register(L, "_io_lines", io_lines);
+    if (!do_string(L, "io.lines = _io_lines")) return;
+
     char buffer[1024];
     const char* version = LUA_VERSION_MAJOR "." LUA_VERSION_MINOR;
 
@@ -189,13 +388,14 @@ static void init_lua_vm(void) {
     platform_open_module(L);
 
    // Execute Lua script
-    const char* main = assets_script_get("main.lua");
+    size_t main_size;
+    const char* main = assets_script_chunk_get("main.lua", &main_size);
     if (!main) {
         log_error("Failed to load main.lua file.");
         return;
     }
 
-    int status = luaL_loadbuffer(L, main, strlen(main), "=main.lua");
+    int status = chunk_load(L, main, main_size, "=main.lua");
 
     if (status != LUA_OK) {
         const char* error_message = lua_tostring(L, -1);
@@ -290,7 +490,7 @@ static void call_global_lua_function(lua_State* L, const char* function_name) {
  * @return int Status of call
  */
 static int call(lua_State* L, int narg, int nresults) {
-    int base = lua_gettop(L);
+    int base = lua_gettop(L) - narg;
     lua_pushcfunction(L, message_handler);
     lua_insert(L, base);
     int status = lua_pcall(L, narg, nresults, base);
@@ -492,6 +692,97 @@ done:
     lua_settop(L, top);
 }
 
+char* script_compile(const char* name, const char* script, size_t size, size_t* chunk_size) {
+    lua_State* state = luaL_newstate();
+    if (!state) return NULL;
+
+    chunk_buffer_t buffer = {NULL, 0, 0};
+
+    if (luaL_loadbuffer(state, script, size, name) != LUA_OK) {
+        log_error(lua_tostring(state, -1));
+    }
+    else if (lua_dump(state, chunk_buffer_write, &buffer, 0) != 0) {
+        log_error("Failed to compile script: %s", name);
+        free(buffer.data);
+        buffer.data = NULL;
+    }
+
+    lua_close(state);
+
+    *chunk_size = buffer.data ? buffer.size : 0;
+
+    return buffer.data;
+}
+
+void script_module_reload(const char* filename) {
+    if (!L || is_in_error_state) return;
+
+    // Get module name from filename
+    size_t length = strlen(filename);
+    if (length <= 4) return;
+
+    char module_name[length + 1];
+    strncpy(module_name, filename, length - 4);
+    module_name[length - 4] = '\0';
+
+    for (char* c = module_name; *c; c++) {
+        if (*c == '/') *c = '.';
+    }
+
+    size_t module_length = strlen(module_name);
+    if (module_length > 5 && strcmp(module_name + module_length - 5, ".init") == 0) {
+        module_name[module_length - 5] = '\0';
+    }
+
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "loaded");
+    int loaded = lua_gettop(L);
+
+    // Modules not yet required will pick up changes when they are
+    lua_getfield(L, loaded, module_name);
+    int previous = lua_gettop(L);
+
+    if (lua_isnil(L, previous)) {
+        lua_settop(L, loaded - 2);
+        return;
+    }
+
+    lua_pushnil(L);
+    lua_setfield(L, loaded, module_name);
+
+    lua_getglobal(L, "require");
+    lua_pushstring(L, module_name);
+
+    if (call(L, 1, 1) != LUA_OK) {
+        log_error(lua_tostring(L, -1));
+
+        // Keep previous module
+        lua_pushvalue(L, previous);
+        lua_setfield(L, loaded, module_name);
+        lua_settop(L, loaded - 2);
+        return;
+    }
+
+    // Update previous module table in place so existing references see
+    // the new definitions.
+    if (lua_istable(L, previous) && lua_istable(L, -1)) {
+        lua_pushnil(L);
+
+        while (lua_next(L, -2)) {
+            lua_pushvalue(L, -2);
+            lua_insert(L, -2);
+            lua_settable(L, previous);
+        }
+
+        lua_pushvalue(L, previous);
+        lua_setfield(L, loaded, module_name);
+    }
+
+    lua_settop(L, loaded - 2);
+
+    log_info("reloaded module: %s", module_name);
+}
+
 double script_update_time_get(void) {
     return update_time;
 }
@@ -536,7 +827,8 @@ static int lua_package_searcher(lua_State* L) {
     strcat(filename, ".lua\0");
 
     // Look for script asset
-    const char* script = assets_script_get(filename);
+    size_t script_size;
+    const char* script = assets_script_chunk_get(filename, &script_size);
 
     if (script) {
         // We found a script asset, remove the module name from the stack.
@@ -546,7 +838,7 @@ static int lua_package_searcher(lua_State* L) {
         size_t size = strlen(module_name) + 6;
         char name[size];
         snprintf(name, size, "=%s.lua", module_name);
-        int result = luaL_loadbuffer(L, script, strlen(script), name);
+        int result = chunk_load(L, script, script_size, name);
         if (result != LUA_OK) {
             message_handler(L);
         }
@@ -601,3 +893,113 @@ static int io_open(lua_State* L) {
 
     return (p->f == NULL) ? luaL_fileresult(L, 0, filename) : 1;
 }
+
+#define MAXARGLINE 250
+
+/**
+ * @brief Iterator returned by io.lines. Reads file with the formats given to
+ * io.lines and closes it at end of file if io.lines opened it.
+ *
+ * @return Values read, nothing at end of file
+ */
+static int io_readline(lua_State* L) {
+    luaL_Stream *p = (luaL_Stream *)lua_touserdata(L, lua_upvalueindex(1));
+    int n = (int)lua_tointeger(L, lua_upvalueindex(2));
+
+    if (p->closef == NULL) {
+        return luaL_error(L, "file is already closed");
+    }
+
+    lua_settop(L, 0);
+    luaL_checkstack(L, n + 2, "too many arguments");
+
+    // Call file:read(...) with stored formats
+    lua_getfield(L, lua_upvalueindex(1), "read");
+    lua_pushvalue(L, lua_upvalueindex(1));
+    for (int i = 1; i <= n; i++) {
+        lua_pushvalue(L, lua_upvalueindex(3 + i));
+    }
+    lua_call(L, n + 1, LUA_MULTRET);
+
+    int results = lua_gettop(L);
+
+    if (lua_toboolean(L, 1)) {
+        return results;
+    }
+
+    // Read failed with an error message
+    if (results > 1) {
+        return luaL_error(L, "%s", lua_tostring(L, 2));
+    }
+
+    if (lua_toboolean(L, lua_upvalueindex(3))) {
+        lua_settop(L, 0);
+        lua_getfield(L, lua_upvalueindex(1), "close");
+        lua_pushvalue(L, lua_upvalueindex(1));
+        lua_call(L, 1, 0);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Creates io.lines iterator for file at index 1, using remaining
+ * arguments as read formats.
+ *
+ * @param toclose Close file at end of file
+ */
+static void aux_lines(lua_State* L, bool toclose) {
+    int n = lua_gettop(L) - 1;
+    luaL_argcheck(L, n <= MAXARGLINE, MAXARGLINE + 2, "too many arguments");
+
+    lua_pushvalue(L, 1);
+    lua_pushinteger(L, n);
+    lua_pushboolean(L, toclose);
+    lua_rotate(L, 2, 3);
+    lua_pushcclosure(L, io_readline, 3 + n);
+}
+
+/**
+ * @brief Iterates over lines of a file inside asset directory or zip.
+ * Without a filename lines are read from default input.
+ *
+ * This was largely lifted from liolib.c
+ *
+ * @param filename Name of file
+ * @return Iterator function, two nils and file handle
+ */
+static int io_lines(lua_State* L) {
+    if (lua_isnone(L, 1)) {
+        lua_pushnil(L);
+    }
+
+    if (lua_isnil(L, 1)) {
+        // Use default input
+        lua_getglobal(L, "io");
+        lua_getfield(L, -1, "input");
+        lua_call(L, 0, 1);
+        lua_replace(L, 1);
+        lua_pop(L, 1);
+
+        aux_lines(L, false);
+        return 1;
+    }
+
+    const char *filename = luaL_checkstring(L, 1);
+    luaL_Stream *p = newfile(L);
+    p->f = files_open(filename, "r");
+
+    if (p->f == NULL) {
+        return luaL_error(L, "%s: %s", filename, strerror(errno));
+    }
+
+    lua_replace(L, 1);
+    aux_lines(L, true);
+
+    // Return file as to-be-closed variable for generic for
+    lua_pushnil(L);
+    lua_pushnil(L);
+    lua_pushvalue(L, 1);
+
+    return 4;
+}
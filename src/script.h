@@ -7,6 +7,7 @@
 #define SCRIPT_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "event.h"
 
@@ -53,6 +54,27 @@ int script_evaluate(const char* script);
  */
 void script_complete(char* expression);
 
+/**
+ * Require given script module again without resetting VM state. Modules that
+ * return tables are updated in place. Does nothing if module was never
+ * required.
+ *
+ * @param filename Script filename relative to assets.
+ */
+void script_module_reload(const char* filename);
+
+/**
+ * Compile given script to Lua bytecode. Compiles in a separate Lua state, so
+ * the scripting system need not be initialized.
+ *
+ * @param name Chunk name used in error messages.
+ * @param script Script text.
+ * @param size Size of script text in bytes.
+ * @param chunk_size Out size of bytecode in bytes.
+ * @return char* Bytecode if successful, NULL otherwise. Caller must free.
+ */
+char* script_compile(const char* name, const char* script, size_t size, size_t* chunk_size);
+
 /**
  * Gets time used by _update function call in milliseconds
  *
@@ -2,7 +2,7 @@
 #include <string.h>
 
 #include "log.h"
-#include "platform.h"
+#include "mixer.h"
 #include "sounds.h"
 
 sound_t* sounds_sound_new(uint64_t frame_count, uint16_t channel_count, sample_t* pcm) {
@@ -26,6 +26,9 @@ sound_t* sounds_sound_new(uint64_t frame_count, uint16_t channel_count, sample_t
 }
 
 void sounds_sound_free(sound_t* sound) {
+    // Mixer frees sound once it stops playing
+    if (mixer_sound_release(sound)) return;
+
     free(sound);
     sound = NULL;
 }
@@ -38,6 +41,41 @@ sound_t* sounds_sound_copy(sound_t* sound) {
     );
 }
 
-void sounds_sound_play(sound_t* sound, int channel) {
-    platform_sound_play(sound, channel);
+uint64_t sounds_sound_frames_set(sound_t* sound, uint64_t offset, uint64_t frame_count, const float* samples) {
+    if (offset >= sound->frame_count) return 0;
+    if (frame_count > sound->frame_count - offset) {
+        frame_count = sound->frame_count - offset;
+    }
+
+    sample_t* pcm = sound->pcm + offset * sound->channel_count;
+
+    for (uint64_t i = 0; i < frame_count * sound->channel_count; i++) {
+        float value = samples[i] * 128.0f + 128.0f;
+
+        if (value < 0.0f) value = 0.0f;
+        if (value > 255.0f) value = 255.0f;
+
+        pcm[i] = (sample_t)(value + 0.5f);
+    }
+
+    return frame_count;
+}
+
+uint64_t sounds_sound_frames_get(sound_t* sound, uint64_t offset, uint64_t frame_count, float* samples) {
+    if (offset >= sound->frame_count) return 0;
+    if (frame_count > sound->frame_count - offset) {
+        frame_count = sound->frame_count - offset;
+    }
+
+    const sample_t* pcm = sound->pcm + offset * sound->channel_count;
+
+    for (uint64_t i = 0; i < frame_count * sound->channel_count; i++) {
+        samples[i] = ((int)pcm[i] - 128) / 128.0f;
+    }
+
+    return frame_count;
+}
+
+int sounds_sound_play(sound_t* sound, int channel) {
+    return mixer_play(sound, channel, 1.0f, 0.0f, 1.0f, false);
 }
@@ -9,6 +9,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/** Sample rate all sounds are stored at. */
+#define SOUNDS_SAMPLE_RATE 11025
+
 typedef uint8_t sample_t;
 
 typedef struct {
@@ -42,12 +45,37 @@ void sounds_sound_free(sound_t* sound);
  */
 sound_t* sounds_sound_copy(sound_t* sound);
 
+/**
+ * Set frames from float samples. Samples are interleaved by channel and
+ * range from -1 to 1, values outside are clamped.
+ *
+ * @param sound Sound to modify.
+ * @param offset Index of first frame to set.
+ * @param frame_count Number of frames to set.
+ * @param samples Samples to copy.
+ * @return uint64_t Number of frames set, less if sound ends first.
+ */
+uint64_t sounds_sound_frames_set(sound_t* sound, uint64_t offset, uint64_t frame_count, const float* samples);
+
+/**
+ * Get frames as float samples. Samples are interleaved by channel and range
+ * from -1 to 1.
+ *
+ * @param sound Sound to read.
+ * @param offset Index of first frame to get.
+ * @param frame_count Number of frames to get.
+ * @param samples Buffer to copy samples to.
+ * @return uint64_t Number of frames copied, less if sound ends first.
+ */
+uint64_t sounds_sound_frames_get(sound_t* sound, uint64_t offset, uint64_t frame_count, float* samples);
+
 /**
  * Plays a sound.
  *
  * @param sound Sound to play
- * @param channel Channel to play sound on
+ * @param channel Channel to play sound on, or -1 for any free channel
+ * @return int Voice handle if playing, -1 otherwise
 */
-void sounds_sound_play(sound_t* sound, int channel);
+int sounds_sound_play(sound_t* sound, int channel);
 
 #endif
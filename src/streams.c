@@ -0,0 +1,454 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#include "assets.h"
+#include "log.h"
+#include "mixer.h"
+#include "streams.h"
+
+/** Seconds of audio buffered per stream. */
+#define STREAM_BUFFER_SECONDS 1
+
+/** Milliseconds between buffer refills. */
+#define STREAM_REFILL_INTERVAL 10
+
+/** Most frames decoded at a time. Bounds how long stop and seek wait on the
+ * decoder. */
+#define STREAM_DECODE_FRAMES 4096
+
+static stream_t** streams = NULL;
+static int stream_count = 0;
+static int stream_capacity = 0;
+
+#ifndef __EMSCRIPTEN__
+static pthread_t decoder_thread;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t refill_requested = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t decode_done = PTHREAD_COND_INITIALIZER;
+
+/** Number of callers waiting for a decode to finish. Decoder yields to them. */
+static int decode_waiter_count = 0;
+static bool is_decoder_running = false;
+static bool is_stopping = false;
+#endif
+
+static void streams_lock(void) {
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&mutex);
+#endif
+}
+
+static void streams_unlock(void) {
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_unlock(&mutex);
+#endif
+}
+
+/**
+ * Wait until the decoder is done reading the source of stream. Must be
+ * called with lock held.
+ *
+ * @param stream Stream to wait for.
+ */
+static void stream_decode_wait(stream_t* stream) {
+#ifndef __EMSCRIPTEN__
+    decode_waiter_count++;
+
+    while (stream->is_decoding) {
+        pthread_cond_wait(&decode_done, &mutex);
+    }
+
+    decode_waiter_count--;
+#endif
+}
+
+/**
+ * Decode a chunk into free space of stream buffer. Sources are restarted at
+ * their end when looping. Must be called with lock held. Lock is released
+ * while the source is read, so a slow read does not hold up other streams or
+ * the game thread. Nothing else touches the source or free space meanwhile,
+ * so frames are decoded in place and the lock is only taken to publish them.
+ *
+ * @param stream Stream to decode.
+ * @return true if frames were decoded, false if buffer is full or stream has
+ * nothing more to decode.
+ */
+static bool stream_decode(stream_t* stream) {
+    if (!stream->source.read || stream->is_ended || stream->is_decoding) return false;
+
+#ifndef __EMSCRIPTEN__
+    // Let waiting callers go first, they hold up the game thread
+    if (decode_waiter_count > 0) return false;
+#endif
+
+    uint64_t mask = stream->buffer_frame_count - 1;
+    uint64_t write = stream->write_frame;
+    uint64_t read = __atomic_load_n(&stream->read_frame, __ATOMIC_ACQUIRE);
+    uint64_t space = stream->buffer_frame_count - (write - read);
+    if (space == 0) return false;
+
+    // Stop at end of buffer, the rest is filled from its start
+    uint64_t offset = write & mask;
+    uint64_t count = stream->buffer_frame_count - offset;
+    if (count > space) count = space;
+    if (count > STREAM_DECODE_FRAMES) count = STREAM_DECODE_FRAMES;
+
+    bool is_looping = __atomic_load_n(&stream->is_looping, __ATOMIC_RELAXED);
+    sample_t* buffer = stream->buffer + offset * stream->source.channel_count;
+
+    stream->is_decoding = true;
+    streams_unlock();
+
+    uint64_t frames = stream->source.read(stream->source.data, buffer, count);
+
+    // Restart once, an empty source would loop forever
+    if (frames == 0 && is_looping && stream->source.seek(stream->source.data, 0)) {
+        frames = stream->source.read(stream->source.data, buffer, count);
+    }
+
+    streams_lock();
+    stream->is_decoding = false;
+
+    if (frames > 0) {
+        __atomic_store_n(&stream->write_frame, write + frames, __ATOMIC_RELEASE);
+    }
+    else {
+        __atomic_store_n(&stream->is_ended, true, __ATOMIC_RELEASE);
+    }
+
+#ifndef __EMSCRIPTEN__
+    pthread_cond_broadcast(&decode_done);
+#endif
+
+    return frames > 0;
+}
+
+/**
+ * Move source to given frame and empty buffer. Stream must not be playing
+ * and lock must be held.
+ *
+ * @param stream Stream to reset.
+ * @param frame Source frame to continue from.
+ */
+static void stream_reset(stream_t* stream, uint64_t frame) {
+    stream_decode_wait(stream);
+
+    if (!stream->source.read) return;
+
+    if (!stream->source.seek(stream->source.data, frame)) {
+        log_error("Failed to seek stream");
+        stream->source.seek(stream->source.data, 0);
+        frame = 0;
+    }
+
+    stream->start_frame = frame;
+    stream->write_frame = 0;
+    stream->read_frame = 0;
+    stream->is_ended = false;
+}
+
+/**
+ * Stop voice playing stream and wait until the mixer has let go of it.
+ *
+ * @param stream Stream to stop.
+ */
+static void stream_voice_stop(stream_t* stream) {
+    if (mixer_voice_is_playing(stream->voice)) {
+        mixer_voice_stop(stream->voice);
+        mixer_sync();
+    }
+
+    stream->voice = -1;
+}
+
+/**
+ * Close source of stream. Stream plays nothing afterwards. Must be called
+ * with lock held.
+ *
+ * @param stream Stream to close.
+ */
+static void stream_source_close(stream_t* stream) {
+    stream_decode_wait(stream);
+
+    if (stream->source.close) {
+        stream->source.close(stream->source.data);
+    }
+
+    stream->source.data = NULL;
+    stream->source.read = NULL;
+    stream->source.seek = NULL;
+    stream->source.close = NULL;
+    stream->write_frame = 0;
+    stream->read_frame = 0;
+    stream->is_ended = true;
+}
+
+#ifndef __EMSCRIPTEN__
+static void* decoder_thread_run(void* arg) {
+    pthread_mutex_lock(&mutex);
+
+    while (!is_stopping) {
+        // A chunk per stream at a time, so one slow source doesn't starve the
+        // others. Lock is released while decoding, so streams may change.
+        bool is_decoded = true;
+
+        while (is_decoded && !is_stopping) {
+            is_decoded = false;
+
+            for (int i = 0; i < stream_count; i++) {
+                if (stream_decode(streams[i])) {
+                    is_decoded = true;
+                }
+            }
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+
+        deadline.tv_nsec += STREAM_REFILL_INTERVAL * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        pthread_cond_timedwait(&refill_requested, &mutex, &deadline);
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    return NULL;
+}
+#endif
+
+void streams_init(void) {
+#ifndef __EMSCRIPTEN__
+    is_stopping = false;
+
+    if (pthread_create(&decoder_thread, NULL, decoder_thread_run, NULL) != 0) {
+        log_error("Failed to start stream decoder");
+        return;
+    }
+
+    is_decoder_running = true;
+#endif
+}
+
+void streams_destroy(void) {
+#ifndef __EMSCRIPTEN__
+    if (is_decoder_running) {
+        pthread_mutex_lock(&mutex);
+        is_stopping = true;
+        pthread_cond_signal(&refill_requested);
+        pthread_mutex_unlock(&mutex);
+
+        pthread_join(decoder_thread, NULL);
+        is_decoder_running = false;
+    }
+#endif
+
+    while (stream_count > 0) {
+        streams_stream_free(streams[stream_count - 1]);
+    }
+
+    free(streams);
+    streams = NULL;
+    stream_capacity = 0;
+}
+
+void streams_update(void) {
+#ifdef __EMSCRIPTEN__
+    // No decoder thread, audio callback runs on this thread too
+    for (int i = 0; i < stream_count; i++) {
+        while (stream_decode(streams[i]));
+    }
+#endif
+}
+
+void streams_sources_close(void) {
+    for (int i = 0; i < stream_count; i++) {
+        stream_voice_stop(streams[i]);
+    }
+
+    streams_lock();
+
+    for (int i = 0; i < stream_count; i++) {
+        stream_source_close(streams[i]);
+    }
+
+    streams_unlock();
+}
+
+stream_t* streams_stream_open(const char* filename) {
+    stream_t* stream = (stream_t*)calloc(1, sizeof(stream_t));
+    if (!stream) {
+        log_error("Failed to create stream");
+        return NULL;
+    }
+
+    stream->voice = -1;
+
+    if (!assets_stream_source_open(filename, &stream->source)) {
+        log_error("Failed to open stream: %s", filename);
+        free(stream);
+        return NULL;
+    }
+
+    uint32_t frame_count = 1;
+    while (frame_count < stream->source.sample_rate * STREAM_BUFFER_SECONDS) {
+        frame_count *= 2;
+    }
+
+    stream->buffer_frame_count = frame_count;
+    stream->buffer = (sample_t*)malloc(sizeof(sample_t) * frame_count * stream->source.channel_count);
+
+    if (!stream->buffer) {
+        log_error("Failed to create stream buffer");
+        stream->source.close(stream->source.data);
+        free(stream);
+        return NULL;
+    }
+
+    streams_lock();
+
+    if (stream_count == stream_capacity) {
+        int capacity = stream_capacity ? stream_capacity * 2 : 8;
+        stream_t** new_streams = (stream_t**)realloc(streams, sizeof(stream_t*) * capacity);
+
+        if (!new_streams) {
+            streams_unlock();
+            log_error("Failed to create stream");
+            stream->source.close(stream->source.data);
+            free(stream->buffer);
+            free(stream);
+            return NULL;
+        }
+
+        streams = new_streams;
+        stream_capacity = capacity;
+    }
+
+    streams[stream_count++] = stream;
+
+    streams_unlock();
+
+    return stream;
+}
+
+void streams_stream_free(stream_t* stream) {
+    if (!stream) return;
+
+    stream_voice_stop(stream);
+
+    streams_lock();
+
+    for (int i = 0; i < stream_count; i++) {
+        if (streams[i] == stream) {
+            streams[i] = streams[--stream_count];
+            break;
+        }
+    }
+
+    stream_source_close(stream);
+
+    streams_unlock();
+
+    free(stream->buffer);
+    free(stream);
+}
+
+int streams_stream_play(stream_t* stream, float volume, float pan, float pitch) {
+    if (mixer_voice_is_playing(stream->voice)) {
+        mixer_voice_set(stream->voice, volume, pan, pitch);
+        return stream->voice;
+    }
+
+    if (!stream->source.read) return -1;
+
+    streams_lock();
+    stream_decode_wait(stream);
+
+    // Played to the end, start over
+    if (stream->is_ended && stream->read_frame == stream->write_frame) {
+        stream_reset(stream, 0);
+    }
+
+    // Decode a chunk now so playback doesn't start with a gap, decoder fills
+    // the rest
+    stream_decode(stream);
+
+    streams_unlock();
+
+    stream->voice = mixer_stream_play(stream, volume, pan, pitch);
+
+#ifndef __EMSCRIPTEN__
+    pthread_cond_signal(&refill_requested);
+#endif
+
+    return stream->voice;
+}
+
+void streams_stream_stop(stream_t* stream) {
+    stream_voice_stop(stream);
+
+    streams_lock();
+    stream_reset(stream, 0);
+    streams_unlock();
+}
+
+void streams_stream_seek(stream_t* stream, double seconds) {
+    if (!stream->source.read) return;
+
+    uint64_t frame = seconds > 0 ? (uint64_t)(seconds * stream->source.sample_rate) : 0;
+    if (frame > stream->source.frame_count) {
+        frame = stream->source.frame_count;
+    }
+
+    float volume, pan, pitch;
+    bool was_playing = mixer_voice_is_playing(stream->voice) && mixer_voice_get(stream->voice, &volume, &pan, &pitch);
+
+    stream_voice_stop(stream);
+
+    streams_lock();
+    stream_reset(stream, frame);
+    streams_unlock();
+
+    if (was_playing) {
+        streams_stream_play(stream, volume, pan, pitch);
+    }
+}
+
+double streams_stream_position_get(stream_t* stream) {
+    if (!stream->source.read || stream->source.sample_rate == 0) return 0;
+
+    uint64_t frame = stream->start_frame + __atomic_load_n(&stream->read_frame, __ATOMIC_ACQUIRE);
+
+    if (stream->source.frame_count > 0) {
+        if (stream->is_looping) {
+            frame %= stream->source.frame_count;
+        }
+        else if (frame > stream->source.frame_count) {
+            frame = stream->source.frame_count;
+        }
+    }
+
+    return (double)frame / stream->source.sample_rate;
+}
+
+void streams_stream_loop_set(stream_t* stream, bool loop) {
+    __atomic_store_n(&stream->is_looping, loop, __ATOMIC_RELAXED);
+}
+
+bool streams_stream_is_playing(stream_t* stream) {
+    return mixer_voice_is_playing(stream->voice);
+}
@@ -0,0 +1,156 @@
+/**
+ * @file streams.h
+ * Streams module. Plays long sounds such as music without decoding them up
+ * front. Streams decode into a small ring buffer which a background thread
+ * keeps filled while the mixer plays from it.
+ */
+
+#ifndef STREAMS_H
+#define STREAMS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sounds.h"
+
+/**
+ * Decoder a stream reads frames from.
+ */
+typedef struct {
+    void* data;
+
+    /**
+     * Read up to frame_count frames into buffer. Returns number of frames
+     * read, 0 at end of sound.
+     */
+    uint64_t (*read)(void* data, sample_t* buffer, uint64_t frame_count);
+
+    /** Move to given frame. Returns false on failure. */
+    bool (*seek)(void* data, uint64_t frame);
+
+    /** Free decoder. */
+    void (*close)(void* data);
+
+    uint64_t frame_count;
+    uint16_t channel_count;
+    uint32_t sample_rate;
+} stream_source_t;
+
+typedef struct {
+    stream_source_t source;
+
+    /** Decoded frames. Size is a power of two. */
+    sample_t* buffer;
+    uint32_t buffer_frame_count;
+
+    /**
+     * Total frames written by the decoder and read by the mixer since last
+     * seek. Frames in [read, write) are waiting to be played.
+     */
+    uint64_t write_frame;
+    uint64_t read_frame;
+
+    /** Frame of source the buffer starts at, used to report position. */
+    uint64_t start_frame;
+
+    /** Set once the source is exhausted and won't be restarted. */
+    bool is_ended;
+    bool is_looping;
+
+    /**
+     * Set while the source is read without holding the streams lock. Source
+     * and free space of buffer belong to the decoder until it is cleared.
+     */
+    bool is_decoding;
+
+    /** Voice playing stream, -1 if none. */
+    int voice;
+} stream_t;
+
+/**
+ * Initialize streams system. Starts decoder thread.
+ */
+void streams_init(void);
+
+/**
+ * Destroy streams system. Frees all open streams.
+ */
+void streams_destroy(void);
+
+/**
+ * Refill stream buffers. Only does work on platforms without threads.
+ */
+void streams_update(void);
+
+/**
+ * Stop all streams and close their sources. Called before assets are
+ * unloaded, as sources may read from asset memory.
+ */
+void streams_sources_close(void);
+
+/**
+ * Open stream for given asset file.
+ *
+ * @param filename Name of WAV file to stream.
+ * @return stream_t* New stream if successful, NULL otherwise.
+ */
+stream_t* streams_stream_open(const char* filename);
+
+/**
+ * Stop and free a stream.
+ *
+ * @param stream Stream to free.
+ */
+void streams_stream_free(stream_t* stream);
+
+/**
+ * Play stream from its current position. Restarts stream if it has ended.
+ *
+ * @param stream Stream to play.
+ * @param volume Volume from 0 to 1.
+ * @param pan Pan from -1 (left) to 1 (right).
+ * @param pitch Playback speed. 1 is normal.
+ * @return int Voice handle if playing, -1 otherwise.
+ */
+int streams_stream_play(stream_t* stream, float volume, float pan, float pitch);
+
+/**
+ * Stop stream and move back to its start.
+ *
+ * @param stream Stream to stop.
+ */
+void streams_stream_stop(stream_t* stream);
+
+/**
+ * Move stream to given position. Playing streams continue from there.
+ *
+ * @param stream Stream to seek.
+ * @param seconds Position in seconds.
+ */
+void streams_stream_seek(stream_t* stream, double seconds);
+
+/**
+ * Get position of stream.
+ *
+ * @param stream Stream to check.
+ * @return double Position in seconds.
+ */
+double streams_stream_position_get(stream_t* stream);
+
+/**
+ * Set if stream restarts when it reaches its end.
+ *
+ * @param stream Stream to change.
+ * @param loop True to loop.
+ */
+void streams_stream_loop_set(stream_t* stream, bool loop);
+
+/**
+ * Check if stream is playing.
+ *
+ * @param stream Stream to check.
+ * @return bool True if playing, false otherwise.
+ */
+bool streams_stream_is_playing(stream_t* stream);
+
+#endif
@@ -0,0 +1,240 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "log.h"
+#include "sounds.h"
+#include "synth.h"
+
+#define SYNTH_TAU 6.28318530717958647692
+
+void synth_params_default(synth_params_t* params) {
+    params->wave = SYNTH_WAVE_SQUARE;
+    params->frequency = 440;
+    params->frequency_end = 440;
+    params->duty = 0.5f;
+    params->vibrato_depth = 0;
+    params->vibrato_speed = 0;
+    params->volume = 0.5f;
+    params->attack = 0.01f;
+    params->decay = 0.05f;
+    params->sustain = 0.5f;
+    params->hold = 0.1f;
+    params->release = 0.1f;
+    params->lowpass = 0;
+    params->highpass = 0;
+    params->seed = 1;
+}
+
+/**
+ * Next value of xorshift generator, from -1 to 1.
+ */
+static float noise_next(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return (float)((double)x / 2147483647.5 - 1.0);
+}
+
+/**
+ * Render oscillator into every channel of a sample buffer.
+ */
+static void oscillator_render(float* samples, uint64_t frame_count, int channel_count, const synth_params_t* params) {
+    double phase = 0;
+    double vibrato_phase = 0;
+    uint32_t noise_state = params->seed ? params->seed : 1;
+    float noise = noise_next(&noise_state);
+
+    for (uint64_t i = 0; i < frame_count; i++) {
+        float t = frame_count > 1 ? (float)i / (frame_count - 1) : 0;
+        double frequency = params->frequency + (params->frequency_end - params->frequency) * t;
+
+        if (params->vibrato_depth > 0) {
+            frequency *= 1.0 + params->vibrato_depth * sin(vibrato_phase * SYNTH_TAU);
+            vibrato_phase += (double)params->vibrato_speed / SOUNDS_SAMPLE_RATE;
+        }
+
+        float value = 0;
+
+        switch (params->wave) {
+            case SYNTH_WAVE_SQUARE:
+                value = phase < params->duty ? 1.0f : -1.0f;
+                break;
+
+            case SYNTH_WAVE_SAW:
+                value = (float)(phase * 2.0 - 1.0);
+                break;
+
+            case SYNTH_WAVE_SINE:
+                value = (float)sin(phase * SYNTH_TAU);
+                break;
+
+            case SYNTH_WAVE_TRIANGLE:
+                value = (float)(phase < 0.5 ? phase * 4.0 - 1.0 : 3.0 - phase * 4.0);
+                break;
+
+            case SYNTH_WAVE_NOISE:
+                value = noise;
+                break;
+        }
+
+        value *= params->volume;
+
+        for (int c = 0; c < channel_count; c++) {
+            samples[i * channel_count + c] = value;
+        }
+
+        phase += frequency / SOUNDS_SAMPLE_RATE;
+
+        if (phase >= 1.0) {
+            phase -= floor(phase);
+
+            // Noise holds a random value for each period, so frequency sets its color
+            noise = noise_next(&noise_state);
+        }
+    }
+}
+
+/**
+ * Apply ADSR envelope to a sample buffer.
+ */
+static void envelope_apply(float* samples, uint64_t frame_count, int channel_count, float attack, float decay, float sustain, float release) {
+    double attack_end = attack * SOUNDS_SAMPLE_RATE;
+    double decay_end = attack_end + decay * SOUNDS_SAMPLE_RATE;
+    double release_start = frame_count - (double)release * SOUNDS_SAMPLE_RATE;
+
+    for (uint64_t i = 0; i < frame_count; i++) {
+        double gain;
+
+        if (i < attack_end) {
+            gain = i / attack_end;
+        }
+        else if (i < decay_end) {
+            gain = 1.0 - (1.0 - sustain) * (i - attack_end) / (decay_end - attack_end);
+        }
+        else {
+            gain = sustain;
+        }
+
+        if (i >= release_start && release > 0) {
+            gain *= (frame_count - i) / ((double)release * SOUNDS_SAMPLE_RATE);
+        }
+
+        for (int c = 0; c < channel_count; c++) {
+            samples[i * channel_count + c] *= (float)gain;
+        }
+    }
+}
+
+/**
+ * Apply one pole lowpass or highpass filter to a sample buffer.
+ */
+static void filter_apply(float* samples, uint64_t frame_count, int channel_count, float cutoff, bool highpass) {
+    if (cutoff <= 0) return;
+
+    float alpha = (float)(1.0 - exp(-SYNTH_TAU * cutoff / SOUNDS_SAMPLE_RATE));
+
+    for (int c = 0; c < channel_count; c++) {
+        float low = 0;
+
+        for (uint64_t i = 0; i < frame_count; i++) {
+            float* sample = &samples[i * channel_count + c];
+            low += alpha * (*sample - low);
+            *sample = highpass ? *sample - low : low;
+        }
+    }
+}
+
+/**
+ * Convert sound to float samples for processing.
+ *
+ * @return float* Samples if successful, NULL otherwise.
+ */
+static float* samples_from_sound(sound_t* sound) {
+    float* samples = (float*)malloc(sizeof(float) * (sound->frame_count * sound->channel_count + 1));
+    if (!samples) {
+        log_error("Failed to allocate memory for synth");
+        return NULL;
+    }
+
+    sounds_sound_frames_get(sound, 0, sound->frame_count, samples);
+
+    return samples;
+}
+
+sound_t* synth_render(const synth_params_t* params) {
+    float length = params->attack + params->decay + params->hold + params->release;
+    uint64_t frame_count = length > 0 ? (uint64_t)(length * SOUNDS_SAMPLE_RATE) : 0;
+
+    sound_t* sound = sounds_sound_new(frame_count, 1, NULL);
+    if (!sound) return NULL;
+
+    float* samples = (float*)malloc(sizeof(float) * (frame_count + 1));
+    if (!samples) {
+        log_error("Failed to allocate memory for synth");
+        sounds_sound_free(sound);
+        return NULL;
+    }
+
+    oscillator_render(samples, frame_count, 1, params);
+    envelope_apply(samples, frame_count, 1, params->attack, params->decay, params->sustain, params->release);
+    filter_apply(samples, frame_count, 1, params->lowpass, false);
+    filter_apply(samples, frame_count, 1, params->highpass, true);
+
+    sounds_sound_frames_set(sound, 0, frame_count, samples);
+    free(samples);
+
+    return sound;
+}
+
+void synth_oscillator_render(sound_t* sound, synth_wave_t wave, float frequency, float frequency_end, float duty, float volume, uint32_t seed) {
+    synth_params_t params;
+    synth_params_default(&params);
+    params.wave = wave;
+    params.frequency = frequency;
+    params.frequency_end = frequency_end;
+    params.duty = duty;
+    params.volume = volume;
+    params.seed = seed;
+
+    float* samples = (float*)malloc(sizeof(float) * (sound->frame_count * sound->channel_count + 1));
+    if (!samples) {
+        log_error("Failed to allocate memory for synth");
+        return;
+    }
+
+    oscillator_render(samples, sound->frame_count, sound->channel_count, &params);
+    sounds_sound_frames_set(sound, 0, sound->frame_count, samples);
+    free(samples);
+}
+
+void synth_envelope_apply(sound_t* sound, float attack, float decay, float sustain, float release) {
+    float* samples = samples_from_sound(sound);
+    if (!samples) return;
+
+    envelope_apply(samples, sound->frame_count, sound->channel_count, attack, decay, sustain, release);
+    sounds_sound_frames_set(sound, 0, sound->frame_count, samples);
+    free(samples);
+}
+
+void synth_lowpass_apply(sound_t* sound, float cutoff) {
+    float* samples = samples_from_sound(sound);
+    if (!samples) return;
+
+    filter_apply(samples, sound->frame_count, sound->channel_count, cutoff, false);
+    sounds_sound_frames_set(sound, 0, sound->frame_count, samples);
+    free(samples);
+}
+
+void synth_highpass_apply(sound_t* sound, float cutoff) {
+    float* samples = samples_from_sound(sound);
+    if (!samples) return;
+
+    filter_apply(samples, sound->frame_count, sound->channel_count, cutoff, true);
+    sounds_sound_frames_set(sound, 0, sound->frame_count, samples);
+    free(samples);
+}
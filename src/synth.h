@@ -0,0 +1,111 @@
+/**
+ * @file synth.h
+ * Synth module. Renders procedural sound effects straight into sounds.
+ * Effects are built from an oscillator shaped by an ADSR envelope and
+ * optional filters, in the spirit of sfxr.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+
+#include "sounds.h"
+
+typedef enum {
+    SYNTH_WAVE_SQUARE,
+    SYNTH_WAVE_SAW,
+    SYNTH_WAVE_SINE,
+    SYNTH_WAVE_TRIANGLE,
+    SYNTH_WAVE_NOISE
+} synth_wave_t;
+
+typedef struct {
+    synth_wave_t wave;
+
+    /** Frequency in Hz at start and end. Frequency slides between them. */
+    float frequency;
+    float frequency_end;
+
+    /** Portion of each square wave period spent high, 0 to 1. */
+    float duty;
+
+    /** Vibrato depth as a fraction of frequency, and speed in Hz. */
+    float vibrato_depth;
+    float vibrato_speed;
+
+    float volume;
+
+    /** Envelope times in seconds. Sustain is a level from 0 to 1. */
+    float attack;
+    float decay;
+    float sustain;
+    float hold;
+    float release;
+
+    /** Filter cutoff frequencies in Hz. 0 disables filter. */
+    float lowpass;
+    float highpass;
+
+    /** Noise seed. Same seed renders same noise. */
+    uint32_t seed;
+} synth_params_t;
+
+/**
+ * Get default parameters. A short square wave beep.
+ *
+ * @param params Parameters to fill.
+ */
+void synth_params_default(synth_params_t* params);
+
+/**
+ * Render sound effect. Length is the sum of envelope times.
+ *
+ * @param params Effect parameters.
+ * @return sound_t* New mono sound if successful, NULL otherwise.
+ */
+sound_t* synth_render(const synth_params_t* params);
+
+/**
+ * Render oscillator into sound, replacing its contents. All channels get
+ * the same signal.
+ *
+ * @param sound Sound to render into.
+ * @param wave Wave shape.
+ * @param frequency Frequency in Hz at start.
+ * @param frequency_end Frequency in Hz at end.
+ * @param duty Portion of square wave period spent high.
+ * @param volume Volume from 0 to 1.
+ * @param seed Noise seed.
+ */
+void synth_oscillator_render(sound_t* sound, synth_wave_t wave, float frequency, float frequency_end, float duty, float volume, uint32_t seed);
+
+/**
+ * Shape sound with an ADSR envelope. Sustain lasts until release starts at
+ * the end of the sound.
+ *
+ * @param sound Sound to shape.
+ * @param attack Attack time in seconds.
+ * @param decay Decay time in seconds.
+ * @param sustain Sustain level from 0 to 1.
+ * @param release Release time in seconds.
+ */
+void synth_envelope_apply(sound_t* sound, float attack, float decay, float sustain, float release);
+
+/**
+ * Filter out frequencies above cutoff.
+ *
+ * @param sound Sound to filter.
+ * @param cutoff Cutoff frequency in Hz.
+ */
+void synth_lowpass_apply(sound_t* sound, float cutoff);
+
+/**
+ * Filter out frequencies below cutoff.
+ *
+ * @param sound Sound to filter.
+ * @param cutoff Cutoff frequency in Hz.
+ */
+void synth_highpass_apply(sound_t* sound, float cutoff);
+
+#endif
@@ -0,0 +1,243 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "assets.h"
+#include "event.h"
+#include "files.h"
+#include "log.h"
+#include "script.h"
+#include "watcher.h"
+
+#ifdef __linux__
+typedef struct {
+    int descriptor;
+    char* path;
+} watch_t;
+
+static int inotify_fd = -1;
+static const char* watched_directory = NULL;
+
+static watch_t* watches = NULL;
+static int watch_count = 0;
+static int watch_capacity = 0;
+
+/** Changed files collected from one update, without duplicates. */
+static char** changes = NULL;
+static int change_count = 0;
+static int change_capacity = 0;
+
+/**
+ * Watch given directory and all directories below it. Hidden directories are
+ * skipped.
+ *
+ * @param directory Directory to watch
+ */
+static void watch_add(const char* directory) {
+    int descriptor = inotify_add_watch(inotify_fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (descriptor < 0) {
+        log_error("Failed to watch directory: %s", directory);
+        return;
+    }
+
+    if (watch_count == watch_capacity) {
+        int capacity = watch_capacity ? watch_capacity * 2 : 16;
+        watch_t* new_watches = (watch_t*)realloc(watches, sizeof(watch_t) * capacity);
+
+        if (!new_watches) {
+            inotify_rm_watch(inotify_fd, descriptor);
+            return;
+        }
+
+        watches = new_watches;
+        watch_capacity = capacity;
+    }
+
+    char* path = (char*)malloc(strlen(directory) + 1);
+    if (!path) {
+        inotify_rm_watch(inotify_fd, descriptor);
+        return;
+    }
+
+    strcpy(path, directory);
+    watches[watch_count++] = (watch_t) {descriptor, path};
+
+    DIR* dir = opendir(directory);
+    if (!dir) return;
+
+    struct dirent* entry;
+    struct stat s;
+    char fullpath[512];
+
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] == '.') continue;
+
+        snprintf(fullpath, sizeof(fullpath), "%s/%s", directory, entry->d_name);
+
+        if (stat(fullpath, &s) == 0 && S_ISDIR(s.st_mode)) {
+            watch_add(fullpath);
+        }
+    }
+
+    closedir(dir);
+}
+
+/**
+ * Get directory for given watch descriptor.
+ *
+ * @param descriptor Watch descriptor
+ * @return const char* Watched directory if found, NULL otherwise
+ */
+static const char* watch_path_get(int descriptor) {
+    for (int i = 0; i < watch_count; i++) {
+        if (watches[i].descriptor == descriptor) return watches[i].path;
+    }
+
+    return NULL;
+}
+
+/**
+ * Record file as changed.
+ *
+ * @param path Path of changed file
+ */
+static void change_add(const char* path) {
+    for (int i = 0; i < change_count; i++) {
+        if (strcmp(changes[i], path) == 0) return;
+    }
+
+    if (change_count == change_capacity) {
+        int capacity = change_capacity ? change_capacity * 2 : 16;
+        char** new_changes = (char**)realloc(changes, sizeof(char*) * capacity);
+
+        if (!new_changes) return;
+
+        changes = new_changes;
+        change_capacity = capacity;
+    }
+
+    char* change = (char*)malloc(strlen(path) + 1);
+    if (!change) return;
+
+    strcpy(change, path);
+    changes[change_count++] = change;
+}
+
+/**
+ * Check if changing given file requires a full reload.
+ *
+ * @param name Filename relative to asset directory
+ * @return true if full reload is required, false otherwise
+ */
+static bool requires_full_reload(const char* name) {
+    return strcmp(name, "main.lua") == 0 || strcmp(name, "palette.gif") == 0 || strcmp(name, "config.json") == 0;
+}
+#endif
+
+void watcher_init(void) {
+#ifdef __linux__
+    watched_directory = assets_source_directory_get();
+    if (!watched_directory) return;
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        log_error("Failed to create file watcher");
+        return;
+    }
+
+    watch_add(watched_directory);
+
+    log_info("watching: %s", watched_directory);
+#endif
+}
+
+void watcher_destroy(void) {
+#ifdef __linux__
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+        inotify_fd = -1;
+    }
+
+    for (int i = 0; i < watch_count; i++) {
+        free(watches[i].path);
+    }
+    free(watches);
+    watches = NULL;
+    watch_count = 0;
+    watch_capacity = 0;
+
+    free(changes);
+    changes = NULL;
+    change_count = 0;
+    change_capacity = 0;
+#endif
+}
+
+void watcher_update(void) {
+#ifdef __linux__
+    if (inotify_fd < 0) return;
+
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    char path[512];
+
+    while (true) {
+        ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* p = buffer; p < buffer + length; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+
+            if (event->len == 0) continue;
+
+            const char* directory = watch_path_get(event->wd);
+            if (!directory) continue;
+
+            snprintf(path, sizeof(path), "%s/%s", directory, event->name);
+
+            if (event->mask & IN_ISDIR) {
+                if (event->name[0] != '.') {
+                    watch_add(path);
+                }
+                continue;
+            }
+
+            // Wait for created files to be written
+            if (event->mask & IN_CREATE) continue;
+
+            change_add(path);
+        }
+    }
+
+    bool reload = false;
+
+    for (int i = 0; i < change_count; i++) {
+        const char* name = changes[i] + strlen(watched_directory) + 1;
+
+        if (requires_full_reload(name)) {
+            reload = true;
+        }
+        else if (!reload && assets_file_reload(changes[i]) && files_check_extension(name, "lua")) {
+            script_module_reload(name);
+        }
+
+        free(changes[i]);
+    }
+
+    change_count = 0;
+
+    if (reload) {
+        event_t event;
+        event.type = EVENT_RELOAD;
+        event_post(&event);
+    }
+#endif
+}
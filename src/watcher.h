@@ -0,0 +1,28 @@
+/**
+ * @file watcher.h
+ * File watcher module. Responsible for noticing changes to the asset
+ * directory and reloading changed assets without a full reload. Only
+ * supported on Linux, other platforms do nothing.
+ */
+
+#ifndef WATCHER_H
+#define WATCHER_H
+
+/**
+ * Initialize watcher system. Starts watching the asset directory if assets
+ * were loaded from one.
+ */
+void watcher_init(void);
+
+/**
+ * Destroy watcher system.
+ */
+void watcher_destroy(void);
+
+/**
+ * Reload assets changed since last update. Changes to main.lua, palette.gif
+ * or config.json post a reload event instead.
+ */
+void watcher_update(void);
+
+#endif